@@ -38,6 +38,7 @@
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_version_string.h"
 
+#include "math/oskar_cmath.h"
 #include <cstdio>
 #include <cstdlib>
 
@@ -94,9 +95,13 @@ int main(int argc, char** argv)
     oskar_settings_log(s, log);
 
     // Set up the sky model and telescope model.
+    // A chunked sky model file is used directly, without loading it here.
     oskar_Telescope* tel = 0;
-    oskar_Sky* sky = oskar_settings_to_sky(s, log, &status);
-    if (!sky || status)
+    oskar_Sky* sky = 0;
+    const char* sky_file = oskar_settings_to_sky_file(s, &status);
+    if (!sky_file)
+        sky = oskar_settings_to_sky(s, log, &status);
+    if ((!sky && !sky_file) || status)
         oskar_log_error(log, "Failed to set up sky model: %s.",
                 oskar_get_error_string(status));
     else
@@ -110,12 +115,28 @@ int main(int argc, char** argv)
     // Set up the interferometer simulator.
     const char *warning_source_count = 0, *warning_gpu = 0;
     oskar_Interferometer* sim = 0;
-    if (sky && tel)
+    if ((sky || sky_file) && tel)
     {
         sim = oskar_settings_to_interferometer(s, log, &status);
-        oskar_interferometer_set_sky_model(sim, sky, &status);
+        if (sky_file)
+        {
+            const double deg2rad = M_PI / 180.0;
+            s->clear_group();
+            s->begin_group("sky");
+            s->begin_group("oskar_sky_model");
+            s->begin_group("filter");
+            oskar_interferometer_set_sky_model_filter(sim,
+                    s->to_double("flux_min", &status),
+                    s->to_double("flux_max", &status),
+                    s->to_double("radius_inner_deg", &status) * deg2rad,
+                    s->to_double("radius_outer_deg", &status) * deg2rad);
+            s->clear_group();
+            oskar_interferometer_set_sky_model_file(sim, sky_file, &status);
+        }
+        else
+            oskar_interferometer_set_sky_model(sim, sky, &status);
         oskar_interferometer_set_telescope_model(sim, tel, &status);
-        if (oskar_sky_num_sources(sky) < 32 &&
+        if (sky && oskar_sky_num_sources(sky) < 32 &&
                 oskar_interferometer_num_gpus(sim) > 0)
         {
             warning_source_count = "It may be faster to use CPU cores only, "
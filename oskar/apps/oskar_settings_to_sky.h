@@ -59,6 +59,26 @@ OSKAR_APPS_EXPORT
 oskar_Sky* oskar_settings_to_sky(oskar::SettingsTree* s,
         oskar_Log* log, int* status);
 
+/**
+ * @brief
+ * Returns the sky model file that can be used directly by a simulator.
+ *
+ * @details
+ * If the only input in the sky model settings is a single chunked OSKAR
+ * binary sky model file (written using oskar_sky_write_chunked()), with
+ * no source parameter overrides and no output files, this function returns
+ * its path, so that it can be memory-mapped by the simulator instead of
+ * being loaded using oskar_settings_to_sky().
+ * Otherwise, it returns NULL.
+ *
+ * @param[in] s           A pointer to the settings tree.
+ * @param[in,out] status  Status return code.
+ *
+ * @return The path of the sky model file, or NULL.
+ */
+OSKAR_APPS_EXPORT
+const char* oskar_settings_to_sky_file(oskar::SettingsTree* s, int* status);
+
 #endif
 
 #endif /* OSKAR_SETTINGS_TO_SKY_H_ */
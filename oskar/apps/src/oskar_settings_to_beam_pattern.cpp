@@ -46,8 +46,9 @@ oskar_BeamPattern* oskar_settings_to_beam_pattern(oskar::SettingsTree* s,
             OSKAR_DOUBLE : OSKAR_SINGLE;
     oskar_BeamPattern* h = oskar_beam_pattern_create(prec, status);
     oskar_beam_pattern_set_log(h, log);
-    oskar_beam_pattern_set_max_chunk_size(h,
-            s->to_int("max_sources_per_chunk", status));
+    if (!s->starts_with("max_sources_per_chunk", "auto", status))
+        oskar_beam_pattern_set_max_chunk_size(h,
+                s->to_int("max_sources_per_chunk", status));
     if (!s->to_int("use_gpus", status))
         oskar_beam_pattern_set_gpus(h, 0, 0, status);
     else
@@ -61,6 +62,8 @@ oskar_BeamPattern* oskar_settings_to_beam_pattern(oskar::SettingsTree* s,
                 oskar_beam_pattern_set_gpus(h, size, ids, status);
         }
     }
+    oskar_beam_pattern_set_num_threads_per_device(h,
+            s->to_int("num_threads_per_device", status));
     if (s->starts_with("num_devices", "auto", status))
         oskar_beam_pattern_set_num_devices(h, -1);
     else
@@ -121,6 +124,10 @@ oskar_BeamPattern* oskar_settings_to_beam_pattern(oskar::SettingsTree* s,
             s->to_int("average_time_and_channel", status));
     oskar_beam_pattern_set_separate_time_and_channel(h,
             s->to_int("separate_time_and_channel", status));
+    oskar_beam_pattern_set_pixel_list_format(h,
+            s->first_letter("pixel_list_format", status));
+    oskar_beam_pattern_set_fits_compression(h,
+            s->first_letter("fits_compression", status));
     // oskar_beam_pattern_set_stokes(h, s->to_string("stokes", status).c_str());
     s->end_group();
 
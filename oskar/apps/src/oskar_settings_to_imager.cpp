@@ -65,6 +65,9 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
         oskar_imager_set_num_devices(h, -1);
     else
         oskar_imager_set_num_devices(h, s->to_int("num_devices", status));
+    oskar_imager_set_num_read_buffers(h,
+            s->to_int("num_read_buffers", status));
+    oskar_imager_set_cache_vis(h, s->to_int("cache_vis", status));
 
     // Set input and output files.
     int num_files = 0;
@@ -111,6 +114,8 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
     oskar_imager_set_fft_on_gpu(h, s->to_int("fft/use_gpu", status));
     oskar_imager_set_generate_w_kernels_on_gpu(h,
             s->to_int("wproj/generate_w_kernels_on_gpu", status));
+    oskar_imager_set_w_kernel_cache_dir(h,
+            s->to_string("wproj/kernel_cache_dir", status));
     if (s->first_letter("direction", status) == 'R')
         oskar_imager_set_direction(h,
                 s->to_double("direction/ra_deg", status),
@@ -45,8 +45,11 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
             OSKAR_DOUBLE : OSKAR_SINGLE;
     oskar_Interferometer* h = oskar_interferometer_create(prec, status);
     oskar_interferometer_set_log(h, log);
-    oskar_interferometer_set_max_sources_per_chunk(h,
-            s->to_int("max_sources_per_chunk", status));
+    if (s->starts_with("max_sources_per_chunk", "auto", status))
+        oskar_interferometer_set_max_sources_per_chunk(h, 0);
+    else
+        oskar_interferometer_set_max_sources_per_chunk(h,
+                s->to_int("max_sources_per_chunk", status));
     oskar_interferometer_set_settings_path(h, s->file_name());
     if (!s->to_int("use_gpus", status))
         oskar_interferometer_set_gpus(h, 0, 0, status);
@@ -62,6 +65,8 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
                 oskar_interferometer_set_gpus(h, size, ids, status);
         }
     }
+    oskar_interferometer_set_num_threads_per_device(h,
+            s->to_int("num_threads_per_device", status));
     if (s->starts_with("num_devices", "auto", status))
         oskar_interferometer_set_num_devices(h, -1);
     else
@@ -100,14 +105,27 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
     s->begin_group("interferometer");
     oskar_interferometer_set_correlation_type(h,
             s->to_string("correlation_type", status), status);
-    oskar_interferometer_set_max_times_per_block(h,
-            s->to_int("max_time_samples_per_block", status));
+    if (s->starts_with("max_time_samples_per_block", "auto", status))
+        oskar_interferometer_set_max_times_per_block(h, 0);
+    else
+        oskar_interferometer_set_max_times_per_block(h,
+                s->to_int("max_time_samples_per_block", status));
+    if (!s->starts_with("max_memory_usage_gb", "auto", status))
+        oskar_interferometer_set_max_memory_usage(h,
+                s->to_double("max_memory_usage_gb", status));
+    oskar_interferometer_set_num_output_buffers(h,
+            s->to_int("num_output_buffers", status));
+    oskar_interferometer_set_sky_pool_size(h,
+            s->to_int("sky_chunk_pool_size", status));
     oskar_interferometer_set_output_vis_file(h,
             s->to_string("oskar_vis_filename", status));
     oskar_interferometer_set_output_measurement_set(h,
             s->to_string("ms_filename", status));
     oskar_interferometer_set_force_polarised_ms(h,
             s->to_int("force_polarised_ms", status));
+    oskar_interferometer_set_bda(h, s->to_int("enable_bda", status),
+            s->to_double("enable_bda/max_average_duration_sec", status),
+            s->to_double("enable_bda/max_uvw_distance", status));
     s->end_group();
 
     // Return handle to interferometer simulator.
@@ -67,6 +67,8 @@ static void gen_rbpl(oskar_Sky* sky, oskar_Log* log, SettingsTree* s,
 
 static void set_up_filter(oskar_Sky* sky, SettingsTree* s,
         double ra0_rad, double dec0_rad, int* status);
+static int num_files(SettingsTree* s, const char* key, const char** first,
+        int* status);
 static void set_up_extended(oskar_Sky* sky, SettingsTree* s, int* status);
 static void set_up_pol(oskar_Sky* sky, SettingsTree* s, int* status);
 
@@ -146,9 +148,13 @@ oskar_Sky* oskar_settings_to_sky(SettingsTree* s, oskar_Log* log, int* status)
     filename = s->to_string("output_binary_file", status);
     if (filename && strlen(filename) > 0 && !*status)
     {
+        int chunk_size = s->to_int("output_binary_chunk_size", status);
         if (log) oskar_log_message(log, 'M', 1,
                 "Writing sky model binary file: %s", filename);
-        oskar_sky_write(filename, sky, status);
+        if (chunk_size > 0)
+            oskar_sky_write_chunked(filename, sky, chunk_size, status);
+        else
+            oskar_sky_write(filename, sky, status);
     }
 
     s->clear_group();
@@ -156,6 +162,53 @@ oskar_Sky* oskar_settings_to_sky(SettingsTree* s, oskar_Log* log, int* status)
 }
 
 
+const char* oskar_settings_to_sky_file(SettingsTree* s, int* status)
+{
+    int chunk_size = 0, num_chunks = 0, error = 0;
+    const char* filename = 0;
+    if (*status || !s) return 0;
+    s->clear_group();
+    s->begin_group("sky");
+
+    /* Check that there is only one OSKAR sky model file,
+     * with no source parameter overrides. */
+    if (num_files(s, "oskar_sky_model/file", &filename, status) != 1 ||
+            s->to_double("oskar_sky_model/extended_sources/FWHM_major",
+                    status) > 0.0 ||
+            s->to_double("oskar_sky_model/extended_sources/FWHM_minor",
+                    status) > 0.0 ||
+            s->to_int("spectral_index/override", status))
+        filename = 0;
+
+    /* Check that there are no other inputs or outputs. */
+    const char* gsm_file = s->to_string("gsm/file", status);
+    if ((gsm_file && strlen(gsm_file) > 0) ||
+            num_files(s, "fits_image/file", 0, status) > 0 ||
+            num_files(s, "healpix_fits/file", 0, status) > 0 ||
+            s->to_int("generator/grid/side_length", status) > 0 ||
+            s->to_int("generator/healpix/nside", status) > 0 ||
+            s->to_int("generator/random_power_law/num_sources", status) > 0 ||
+            s->to_int("generator/random_broken_power_law/num_sources",
+                    status) > 0)
+        filename = 0;
+    const char* text_file = s->to_string("output_text_file", status);
+    const char* binary_file = s->to_string("output_binary_file", status);
+    if ((text_file && strlen(text_file) > 0) ||
+            (binary_file && strlen(binary_file) > 0))
+        filename = 0;
+    s->clear_group();
+    if (*status || !filename) return 0;
+
+    /* Check that the file is a chunked binary sky model file. */
+    oskar_Binary* h = oskar_binary_create(filename, 'r', &error);
+    oskar_Mem* directory = oskar_sky_read_chunk_directory(h,
+            &chunk_size, &num_chunks, &error);
+    oskar_mem_free(directory, &error);
+    oskar_binary_free(h);
+    return error ? 0 : filename;
+}
+
+
 static void load_osm(oskar_Sky* sky, oskar_Log* log, SettingsTree* s,
         double ra0, double dec0, int* status)
 {
@@ -530,3 +583,19 @@ static void set_up_pol(oskar_Sky* sky, SettingsTree* s, int* status)
             std_pol_angle_rad, seed, status);
     s->end_group();
 }
+
+
+static int num_files(SettingsTree* s, const char* key, const char** first,
+        int* status)
+{
+    int num = 0, count = 0;
+    const char* const* files = s->to_string_list(key, &num, status);
+    if (first) *first = 0;
+    for (int i = 0; i < num; ++i)
+    {
+        if (!files[i] || strlen(files[i]) == 0) continue;
+        if (first && count == 0) *first = files[i];
+        count++;
+    }
+    return count;
+}
@@ -84,6 +84,10 @@ void oskar_beam_pattern_set_coordinate_frame(oskar_BeamPattern* h, char option);
 OSKAR_EXPORT
 void oskar_beam_pattern_set_coordinate_type(oskar_BeamPattern* h, char option);
 
+OSKAR_EXPORT
+void oskar_beam_pattern_set_fits_compression(oskar_BeamPattern* h,
+        char option);
+
 OSKAR_EXPORT
 void oskar_beam_pattern_set_gpus(oskar_BeamPattern* h, int num_gpus,
         const int* cuda_device_ids, int* status);
@@ -105,6 +109,10 @@ void oskar_beam_pattern_set_max_chunk_size(oskar_BeamPattern* h, int value);
 OSKAR_EXPORT
 void oskar_beam_pattern_set_num_devices(oskar_BeamPattern* h, int value);
 
+OSKAR_EXPORT
+void oskar_beam_pattern_set_num_threads_per_device(oskar_BeamPattern* h,
+        int value);
+
 OSKAR_EXPORT
 void oskar_beam_pattern_set_observation_frequency(oskar_BeamPattern* h,
         double start_hz, double inc_hz, int num_channels);
@@ -113,6 +121,10 @@ OSKAR_EXPORT
 void oskar_beam_pattern_set_observation_time(oskar_BeamPattern* h,
         double time_start_mjd_utc, double inc_sec, int num_time_steps);
 
+OSKAR_EXPORT
+void oskar_beam_pattern_set_pixel_list_format(oskar_BeamPattern* h,
+        char option);
+
 OSKAR_EXPORT
 void oskar_beam_pattern_set_root_path(oskar_BeamPattern* h, const char* path);
 
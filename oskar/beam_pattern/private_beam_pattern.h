@@ -26,6 +26,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <binary/oskar_binary.h>
 #include <mem/oskar_mem.h>
 #include <telescope/oskar_telescope.h>
 #include <utility/oskar_timer.h>
@@ -80,13 +81,14 @@ struct DataProduct
     int channel_average;
     fitsfile* fits_file;
     FILE* text_file;
+    oskar_Binary* binary_file;
 };
 typedef struct DataProduct DataProduct;
 
 struct oskar_BeamPattern
 {
     /* Settings. */
-    int prec, num_devices, num_gpus, *gpu_ids;
+    int prec, num_devices, num_gpus, *gpu_ids, num_threads_per_device;
     int coord_type, max_chunk_size;
     int num_time_steps, num_channels, num_chunks;
     int pol_mode, width, height, num_pixels, nside;
@@ -100,6 +102,7 @@ struct oskar_BeamPattern
     double time_start_mjd_utc, time_inc_sec, length_sec;
     double freq_start_hz, freq_inc_hz;
     char average_single_axis, coord_frame_type, coord_grid_type;
+    char fits_compression, pixel_list_format;
     char *root_path, *sky_model_file;
 
     /* State. */
@@ -114,6 +117,7 @@ struct oskar_BeamPattern
     /* Temporary arrays. */
     oskar_Mem* pix; /* Real-valued pixel array to write to file. */
     oskar_Mem* ctemp; /* Complex-valued array used for reordering. */
+    oskar_MemArena* arena; /* Alias handles used by the writer thread. */
 
     /* Settings log data. */
     oskar_Log* log;
@@ -126,6 +130,7 @@ struct oskar_BeamPattern
 
     /* Timers. */
     oskar_Timer *tmr_sim, *tmr_write;
+    size_t num_allocations;
 
     /* Array of DeviceData structures, one per compute device. */
     DeviceData* d;
@@ -154,6 +159,9 @@ enum OSKAR_BEAM_DATA_TYPE
     CROSS_POWER_DATA
 };
 
+/* Name of the tag group used in binary pixel list files. */
+#define OSKAR_BEAM_PATTERN_TAG_GROUP "BEAM_PATTERN"
+
 enum OSKAR_STOKES
 {
     /* IQUV must be 0 to 3. */
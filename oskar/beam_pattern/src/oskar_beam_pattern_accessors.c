@@ -118,6 +118,13 @@ void oskar_beam_pattern_set_cross_power_raw_text(oskar_BeamPattern* h,
 }
 
 
+void oskar_beam_pattern_set_fits_compression(oskar_BeamPattern* h,
+        char option)
+{
+    h->fits_compression = option;
+}
+
+
 void oskar_beam_pattern_set_gpus(oskar_BeamPattern* h, int num,
         const int* ids, int* status)
 {
@@ -193,7 +200,8 @@ void oskar_beam_pattern_set_num_devices(oskar_BeamPattern* h, int value)
     int status = 0;
     oskar_beam_pattern_free_device_data(h, &status);
     if (value < 1)
-        value = (h->num_gpus == 0) ? (oskar_get_num_procs() - 1) : h->num_gpus;
+        value = (h->num_gpus == 0) ? ((oskar_get_num_procs() - 1) /
+                h->num_threads_per_device) : h->num_gpus;
     if (value < 1) value = 1;
     h->num_devices = value;
     h->d = (DeviceData*) realloc(h->d, h->num_devices * sizeof(DeviceData));
@@ -201,6 +209,16 @@ void oskar_beam_pattern_set_num_devices(oskar_BeamPattern* h, int value)
 }
 
 
+void oskar_beam_pattern_set_num_threads_per_device(oskar_BeamPattern* h,
+        int value)
+{
+    int status = 0;
+    oskar_beam_pattern_free_device_data(h, &status);
+    if (value < 1) value = 1;
+    h->num_threads_per_device = value;
+}
+
+
 void oskar_beam_pattern_set_observation_frequency(oskar_BeamPattern* h,
         double start_hz, double inc_hz, int num_channels)
 {
@@ -219,6 +237,13 @@ void oskar_beam_pattern_set_observation_time(oskar_BeamPattern* h,
 }
 
 
+void oskar_beam_pattern_set_pixel_list_format(oskar_BeamPattern* h,
+        char option)
+{
+    h->pixel_list_format = option;
+}
+
+
 void oskar_beam_pattern_set_root_path(oskar_BeamPattern* h, const char* path)
 {
     h->root_path = (char*) realloc(h->root_path, 1 + strlen(path));
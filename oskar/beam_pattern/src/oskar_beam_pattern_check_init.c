@@ -32,6 +32,8 @@
 #include "convert/oskar_convert_fov_to_cellsize.h"
 #include "math/oskar_cmath.h"
 #include "math/private_cond2_2x2.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "utility/oskar_binary_write_metadata.h"
 #include "utility/oskar_device_utils.h"
 #include "utility/oskar_file_exists.h"
 #include "oskar_version.h"
@@ -57,12 +59,17 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status);
 static void write_axis(fitsfile* fptr, int axis_id, const char* ctype,
         const char* ctype_comment, double crval, double cdelt, double crpix,
         int* status);
+static void write_fits_header(fitsfile* f, int num_axes, int width,
+        int height, double centre_deg[2], double fov_deg[2],
+        double start_time_mjd, double delta_time_sec, double start_freq_hz,
+        double delta_freq_hz, int horizon_mode, const char* settings_log,
+        size_t settings_log_length, int* status);
 static fitsfile* create_fits_file(const char* filename, int precision,
         int width, int height, int num_times, int num_channels,
         double centre_deg[2], double fov_deg[2], double start_time_mjd,
         double delta_time_sec, double start_freq_hz, double delta_freq_hz,
-        int horizon_mode, const char* settings_log, size_t settings_log_length,
-        int* status);
+        int horizon_mode, char compression, int tile_height,
+        const char* settings_log, size_t settings_log_length, int* status);
 static int data_product_index(oskar_BeamPattern* h, int data_product_type,
         int stokes_in, int stokes_out, int i_station, int time_average,
         int channel_average);
@@ -75,6 +82,9 @@ static void new_fits_file(oskar_BeamPattern* h, int data_product_type,
 static void new_text_file(oskar_BeamPattern* h, int data_product_type,
         int stokes_in, int stokes_out, int i_station, int channel_average,
         int time_average, int* status);
+static void new_binary_file(oskar_BeamPattern* h, int data_product_type,
+        int stokes_in, int stokes_out, int i_station, int time_average,
+        int channel_average, int* status);
 static const char* data_type_to_string(int type);
 static const char* stokes_type_to_string(int type);
 
@@ -107,6 +117,21 @@ static void set_up_host_data(oskar_BeamPattern* h, int *status)
     oskar_beam_pattern_generate_coordinates(h,
             OSKAR_SPHERICAL_TYPE_EQUATORIAL, status);
 
+    /* Compressed FITS images are written using one tile per chunk,
+     * so make each chunk hold whole rows, to avoid recompressing tiles. */
+    if (h->fits_compression != 'N' && h->coord_grid_type == 'B' &&
+            h->width > 0 && h->max_chunk_size % h->width != 0)
+    {
+        const int old_chunk_size = h->max_chunk_size;
+        if (h->max_chunk_size < h->width)
+            h->max_chunk_size = h->width;
+        else
+            h->max_chunk_size -= h->max_chunk_size % h->width;
+        oskar_log_message(h->log, 'M', 0, "Adjusted pixel chunk size from "
+                "%d to %d to hold whole image rows for compressed FITS "
+                "output.", old_chunk_size, h->max_chunk_size);
+    }
+
     /* Work out how many pixel chunks have to be processed. */
     h->num_chunks = (h->num_pixels + h->max_chunk_size - 1) / h->max_chunk_size;
 
@@ -117,6 +142,7 @@ static void set_up_host_data(oskar_BeamPattern* h, int *status)
                 h->max_chunk_size, status);
         h->ctemp = oskar_mem_create(h->prec | OSKAR_COMPLEX, OSKAR_CPU,
                 h->max_chunk_size, status);
+        h->arena = oskar_mem_arena_create(OSKAR_CPU, status);
     }
 
     /* Get the contents of the log at this point so we can write a
@@ -279,32 +305,17 @@ static void write_axis(fitsfile* fptr, int axis_id, const char* ctype,
 }
 
 
-static fitsfile* create_fits_file(const char* filename, int precision,
-        int width, int height, int num_times, int num_channels,
-        double centre_deg[2], double fov_deg[2], double start_time_mjd,
-        double delta_time_sec, double start_freq_hz, double delta_freq_hz,
-        int horizon_mode, const char* settings_log, size_t settings_log_length,
-        int* status)
+static void write_fits_header(fitsfile* f, int num_axes, int width,
+        int height, double centre_deg[2], double fov_deg[2],
+        double start_time_mjd, double delta_time_sec, double start_freq_hz,
+        double delta_freq_hz, int horizon_mode, const char* settings_log,
+        size_t settings_log_length, int* status)
 {
-    int imagetype;
-    long naxes[4], naxes_dummy[4] = {1l, 1l, 1l, 1l};
     double delta;
     const double deg2rad = M_PI / 180.0;
     const double rad2deg = 180.0 / M_PI;
-    fitsfile* f = 0;
     const char* line;
     size_t length;
-    if (*status) return 0;
-
-    /* Create a new FITS file and write the image headers. */
-    if (oskar_file_exists(filename)) remove(filename);
-    imagetype = (precision == OSKAR_DOUBLE ? DOUBLE_IMG : FLOAT_IMG);
-    naxes[0]  = width;
-    naxes[1]  = height;
-    naxes[2]  = num_channels;
-    naxes[3]  = num_times;
-    fits_create_file(&f, filename, status);
-    fits_create_img(f, imagetype, 4, naxes_dummy, status);
     fits_write_date(f, status);
     fits_write_key_str(f, "TELESCOP", "OSKAR " OSKAR_VERSION_STR, 0, status);
 
@@ -329,8 +340,9 @@ static fitsfile* create_fits_file(const char* filename, int precision,
     }
     write_axis(f, 3, "FREQ", "Frequency",
             start_freq_hz, delta_freq_hz, 1.0, status);
-    write_axis(f, 4, "UTC", "Time",
-            start_time_mjd * 86400.0, delta_time_sec, 1.0, status);
+    if (num_axes > 3)
+        write_axis(f, 4, "UTC", "Time",
+                start_time_mjd * 86400.0, delta_time_sec, 1.0, status);
 
     /* Write other headers. */
     fits_write_key_str(f, "TIMESYS", "UTC", NULL, status);
@@ -355,17 +367,70 @@ static fitsfile* create_fits_file(const char* filename, int precision,
         length -= (eol - line);
         line = eol;
     }
+}
+
 
-    /* Update header keywords with the correct axis lengths.
-     * Needs to be done here because CFITSIO doesn't let us write only the
-     * file header with the correct axis lengths to start with. This trick
-     * allows us to create a small dummy image block to write only the headers,
-     * and not waste effort moving a huge block of zeros within the file. */
-    fits_update_key_lng(f, "NAXIS1", naxes[0], 0, status);
-    fits_update_key_lng(f, "NAXIS2", naxes[1], 0, status);
-    fits_update_key_lng(f, "NAXIS3", naxes[2], 0, status);
-    fits_update_key_lng(f, "NAXIS4", naxes[3], 0, status);
+static fitsfile* create_fits_file(const char* filename, int precision,
+        int width, int height, int num_times, int num_channels,
+        double centre_deg[2], double fov_deg[2], double start_time_mjd,
+        double delta_time_sec, double start_freq_hz, double delta_freq_hz,
+        int horizon_mode, char compression, int tile_height,
+        const char* settings_log, size_t settings_log_length, int* status)
+{
+    int imagetype, t;
+    long naxes[4], naxes_dummy[4] = {1l, 1l, 1l, 1l}, tile[3];
+    fitsfile* f = 0;
+    if (*status) return 0;
+
+    /* Create a new FITS file. */
+    if (oskar_file_exists(filename)) remove(filename);
+    imagetype = (precision == OSKAR_DOUBLE ? DOUBLE_IMG : FLOAT_IMG);
+    naxes[0]  = width;
+    naxes[1]  = height;
+    naxes[2]  = num_channels;
+    naxes[3]  = num_times;
+    fits_create_file(&f, filename, status);
+    if (compression == 'N')
+    {
+        /* Write the image headers. */
+        fits_create_img(f, imagetype, 4, naxes_dummy, status);
+        write_fits_header(f, 4, width, height, centre_deg, fov_deg,
+                start_time_mjd, delta_time_sec, start_freq_hz, delta_freq_hz,
+                horizon_mode, settings_log, settings_log_length, status);
+
+        /* Update header keywords with the correct axis lengths.
+         * Needs to be done here because CFITSIO doesn't let us write only
+         * the file header with the correct axis lengths to start with.
+         * This trick allows us to create a small dummy image block to write
+         * only the headers, and not waste effort moving a huge block of
+         * zeros within the file. */
+        fits_update_key_lng(f, "NAXIS1", naxes[0], 0, status);
+        fits_update_key_lng(f, "NAXIS2", naxes[1], 0, status);
+        fits_update_key_lng(f, "NAXIS3", naxes[2], 0, status);
+        fits_update_key_lng(f, "NAXIS4", naxes[3], 0, status);
+        return f;
+    }
 
+    /* CFITSIO can only compress images with up to three axes, so write
+     * each time step as a separate tile-compressed image extension.
+     * Each tile holds the image rows of one pixel chunk, and floating-point
+     * values are not quantised, so the compression is lossless.
+     * Creating a compressed image does not write any pixel data. */
+    tile[0] = width;
+    tile[1] = tile_height < 1 ? 1 : (tile_height > height ? height : tile_height);
+    tile[2] = 1;
+    for (t = 0; t < num_times; ++t)
+    {
+        fits_set_compression_type(f, GZIP_2, status);
+        fits_set_tile_dim(f, 3, tile, status);
+        fits_set_quantize_level(f, 0.0f, status);
+        fits_create_img(f, imagetype, 3, naxes, status);
+        write_fits_header(f, 3, width, height, centre_deg, fov_deg,
+                start_time_mjd + t * delta_time_sec / 86400.0,
+                delta_time_sec, start_freq_hz, delta_freq_hz, horizon_mode,
+                t == 0 ? settings_log : 0, t == 0 ? settings_log_length : 0,
+                status);
+    }
     return f;
 }
 
@@ -454,7 +519,9 @@ static void new_fits_file(oskar_BeamPattern* h, int data_product_type,
             (channel_average ? 1 : h->num_channels),
             h->phase_centre_deg, h->fov_deg, h->time_start_mjd_utc,
             h->time_inc_sec, h->freq_start_hz, h->freq_inc_hz,
-            horizon_mode, h->settings_log, h->settings_log_length, status);
+            horizon_mode, h->fits_compression,
+            h->width > 0 ? h->max_chunk_size / h->width : 1, h->settings_log,
+            h->settings_log_length, status);
     if (!f || *status)
     {
         *status = OSKAR_ERR_FILE_IO;
@@ -481,6 +548,14 @@ static void new_text_file(oskar_BeamPattern* h, int data_product_type,
     if ((stokes_in > I || stokes_out > I) && h->pol_mode != OSKAR_POL_MODE_FULL)
         return;
 
+    /* Write binary files instead of text files if required. */
+    if (h->pixel_list_format == 'B')
+    {
+        new_binary_file(h, data_product_type, stokes_in, stokes_out,
+                i_station, time_average, channel_average, status);
+        return;
+    }
+
     /* Construct the filename. */
     name = construct_filename(h, data_product_type, stokes_in, stokes_out,
             i_station, time_average, channel_average, "txt");
@@ -518,6 +593,68 @@ static void new_text_file(oskar_BeamPattern* h, int data_product_type,
 }
 
 
+static void new_binary_file(oskar_BeamPattern* h, int data_product_type,
+        int stokes_in, int stokes_out, int i_station, int time_average,
+        int channel_average, int* status)
+{
+    int i;
+    char* name;
+    oskar_Binary* f;
+    const char* grp = OSKAR_BEAM_PATTERN_TAG_GROUP;
+    if (*status) return;
+
+    /* Construct the filename. */
+    name = construct_filename(h, data_product_type, stokes_in, stokes_out,
+            i_station, time_average, channel_average, "bin");
+
+    /* Create the file and write the dimensions of the data. */
+    f = oskar_binary_create(name, 'w', status);
+    if (!f || *status)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        free(name);
+        return;
+    }
+    oskar_binary_set_write_index(f, 1);
+    oskar_binary_write_metadata(f, status);
+    oskar_binary_write_ext(f, OSKAR_CHAR, grp, "DATA_TYPE", 0,
+            1 + strlen(data_type_to_string(data_product_type)),
+            data_type_to_string(data_product_type), status);
+    if (stokes_in >= 0)
+        oskar_binary_write_ext(f, OSKAR_CHAR, grp, "STOKES_IN", 0,
+                1 + strlen(stokes_type_to_string(stokes_in)),
+                stokes_type_to_string(stokes_in), status);
+    if (stokes_out >= 0)
+        oskar_binary_write_ext(f, OSKAR_CHAR, grp, "STOKES_OUT", 0,
+                1 + strlen(stokes_type_to_string(stokes_out)),
+                stokes_type_to_string(stokes_out), status);
+    oskar_binary_write_ext_int(f, grp, "STATION_ID", 0,
+            i_station >= 0 ? h->station_ids[i_station] : -1, status);
+    oskar_binary_write_ext_int(f, grp, "NUM_CHUNKS", 0,
+            h->num_chunks, status);
+    oskar_binary_write_ext_int(f, grp, "NUM_TIMES", 0,
+            time_average ? 1 : h->num_time_steps, status);
+    oskar_binary_write_ext_int(f, grp, "NUM_CHANNELS", 0,
+            channel_average ? 1 : h->num_channels, status);
+    oskar_binary_write_ext_int(f, grp, "MAX_CHUNK_SIZE", 0,
+            h->max_chunk_size, status);
+    oskar_binary_write_ext_int(f, grp, "NUM_PIXELS", 0,
+            h->num_pixels, status);
+    oskar_binary_write_ext_double(f, grp, "TIME_START_MJD_UTC", 0,
+            h->time_start_mjd_utc, status);
+    oskar_binary_write_ext_double(f, grp, "TIME_INC_SEC", 0,
+            h->time_inc_sec, status);
+    oskar_binary_write_ext_double(f, grp, "FREQ_START_HZ", 0,
+            h->freq_start_hz, status);
+    oskar_binary_write_ext_double(f, grp, "FREQ_INC_HZ", 0,
+            h->freq_inc_hz, status);
+    i = data_product_index(h, data_product_type, stokes_in, stokes_out,
+            i_station, time_average, channel_average);
+    h->data_products[i].binary_file = f;
+    free(name);
+}
+
+
 static const char* data_type_to_string(int type)
 {
     switch (type)
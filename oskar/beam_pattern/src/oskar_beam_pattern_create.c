@@ -47,6 +47,7 @@ oskar_BeamPattern* oskar_beam_pattern_create(int precision, int* status)
     h->barrier   = oskar_barrier_create(0);
 
     /* Set sensible defaults. */
+    h->num_threads_per_device = 1;
     oskar_beam_pattern_set_gpus(h, -1, 0, status);
     oskar_beam_pattern_set_num_devices(h, -1);
     oskar_beam_pattern_set_max_chunk_size(h, 16384);
@@ -57,6 +58,8 @@ oskar_BeamPattern* oskar_beam_pattern_create(int precision, int* status)
     oskar_beam_pattern_set_image_size(h, 256, 256);
     oskar_beam_pattern_set_image_fov(h, 2.0, 2.0);
     oskar_beam_pattern_set_separate_time_and_channel(h, 1);
+    oskar_beam_pattern_set_pixel_list_format(h, 'T'); /* Text. */
+    oskar_beam_pattern_set_fits_compression(h, 'N'); /* None. */
     return h;
 }
 
@@ -48,7 +48,9 @@ void oskar_beam_pattern_reset_cache(oskar_BeamPattern* h, int* status)
     oskar_mem_free(h->z, status);
     oskar_mem_free(h->pix, status);
     oskar_mem_free(h->ctemp, status);
+    oskar_mem_arena_free(h->arena, status);
     h->x = h->y = h->z = h->pix = h->ctemp = NULL;
+    h->arena = NULL;
 
     /* Close files and free data products. */
     for (i = 0; i < h->num_data_products; ++i)
@@ -57,6 +59,8 @@ void oskar_beam_pattern_reset_cache(oskar_BeamPattern* h, int* status)
             fclose(h->data_products[i].text_file);
         if (h->data_products[i].fits_file)
             ffclos(h->data_products[i].fits_file, status);
+        if (h->data_products[i].binary_file)
+            oskar_binary_free(h->data_products[i].binary_file);
     }
     free(h->data_products);
     h->data_products = NULL;
@@ -32,8 +32,10 @@
 #include "correlate/oskar_evaluate_auto_power.h"
 #include "correlate/oskar_evaluate_cross_power.h"
 #include "telescope/station/oskar_evaluate_station_beam.h"
+#include "telescope/station/oskar_station_work.h"
 #include "math/oskar_cmath.h"
 #include "math/private_cond2_2x2.h"
+#include "mem/oskar_binary_write_mem.h"
 #include "utility/oskar_cuda_mem_log.h"
 #include "utility/oskar_device_utils.h"
 #include "utility/oskar_file_exists.h"
@@ -132,6 +134,7 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
 
     /* Start simulation timer. */
     oskar_timer_start(h->tmr_sim);
+    h->num_allocations = oskar_mem_allocation_count();
 
     /* Start the worker threads. */
     for (i = 0; i < num_threads; ++i)
@@ -145,6 +148,7 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
     }
     free(threads);
     free(args);
+    h->num_allocations = oskar_mem_allocation_count() - h->num_allocations;
 
     /* Get status code. */
     *status = h->status;
@@ -193,6 +197,10 @@ static void* run_blocks(void* arg)
 
     if (device_id >= 0 && device_id < h->num_gpus)
         oskar_device_set(h->gpu_ids[device_id], status);
+#ifdef _OPENMP
+    else if (device_id >= 0)
+        omp_set_num_threads(h->num_threads_per_device);
+#endif
 
     /* Set ranges of inner and outer loops based on averaging mode. */
     if (h->average_single_axis != 'T')
@@ -262,9 +270,10 @@ static void* run_blocks(void* arg)
 static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
         int i_channel, int i_active, int device_id, int* status)
 {
-    int chunk_size, i_chunk, i;
+    int chunk_size, i_chunk, i, mark;
     double dt_dump, mjd, gast, freq_hz;
     oskar_Mem *input_alias, *output_alias;
+    oskar_MemArena* arena;
     DeviceData* d;
 
     /* Check if safe to proceed. */
@@ -301,8 +310,10 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
     }
 
     /* Generate beam for this pixel chunk, for all active stations. */
-    input_alias  = oskar_mem_create_alias(0, 0, 0, status);
-    output_alias = oskar_mem_create_alias(0, 0, 0, status);
+    arena = oskar_station_work_arena(d->work);
+    mark = oskar_mem_arena_mark(arena);
+    input_alias  = oskar_mem_arena_alias(arena, 0, 0, 0, status);
+    output_alias = oskar_mem_arena_alias(arena, 0, 0, 0, status);
     for (i = 0; i < h->num_active_stations; ++i)
     {
         oskar_mem_set_alias(input_alias, d->jones_data,
@@ -342,8 +353,7 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
     if (d->cross_power[I])
         oskar_evaluate_cross_power(chunk_size, h->num_active_stations,
                 d->jones_data, d->cross_power[I], status);
-    oskar_mem_free(input_alias, status);
-    oskar_mem_free(output_alias, status);
+    oskar_mem_arena_release(arena, mark);
 
     /* Copy the output data into host memory. */
     if (d->jones_data_cpu[i_active])
@@ -546,11 +556,13 @@ static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
     {
         fitsfile* f;
         FILE* t;
-        int dp, stokes_out, i_station, off;
+        oskar_Binary* b;
+        int dp, stokes_out, i_station, off, idx;
 
         /* Get data product info. */
         f          = h->data_products[i].fits_file;
         t          = h->data_products[i].text_file;
+        b          = h->data_products[i].binary_file;
         dp         = h->data_products[i].type;
         stokes_out = h->data_products[i].stokes_out;
         i_station  = h->data_products[i].i_station;
@@ -561,20 +573,32 @@ static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
                 h->data_products[i].stokes_in != stokes_in)
             continue;
 
+        /* Get the index of the record in a binary file. */
+        idx = i_chunk;
+        idx = idx * (time_average ? 1 : h->num_time_steps) + i_time;
+        idx = idx * (channel_average ? 1 : h->num_channels) + i_channel;
+
         /* Treat raw data output as special case, as it doesn't go via pix. */
-        if (dp == RAW_COMPLEX && chunk_desc == JONES_DATA && t)
+        if (dp == RAW_COMPLEX && chunk_desc == JONES_DATA && (t || b))
         {
+            const int mark = oskar_mem_arena_mark(h->arena);
             oskar_Mem* station_data;
-            station_data = oskar_mem_create_alias(in, i_station * num_pix,
+            station_data = oskar_mem_arena_alias(h->arena, in,
+                    i_station * num_pix, num_pix, status);
+            if (t) oskar_mem_save_ascii(t, 1, num_pix, status, station_data);
+            if (b) oskar_binary_write_mem_ext(b, station_data,
+                    OSKAR_BEAM_PATTERN_TAG_GROUP, "PIXELS", idx,
                     num_pix, status);
-            oskar_mem_save_ascii(t, 1, num_pix, status, station_data);
-            oskar_mem_free(station_data, status);
+            oskar_mem_arena_release(h->arena, mark);
             continue;
         }
         if (dp == CROSS_POWER_RAW_COMPLEX &&
-                chunk_desc == CROSS_POWER_DATA && t)
+                chunk_desc == CROSS_POWER_DATA && (t || b))
         {
-            oskar_mem_save_ascii(t, 1, num_pix, status, in);
+            if (t) oskar_mem_save_ascii(t, 1, num_pix, status, in);
+            if (b) oskar_binary_write_mem_ext(b, in,
+                    OSKAR_BEAM_PATTERN_TAG_GROUP, "PIXELS", idx,
+                    num_pix, status);
             continue;
         }
 
@@ -636,7 +660,7 @@ static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
         else continue;
 
         /* Check for FITS file. */
-        if (f && h->width && h->height)
+        if (f && h->width && h->height && h->fits_compression == 'N')
         {
             long firstpix[4];
             firstpix[0] = 1 + (i_chunk * h->max_chunk_size) % h->width;
@@ -646,9 +670,20 @@ static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
             fits_write_pix(f, (h->prec == OSKAR_DOUBLE ? TDOUBLE : TFLOAT),
                     firstpix, num_pix, oskar_mem_void(h->pix), status);
         }
+        else if (f && h->width && h->height)
+        {
+            /* Compressed images have one extension per time step. */
+            LONGLONG firstelem = 1 + (LONGLONG) i_chunk * h->max_chunk_size +
+                    (LONGLONG) i_channel * h->width * h->height;
+            fits_movabs_hdu(f, 2 + i_time, 0, status);
+            fits_write_img(f, (h->prec == OSKAR_DOUBLE ? TDOUBLE : TFLOAT),
+                    firstelem, num_pix, oskar_mem_void(h->pix), status);
+        }
 
-        /* Check for text file. */
+        /* Check for text or binary file. */
         if (t) oskar_mem_save_ascii(t, 1, num_pix, status, h->pix);
+        if (b) oskar_binary_write_mem_ext(b, h->pix,
+                OSKAR_BEAM_PATTERN_TAG_GROUP, "PIXELS", idx, num_pix, status);
     }
 }
 
@@ -930,6 +965,8 @@ static void record_timing(oskar_BeamPattern* h)
     }
     oskar_log_value(h->log, 'M', 0, "Write", "%.3f s",
             oskar_timer_elapsed(h->tmr_write));
+    oskar_log_value(h->log, 'M', 0, "Memory allocations", "%lu",
+            (unsigned long) h->num_allocations);
 }
 
 
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <gtest/gtest.h>
+
+#include <fitsio.h>
+#include "beam_pattern/oskar_beam_pattern.h"
+#include "binary/oskar_binary.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+static const int width = 12, height = 10, num_times = 2, num_channels = 2;
+
+static oskar_Telescope* create_telescope(const char* dir, int* status)
+{
+    FILE* f;
+    char *path, *station_dir;
+
+    // Write a telescope model with two stations of four elements each.
+    station_dir = oskar_dir_get_path(dir, "station001");
+    oskar_dir_mkpath(station_dir);
+    path = oskar_dir_get_path(dir, "position.txt");
+    f = fopen(path, "w");
+    fprintf(f, "0.0, -50.0\n");
+    fclose(f);
+    free(path);
+    path = oskar_dir_get_path(dir, "layout.txt");
+    f = fopen(path, "w");
+    fprintf(f, "0.0, 0.0\n100.0, 50.0\n");
+    fclose(f);
+    free(path);
+    path = oskar_dir_get_path(station_dir, "layout.txt");
+    f = fopen(path, "w");
+    fprintf(f, "-1.5, -1.0\n1.5, -1.0\n-1.5, 1.0\n1.5, 1.0\n");
+    fclose(f);
+    free(path);
+    free(station_dir);
+
+    // Load it.
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, 0, status);
+    oskar_telescope_set_enable_numerical_patterns(tel, 0);
+    oskar_telescope_load(tel, dir, NULL, status);
+    oskar_telescope_set_phase_centre(tel, OSKAR_SPHERICAL_TYPE_EQUATORIAL,
+            20.0 * M_PI / 180.0, -50.0 * M_PI / 180.0);
+    return tel;
+}
+
+static void run_beam_pattern(const oskar_Telescope* tel, const char* root,
+        int max_chunk_size, char compression, char pixel_list_format,
+        int* status)
+{
+    oskar_BeamPattern* h = oskar_beam_pattern_create(OSKAR_DOUBLE, status);
+    oskar_beam_pattern_set_gpus(h, 0, 0, status);
+    oskar_beam_pattern_set_num_devices(h, 1);
+    oskar_beam_pattern_set_observation_time(h, 51544.5, 3600.0, num_times);
+    oskar_beam_pattern_set_observation_frequency(h, 100e6, 20e6,
+            num_channels);
+    oskar_beam_pattern_set_image_size(h, width, height);
+    oskar_beam_pattern_set_image_fov(h, 60.0, 60.0);
+    oskar_beam_pattern_set_max_chunk_size(h, max_chunk_size);
+    oskar_beam_pattern_set_fits_compression(h, compression);
+    oskar_beam_pattern_set_pixel_list_format(h, pixel_list_format);
+    oskar_beam_pattern_set_voltage_amp_fits(h, 1);
+    oskar_beam_pattern_set_voltage_raw_text(h, 1);
+    oskar_beam_pattern_set_root_path(h, root);
+    oskar_beam_pattern_set_telescope_model(h, tel, status);
+    oskar_beam_pattern_run(h, status);
+    oskar_beam_pattern_free(h, status);
+}
+
+// Reorders values from [chunk][time][channel][pixel][value]
+// to [time][channel][pixel][value].
+static vector<double> reorder_chunks(const vector<double>& in,
+        int max_chunk_size, int values_per_pixel)
+{
+    const int num_pixels = width * height;
+    vector<double> out(in.size());
+    size_t i = 0;
+    for (int start = 0; start < num_pixels; start += max_chunk_size)
+    {
+        int chunk_size = max_chunk_size;
+        if (start + chunk_size > num_pixels) chunk_size = num_pixels - start;
+        for (int t = 0; t < num_times; ++t)
+        {
+            for (int c = 0; c < num_channels; ++c)
+            {
+                size_t o = ((size_t)(t * num_channels + c) * num_pixels +
+                        start) * values_per_pixel;
+                for (int p = 0; p < chunk_size * values_per_pixel; ++p)
+                    out.at(o + p) = in.at(i++);
+            }
+        }
+    }
+    return out;
+}
+
+static vector<double> read_text(const string& filename)
+{
+    vector<double> values;
+    char line[4096];
+    FILE* f = fopen(filename.c_str(), "r");
+    if (!f) return values;
+    while (fgets(line, sizeof(line), f))
+    {
+        if (line[0] == '#') continue;
+        char *ptr = line, *end = 0;
+        for (;;)
+        {
+            double v = strtod(ptr, &end);
+            if (end == ptr) break;
+            values.push_back(v);
+            ptr = end;
+        }
+    }
+    fclose(f);
+    return values;
+}
+
+static vector<double> read_binary(const string& filename, int type,
+        int* num_chunks, int* max_chunk_size, int* status)
+{
+    vector<double> values;
+    const char* grp = "BEAM_PATTERN";
+    oskar_Binary* h = oskar_binary_create(filename.c_str(), 'r', status);
+    int nt = 0, nc = 0;
+    oskar_binary_read_ext_int(h, grp, "NUM_CHUNKS", 0, num_chunks, status);
+    oskar_binary_read_ext_int(h, grp, "MAX_CHUNK_SIZE", 0,
+            max_chunk_size, status);
+    oskar_binary_read_ext_int(h, grp, "NUM_TIMES", 0, &nt, status);
+    oskar_binary_read_ext_int(h, grp, "NUM_CHANNELS", 0, &nc, status);
+    EXPECT_EQ(num_times, nt);
+    EXPECT_EQ(num_channels, nc);
+    oskar_Mem* m = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    for (int i = 0; i < *num_chunks * nt * nc && !*status; ++i)
+    {
+        oskar_binary_read_mem_ext(h, m, grp, "PIXELS", i, status);
+        const double* d = (const double*) oskar_mem_void_const(m);
+        size_t n = oskar_mem_length(m) *
+                oskar_mem_element_size(oskar_mem_type(m)) / sizeof(double);
+        values.insert(values.end(), d, d + n);
+    }
+    oskar_mem_free(m, status);
+    oskar_binary_free(h);
+    return values;
+}
+
+static vector<double> read_fits(const string& filename, int* num_hdus,
+        int* status)
+{
+    const long num_pixels = width * height * num_channels;
+    vector<double> values;
+    fitsfile* f = 0;
+    fits_open_file(&f, filename.c_str(), READONLY, status);
+    fits_get_num_hdus(f, num_hdus, status);
+    if (*num_hdus == 1)
+    {
+        values.resize(num_pixels * num_times);
+        fits_read_img(f, TDOUBLE, 1, num_pixels * num_times, 0,
+                &values[0], 0, status);
+    }
+    else
+    {
+        // Compressed images have one extension per time step.
+        for (int t = 0; t < *num_hdus - 1 && !*status; ++t)
+        {
+            values.resize(values.size() + num_pixels);
+            fits_movabs_hdu(f, 2 + t, 0, status);
+            fits_read_img(f, TDOUBLE, 1, num_pixels, 0,
+                    &values[values.size() - num_pixels], 0, status);
+        }
+    }
+    if (f) fits_close_file(f, status);
+    return values;
+}
+
+TEST(beam_pattern_output, binary_and_compressed_fits)
+{
+    int status = 0;
+    const char* tm = "temp_test_beam_pattern_output.tm";
+    const string plain = "temp_test_beam_pattern_plain";
+    const string packed = "temp_test_beam_pattern_packed";
+    const string small = "temp_test_beam_pattern_small";
+    const string suffix = "_S0000_TIME_SEP_CHAN_SEP_";
+    const int chunk_size = 30;
+
+    oskar_Telescope* tel = create_telescope(tm, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Write text and uncompressed FITS, then binary and compressed FITS.
+    // The chunk size is not a multiple of the image width, so must be
+    // adjusted for compressed output.
+    run_beam_pattern(tel, plain.c_str(), chunk_size, 'N', 'T', &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    run_beam_pattern(tel, packed.c_str(), chunk_size, 'G', 'B', &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Chunks smaller than one image row must also be adjusted.
+    run_beam_pattern(tel, small.c_str(), width / 2, 'G', 'T', &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_telescope_free(tel, &status);
+
+    // Check the binary pixel list matches the text version.
+    int num_chunks = 0, packed_chunk_size = 0;
+    vector<double> text = read_text(plain + suffix + "RAW_COMPLEX.txt");
+    vector<double> bin = read_binary(packed + suffix + "RAW_COMPLEX.bin",
+            OSKAR_DOUBLE_COMPLEX_MATRIX, &num_chunks, &packed_chunk_size,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(2 * width, packed_chunk_size);
+    EXPECT_EQ((height + 1) / 2, num_chunks);
+    const int values_per_pixel = 8; // Complex 2x2 matrix.
+    ASSERT_EQ((size_t)(width * height * num_times * num_channels *
+            values_per_pixel), text.size());
+    ASSERT_EQ(text.size(), bin.size());
+    text = reorder_chunks(text, chunk_size, values_per_pixel);
+    bin = reorder_chunks(bin, packed_chunk_size, values_per_pixel);
+    for (size_t i = 0; i < text.size(); ++i)
+        EXPECT_NEAR(text[i], bin[i], 1e-12 * (1.0 + fabs(text[i])));
+
+    // Check the compressed FITS images are identical to the uncompressed one.
+    int plain_hdus = 0, packed_hdus = 0, small_hdus = 0;
+    vector<double> a = read_fits(plain + suffix + "AMP_XX.fits",
+            &plain_hdus, &status);
+    vector<double> b = read_fits(packed + suffix + "AMP_XX.fits",
+            &packed_hdus, &status);
+    vector<double> c = read_fits(small + suffix + "AMP_XX.fits",
+            &small_hdus, &status);
+    ASSERT_EQ(0, status);
+    EXPECT_EQ(1, plain_hdus);
+    EXPECT_EQ(1 + num_times, packed_hdus);
+    EXPECT_EQ(1 + num_times, small_hdus);
+    ASSERT_EQ(a.size(), b.size());
+    ASSERT_EQ(a.size(), c.size());
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        EXPECT_EQ(a[i], b[i]);
+        EXPECT_EQ(a[i], c[i]);
+    }
+
+    // Clean up.
+    const char* stokes[] = {"XX", "XY", "YX", "YY"};
+    for (int i = 0; i < 4; ++i)
+    {
+        remove((plain + suffix + "AMP_" + stokes[i] + ".fits").c_str());
+        remove((packed + suffix + "AMP_" + stokes[i] + ".fits").c_str());
+        remove((small + suffix + "AMP_" + stokes[i] + ".fits").c_str());
+    }
+    remove((plain + suffix + "RAW_COMPLEX.txt").c_str());
+    remove((small + suffix + "RAW_COMPLEX.txt").c_str());
+    remove((packed + suffix + "RAW_COMPLEX.bin").c_str());
+    oskar_dir_remove(tm);
+}
@@ -59,6 +59,28 @@ OSKAR_BINARY_EXPORT
 void oskar_binary_read_block(oskar_Binary* handle,
         int chunk_index, size_t data_size, void* data, int* status);
 
+/**
+ * @brief Returns a pointer to the payload of a tag in a memory-mapped file.
+ *
+ * @details
+ * If the file could be mapped into memory when it was opened, this function
+ * returns a pointer to the payload of the given chunk without copying it.
+ * The CRC code of the chunk is checked first, if present.
+ *
+ * NULL is returned if the file is not mapped, in which case
+ * oskar_binary_read_block() must be used instead.
+ *
+ * The pointer remains valid until the handle is freed. The mapping is
+ * private, so any modifications made through it are not written to the file.
+ *
+ * @param[in,out] handle   Binary file handle.
+ * @param[in] chunk_index  Sequence index of the chunk's tag in the file.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_BINARY_EXPORT
+void* oskar_binary_map_block(oskar_Binary* handle, int chunk_index,
+        int* status);
+
 /**
  * @brief Reads a block of binary data for a single tag from an input stream.
  *
@@ -178,6 +178,22 @@ OSKAR_BINARY_EXPORT
 void oskar_binary_write_ext_int(oskar_Binary* handle, const char* name_group,
         const char* name_tag, int user_index, int value, int* status);
 
+/**
+ * @brief Sets whether a tag index is written when the file is closed.
+ *
+ * @details
+ * If enabled, an index of all chunks written to a new file is appended to it
+ * by oskar_binary_free(), so that the file can be opened for reading without
+ * scanning every tag. Files with an index remain readable by older versions.
+ *
+ * This has no effect on files opened in append mode.
+ *
+ * @param[in,out] handle   Binary file handle.
+ * @param[in] value        If true, write a tag index.
+ */
+OSKAR_BINARY_EXPORT
+void oskar_binary_set_write_index(oskar_Binary* handle, int value);
+
 #ifdef __cplusplus
 }
 #endif
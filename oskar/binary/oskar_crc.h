@@ -104,6 +104,9 @@ void oskar_crc_free(oskar_CRC* data);
  * http://web.archive.org/web/20121011093914/http://www.intel.com/technology/comms/perfnet/download/CRC_generators.pdf
  * http://create.stephan-brumme.com/crc32/
  *
+ * For CRC-32C on x86-64 CPUs that support SSE4.2, the CRC32 instruction
+ * is used instead, if available at run time.
+ *
  * @param[in] crc_data  Pointer to CRC data table, which defines the type.
  * @param[in] crc       CRC code to update.
  * @param[in] data      Pointer to data block to use.
@@ -189,6 +189,19 @@ struct oskar_Binary
     size_t* block_size_bytes;   /* Total block size. */
     unsigned long* crc;         /* CRC-32C code. */
     unsigned long* crc_header;  /* CRC-32C code of payload identifier. */
+    int capacity;               /* Allocated length of the tag index arrays. */
+
+    /* Hash table used to look up tags in the index. */
+    int num_buckets;            /* Number of hash buckets (a power of 2). */
+    int* bucket_head;           /* First tag in each bucket, or -1. */
+    int* bucket_next;           /* Next tag in the same bucket, or -1. */
+
+    /* Memory-mapped file, if available. */
+    char* map_ptr;              /* Start of mapped file, or NULL. */
+    size_t map_size;            /* Size of mapped file in bytes. */
+
+    /* Flag set if a tag index is to be written when the file is closed. */
+    int write_index;
 
     /* Data tables used for CRC computation. */
     oskar_CRC* crc_data;
@@ -199,6 +212,52 @@ struct oskar_Binary
 typedef struct oskar_Binary oskar_Binary;
 #endif /* OSKAR_BINARY_TYPEDEF_ */
 
+/*
+ * A tag index may be written as the last chunk in a file, using tag group
+ * OSKAR_TAG_GROUP_INDEX, so that the file can be opened without reading
+ * every tag. The payload (all values little-endian) is:
+ *
+ * Offset  Length  Description
+ * ----------------------------------------------------------------------------
+ *  0      32 * N  One record per indexed chunk (see below).
+ *  32 * N  ...    Group and tag names of all extended tags, in record order.
+ *  end-24  8      Number of records, N.
+ *  end-16  8      Offset of the index tag from the start of the file.
+ *  end-8   8      The ASCII characters "OSKARIDX".
+ *
+ * Each record contains:
+ *
+ * Offset  Length  Description
+ * ----------------------------------------------------------------------------
+ *  0      8       Payload offset from the start of the file.
+ *  8      8       Block size in bytes.
+ * 16      4       User index.
+ * 20      1       Payload data type.
+ * 21      1       Chunk flags (bits 6 and 7 only, as in the tag).
+ * 22      1       Group ID, or group name size in bytes if extended.
+ * 23      1       Tag ID, or tag name size in bytes if extended.
+ * 24      4       CRC-32C code of the chunk, or 0 if not present.
+ * 28      4       CRC-32C code of the tag and names.
+ */
+#define OSKAR_BINARY_INDEX_RECORD_SIZE 32
+#define OSKAR_BINARY_INDEX_TRAILER_SIZE 24
+
+/* Private functions. */
+void oskar_binary_index_resize(oskar_Binary* handle, int num_chunks);
+void oskar_binary_index_add(oskar_Binary* handle, int extended,
+        int data_type, int id_group, int id_tag, const char* name_group,
+        const char* name_tag, int user_index, long payload_offset,
+        size_t payload_size, size_t block_size, unsigned long crc,
+        unsigned long crc_header);
+void oskar_binary_index_build_hash(oskar_Binary* handle);
+int oskar_binary_index_find(const oskar_Binary* handle, int extended,
+        int data_type, int id_group, int id_tag, const char* name_group,
+        const char* name_tag, int user_index);
+int oskar_binary_index_read(oskar_Binary* handle, int* status);
+void oskar_binary_index_write(oskar_Binary* handle, int* status);
+void oskar_binary_map(oskar_Binary* handle);
+void oskar_binary_unmap(oskar_Binary* handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,7 +39,6 @@ extern "C" {
 
 #define MIN(X,Y) ((X) < (Y) ? (X) : (Y))
 
-static void oskar_binary_resize(oskar_Binary* handle, int m);
 static void oskar_binary_read_header(FILE* stream, oskar_BinaryHeader* header,
         int* status);
 static void oskar_binary_write_header(FILE* stream, oskar_BinaryHeader* header,
@@ -118,6 +117,13 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
     handle->block_size_bytes = 0;
     handle->crc = 0;
     handle->crc_header = 0;
+    handle->capacity = 0;
+    handle->num_buckets = 0;
+    handle->bucket_head = 0;
+    handle->bucket_next = 0;
+    handle->map_ptr = 0;
+    handle->map_size = 0;
+    handle->write_index = 0;
 
     /* Store the contents of the header for later use. */
     handle->bin_version = header.bin_version;
@@ -126,6 +132,19 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
     if (mode == 'w')
         return handle;
 
+    /* Map the file into memory if possible, and try to use a tag index
+     * stored at the end of the file instead of reading every tag. */
+    if (mode == 'r')
+    {
+        oskar_binary_map(handle);
+        if (oskar_binary_index_read(handle, status))
+        {
+            oskar_binary_index_build_hash(handle);
+            return handle;
+        }
+        fseek(stream, sizeof(oskar_BinaryHeader), SEEK_SET);
+    }
+
     /* Read all tags in the stream. */
     for (i = 0;; ++i)
     {
@@ -196,8 +215,7 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
         }
 
         /* Check if we need to allocate more storage for the tag data. */
-        if (i % 10 == 0)
-            oskar_binary_resize(handle, i + 10);
+        oskar_binary_index_resize(handle, i + 1);
 
         /* Initialise the tag index data. */
         handle->extended[i] = 0;
@@ -293,31 +311,12 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
         handle->num_chunks = i + 1;
     }
 
+    /* Build the hash table used to look up tags. */
+    if (mode == 'r')
+        oskar_binary_index_build_hash(handle);
     return handle;
 }
 
-static void oskar_binary_resize(oskar_Binary* handle, int m)
-{
-    handle->extended = (int*) realloc(handle->extended, m * sizeof(int));
-    handle->data_type = (int*) realloc(handle->data_type, m * sizeof(int));
-    handle->id_group = (int*) realloc(handle->id_group, m * sizeof(int));
-    handle->id_tag = (int*) realloc(handle->id_tag, m * sizeof(int));
-    handle->name_group = (char**) realloc(handle->name_group,
-            m * sizeof(char*));
-    handle->name_tag = (char**) realloc(handle->name_tag, m * sizeof(char*));
-    handle->user_index = (int*) realloc(handle->user_index, m * sizeof(int));
-    handle->payload_offset_bytes = (long*) realloc(handle->payload_offset_bytes,
-            m * sizeof(long));
-    handle->payload_size_bytes = (size_t*) realloc(handle->payload_size_bytes,
-            m * sizeof(size_t));
-    handle->block_size_bytes = (size_t*) realloc(handle->block_size_bytes,
-            m * sizeof(size_t));
-    handle->crc = (unsigned long*) realloc(handle->crc,
-            m * sizeof(unsigned long));
-    handle->crc_header = (unsigned long*) realloc(handle->crc_header,
-            m * sizeof(unsigned long));
-}
-
 static void oskar_binary_write_header(FILE* stream, oskar_BinaryHeader* header,
         int* status)
 {
@@ -41,7 +41,16 @@ void oskar_binary_free(oskar_Binary* handle)
     /* Check if structure exists. */
     if (!handle) return;
 
-    /* Close the file. */
+    /* Append the tag index if required. Errors are not reported here,
+     * as a file without an index is still valid. */
+    if (handle->stream && handle->open_mode == 'w' && handle->write_index)
+    {
+        int status = 0;
+        oskar_binary_index_write(handle, &status);
+    }
+
+    /* Unmap and close the file. */
+    oskar_binary_unmap(handle);
     if (handle->stream)
         fclose(handle->stream);
 
@@ -65,6 +74,8 @@ void oskar_binary_free(oskar_Binary* handle)
     free(handle->block_size_bytes);
     free(handle->crc);
     free(handle->crc_header);
+    free(handle->bucket_head);
+    free(handle->bucket_next);
 
     /* Free the CRC data. */
     oskar_crc_free(handle->crc_data);
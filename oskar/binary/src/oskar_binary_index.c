@@ -0,0 +1,480 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "binary/oskar_binary.h"
+#include "binary/oskar_endian.h"
+#include "binary/private_binary.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define OSKAR_BINARY_HAVE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const char index_magic[] = "OSKARIDX";
+
+static void put_u32(unsigned char* p, unsigned long v)
+{
+    int i;
+    for (i = 0; i < 4; ++i) p[i] = (unsigned char) ((v >> (8 * i)) & 0xFF);
+}
+
+static void put_u64(unsigned char* p, unsigned long long v)
+{
+    int i;
+    for (i = 0; i < 8; ++i) p[i] = (unsigned char) ((v >> (8 * i)) & 0xFF);
+}
+
+static unsigned long get_u32(const unsigned char* p)
+{
+    int i;
+    unsigned long v = 0;
+    for (i = 3; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+static unsigned long long get_u64(const unsigned char* p)
+{
+    int i;
+    unsigned long long v = 0;
+    for (i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+/* FNV-1a hash of the identifiers of a tag. */
+static unsigned int hash_bytes(unsigned int h, const void* data, size_t n)
+{
+    size_t i;
+    const unsigned char* p = (const unsigned char*) data;
+    for (i = 0; i < n; ++i)
+    {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static unsigned int hash_tag(int extended, int id_group, int id_tag,
+        const char* name_group, const char* name_tag, int user_index)
+{
+    unsigned int h = 2166136261u;
+    unsigned char key[3];
+    key[0] = (unsigned char) extended;
+    key[1] = (unsigned char) id_group;
+    key[2] = (unsigned char) id_tag;
+    h = hash_bytes(h, key, sizeof(key));
+    h = hash_bytes(h, &user_index, sizeof(int));
+    if (extended)
+    {
+        h = hash_bytes(h, name_group, strlen(name_group));
+        h = hash_bytes(h, name_tag, strlen(name_tag));
+    }
+    return h;
+}
+
+void oskar_binary_index_resize(oskar_Binary* handle, int num_chunks)
+{
+    int m;
+    if (num_chunks <= handle->capacity) return;
+    m = 2 * handle->capacity;
+    if (m < num_chunks) m = num_chunks;
+    if (m < 16) m = 16;
+    handle->capacity = m;
+    handle->extended = (int*) realloc(handle->extended, m * sizeof(int));
+    handle->data_type = (int*) realloc(handle->data_type, m * sizeof(int));
+    handle->id_group = (int*) realloc(handle->id_group, m * sizeof(int));
+    handle->id_tag = (int*) realloc(handle->id_tag, m * sizeof(int));
+    handle->name_group = (char**) realloc(handle->name_group,
+            m * sizeof(char*));
+    handle->name_tag = (char**) realloc(handle->name_tag, m * sizeof(char*));
+    handle->user_index = (int*) realloc(handle->user_index, m * sizeof(int));
+    handle->payload_offset_bytes = (long*) realloc(handle->payload_offset_bytes,
+            m * sizeof(long));
+    handle->payload_size_bytes = (size_t*) realloc(handle->payload_size_bytes,
+            m * sizeof(size_t));
+    handle->block_size_bytes = (size_t*) realloc(handle->block_size_bytes,
+            m * sizeof(size_t));
+    handle->crc = (unsigned long*) realloc(handle->crc,
+            m * sizeof(unsigned long));
+    handle->crc_header = (unsigned long*) realloc(handle->crc_header,
+            m * sizeof(unsigned long));
+}
+
+void oskar_binary_index_add(oskar_Binary* handle, int extended,
+        int data_type, int id_group, int id_tag, const char* name_group,
+        const char* name_tag, int user_index, long payload_offset,
+        size_t payload_size, size_t block_size, unsigned long crc,
+        unsigned long crc_header)
+{
+    const int i = handle->num_chunks;
+    oskar_binary_index_resize(handle, i + 1);
+    handle->extended[i] = extended;
+    handle->data_type[i] = data_type;
+    handle->id_group[i] = id_group;
+    handle->id_tag[i] = id_tag;
+    handle->name_group[i] = 0;
+    handle->name_tag[i] = 0;
+    if (extended)
+    {
+        handle->name_group[i] = (char*) malloc(id_group);
+        handle->name_tag[i] = (char*) malloc(id_tag);
+        memcpy(handle->name_group[i], name_group, id_group);
+        memcpy(handle->name_tag[i], name_tag, id_tag);
+    }
+    handle->user_index[i] = user_index;
+    handle->payload_offset_bytes[i] = payload_offset;
+    handle->payload_size_bytes[i] = payload_size;
+    handle->block_size_bytes[i] = block_size;
+    handle->crc[i] = crc;
+    handle->crc_header[i] = crc_header;
+    handle->num_chunks = i + 1;
+}
+
+void oskar_binary_index_build_hash(oskar_Binary* handle)
+{
+    int i, nb = 16;
+
+    /* Use at least twice as many buckets as tags. */
+    while (nb < 2 * handle->num_chunks) nb *= 2;
+    free(handle->bucket_head);
+    free(handle->bucket_next);
+    handle->num_buckets = nb;
+    handle->bucket_head = (int*) malloc(nb * sizeof(int));
+    handle->bucket_next = (int*) malloc((handle->num_chunks + 1) * sizeof(int));
+    if (!handle->bucket_head || !handle->bucket_next)
+    {
+        free(handle->bucket_head);
+        free(handle->bucket_next);
+        handle->bucket_head = 0;
+        handle->bucket_next = 0;
+        handle->num_buckets = 0;
+        return;
+    }
+    for (i = 0; i < nb; ++i) handle->bucket_head[i] = -1;
+
+    /* Insert tags in reverse, so each bucket lists them in file order. */
+    for (i = handle->num_chunks - 1; i >= 0; --i)
+    {
+        const unsigned int b = hash_tag(handle->extended[i],
+                handle->id_group[i], handle->id_tag[i],
+                handle->name_group[i], handle->name_tag[i],
+                handle->user_index[i]) & (nb - 1);
+        handle->bucket_next[i] = handle->bucket_head[b];
+        handle->bucket_head[b] = i;
+    }
+}
+
+int oskar_binary_index_find(const oskar_Binary* handle, int extended,
+        int data_type, int id_group, int id_tag, const char* name_group,
+        const char* name_tag, int user_index)
+{
+    int i;
+    const unsigned int b = hash_tag(extended, id_group, id_tag,
+            name_group, name_tag, user_index) & (handle->num_buckets - 1);
+    for (i = handle->bucket_head[b]; i >= 0; i = handle->bucket_next[i])
+    {
+        if (i < handle->query_search_start) continue;
+        if (handle->extended[i] == extended &&
+                ((handle->data_type[i] == data_type) || (!data_type)) &&
+                handle->id_group[i] == id_group &&
+                handle->id_tag[i] == id_tag &&
+                handle->user_index[i] == user_index)
+        {
+            if (extended && (strcmp(name_group, handle->name_group[i]) ||
+                    strcmp(name_tag, handle->name_tag[i])))
+                continue;
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* Reads bytes from the file, using the memory map if available. */
+static int read_bytes(oskar_Binary* handle, size_t offset, size_t length,
+        void* data)
+{
+    if (handle->map_ptr)
+    {
+        if (offset + length > handle->map_size) return 1;
+        memcpy(data, handle->map_ptr + offset, length);
+        return 0;
+    }
+    if (fseek(handle->stream, (long) offset, SEEK_SET) != 0) return 1;
+    return fread(data, 1, length, handle->stream) != length;
+}
+
+int oskar_binary_index_read(oskar_Binary* handle, int* status)
+{
+    unsigned char trailer[OSKAR_BINARY_INDEX_TRAILER_SIZE + 4], *payload = 0;
+    unsigned char* names;
+    unsigned long long n, tag_offset;
+    size_t file_size, block_size = 0, payload_size, names_size;
+    unsigned long crc;
+    oskar_BinaryTag tag;
+    int i;
+    if (*status) return 0;
+
+    /* The index is only used on little-endian systems. */
+    if (oskar_endian() != OSKAR_LITTLE_ENDIAN) return 0;
+
+    /* Get the file size. */
+    if (handle->map_ptr)
+        file_size = handle->map_size;
+    else
+    {
+        long end;
+        if (fseek(handle->stream, 0, SEEK_END) != 0) return 0;
+        end = ftell(handle->stream);
+        if (end < 0) return 0;
+        file_size = (size_t) end;
+    }
+    if (file_size < sizeof(oskar_BinaryHeader) + sizeof(oskar_BinaryTag) +
+            sizeof(trailer))
+        return 0;
+
+    /* Check for the trailer at the end of the index payload. */
+    if (read_bytes(handle, file_size - sizeof(trailer), sizeof(trailer),
+            trailer))
+        return 0;
+    if (memcmp(trailer + 16, index_magic, 8) != 0) return 0;
+    n = get_u64(trailer);
+    tag_offset = get_u64(trailer + 8);
+    if (tag_offset < sizeof(oskar_BinaryHeader) ||
+            tag_offset + sizeof(oskar_BinaryTag) > file_size)
+        return 0;
+
+    /* Read and check the index tag. */
+    if (read_bytes(handle, (size_t) tag_offset, sizeof(oskar_BinaryTag),
+            &tag))
+        return 0;
+    memcpy(&block_size, tag.size_bytes,
+            sizeof(size_t) < 8 ? sizeof(size_t) : 8);
+    if (tag.magic[0] != 'T' || tag.magic[2] != 'G' ||
+            (tag.flags & 0xC0) != 0x40 ||
+            tag.group.id != OSKAR_TAG_GROUP_INDEX ||
+            tag_offset + sizeof(oskar_BinaryTag) + block_size != file_size)
+        return 0;
+    payload_size = block_size - 4;
+    if (payload_size < OSKAR_BINARY_INDEX_TRAILER_SIZE ||
+            n > (payload_size - OSKAR_BINARY_INDEX_TRAILER_SIZE) /
+            OSKAR_BINARY_INDEX_RECORD_SIZE || n > 0x7FFFFFFF)
+        return 0;
+
+    /* Read the payload and check its CRC code. */
+    payload = (unsigned char*) malloc(payload_size);
+    if (!payload) return 0;
+    if (read_bytes(handle, (size_t) tag_offset + sizeof(oskar_BinaryTag),
+            payload_size, payload))
+    {
+        free(payload);
+        return 0;
+    }
+    crc = oskar_crc_compute(handle->crc_data, &tag, sizeof(oskar_BinaryTag));
+    crc = oskar_crc_update(handle->crc_data, crc, payload, payload_size);
+    if (crc != get_u32(trailer + OSKAR_BINARY_INDEX_TRAILER_SIZE))
+    {
+        free(payload);
+        return 0;
+    }
+
+    /* Fill the tag index from the records. */
+    oskar_binary_index_resize(handle, (int) n);
+    names = payload + n * OSKAR_BINARY_INDEX_RECORD_SIZE;
+    names_size = payload_size - OSKAR_BINARY_INDEX_TRAILER_SIZE -
+            n * OSKAR_BINARY_INDEX_RECORD_SIZE;
+    for (i = 0; i < (int) n; ++i)
+    {
+        const unsigned char* r = payload + i * OSKAR_BINARY_INDEX_RECORD_SIZE;
+        const int flags = r[21];
+        size_t overhead = (flags & (1 << 6)) ? 4 : 0;
+        handle->extended[i] = (flags & (1 << 7)) ? 1 : 0;
+        handle->data_type[i] = r[20];
+        handle->id_group[i] = r[22];
+        handle->id_tag[i] = r[23];
+        handle->name_group[i] = 0;
+        handle->name_tag[i] = 0;
+        handle->user_index[i] = (int) get_u32(r + 16);
+        handle->payload_offset_bytes[i] = (long) get_u64(r);
+        handle->block_size_bytes[i] = (size_t) get_u64(r + 8);
+        handle->crc[i] = get_u32(r + 24);
+        handle->crc_header[i] = get_u32(r + 28);
+        handle->num_chunks = i + 1;
+        if (handle->extended[i])
+        {
+            const size_t lg = r[22], lt = r[23];
+            if (lg + lt > names_size || lg == 0 || lt == 0 ||
+                    names[lg - 1] != 0 || names[lg + lt - 1] != 0)
+                break;
+            handle->name_group[i] = (char*) malloc(lg);
+            handle->name_tag[i] = (char*) malloc(lt);
+            memcpy(handle->name_group[i], names, lg);
+            memcpy(handle->name_tag[i], names + lg, lt);
+            names += lg + lt;
+            names_size -= lg + lt;
+            overhead += lg + lt;
+        }
+        if (handle->block_size_bytes[i] < overhead) break;
+        handle->payload_size_bytes[i] = handle->block_size_bytes[i] - overhead;
+        if ((unsigned long long) handle->payload_offset_bytes[i] +
+                handle->payload_size_bytes[i] > tag_offset)
+            break;
+    }
+    free(payload);
+
+    /* Discard the index if it is inconsistent. */
+    if (i < (int) n)
+    {
+        for (i = 0; i < handle->num_chunks; ++i)
+        {
+            free(handle->name_group[i]);
+            free(handle->name_tag[i]);
+        }
+        handle->num_chunks = 0;
+        return 0;
+    }
+    return 1;
+}
+
+void oskar_binary_index_write(oskar_Binary* handle, int* status)
+{
+    unsigned char *payload, *names;
+    size_t payload_size, names_size = 0;
+    long tag_offset;
+    int i, n;
+    if (*status) return;
+    if (handle->open_mode != 'w' || oskar_endian() != OSKAR_LITTLE_ENDIAN)
+        return;
+
+    /* Get the size of the payload. */
+    n = handle->num_chunks;
+    for (i = 0; i < n; ++i)
+    {
+        if (handle->extended[i])
+            names_size += handle->id_group[i] + handle->id_tag[i];
+    }
+    payload_size = n * OSKAR_BINARY_INDEX_RECORD_SIZE + names_size +
+            OSKAR_BINARY_INDEX_TRAILER_SIZE;
+    payload = (unsigned char*) calloc(payload_size, 1);
+    if (!payload)
+    {
+        *status = OSKAR_ERR_BINARY_MEMORY_NOT_ALLOCATED;
+        return;
+    }
+
+    /* Write the records and the tag names. */
+    names = payload + n * OSKAR_BINARY_INDEX_RECORD_SIZE;
+    for (i = 0; i < n; ++i)
+    {
+        unsigned char* r = payload + i * OSKAR_BINARY_INDEX_RECORD_SIZE;
+        size_t overhead = handle->block_size_bytes[i] -
+                handle->payload_size_bytes[i];
+        int flags = 0;
+        if (handle->extended[i])
+        {
+            const size_t lg = handle->id_group[i], lt = handle->id_tag[i];
+            memcpy(names, handle->name_group[i], lg);
+            memcpy(names + lg, handle->name_tag[i], lt);
+            names += lg + lt;
+            overhead -= lg + lt;
+            flags |= (1 << 7);
+        }
+        if (overhead == 4) flags |= (1 << 6);
+        put_u64(r, (unsigned long long) handle->payload_offset_bytes[i]);
+        put_u64(r + 8, (unsigned long long) handle->block_size_bytes[i]);
+        put_u32(r + 16, (unsigned long) handle->user_index[i]);
+        r[20] = (unsigned char) handle->data_type[i];
+        r[21] = (unsigned char) flags;
+        r[22] = (unsigned char) handle->id_group[i];
+        r[23] = (unsigned char) handle->id_tag[i];
+        put_u32(r + 24, handle->crc[i]);
+        put_u32(r + 28, handle->crc_header[i]);
+    }
+
+    /* Write the trailer and the index chunk at the end of the file. */
+    tag_offset = ftell(handle->stream);
+    if (tag_offset < 0)
+    {
+        free(payload);
+        *status = OSKAR_ERR_BINARY_SEEK_FAIL;
+        return;
+    }
+    put_u64(names, (unsigned long long) n);
+    put_u64(names + 8, (unsigned long long) tag_offset);
+    memcpy(names + 16, index_magic, 8);
+    oskar_binary_write(handle, OSKAR_CHAR, OSKAR_TAG_GROUP_INDEX, 1, 0,
+            payload_size, payload, status);
+    free(payload);
+}
+
+void oskar_binary_map(oskar_Binary* handle)
+{
+#ifdef OSKAR_BINARY_HAVE_MMAP
+    struct stat st;
+    void* ptr;
+    int fd;
+    if (handle->map_ptr || !handle->stream) return;
+    fd = fileno(handle->stream);
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size <= 0) return;
+    if ((unsigned long long) st.st_size > (size_t)(-1)) return;
+
+    /* Use a private mapping, so that aliased data can safely be modified. */
+    ptr = mmap(0, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+            fd, 0);
+    if (ptr == MAP_FAILED) return;
+    handle->map_ptr = (char*) ptr;
+    handle->map_size = (size_t) st.st_size;
+#else
+    (void) handle;
+#endif
+}
+
+void oskar_binary_unmap(oskar_Binary* handle)
+{
+#ifdef OSKAR_BINARY_HAVE_MMAP
+    if (handle->map_ptr)
+        munmap(handle->map_ptr, handle->map_size);
+#endif
+    handle->map_ptr = 0;
+    handle->map_size = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -62,17 +62,27 @@ int oskar_binary_query(const oskar_Binary* handle,
     /* Check if safe to proceed. */
     if (*status) return 0;
 
-    /* Find the tag in the index. */
-    for (i = handle->query_search_start; i < handle->num_chunks; ++i)
+    /* Find the tag in the index, using the hash table if available. */
+    if (handle->bucket_head)
     {
-        if (!(handle->extended[i]) &&
-                ((handle->data_type[i] == (int) data_type) || (!data_type)) &&
-                handle->id_group[i] == (int) id_group &&
-                handle->id_tag[i] == (int) id_tag &&
-                handle->user_index[i] == user_index)
+        i = oskar_binary_index_find(handle, 0, data_type, id_group, id_tag,
+                0, 0, user_index);
+        if (i < 0) i = handle->num_chunks;
+    }
+    else
+    {
+        for (i = handle->query_search_start; i < handle->num_chunks; ++i)
         {
-            /* Match found, so break. */
-            break;
+            if (!(handle->extended[i]) &&
+                    ((handle->data_type[i] == (int) data_type) ||
+                            (!data_type)) &&
+                    handle->id_group[i] == (int) id_group &&
+                    handle->id_tag[i] == (int) id_tag &&
+                    handle->user_index[i] == user_index)
+            {
+                /* Match found, so break. */
+                break;
+            }
         }
     }
 
@@ -105,23 +115,33 @@ int oskar_binary_query_ext(const oskar_Binary* handle,
         return -1;
     }
 
-    /* Find the tag in the index. */
-    for (i = handle->query_search_start; i < handle->num_chunks; ++i)
+    /* Find the tag in the index, using the hash table if available. */
+    if (handle->bucket_head)
+    {
+        i = oskar_binary_index_find(handle, 1, data_type, lgroup, ltag,
+                name_group, name_tag, user_index);
+        if (i < 0) i = handle->num_chunks;
+    }
+    else
     {
-        if (handle->extended[i] &&
-                ((handle->data_type[i] == (int) data_type) || (!data_type)) &&
-                handle->id_group[i] == (int) lgroup &&
-                handle->id_tag[i] == (int) ltag &&
-                handle->user_index[i] == user_index)
+        for (i = handle->query_search_start; i < handle->num_chunks; ++i)
         {
-            /* Possible match: check names. */
-            if (strcmp(name_group, handle->name_group[i]))
-                continue;
-            if (strcmp(name_tag, handle->name_tag[i]))
-                continue;
-
-            /* Match found, so break. */
-            break;
+            if (handle->extended[i] &&
+                    ((handle->data_type[i] == (int) data_type) ||
+                            (!data_type)) &&
+                    handle->id_group[i] == (int) lgroup &&
+                    handle->id_tag[i] == (int) ltag &&
+                    handle->user_index[i] == user_index)
+            {
+                /* Possible match: check names. */
+                if (strcmp(name_group, handle->name_group[i]))
+                    continue;
+                if (strcmp(name_tag, handle->name_tag[i]))
+                    continue;
+
+                /* Match found, so break. */
+                break;
+            }
         }
     }
 
@@ -36,6 +36,16 @@
 extern "C" {
 #endif
 
+/* Returns true if the payload of a chunk lies within the mapped file.
+ * Chunks found by scanning a truncated file may extend past its end. */
+static int payload_in_map(const oskar_Binary* handle, int chunk_index)
+{
+    const long offset = handle->payload_offset_bytes[chunk_index];
+    const size_t size = handle->payload_size_bytes[chunk_index];
+    return offset >= 0 && (size_t) offset <= handle->map_size &&
+            size <= handle->map_size - (size_t) offset;
+}
+
 void oskar_binary_read_block(oskar_Binary* handle,
         int chunk_index, size_t data_size, void* data, int* status)
 {
@@ -69,27 +79,42 @@ void oskar_binary_read_block(oskar_Binary* handle,
         return;
     }
 
-    /* Copy the data out of the stream. */
-    if (fseek(handle->stream,
-            handle->payload_offset_bytes[chunk_index], SEEK_SET) != 0)
+    /* Copy the data directly if the file is mapped into memory. */
+    if (handle->map_ptr)
     {
-        *status = OSKAR_ERR_BINARY_SEEK_FAIL;
-        return;
+        if (!payload_in_map(handle, chunk_index))
+        {
+            *status = OSKAR_ERR_BINARY_FILE_INVALID;
+            return;
+        }
+        memcpy(data,
+                handle->map_ptr + handle->payload_offset_bytes[chunk_index],
+                handle->payload_size_bytes[chunk_index]);
     }
-
-    /* Read the data in chunks of 2^29 bytes (512 MB). */
-    /* This works around a bug in some versions of fread() which are
-     * limited to reading a maximum of 2 GB at once. */
-    for (p = (char*)data, bytes = handle->payload_size_bytes[chunk_index];
-            bytes > 0; p += chunk_size)
+    else
     {
-        if (bytes < chunk_size) chunk_size = bytes;
-        if (fread(p, 1, chunk_size, handle->stream) != chunk_size)
+        /* Copy the data out of the stream. */
+        if (fseek(handle->stream,
+                handle->payload_offset_bytes[chunk_index], SEEK_SET) != 0)
         {
-            *status = OSKAR_ERR_BINARY_READ_FAIL;
+            *status = OSKAR_ERR_BINARY_SEEK_FAIL;
             return;
         }
-        bytes -= chunk_size;
+
+        /* Read the data in chunks of 2^29 bytes (512 MB). */
+        /* This works around a bug in some versions of fread() which are
+         * limited to reading a maximum of 2 GB at once. */
+        for (p = (char*)data, bytes = handle->payload_size_bytes[chunk_index];
+                bytes > 0; p += chunk_size)
+        {
+            if (bytes < chunk_size) chunk_size = bytes;
+            if (fread(p, 1, chunk_size, handle->stream) != chunk_size)
+            {
+                *status = OSKAR_ERR_BINARY_READ_FAIL;
+                return;
+            }
+            bytes -= chunk_size;
+        }
     }
 
     /* Check CRC-32 code, if present. */
@@ -104,6 +129,53 @@ void oskar_binary_read_block(oskar_Binary* handle,
     }
 }
 
+void* oskar_binary_map_block(oskar_Binary* handle, int chunk_index,
+        int* status)
+{
+    char* p;
+
+    /* Check if safe to proceed. */
+    if (*status) return 0;
+
+    /* Check file was opened for reading. */
+    if (handle->open_mode != 'r')
+    {
+        *status = OSKAR_ERR_BINARY_NOT_OPEN_FOR_READ;
+        return 0;
+    }
+
+    /* Check index is in range. */
+    if (chunk_index < 0 || chunk_index >= handle->num_chunks)
+    {
+        *status = OSKAR_ERR_BINARY_TAG_OUT_OF_RANGE;
+        return 0;
+    }
+
+    /* Return NULL if the file is not mapped into memory. */
+    if (!handle->map_ptr) return 0;
+    if (!payload_in_map(handle, chunk_index))
+    {
+        *status = OSKAR_ERR_BINARY_FILE_INVALID;
+        return 0;
+    }
+    p = handle->map_ptr + handle->payload_offset_bytes[chunk_index];
+
+    /* Check CRC-32 code, if present. */
+    if (handle->crc[chunk_index])
+    {
+        unsigned long crc;
+        crc = handle->crc_header[chunk_index];
+        crc = oskar_crc_update(handle->crc_data, crc, p,
+                handle->payload_size_bytes[chunk_index]);
+        if (crc != handle->crc[chunk_index])
+        {
+            *status = OSKAR_ERR_BINARY_CRC_FAIL;
+            return 0;
+        }
+    }
+    return p;
+}
+
 void oskar_binary_read(oskar_Binary* handle,
         unsigned char data_type, unsigned char id_group, unsigned char id_tag,
         int user_index, size_t data_size, void* data, int* status)
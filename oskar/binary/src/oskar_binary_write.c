@@ -42,7 +42,9 @@ void oskar_binary_write(oskar_Binary* handle, unsigned char data_type,
 {
     oskar_BinaryTag tag;
     size_t block_size;
-    unsigned long crc = 0;
+    unsigned long crc = 0, crc_header = 0, crc_chunk = 0;
+    long payload_offset;
+    const int index = user_index;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -108,7 +110,9 @@ void oskar_binary_write(oskar_Binary* handle, unsigned char data_type,
 
     /* Tag is complete at this point, so calculate CRC. */
     crc = oskar_crc_compute(handle->crc_data, &tag, sizeof(oskar_BinaryTag));
+    crc_header = crc;
     crc = oskar_crc_update(handle->crc_data, crc, data, data_size);
+    crc_chunk = crc;
     if (oskar_endian() != OSKAR_LITTLE_ENDIAN)
         oskar_endian_swap(&crc, sizeof(unsigned long));
 
@@ -118,6 +122,7 @@ void oskar_binary_write(oskar_Binary* handle, unsigned char data_type,
         *status = OSKAR_ERR_BINARY_WRITE_FAIL;
         return;
     }
+    payload_offset = ftell(handle->stream);
 
     /* Check there is data to write. */
     if (data && data_size > 0)
@@ -132,7 +137,16 @@ void oskar_binary_write(oskar_Binary* handle, unsigned char data_type,
 
     /* Write the 4-byte CRC-32C code. */
     if (fwrite(&crc, 4, 1, handle->stream) != 1)
+    {
         *status = OSKAR_ERR_BINARY_WRITE_FAIL;
+        return;
+    }
+
+    /* Add the chunk to the tag index of a new file. */
+    if (handle->open_mode == 'w')
+        oskar_binary_index_add(handle, 0, data_type, id_group, id_tag, 0, 0,
+                index, payload_offset, data_size, data_size + 4,
+                crc_chunk, crc_header);
 }
 
 void oskar_binary_write_double(oskar_Binary* handle, unsigned char id_group,
@@ -155,7 +169,9 @@ void oskar_binary_write_ext(oskar_Binary* handle, unsigned char data_type,
 {
     oskar_BinaryTag tag;
     size_t block_size, lgroup, ltag;
-    unsigned long crc = 0;
+    unsigned long crc = 0, crc_header = 0, crc_chunk = 0;
+    long payload_offset;
+    const int index = user_index;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -233,7 +249,9 @@ void oskar_binary_write_ext(oskar_Binary* handle, unsigned char data_type,
     crc = oskar_crc_compute(handle->crc_data, &tag, sizeof(oskar_BinaryTag));
     crc = oskar_crc_update(handle->crc_data, crc, name_group, tag.group.bytes);
     crc = oskar_crc_update(handle->crc_data, crc, name_tag, tag.tag.bytes);
+    crc_header = crc;
     crc = oskar_crc_update(handle->crc_data, crc, data, data_size);
+    crc_chunk = crc;
     if (oskar_endian() != OSKAR_LITTLE_ENDIAN)
         oskar_endian_swap(&crc, sizeof(unsigned long));
 
@@ -255,6 +273,7 @@ void oskar_binary_write_ext(oskar_Binary* handle, unsigned char data_type,
         *status = OSKAR_ERR_BINARY_WRITE_FAIL;
         return;
     }
+    payload_offset = ftell(handle->stream);
 
     /* Check there is data to write. */
     if (data && data_size > 0)
@@ -269,7 +288,17 @@ void oskar_binary_write_ext(oskar_Binary* handle, unsigned char data_type,
 
     /* Write the 4-byte CRC-32C code. */
     if (fwrite(&crc, 4, 1, handle->stream) != 1)
+    {
         *status = OSKAR_ERR_BINARY_WRITE_FAIL;
+        return;
+    }
+
+    /* Add the chunk to the tag index of a new file. */
+    if (handle->open_mode == 'w')
+        oskar_binary_index_add(handle, 1, data_type, tag.group.bytes,
+                tag.tag.bytes, name_group, name_tag, index, payload_offset,
+                data_size, data_size + tag.group.bytes + tag.tag.bytes + 4,
+                crc_chunk, crc_header);
 }
 
 void oskar_binary_write_ext_double(oskar_Binary* handle, const char* name_group,
@@ -286,6 +315,11 @@ void oskar_binary_write_ext_int(oskar_Binary* handle, const char* name_group,
             name_tag, user_index, sizeof(int), &value, status);
 }
 
+void oskar_binary_set_write_index(oskar_Binary* handle, int value)
+{
+    handle->write_index = value;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -179,6 +179,102 @@ int main(void)
     /* Remove the file. */
     remove(filename);
 
+    /* Write a file with a tag index, and read it back. */
+    h = oskar_binary_create(filename, 'w', &status);
+    oskar_binary_set_write_index(h, 1);
+    for (i = 0; i < 100; ++i)
+    {
+        oskar_binary_write_int(h, 5, 1, i, i * 3, &status);
+        oskar_binary_write_ext_int(h, "group", "tag", i, i * 7, &status);
+    }
+    oskar_binary_write_int(h, 5, 1, 0, 999, &status);
+    ASSERT_INT_EQ(0, status);
+    oskar_binary_free(h);
+    h = oskar_binary_create(filename, 'r', &status);
+    ASSERT_INT_EQ(0, status);
+
+    /* The index chunk itself is not listed if the index was used. */
+    ASSERT_INT_EQ(201, oskar_binary_num_tags(h));
+    for (i = 99; i >= 0; --i)
+    {
+        oskar_binary_read_int(h, 5, 1, i, &a, &status);
+        ASSERT_INT_EQ(0, status);
+        ASSERT_INT_EQ(i * 3, a);
+        oskar_binary_read_ext_int(h, "group", "tag", i, &b, &status);
+        ASSERT_INT_EQ(0, status);
+        ASSERT_INT_EQ(i * 7, b);
+    }
+
+    /* Check that the search start is respected for duplicate tags. */
+    oskar_binary_set_query_search_start(h, 1, &status);
+    oskar_binary_read_int(h, 5, 1, 0, &a, &status);
+    ASSERT_INT_EQ(0, status);
+    ASSERT_INT_EQ(999, a);
+    oskar_binary_set_query_search_start(h, 0, &status);
+    oskar_binary_read_ext_int(h, "group", "tag", 100, &b, &status);
+    ASSERT_INT_EQ((int) OSKAR_ERR_BINARY_TAG_NOT_FOUND, status);
+    status = 0;
+
+    /* Check data can be accessed directly if the file is mapped. */
+    {
+        const int* p;
+        int chunk = oskar_binary_query(h, OSKAR_INT, 5, 1, 42, 0, &status);
+        p = (const int*) oskar_binary_map_block(h, chunk, &status);
+        ASSERT_INT_EQ(0, status);
+        if (p) ASSERT_INT_EQ(126, *p);
+    }
+    oskar_binary_free(h);
+    remove(filename);
+
+    /* Check that a truncated chunk without a CRC code is rejected. */
+    {
+        FILE* f;
+        char* buffer;
+        long file_size, tag_start;
+        double data[1000];
+        const size_t tag_size = 20;
+        for (i = 0; i < 1000; ++i) data[i] = (double) i;
+        h = oskar_binary_create(filename, 'w', &status);
+        oskar_binary_write_int(h, 5, 1, 0, 42, &status);
+        oskar_binary_write(h, OSKAR_DOUBLE, 7, 8, 0, sizeof(data), data,
+                &status);
+        ASSERT_INT_EQ(0, status);
+        oskar_binary_free(h);
+
+        /* Clear the CRC flag of the last chunk, and cut its payload short. */
+        f = fopen(filename, "rb");
+        fseek(f, 0, SEEK_END);
+        file_size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        buffer = (char*) malloc(file_size);
+        if (fread(buffer, 1, file_size, f) != (size_t) file_size) exit(1);
+        fclose(f);
+        tag_start = file_size - (long) (tag_size + sizeof(data) + 4);
+        buffer[tag_start + 4] &= ~(1 << 6);
+        f = fopen(filename, "wb");
+        fwrite(buffer, 1, tag_start + tag_size + 100, f);
+        fclose(f);
+        free(buffer);
+
+        /* The first chunk can be read, but the truncated one cannot. */
+        h = oskar_binary_create(filename, 'r', &status);
+        ASSERT_INT_EQ(0, status);
+        oskar_binary_read_int(h, 5, 1, 0, &a, &status);
+        ASSERT_INT_EQ(0, status);
+        ASSERT_INT_EQ(42, a);
+        oskar_binary_read(h, OSKAR_DOUBLE, 7, 8, 0, sizeof(data), data,
+                &status);
+        a = (status != 0);
+        ASSERT_INT_EQ(1, a);
+        status = 0;
+        oskar_binary_map_block(h, 1, &status);
+        a = (status != 0);
+        ASSERT_INT_EQ(1, a);
+        status = 0;
+        oskar_binary_free(h);
+        remove(filename);
+    }
+
     printf("PASS: Test_binary OK.\n");
     return 0;
 }
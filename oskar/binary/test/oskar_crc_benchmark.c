@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "binary/oskar_crc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Measures the throughput of oskar_crc_update() for each CRC type.
+ * Usage: oskar_crc_benchmark [block size in MB] [number of iterations]
+ */
+
+static void benchmark(const char* name, int type, const unsigned char* data,
+        size_t num_bytes, int num_iter)
+{
+    int i;
+    clock_t start;
+    double elapsed;
+    unsigned long crc = 0;
+    oskar_CRC* crc_data = oskar_crc_create(type);
+    start = clock();
+    for (i = 0; i < num_iter; ++i)
+        crc = oskar_crc_compute(crc_data, data, num_bytes);
+    elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("%-10s: %8.3f GB/s (CRC 0x%08lx)\n", name,
+            elapsed > 0.0 ? 1e-9 * num_bytes * num_iter / elapsed : 0.0, crc);
+    oskar_crc_free(crc_data);
+}
+
+int main(int argc, char** argv)
+{
+    size_t i, num_bytes;
+    unsigned char* data;
+    int num_iter;
+    num_bytes = (argc > 1 ? (size_t) atoi(argv[1]) : 64) * 1024 * 1024;
+    num_iter = argc > 2 ? atoi(argv[2]) : 10;
+    data = (unsigned char*) malloc(num_bytes);
+    if (!data)
+    {
+        fprintf(stderr, "Unable to allocate %lu bytes.\n",
+                (unsigned long) num_bytes);
+        return 1;
+    }
+    for (i = 0; i < num_bytes; ++i)
+        data[i] = (unsigned char) ((i * 2654435761uL) >> 13);
+    printf("Block size %lu bytes, %d iterations.\n",
+            (unsigned long) num_bytes, num_iter);
+    benchmark("CRC-8-EBU", OSKAR_CRC_8_EBU, data, num_bytes, num_iter);
+    benchmark("CRC-32", OSKAR_CRC_32, data, num_bytes, num_iter);
+    benchmark("CRC-32C", OSKAR_CRC_32C, data, num_bytes, num_iter);
+    free(data);
+    return 0;
+}
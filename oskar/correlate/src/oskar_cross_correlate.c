@@ -28,7 +28,7 @@
 
 #include "correlate/oskar_cross_correlate.h"
 #include "correlate/oskar_cross_correlate_cuda.h"
-#include "correlate/oskar_cross_correlate_omp.h"
+#include "correlate/oskar_cross_correlate_tiled_omp.h"
 #include "correlate/oskar_cross_correlate_scalar_cuda.h"
 #include "correlate/oskar_cross_correlate_scalar_omp.h"
 #include "utility/oskar_device_utils.h"
@@ -155,7 +155,7 @@ void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
             switch (oskar_mem_type(vis))
             {
             case OSKAR_SINGLE_COMPLEX_MATRIX:
-                oskar_cross_correlate_gaussian_omp_f(
+                oskar_cross_correlate_gaussian_tiled_omp_f(
                         n_sources, n_stations,
                         oskar_mem_float4c_const(J, status),
                         oskar_mem_float_const(I, status),
@@ -178,7 +178,7 @@ void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
                         oskar_mem_float4c(vis, status));
                 break;
             case OSKAR_DOUBLE_COMPLEX_MATRIX:
-                oskar_cross_correlate_gaussian_omp_d(
+                oskar_cross_correlate_gaussian_tiled_omp_d(
                         n_sources, n_stations,
                         oskar_mem_double4c_const(J, status),
                         oskar_mem_double_const(I, status),
@@ -250,7 +250,7 @@ void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
             switch (oskar_mem_type(vis))
             {
             case OSKAR_SINGLE_COMPLEX_MATRIX:
-                oskar_cross_correlate_point_omp_f(
+                oskar_cross_correlate_point_tiled_omp_f(
                         n_sources, n_stations,
                         oskar_mem_float4c_const(J, status),
                         oskar_mem_float_const(I, status),
@@ -270,7 +270,7 @@ void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
                         oskar_mem_float4c(vis, status));
                 break;
             case OSKAR_DOUBLE_COMPLEX_MATRIX:
-                oskar_cross_correlate_point_omp_d(
+                oskar_cross_correlate_point_tiled_omp_d(
                         n_sources, n_stations,
                         oskar_mem_double4c_const(J, status),
                         oskar_mem_double_const(I, status),
@@ -0,0 +1,462 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <vector>
+#include "correlate/private_correlate_functions_inline.h"
+#include "correlate/oskar_cross_correlate_tiled_omp.h"
+
+// Number of stations in a tile.
+#define TILE_STATIONS 8
+
+// Number of sources in a block.
+// Two tiles of Jones matrices for one block must fit in L2 cache.
+#define BLOCK_SOURCES 128
+
+// Stride between components in the tile buffers.
+#define COMP (BLOCK_SOURCES)
+
+// Stride between stations in the tile buffers (8 real components each).
+#define STRIDE (8 * BLOCK_SOURCES)
+
+template
+<
+// Compile-time parameters.
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN,
+typename REAL, typename REAL2, typename REAL8
+>
+void oskar_xcorr_tiled_omp(
+        const int                   num_sources,
+        const int                   num_stations,
+        const REAL8* const restrict jones,
+        const REAL*  const restrict source_I,
+        const REAL*  const restrict source_Q,
+        const REAL*  const restrict source_U,
+        const REAL*  const restrict source_V,
+        const REAL*  const restrict source_l,
+        const REAL*  const restrict source_m,
+        const REAL*  const restrict source_n,
+        const REAL*  const restrict source_a,
+        const REAL*  const restrict source_b,
+        const REAL*  const restrict source_c,
+        const REAL*  const restrict station_u,
+        const REAL*  const restrict station_v,
+        const REAL*  const restrict station_w,
+        const REAL*  const restrict station_x,
+        const REAL*  const restrict station_y,
+        const REAL                  uv_min_lambda,
+        const REAL                  uv_max_lambda,
+        const REAL                  inv_wavelength,
+        const REAL                  frac_bandwidth,
+        const REAL                  time_int_sec,
+        const REAL                  gha0_rad,
+        const REAL                  dec0_rad,
+        REAL8*             restrict vis)
+{
+    const int num_tiles = (num_stations + TILE_STATIONS - 1) / TILE_STATIONS;
+
+#pragma omp parallel
+    {
+        // Per-thread tile buffers, held as separate real and imaginary
+        // components for each polarisation (structure of arrays).
+        // The buffer for station p holds the product of its Jones matrix
+        // with the source brightness matrix.
+        std::vector<REAL> tile_p(TILE_STATIONS * STRIDE);
+        std::vector<REAL> tile_q(TILE_STATIONS * STRIDE);
+
+        // Per-baseline data for baselines in a tile pair.
+        // Partial sums for each block are accumulated in double precision.
+        double sum[TILE_STATIONS * TILE_STATIONS][8];
+        REAL uu[TILE_STATIONS * TILE_STATIONS];
+        REAL vv[TILE_STATIONS * TILE_STATIONS];
+        REAL ww[TILE_STATIONS * TILE_STATIONS];
+        REAL uu2[TILE_STATIONS * TILE_STATIONS];
+        REAL vv2[TILE_STATIONS * TILE_STATIONS];
+        REAL uuvv[TILE_STATIONS * TILE_STATIONS];
+        REAL du[TILE_STATIONS * TILE_STATIONS];
+        REAL dv[TILE_STATIONS * TILE_STATIONS];
+        REAL dw[TILE_STATIONS * TILE_STATIONS];
+        int active[TILE_STATIONS * TILE_STATIONS];
+
+        // Loop over pairs of station tiles.
+#pragma omp for schedule(dynamic, 1)
+        for (int k = 0; k < num_tiles * num_tiles; ++k)
+        {
+            const int tp = k / num_tiles, tq = k % num_tiles;
+            if (tq > tp) continue;
+            const int p0 = tp * TILE_STATIONS, q0 = tq * TILE_STATIONS;
+            const int np = (num_stations - p0 < TILE_STATIONS) ?
+                    num_stations - p0 : TILE_STATIONS;
+            const int nq = (num_stations - q0 < TILE_STATIONS) ?
+                    num_stations - q0 : TILE_STATIONS;
+
+            // Get common baseline values for baselines in this tile pair.
+            int num_active = 0;
+            for (int p = 0; p < np; ++p)
+            {
+                for (int q = 0; q < nq; ++q)
+                {
+                    const int b = p * TILE_STATIONS + q;
+                    const int SP = p0 + p, SQ = q0 + q;
+                    REAL uv_len;
+                    active[b] = 0;
+                    if (SP <= SQ) continue;
+                    OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],
+                            station_v[SP], station_v[SQ],
+                            station_w[SP], station_w[SQ],
+                            uu[b], vv[b], ww[b], uu2[b], vv2[b], uuvv[b],
+                            uv_len);
+
+                    // Apply the baseline length filter.
+                    if (uv_len < uv_min_lambda || uv_len > uv_max_lambda)
+                        continue;
+
+                    // Compute the deltas for time-average smearing.
+                    if (TIME_SMEARING)
+                        OSKAR_BASELINE_DELTAS(REAL,
+                                station_x[SP], station_x[SQ],
+                                station_y[SP], station_y[SQ],
+                                du[b], dv[b], dw[b]);
+                    for (int j = 0; j < 8; ++j) sum[b][j] = 0.0;
+                    active[b] = 1;
+                    num_active++;
+                }
+            }
+            if (num_active == 0) continue;
+
+            // Loop over source blocks.
+            for (int s0 = 0; s0 < num_sources; s0 += BLOCK_SOURCES)
+            {
+                const int ns = (num_sources - s0 < BLOCK_SOURCES) ?
+                        num_sources - s0 : BLOCK_SOURCES;
+
+                // Fill the tile buffer for stations p with Jp * B.
+                for (int p = 0; p < np; ++p)
+                {
+                    const REAL8* const restrict J =
+                            &jones[(p0 + p) * num_sources + s0];
+                    REAL* const restrict t = &tile_p[p * STRIDE];
+                    for (int i = 0; i < ns; ++i)
+                    {
+                        REAL8 m1, m2;
+                        OSKAR_CONSTRUCT_B(REAL, m2, source_I[s0 + i],
+                                source_Q[s0 + i], source_U[s0 + i],
+                                source_V[s0 + i])
+                        OSKAR_LOAD_MATRIX(m1, J[i])
+                        OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(
+                                REAL2, m1, m2)
+                        t[0 * COMP + i] = m1.a.x; t[1 * COMP + i] = m1.a.y;
+                        t[2 * COMP + i] = m1.b.x; t[3 * COMP + i] = m1.b.y;
+                        t[4 * COMP + i] = m1.c.x; t[5 * COMP + i] = m1.c.y;
+                        t[6 * COMP + i] = m1.d.x; t[7 * COMP + i] = m1.d.y;
+                    }
+                }
+
+                // Fill the tile buffer for stations q with Jq.
+                for (int q = 0; q < nq; ++q)
+                {
+                    const REAL8* const restrict J =
+                            &jones[(q0 + q) * num_sources + s0];
+                    REAL* const restrict t = &tile_q[q * STRIDE];
+                    for (int i = 0; i < ns; ++i)
+                    {
+                        t[0 * COMP + i] = J[i].a.x; t[1 * COMP + i] = J[i].a.y;
+                        t[2 * COMP + i] = J[i].b.x; t[3 * COMP + i] = J[i].b.y;
+                        t[4 * COMP + i] = J[i].c.x; t[5 * COMP + i] = J[i].c.y;
+                        t[6 * COMP + i] = J[i].d.x; t[7 * COMP + i] = J[i].d.y;
+                    }
+                }
+
+                // Loop over baselines in the tile pair.
+                for (int p = 0; p < np; ++p)
+                {
+                    const REAL* const restrict P = &tile_p[p * STRIDE];
+                    for (int q = 0; q < nq; ++q)
+                    {
+                        const int b = p * TILE_STATIONS + q;
+                        if (!active[b]) continue;
+                        const REAL* const restrict Q = &tile_q[q * STRIDE];
+                        const REAL b_uu = uu[b], b_vv = vv[b], b_ww = ww[b];
+                        const REAL b_uu2 = uu2[b], b_vv2 = vv2[b];
+                        const REAL b_uuvv = uuvv[b];
+                        const REAL b_du = du[b], b_dv = dv[b], b_dw = dw[b];
+                        REAL s_ax = 0, s_ay = 0, s_bx = 0, s_by = 0;
+                        REAL s_cx = 0, s_cy = 0, s_dx = 0, s_dy = 0;
+
+                        // Loop over sources in the block.
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(+:s_ax,s_ay,s_bx,s_by,s_cx,s_cy,s_dx,s_dy)
+#endif
+                        for (int i = 0; i < ns; ++i)
+                        {
+                            REAL smearing = (REAL) 1;
+                            if (GAUSSIAN)
+                            {
+                                const REAL t = source_a[s0 + i] * b_uu2 +
+                                        source_b[s0 + i] * b_uuvv +
+                                        source_c[s0 + i] * b_vv2;
+                                smearing = exp((REAL) -t);
+                            }
+                            if (BANDWIDTH_SMEARING || TIME_SMEARING)
+                            {
+                                const REAL l = source_l[s0 + i];
+                                const REAL m = source_m[s0 + i];
+                                const REAL n = source_n[s0 + i] - (REAL) 1;
+                                if (BANDWIDTH_SMEARING)
+                                {
+                                    const REAL t = b_uu * l + b_vv * m +
+                                            b_ww * n;
+                                    smearing *= oskar_sinc<REAL>(t);
+                                }
+                                if (TIME_SMEARING)
+                                {
+                                    const REAL t = b_du * l + b_dv * m +
+                                            b_dw * n;
+                                    smearing *= oskar_sinc<REAL>(t);
+                                }
+                            }
+
+                            // Load (Jp * B) and Jq.
+                            const REAL pax = P[0 * COMP + i];
+                            const REAL pay = P[1 * COMP + i];
+                            const REAL pbx = P[2 * COMP + i];
+                            const REAL pby = P[3 * COMP + i];
+                            const REAL pcx = P[4 * COMP + i];
+                            const REAL pcy = P[5 * COMP + i];
+                            const REAL pdx = P[6 * COMP + i];
+                            const REAL pdy = P[7 * COMP + i];
+                            const REAL qax = Q[0 * COMP + i];
+                            const REAL qay = Q[1 * COMP + i];
+                            const REAL qbx = Q[2 * COMP + i];
+                            const REAL qby = Q[3 * COMP + i];
+                            const REAL qcx = Q[4 * COMP + i];
+                            const REAL qcy = Q[5 * COMP + i];
+                            const REAL qdx = Q[6 * COMP + i];
+                            const REAL qdy = Q[7 * COMP + i];
+
+                            // Multiply by Jq^H, apply smearing, accumulate.
+                            s_ax += smearing * (pax * qax + pay * qay +
+                                    pbx * qbx + pby * qby);
+                            s_ay += smearing * (pay * qax - pax * qay +
+                                    pby * qbx - pbx * qby);
+                            s_bx += smearing * (pax * qcx + pay * qcy +
+                                    pbx * qdx + pby * qdy);
+                            s_by += smearing * (pay * qcx - pax * qcy +
+                                    pby * qdx - pbx * qdy);
+                            s_cx += smearing * (pcx * qax + pcy * qay +
+                                    pdx * qbx + pdy * qby);
+                            s_cy += smearing * (pcy * qax - pcx * qay +
+                                    pdy * qbx - pdx * qby);
+                            s_dx += smearing * (pcx * qcx + pcy * qcy +
+                                    pdx * qdx + pdy * qdy);
+                            s_dy += smearing * (pcy * qcx - pcx * qcy +
+                                    pdy * qdx - pdx * qdy);
+                        }
+                        sum[b][0] += s_ax; sum[b][1] += s_ay;
+                        sum[b][2] += s_bx; sum[b][3] += s_by;
+                        sum[b][4] += s_cx; sum[b][5] += s_cy;
+                        sum[b][6] += s_dx; sum[b][7] += s_dy;
+                    }
+                }
+            }
+
+            // Add results to the baseline visibilities.
+            for (int p = 0; p < np; ++p)
+            {
+                for (int q = 0; q < nq; ++q)
+                {
+                    const int b = p * TILE_STATIONS + q;
+                    if (!active[b]) continue;
+                    const int i = oskar_evaluate_baseline_index_inline(
+                            num_stations, p0 + p, q0 + q);
+                    vis[i].a.x += (REAL) sum[b][0];
+                    vis[i].a.y += (REAL) sum[b][1];
+                    vis[i].b.x += (REAL) sum[b][2];
+                    vis[i].b.y += (REAL) sum[b][3];
+                    vis[i].c.x += (REAL) sum[b][4];
+                    vis[i].c.y += (REAL) sum[b][5];
+                    vis[i].d.x += (REAL) sum[b][6];
+                    vis[i].d.y += (REAL) sum[b][7];
+                }
+            }
+        }
+    }
+}
+
+
+void oskar_cross_correlate_point_tiled_omp_f(
+        int num_sources, int num_stations, const float4c* d_jones,
+        const float* d_I, const float* d_Q,
+        const float* d_U, const float* d_V,
+        const float* d_l, const float* d_m, const float* d_n,
+        const float* d_station_u, const float* d_station_v,
+        const float* d_station_w,
+        const float* d_station_x, const float* d_station_y,
+        float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
+        float frac_bandwidth, float time_int_sec, float gha0_rad,
+        float dec0_rad, float4c* d_vis)
+{
+    if (frac_bandwidth == 0.0f && time_int_sec == 0.0f)
+        oskar_xcorr_tiled_omp<false, false, false, float, float2, float4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, 0, 0, 0,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+    else if (frac_bandwidth != 0.0f && time_int_sec == 0.0f)
+        oskar_xcorr_tiled_omp<true, false, false, float, float2, float4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, 0, 0, 0,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+    else if (frac_bandwidth == 0.0f && time_int_sec != 0.0f)
+        oskar_xcorr_tiled_omp<false, true, false, float, float2, float4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, 0, 0, 0,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+    else if (frac_bandwidth != 0.0f && time_int_sec != 0.0f)
+        oskar_xcorr_tiled_omp<true, true, false, float, float2, float4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, 0, 0, 0,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+}
+
+void oskar_cross_correlate_point_tiled_omp_d(
+        int num_sources, int num_stations, const double4c* d_jones,
+        const double* d_I, const double* d_Q,
+        const double* d_U, const double* d_V,
+        const double* d_l, const double* d_m, const double* d_n,
+        const double* d_station_u, const double* d_station_v,
+        const double* d_station_w,
+        const double* d_station_x, const double* d_station_y,
+        double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
+        double frac_bandwidth, double time_int_sec, double gha0_rad,
+        double dec0_rad, double4c* d_vis)
+{
+    if (frac_bandwidth == 0.0 && time_int_sec == 0.0)
+        oskar_xcorr_tiled_omp<false, false, false, double, double2, double4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, 0, 0, 0,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+    else if (frac_bandwidth != 0.0 && time_int_sec == 0.0)
+        oskar_xcorr_tiled_omp<true, false, false, double, double2, double4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, 0, 0, 0,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+    else if (frac_bandwidth == 0.0 && time_int_sec != 0.0)
+        oskar_xcorr_tiled_omp<false, true, false, double, double2, double4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, 0, 0, 0,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+    else if (frac_bandwidth != 0.0 && time_int_sec != 0.0)
+        oskar_xcorr_tiled_omp<true, true, false, double, double2, double4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, 0, 0, 0,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+}
+
+void oskar_cross_correlate_gaussian_tiled_omp_f(
+        int num_sources, int num_stations, const float4c* d_jones,
+        const float* d_I, const float* d_Q,
+        const float* d_U, const float* d_V,
+        const float* d_l, const float* d_m, const float* d_n,
+        const float* d_a, const float* d_b, const float* d_c,
+        const float* d_station_u, const float* d_station_v,
+        const float* d_station_w, const float* d_station_x,
+        const float* d_station_y, float uv_min_lambda, float uv_max_lambda,
+        float inv_wavelength, float frac_bandwidth, float time_int_sec,
+        float gha0_rad, float dec0_rad, float4c* d_vis)
+{
+    if (frac_bandwidth == 0.0f && time_int_sec == 0.0f)
+        oskar_xcorr_tiled_omp<false, false, true, float, float2, float4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, d_a, d_b, d_c,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+    else if (frac_bandwidth != 0.0f && time_int_sec == 0.0f)
+        oskar_xcorr_tiled_omp<true, false, true, float, float2, float4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, d_a, d_b, d_c,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+    else if (frac_bandwidth == 0.0f && time_int_sec != 0.0f)
+        oskar_xcorr_tiled_omp<false, true, true, float, float2, float4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, d_a, d_b, d_c,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+    else if (frac_bandwidth != 0.0f && time_int_sec != 0.0f)
+        oskar_xcorr_tiled_omp<true, true, true, float, float2, float4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, d_a, d_b, d_c,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+}
+
+void oskar_cross_correlate_gaussian_tiled_omp_d(
+        int num_sources, int num_stations, const double4c* d_jones,
+        const double* d_I, const double* d_Q,
+        const double* d_U, const double* d_V,
+        const double* d_l, const double* d_m, const double* d_n,
+        const double* d_a, const double* d_b, const double* d_c,
+        const double* d_station_u, const double* d_station_v,
+        const double* d_station_w, const double* d_station_x,
+        const double* d_station_y, double uv_min_lambda, double uv_max_lambda,
+        double inv_wavelength, double frac_bandwidth, double time_int_sec,
+        double gha0_rad, double dec0_rad, double4c* d_vis)
+{
+    if (frac_bandwidth == 0.0 && time_int_sec == 0.0)
+        oskar_xcorr_tiled_omp<false, false, true, double, double2, double4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, d_a, d_b, d_c,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+    else if (frac_bandwidth != 0.0 && time_int_sec == 0.0)
+        oskar_xcorr_tiled_omp<true, false, true, double, double2, double4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, d_a, d_b, d_c,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+    else if (frac_bandwidth == 0.0 && time_int_sec != 0.0)
+        oskar_xcorr_tiled_omp<false, true, true, double, double2, double4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, d_a, d_b, d_c,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+    else if (frac_bandwidth != 0.0 && time_int_sec != 0.0)
+        oskar_xcorr_tiled_omp<true, true, true, double, double2, double4c>
+        (num_sources, num_stations, d_jones, d_I, d_Q, d_U, d_V, d_l, d_m, d_n, d_a, d_b, d_c,
+                d_station_u, d_station_v, d_station_w, d_station_x, d_station_y,
+                uv_min_lambda, uv_max_lambda, inv_wavelength,
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, d_vis);
+}
@@ -31,8 +31,10 @@
 #include "utility/oskar_timer.h"
 
 #include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_omp.h"
 #include "utility/oskar_get_error_string.h"
 #include "math/oskar_kahan_sum.h"
+#include <cfloat>
 #include <cstdlib>
 
 // Comment out this line to disable benchmark timer printing.
@@ -223,6 +225,143 @@ protected:
                 time2 * 1000.0);
 #endif
     }
+
+    // Compares the output of the tiled CPU correlator with that of the
+    // untiled reference version, using the same inputs.
+    void runTiledTest(int precision, int extended, double time_average)
+    {
+        int num_baselines, status = 0, type;
+        oskar_Mem *vis1, *vis2;
+        double frequency = 100e6, gast = 1.0;
+
+        createTestData(precision, OSKAR_CPU, 1);
+        num_baselines = oskar_telescope_num_baselines(tel);
+        type = precision | OSKAR_COMPLEX | OSKAR_MATRIX;
+        vis1 = oskar_mem_create(type, OSKAR_CPU, num_baselines, &status);
+        vis2 = oskar_mem_create(type, OSKAR_CPU, num_baselines, &status);
+        oskar_mem_clear_contents(vis1, &status);
+        oskar_mem_clear_contents(vis2, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        oskar_sky_set_use_extended(sky, extended);
+        oskar_telescope_set_channel_bandwidth(tel, bandwidth);
+        oskar_telescope_set_time_average(tel, time_average);
+
+        // Tiled version.
+        oskar_cross_correlate(vis1, oskar_sky_num_sources(sky), jones, sky,
+                tel, u_, v_, w_, gast, frequency, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Reference version.
+        const double inv_wavelength = frequency / 299792458.0;
+        const double frac_bandwidth = bandwidth / frequency;
+        const double gha0 = gast - oskar_telescope_phase_centre_ra_rad(tel);
+        const double dec0 = oskar_telescope_phase_centre_dec_rad(tel);
+        const oskar_Mem* J = oskar_jones_mem_const(jones);
+        const oskar_Mem* x =
+                oskar_telescope_station_true_x_offset_ecef_metres_const(tel);
+        const oskar_Mem* y =
+                oskar_telescope_station_true_y_offset_ecef_metres_const(tel);
+        if (precision == OSKAR_DOUBLE)
+        {
+            if (extended)
+                oskar_cross_correlate_gaussian_omp_d(num_sources, num_stations,
+                        oskar_mem_double4c_const(J, &status),
+                        oskar_mem_double_const(oskar_sky_I_const(sky), &status),
+                        oskar_mem_double_const(oskar_sky_Q_const(sky), &status),
+                        oskar_mem_double_const(oskar_sky_U_const(sky), &status),
+                        oskar_mem_double_const(oskar_sky_V_const(sky), &status),
+                        oskar_mem_double_const(oskar_sky_l_const(sky), &status),
+                        oskar_mem_double_const(oskar_sky_m_const(sky), &status),
+                        oskar_mem_double_const(oskar_sky_n_const(sky), &status),
+                        oskar_mem_double_const(
+                                oskar_sky_gaussian_a_const(sky), &status),
+                        oskar_mem_double_const(
+                                oskar_sky_gaussian_b_const(sky), &status),
+                        oskar_mem_double_const(
+                                oskar_sky_gaussian_c_const(sky), &status),
+                        oskar_mem_double_const(u_, &status),
+                        oskar_mem_double_const(v_, &status),
+                        oskar_mem_double_const(w_, &status),
+                        oskar_mem_double_const(x, &status),
+                        oskar_mem_double_const(y, &status),
+                        0.0, FLT_MAX, inv_wavelength, frac_bandwidth,
+                        time_average, gha0, dec0,
+                        oskar_mem_double4c(vis2, &status));
+            else
+                oskar_cross_correlate_point_omp_d(num_sources, num_stations,
+                        oskar_mem_double4c_const(J, &status),
+                        oskar_mem_double_const(oskar_sky_I_const(sky), &status),
+                        oskar_mem_double_const(oskar_sky_Q_const(sky), &status),
+                        oskar_mem_double_const(oskar_sky_U_const(sky), &status),
+                        oskar_mem_double_const(oskar_sky_V_const(sky), &status),
+                        oskar_mem_double_const(oskar_sky_l_const(sky), &status),
+                        oskar_mem_double_const(oskar_sky_m_const(sky), &status),
+                        oskar_mem_double_const(oskar_sky_n_const(sky), &status),
+                        oskar_mem_double_const(u_, &status),
+                        oskar_mem_double_const(v_, &status),
+                        oskar_mem_double_const(w_, &status),
+                        oskar_mem_double_const(x, &status),
+                        oskar_mem_double_const(y, &status),
+                        0.0, FLT_MAX, inv_wavelength, frac_bandwidth,
+                        time_average, gha0, dec0,
+                        oskar_mem_double4c(vis2, &status));
+        }
+        else
+        {
+            if (extended)
+                oskar_cross_correlate_gaussian_omp_f(num_sources, num_stations,
+                        oskar_mem_float4c_const(J, &status),
+                        oskar_mem_float_const(oskar_sky_I_const(sky), &status),
+                        oskar_mem_float_const(oskar_sky_Q_const(sky), &status),
+                        oskar_mem_float_const(oskar_sky_U_const(sky), &status),
+                        oskar_mem_float_const(oskar_sky_V_const(sky), &status),
+                        oskar_mem_float_const(oskar_sky_l_const(sky), &status),
+                        oskar_mem_float_const(oskar_sky_m_const(sky), &status),
+                        oskar_mem_float_const(oskar_sky_n_const(sky), &status),
+                        oskar_mem_float_const(
+                                oskar_sky_gaussian_a_const(sky), &status),
+                        oskar_mem_float_const(
+                                oskar_sky_gaussian_b_const(sky), &status),
+                        oskar_mem_float_const(
+                                oskar_sky_gaussian_c_const(sky), &status),
+                        oskar_mem_float_const(u_, &status),
+                        oskar_mem_float_const(v_, &status),
+                        oskar_mem_float_const(w_, &status),
+                        oskar_mem_float_const(x, &status),
+                        oskar_mem_float_const(y, &status),
+                        0.0f, FLT_MAX, inv_wavelength, frac_bandwidth,
+                        time_average, gha0, dec0,
+                        oskar_mem_float4c(vis2, &status));
+            else
+                oskar_cross_correlate_point_omp_f(num_sources, num_stations,
+                        oskar_mem_float4c_const(J, &status),
+                        oskar_mem_float_const(oskar_sky_I_const(sky), &status),
+                        oskar_mem_float_const(oskar_sky_Q_const(sky), &status),
+                        oskar_mem_float_const(oskar_sky_U_const(sky), &status),
+                        oskar_mem_float_const(oskar_sky_V_const(sky), &status),
+                        oskar_mem_float_const(oskar_sky_l_const(sky), &status),
+                        oskar_mem_float_const(oskar_sky_m_const(sky), &status),
+                        oskar_mem_float_const(oskar_sky_n_const(sky), &status),
+                        oskar_mem_float_const(u_, &status),
+                        oskar_mem_float_const(v_, &status),
+                        oskar_mem_float_const(w_, &status),
+                        oskar_mem_float_const(x, &status),
+                        oskar_mem_float_const(y, &status),
+                        0.0f, FLT_MAX, inv_wavelength, frac_bandwidth,
+                        time_average, gha0, dec0,
+                        oskar_mem_float4c(vis2, &status));
+        }
+        destroyTestData();
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Compare results.
+        check_values(vis1, vis2);
+
+        // Free memory.
+        oskar_mem_free(vis1, &status);
+        oskar_mem_free(vis2, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
 };
 
 const double cross_correlate::bandwidth = 1e4;
@@ -383,6 +522,27 @@ TEST_F(cross_correlate, matrix_gaussian_timeSmearing_singleCPU_doubleGPU)
 }
 #endif
 
+// Tiled CPU correlator against reference version.
+TEST_F(cross_correlate, matrix_tiled_point_singleCPU)
+{
+    runTiledTest(OSKAR_SINGLE, 0, 0.0);
+}
+
+TEST_F(cross_correlate, matrix_tiled_point_doubleCPU)
+{
+    runTiledTest(OSKAR_DOUBLE, 0, 0.0);
+}
+
+TEST_F(cross_correlate, matrix_tiled_gaussian_timeSmearing_singleCPU)
+{
+    runTiledTest(OSKAR_SINGLE, 1, 10.0);
+}
+
+TEST_F(cross_correlate, matrix_tiled_gaussian_timeSmearing_doubleCPU)
+{
+    runTiledTest(OSKAR_DOUBLE, 1, 10.0);
+}
+
 
 // SCALAR VERSIONS ////////////////////////////////////////////////////////////
 
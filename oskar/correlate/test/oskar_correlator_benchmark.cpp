@@ -28,6 +28,7 @@
 
 #include "apps/oskar_option_parser.h"
 #include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_omp.h"
 #include "sky/oskar_sky.h"
 #include "interferometer/oskar_jones.h"
 #include "mem/oskar_mem.h"
@@ -39,6 +40,7 @@
 #ifndef _WIN32
 #   include <sys/time.h>
 #endif /* _WIN32 */
+#include <cfloat>
 #include <cmath>
 #include <cstdlib>
 #include <cstdio>
@@ -47,8 +49,16 @@
 static void benchmark(int num_stations, int num_sources, int type,
         int jones_type, int location, int use_extended,
         int use_bandwidth_smearing, int use_time_smearing,
-        int niter, std::vector<double>& times, const std::string& ascii_file,
-        int* status);
+        int use_reference, int niter, std::vector<double>& times,
+        const std::string& ascii_file, int* status);
+
+static double average_time(const std::vector<double>& times,
+        double max_std_dev);
+
+static void cross_correlate_reference(oskar_Mem* vis, int n_sources,
+        const oskar_Jones* jones, const oskar_Sky* sky,
+        const oskar_Telescope* tel, const oskar_Mem* u, const oskar_Mem* v,
+        const oskar_Mem* w, double gast, double frequency_hz, int* status);
 
 int main(int argc, char** argv)
 {
@@ -62,6 +72,8 @@ int main(int argc, char** argv)
     opt.add_flag("-e", "Use Gaussian sources (default: point sources).");
     opt.add_flag("-b", "Use bandwidth smearing (default: no bandwidth smearing).");
     opt.add_flag("-t", "Use time smearing (default: no time smearing).");
+    opt.add_flag("-cmp", "Also time the untiled reference CPU correlator "
+            "on the same inputs (matrix Jones terms only).");
     opt.add_flag("-r", "Dump raw iteration data to this file.", 1);
     opt.add_flag("-a", "Dump ASCII visibility data to this file.", 1);
     opt.add_flag("-std", "Discard values greater than this number of standard "
@@ -99,6 +111,12 @@ int main(int argc, char** argv)
         opt.error("Please select one of -g or -c");
         return EXIT_FAILURE;
     }
+    int use_reference = opt.is_set("-cmp") ? OSKAR_TRUE : OSKAR_FALSE;
+    if (use_reference && (location != OSKAR_CPU || opt.is_set("-s")))
+    {
+        opt.error("Option -cmp requires -c and matrix Jones terms");
+        return EXIT_FAILURE;
+    }
 
     if (opt.is_set("-v"))
     {
@@ -122,10 +140,15 @@ int main(int argc, char** argv)
 
     // Run benchmarks.
     double time_taken_sec = 0.0, average_time_sec = 0.0;
-    std::vector<double> times;
+    double average_time_ref_sec = 0.0;
+    std::vector<double> times, times_ref;
     benchmark(num_stations, num_sources, type, jones_type, location,
             use_extended, use_bandwidth_smearing, use_time_smearing,
-            niter, times, ascii_file, &status);
+            OSKAR_FALSE, niter, times, ascii_file, &status);
+    if (use_reference)
+        benchmark(num_stations, num_sources, type, jones_type, location,
+                use_extended, use_bandwidth_smearing, use_time_smearing,
+                OSKAR_TRUE, niter, times_ref, std::string(), &status);
 
     // Compute total time taken.
     for (int i = 0; i < niter; ++i)
@@ -156,7 +179,58 @@ int main(int argc, char** argv)
         return EXIT_FAILURE;
     }
 
-    // Compute average.
+    // Compute averages.
+    average_time_sec = average_time(times, max_std_dev);
+    if (use_reference)
+        average_time_ref_sec = average_time(times_ref, max_std_dev);
+
+    // Nominal operation count for each source on each baseline:
+    // two 2x2 complex matrix products, then scale and accumulate.
+    const double num_baselines = 0.5 * num_stations * (num_stations - 1.0);
+    const double flops_per_source = opt.is_set("-s") ? 14.0 : 128.0;
+    const double gflop = 1e-9 * flops_per_source * num_baselines * num_sources;
+
+    // Print average.
+    if (opt.is_set("-v"))
+    {
+        printf("==> Total time taken: %f seconds.\n", time_taken_sec);
+        printf("==> Time taken per iteration: %f seconds.\n", average_time_sec);
+        printf("==> Performance: %.2f GFLOP/s.\n", gflop / average_time_sec);
+        if (use_reference)
+        {
+            printf("==> Reference time per iteration: %f seconds.\n",
+                    average_time_ref_sec);
+            printf("==> Reference performance: %.2f GFLOP/s.\n",
+                    gflop / average_time_ref_sec);
+            printf("==> Speed-up: %.2f\n",
+                    average_time_ref_sec / average_time_sec);
+        }
+        printf("==> Iteration values:\n");
+        for (int i = 0; i < niter; ++i)
+        {
+            printf("%.6f\n", times[i]);
+        }
+        printf("\n");
+    }
+    else
+    {
+        printf("%f\n", average_time_sec);
+        if (use_reference)
+            printf("%f\n", average_time_ref_sec);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+double average_time(const std::vector<double>& times, double max_std_dev)
+{
+    double time_taken_sec = 0.0, average_time_sec = 0.0;
+    int niter = (int) times.size();
+    for (int i = 0; i < niter; ++i)
+    {
+        time_taken_sec += times[i];
+    }
     if (max_std_dev > 0.0)
     {
         double std_dev_sec = 0.0, old_time_average_sec;
@@ -171,7 +245,6 @@ int main(int argc, char** argv)
         std_dev_sec = sqrt(std_dev_sec);
 
         // Compute new mean.
-        average_time_sec = 0.0;
         int counter = 0;
         for (int i = 0; i < niter; ++i)
         {
@@ -189,33 +262,15 @@ int main(int argc, char** argv)
     {
         average_time_sec = time_taken_sec / niter;
     }
-
-    // Print average.
-    if (opt.is_set("-v"))
-    {
-        printf("==> Total time taken: %f seconds.\n", time_taken_sec);
-        printf("==> Time taken per iteration: %f seconds.\n", average_time_sec);
-        printf("==> Iteration values:\n");
-        for (int i = 0; i < niter; ++i)
-        {
-            printf("%.6f\n", times[i]);
-        }
-        printf("\n");
-    }
-    else
-    {
-        printf("%f\n", average_time_sec);
-    }
-
-    return EXIT_SUCCESS;
+    return average_time_sec;
 }
 
 
 void benchmark(int num_stations, int num_sources, int type,
         int jones_type, int location, int use_extended,
         int use_bandwidth_smearing, int use_time_smearing,
-        int niter, std::vector<double>& times, const std::string& ascii_file,
-        int* status)
+        int use_reference, int niter, std::vector<double>& times,
+        const std::string& ascii_file, int* status)
 {
     oskar_Timer* timer = oskar_timer_create(location == OSKAR_GPU ?
             OSKAR_TIMER_CUDA : OSKAR_TIMER_NATIVE);
@@ -271,8 +326,12 @@ void benchmark(int num_stations, int num_sources, int type,
     {
         oskar_mem_clear_contents(vis, status);
         oskar_timer_start(timer);
-        oskar_cross_correlate(vis, oskar_sky_num_sources(sky), J, sky, tel,
-                u, v, w, 0.0, 100e6, status);
+        if (use_reference)
+            cross_correlate_reference(vis, oskar_sky_num_sources(sky), J,
+                    sky, tel, u, v, w, 0.0, 100e6, status);
+        else
+            oskar_cross_correlate(vis, oskar_sky_num_sources(sky), J, sky,
+                    tel, u, v, w, 0.0, 100e6, status);
         times[i] = oskar_timer_elapsed(timer);
     }
 
@@ -297,3 +356,101 @@ void benchmark(int num_stations, int num_sources, int type,
     oskar_sky_free(sky, status);
     oskar_timer_free(timer);
 }
+
+
+void cross_correlate_reference(oskar_Mem* vis, int n_sources,
+        const oskar_Jones* jones, const oskar_Sky* sky,
+        const oskar_Telescope* tel, const oskar_Mem* u, const oskar_Mem* v,
+        const oskar_Mem* w, double gast, double frequency_hz, int* status)
+{
+    const int n_stations = oskar_telescope_num_stations(tel);
+    const double inv_wavelength = frequency_hz / 299792458.0;
+    const double frac_bandwidth =
+            oskar_telescope_channel_bandwidth_hz(tel) / frequency_hz;
+    const double time_avg = oskar_telescope_time_average_sec(tel);
+    const double gha0 = gast - oskar_telescope_phase_centre_ra_rad(tel);
+    const double dec0 = oskar_telescope_phase_centre_dec_rad(tel);
+    const oskar_Mem* J = oskar_jones_mem_const(jones);
+    const oskar_Mem* x =
+            oskar_telescope_station_true_x_offset_ecef_metres_const(tel);
+    const oskar_Mem* y =
+            oskar_telescope_station_true_y_offset_ecef_metres_const(tel);
+    const int use_extended = oskar_sky_use_extended(sky);
+    if (*status) return;
+    if (oskar_mem_type(vis) == OSKAR_DOUBLE_COMPLEX_MATRIX)
+    {
+        const double* I = oskar_mem_double_const(oskar_sky_I_const(sky), status);
+        const double* Q = oskar_mem_double_const(oskar_sky_Q_const(sky), status);
+        const double* U = oskar_mem_double_const(oskar_sky_U_const(sky), status);
+        const double* V = oskar_mem_double_const(oskar_sky_V_const(sky), status);
+        const double* l = oskar_mem_double_const(oskar_sky_l_const(sky), status);
+        const double* m = oskar_mem_double_const(oskar_sky_m_const(sky), status);
+        const double* n = oskar_mem_double_const(oskar_sky_n_const(sky), status);
+        if (use_extended)
+            oskar_cross_correlate_gaussian_omp_d(n_sources, n_stations,
+                    oskar_mem_double4c_const(J, status), I, Q, U, V, l, m, n,
+                    oskar_mem_double_const(
+                            oskar_sky_gaussian_a_const(sky), status),
+                    oskar_mem_double_const(
+                            oskar_sky_gaussian_b_const(sky), status),
+                    oskar_mem_double_const(
+                            oskar_sky_gaussian_c_const(sky), status),
+                    oskar_mem_double_const(u, status),
+                    oskar_mem_double_const(v, status),
+                    oskar_mem_double_const(w, status),
+                    oskar_mem_double_const(x, status),
+                    oskar_mem_double_const(y, status),
+                    0.0, FLT_MAX, inv_wavelength, frac_bandwidth,
+                    time_avg, gha0, dec0, oskar_mem_double4c(vis, status));
+        else
+            oskar_cross_correlate_point_omp_d(n_sources, n_stations,
+                    oskar_mem_double4c_const(J, status), I, Q, U, V, l, m, n,
+                    oskar_mem_double_const(u, status),
+                    oskar_mem_double_const(v, status),
+                    oskar_mem_double_const(w, status),
+                    oskar_mem_double_const(x, status),
+                    oskar_mem_double_const(y, status),
+                    0.0, FLT_MAX, inv_wavelength, frac_bandwidth,
+                    time_avg, gha0, dec0, oskar_mem_double4c(vis, status));
+    }
+    else if (oskar_mem_type(vis) == OSKAR_SINGLE_COMPLEX_MATRIX)
+    {
+        const float* I = oskar_mem_float_const(oskar_sky_I_const(sky), status);
+        const float* Q = oskar_mem_float_const(oskar_sky_Q_const(sky), status);
+        const float* U = oskar_mem_float_const(oskar_sky_U_const(sky), status);
+        const float* V = oskar_mem_float_const(oskar_sky_V_const(sky), status);
+        const float* l = oskar_mem_float_const(oskar_sky_l_const(sky), status);
+        const float* m = oskar_mem_float_const(oskar_sky_m_const(sky), status);
+        const float* n = oskar_mem_float_const(oskar_sky_n_const(sky), status);
+        if (use_extended)
+            oskar_cross_correlate_gaussian_omp_f(n_sources, n_stations,
+                    oskar_mem_float4c_const(J, status), I, Q, U, V, l, m, n,
+                    oskar_mem_float_const(
+                            oskar_sky_gaussian_a_const(sky), status),
+                    oskar_mem_float_const(
+                            oskar_sky_gaussian_b_const(sky), status),
+                    oskar_mem_float_const(
+                            oskar_sky_gaussian_c_const(sky), status),
+                    oskar_mem_float_const(u, status),
+                    oskar_mem_float_const(v, status),
+                    oskar_mem_float_const(w, status),
+                    oskar_mem_float_const(x, status),
+                    oskar_mem_float_const(y, status),
+                    0.0f, FLT_MAX, inv_wavelength, frac_bandwidth,
+                    time_avg, gha0, dec0, oskar_mem_float4c(vis, status));
+        else
+            oskar_cross_correlate_point_omp_f(n_sources, n_stations,
+                    oskar_mem_float4c_const(J, status), I, Q, U, V, l, m, n,
+                    oskar_mem_float_const(u, status),
+                    oskar_mem_float_const(v, status),
+                    oskar_mem_float_const(w, status),
+                    oskar_mem_float_const(x, status),
+                    oskar_mem_float_const(y, status),
+                    0.0f, FLT_MAX, inv_wavelength, frac_bandwidth,
+                    time_avg, gha0, dec0, oskar_mem_float4c(vis, status));
+    }
+    else
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+    }
+}
@@ -52,6 +52,32 @@ extern "C" {
 OSKAR_EXPORT
 const char* oskar_imager_algorithm(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the flag specifying whether to cache visibility data.
+ *
+ * @details
+ * Returns the flag specifying whether to cache visibility data read in the
+ * first pass of oskar_imager_run().
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+int oskar_imager_cache_vis(const oskar_Imager* h);
+
+/**
+ * @brief
+ * Returns the maximum memory used to cache visibility data.
+ *
+ * @details
+ * Returns the maximum number of bytes of visibility data cached in memory.
+ * A value of 0 means half the free physical memory is used.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+size_t oskar_imager_cache_vis_max_mem(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the image cell size.
@@ -222,6 +248,18 @@ int oskar_imager_num_image_planes(const oskar_Imager* h);
 OSKAR_EXPORT
 int oskar_imager_num_input_files(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the number of buffers used to read visibility data.
+ *
+ * @details
+ * Returns the number of buffers used to read visibility data.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+int oskar_imager_num_read_buffers(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the number of W-planes in use.
@@ -310,6 +348,47 @@ OSKAR_EXPORT
 void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
         int* status);
 
+/**
+ * @brief
+ * Sets the flag specifying whether to cache visibility data.
+ *
+ * @details
+ * Sets the flag specifying whether to cache visibility data read in the
+ * first pass of oskar_imager_run().
+ *
+ * A first pass through the input data is needed to accumulate the
+ * weights grids for uniform weighting, and the W-coordinate range for
+ * W-projection. If this flag is set, all visibility data are read in the
+ * first pass and held in a cache, which is then used to grid the data
+ * instead of reading the input files a second time.
+ * The cache is held in memory while it fits in half the free memory,
+ * and in a temporary file otherwise.
+ *
+ * The default is false.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     value      If true, cache visibility data.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_cache_vis(oskar_Imager* h, int value);
+
+/**
+ * @brief
+ * Sets the maximum memory used to cache visibility data.
+ *
+ * @details
+ * Sets the maximum number of bytes of visibility data cached in memory,
+ * if oskar_imager_set_cache_vis() is used. Blocks that do not fit are
+ * written to a temporary file instead.
+ *
+ * The default is 0, which uses half the free physical memory.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     bytes      Maximum number of bytes to cache in memory.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_cache_vis_max_mem(oskar_Imager* h, size_t bytes);
+
 /**
  * @brief
  * Sets the image cell size.
@@ -600,6 +679,28 @@ void oskar_imager_set_ms_column(oskar_Imager* h, const char* column,
 OSKAR_EXPORT
 void oskar_imager_set_num_devices(oskar_Imager* h, int value);
 
+/**
+ * @brief
+ * Sets the number of buffers used to read visibility data.
+ *
+ * @details
+ * Sets the number of buffers used to read visibility data in
+ * oskar_imager_run().
+ *
+ * If more than one buffer is used, visibility blocks are read by a
+ * separate thread while earlier blocks are gridded, so that reading and
+ * gridding overlap. Each buffer holds one visibility block, and the number
+ * of buffers is reduced if necessary to use at most half the free memory.
+ * A value of 1 reads each block before it is gridded, using no extra memory.
+ *
+ * The default is 2.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     value      Number of read buffers.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_num_read_buffers(oskar_Imager* h, int value);
+
 /**
  * @brief
  * Sets the root path of output images.
@@ -767,6 +868,26 @@ void oskar_imager_set_vis_phase_centre(oskar_Imager* h,
 OSKAR_EXPORT
 void oskar_imager_set_num_w_planes(oskar_Imager* h, int value);
 
+/**
+ * @brief
+ * Sets the directory used to cache W-projection kernels.
+ *
+ * @details
+ * Sets the directory used to cache W-projection kernels.
+ *
+ * If set, generated W-kernels are saved in this directory, in a file
+ * named using a checksum of the parameters used to generate them.
+ * A later run using the same parameters loads the kernels from the file
+ * instead of generating them again.
+ *
+ * The cache is not used if the path is NULL or empty, which is the default.
+ *
+ * @param[in,out] h            Handle to imager.
+ * @param[in] path             Path to cache directory.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_w_kernel_cache_dir(oskar_Imager* h, const char* path);
+
 /**
  * @brief
  * Sets the visibility weighting scheme to use.
@@ -844,6 +965,19 @@ double oskar_imager_uv_filter_max(const oskar_Imager* h);
 OSKAR_EXPORT
 double oskar_imager_uv_filter_min(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the directory used to cache W-projection kernels.
+ *
+ * @details
+ * Returns the directory used to cache W-projection kernels,
+ * or NULL if not set.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+const char* oskar_imager_w_kernel_cache_dir(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the visibility weighting scheme.
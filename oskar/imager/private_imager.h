@@ -26,11 +26,8 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifdef OSKAR_HAVE_CUDA
-#include <cufft.h>
-#endif
-
 #include <fitsio.h>
+#include <math/oskar_fft.h>
 #include <mem/oskar_mem.h>
 #include <log/oskar_log.h>
 #include <utility/oskar_thread.h>
@@ -61,17 +58,20 @@ struct oskar_Imager
     int chan_snaps, im_type, num_im_channels, num_im_pols, pol_offset;
     int algorithm, image_size, use_stokes, support, oversample;
     int generate_w_kernels_on_gpu, set_cellsize, set_fov, weighting;
-    int num_files, scale_norm_with_num_input_files;
+    int num_files, scale_norm_with_num_input_files, num_read_buffers;
+    int cache_vis;
     char direction_type, kernel_type;
     char **input_files, *input_root, *output_root, *ms_column;
+    char *w_kernel_cache_dir;
     double cellsize_rad, fov_deg, image_padding, im_centre_deg[2];
+    size_t cache_vis_max_mem;
     double uv_filter_min, uv_filter_max;
     double time_min_utc, time_max_utc, freq_min_hz, freq_max_hz;
 
     /* Visibility meta-data. */
     int num_sel_freqs;
     double *im_freqs, *sel_freqs;
-    double vis_freq_start_hz, freq_inc_hz;
+    double vis_freq_start_hz, freq_inc_hz, vis_centre_deg[2];
 
     /* State. */
     int status, i_block;
@@ -80,7 +80,10 @@ struct oskar_Imager
     /* Scratch data. */
     oskar_Mem *uu_im, *vv_im, *ww_im, *vis_im, *weight_im, *time_im;
     oskar_Mem *uu_tmp, *vv_tmp, *ww_tmp, *stokes, *weight_tmp;
+    oskar_MemArena* arena; /* Temporary arrays used in update functions. */
     int coords_only; /* Set if doing a first pass for uniform weighting. */
+    struct oskar_ImagerVisCache* vis_cache; /* Data read in the first pass. */
+    size_t vis_bytes_read; /* Visibility data read from input files. */
     int num_planes; /* For each output channel and polarisation. */
     double *plane_norm, delta_l, delta_m, delta_n, M[9];
     oskar_Mem **planes, **weights_grids;
@@ -90,10 +93,8 @@ struct oskar_Imager
 
     /* FFT imager data. */
     int grid_size;
-    oskar_Mem *conv_func, *corr_func, *fftpack_wsave, *fftpack_work;
-#ifdef OSKAR_HAVE_CUDA
-    cufftHandle cufft_plan;
-#endif
+    oskar_Mem *conv_func, *corr_func;
+    oskar_FFT* fft;
 
     /* W-projection imager data. */
     size_t ww_points;
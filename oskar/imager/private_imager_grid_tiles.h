@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_IMAGER_GRID_TILES_H_
+#define OSKAR_IMAGER_GRID_TILES_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Minimum number of visibilities for which tiled gridding is used. */
+#define OSKAR_GRID_TILES_MIN_POINTS 4096
+
+/*
+ * Returns the side length of the grid tiles used for parallel gridding.
+ *
+ * Tiles are at least twice the maximum kernel support, so the footprints
+ * of visibilities in two tiles that are not adjacent can never overlap.
+ */
+int oskar_imager_grid_tile_size(int max_support);
+
+/*
+ * Sorts visibility indices by tile using a stable counting sort.
+ *
+ * Visibilities with a negative tile ID are skipped.
+ * On success, the indices of visibilities in tile t are
+ * sorted[tile_start[t]] to sorted[tile_start[t + 1] - 1].
+ * Both arrays must be freed by the caller.
+ *
+ * Returns 0 on success, or 1 if memory could not be allocated.
+ */
+int oskar_imager_grid_tiles_sort(size_t num_points, const int* tile_id,
+        int num_tiles, size_t** tile_start, size_t** sorted);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_GRID_TILES_H_ */
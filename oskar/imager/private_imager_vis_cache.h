@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_IMAGER_VIS_CACHE_H_
+#define OSKAR_IMAGER_VIS_CACHE_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_ImagerVisCache;
+typedef struct oskar_ImagerVisCache oskar_ImagerVisCache;
+
+/* Creates a cache that holds up to max_mem_bytes in memory. */
+oskar_ImagerVisCache* oskar_imager_vis_cache_create(size_t max_mem_bytes);
+
+void oskar_imager_vis_cache_free(oskar_ImagerVisCache* cache);
+
+/* Appends a block of visibility data, using the imager's current
+ * visibility frequency and phase centre. */
+void oskar_imager_vis_cache_add(oskar_ImagerVisCache* cache,
+        const oskar_Imager* h, size_t num_rows, int start_chan, int end_chan,
+        int num_pols, const oskar_Mem* uu, const oskar_Mem* vv,
+        const oskar_Mem* ww, const oskar_Mem* amps, const oskar_Mem* weight,
+        const oskar_Mem* time_centroid, int* status);
+
+/* Passes all cached blocks to oskar_imager_update(), in order. */
+void oskar_imager_vis_cache_replay(oskar_ImagerVisCache* cache,
+        oskar_Imager* h, int* percent_done, int* percent_next, int* status);
+
+size_t oskar_imager_vis_cache_bytes_in_memory(
+        const oskar_ImagerVisCache* cache);
+
+size_t oskar_imager_vis_cache_bytes_on_disk(
+        const oskar_ImagerVisCache* cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_VIS_CACHE_H_ */
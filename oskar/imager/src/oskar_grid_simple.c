@@ -27,9 +27,14 @@
  */
 
 #include "imager/oskar_grid_simple.h"
+#include "imager/private_imager_grid_tiles.h"
 #include <math.h>
 #include <stdlib.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -175,6 +180,289 @@ static void oskar_grid_simple_default_f(
 }
 
 
+#ifdef _OPENMP
+static int oskar_grid_simple_tiled_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const size_t num_points,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* restrict vis,
+        const double* restrict weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* restrict grid)
+{
+#ifdef OSKAR_OS_WIN
+    int i;
+    const int num = (const int) num_points;
+#else
+    size_t i;
+    const size_t num = num_points;
+#endif
+    int c, t, *tile_id, num_tiles, num_tiles_side, tile_size;
+    size_t skipped = 0, *tile_start = 0, *sorted = 0;
+    double* tile_norm;
+    const int grid_centre = grid_size / 2;
+    const double grid_scale = grid_size * cell_size_rad;
+
+    /* Set up the tiles. */
+    tile_size = oskar_imager_grid_tile_size(support);
+    num_tiles_side = (grid_size + tile_size - 1) / tile_size;
+    num_tiles = num_tiles_side * num_tiles_side;
+    tile_id = (int*) malloc(num_points * sizeof(int));
+    tile_norm = (double*) calloc(num_tiles, sizeof(double));
+    if (!tile_id || !tile_norm)
+    {
+        free(tile_id);
+        free(tile_norm);
+        return 1;
+    }
+
+    /* Find the tile containing the centre of each visibility. */
+#pragma omp parallel for private(i) reduction(+:skipped)
+    for (i = 0; i < num; ++i)
+    {
+        const double pos_u = -uu[i] * grid_scale;
+        const double pos_v = vv[i] * grid_scale;
+        const int grid_u = (int)round(pos_u) + grid_centre;
+        const int grid_v = (int)round(pos_v) + grid_centre;
+
+        /* Catch points that would lie outside the grid. */
+        if (grid_u + support >= grid_size || grid_u - support < 0 ||
+                grid_v + support >= grid_size || grid_v - support < 0)
+        {
+            tile_id[i] = -1;
+            skipped++;
+        }
+        else
+            tile_id[i] = (grid_v / tile_size) * num_tiles_side +
+                    grid_u / tile_size;
+    }
+    if (oskar_imager_grid_tiles_sort(num_points, tile_id, num_tiles,
+            &tile_start, &sorted))
+    {
+        free(tile_id);
+        free(tile_norm);
+        return 1;
+    }
+    free(tile_id);
+
+    /* Grid the tiles in four passes, so that tiles being updated
+     * concurrently are never adjacent, and their footprints are disjoint. */
+    for (c = 0; c < 4; ++c)
+    {
+#pragma omp parallel for private(t) schedule(dynamic, 1)
+        for (t = 0; t < num_tiles; ++t)
+        {
+            size_t k;
+            double tile_sum = 0.0;
+            const int tile_u = t % num_tiles_side, tile_v = t / num_tiles_side;
+            if (((tile_v & 1) << 1 | (tile_u & 1)) != c) continue;
+
+            /* Loop over visibilities in this tile. */
+            for (k = tile_start[t]; k < tile_start[t + 1]; ++k)
+            {
+                double sum = 0.0;
+                int j, l;
+                const size_t s = sorted[k];
+
+                /* Convert UV coordinates to grid coordinates. */
+                const double pos_u = -uu[s] * grid_scale;
+                const double pos_v = vv[s] * grid_scale;
+                const int grid_u = (int)round(pos_u) + grid_centre;
+                const int grid_v = (int)round(pos_v) + grid_centre;
+
+                /* Get visibility data. */
+                const double weight_i = weight[s];
+                const double v_re = weight_i * vis[2 * s];
+                const double v_im = weight_i * vis[2 * s + 1];
+
+                /* Scaled distance from nearest grid point. */
+                const int off_u =
+                        (int)round((round(pos_u) - pos_u) * oversample);
+                const int off_v =
+                        (int)round((round(pos_v) - pos_v) * oversample);
+
+                /* Convolve this point onto the grid. */
+                for (j = -support; j <= support; ++j)
+                {
+                    size_t p1;
+                    const double c1 = conv_func[abs(off_v + j * oversample)];
+                    p1 = grid_v + j;
+                    p1 *= grid_size; /* Tested to avoid int overflow. */
+                    p1 += grid_u;
+                    for (l = -support; l <= support; ++l)
+                    {
+                        const size_t p = (p1 + l) << 1;
+                        const double cv =
+                                conv_func[abs(off_u + l * oversample)] * c1;
+                        grid[p]     += v_re * cv;
+                        grid[p + 1] += v_im * cv;
+                        sum += cv;
+                    }
+                }
+                tile_sum += sum * weight_i;
+            }
+            tile_norm[t] = tile_sum;
+        }
+    }
+
+    /* Update the normalisation factor and the number of points skipped. */
+    for (t = 0; t < num_tiles; ++t) *norm += tile_norm[t];
+    *num_skipped = skipped;
+    free(tile_norm);
+    free(tile_start);
+    free(sorted);
+    return 0;
+}
+#endif
+
+
+#ifdef _OPENMP
+static int oskar_grid_simple_tiled_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const size_t num_points,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* restrict vis,
+        const float* restrict weight,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* restrict grid)
+{
+#ifdef OSKAR_OS_WIN
+    int i;
+    const int num = (const int) num_points;
+#else
+    size_t i;
+    const size_t num = num_points;
+#endif
+    int c, t, *tile_id, num_tiles, num_tiles_side, tile_size;
+    size_t skipped = 0, *tile_start = 0, *sorted = 0;
+    double* tile_norm;
+    const int grid_centre = grid_size / 2;
+    const float grid_scale = grid_size * cell_size_rad;
+
+    /* Set up the tiles. */
+    tile_size = oskar_imager_grid_tile_size(support);
+    num_tiles_side = (grid_size + tile_size - 1) / tile_size;
+    num_tiles = num_tiles_side * num_tiles_side;
+    tile_id = (int*) malloc(num_points * sizeof(int));
+    tile_norm = (double*) calloc(num_tiles, sizeof(double));
+    if (!tile_id || !tile_norm)
+    {
+        free(tile_id);
+        free(tile_norm);
+        return 1;
+    }
+
+    /* Find the tile containing the centre of each visibility. */
+#pragma omp parallel for private(i) reduction(+:skipped)
+    for (i = 0; i < num; ++i)
+    {
+        const float pos_u = -uu[i] * grid_scale;
+        const float pos_v = vv[i] * grid_scale;
+        const int grid_u = (int)roundf(pos_u) + grid_centre;
+        const int grid_v = (int)roundf(pos_v) + grid_centre;
+
+        /* Catch points that would lie outside the grid. */
+        if (grid_u + support >= grid_size || grid_u - support < 0 ||
+                grid_v + support >= grid_size || grid_v - support < 0)
+        {
+            tile_id[i] = -1;
+            skipped++;
+        }
+        else
+            tile_id[i] = (grid_v / tile_size) * num_tiles_side +
+                    grid_u / tile_size;
+    }
+    if (oskar_imager_grid_tiles_sort(num_points, tile_id, num_tiles,
+            &tile_start, &sorted))
+    {
+        free(tile_id);
+        free(tile_norm);
+        return 1;
+    }
+    free(tile_id);
+
+    /* Grid the tiles in four passes, so that tiles being updated
+     * concurrently are never adjacent, and their footprints are disjoint. */
+    for (c = 0; c < 4; ++c)
+    {
+#pragma omp parallel for private(t) schedule(dynamic, 1)
+        for (t = 0; t < num_tiles; ++t)
+        {
+            size_t k;
+            double tile_sum = 0.0;
+            const int tile_u = t % num_tiles_side, tile_v = t / num_tiles_side;
+            if (((tile_v & 1) << 1 | (tile_u & 1)) != c) continue;
+
+            /* Loop over visibilities in this tile. */
+            for (k = tile_start[t]; k < tile_start[t + 1]; ++k)
+            {
+                double sum = 0.0;
+                int j, l;
+                const size_t s = sorted[k];
+
+                /* Convert UV coordinates to grid coordinates. */
+                const float pos_u = -uu[s] * grid_scale;
+                const float pos_v = vv[s] * grid_scale;
+                const int grid_u = (int)roundf(pos_u) + grid_centre;
+                const int grid_v = (int)roundf(pos_v) + grid_centre;
+
+                /* Get visibility data. */
+                const float weight_i = weight[s];
+                const float v_re = weight_i * vis[2 * s];
+                const float v_im = weight_i * vis[2 * s + 1];
+
+                /* Scaled distance from nearest grid point. */
+                const int off_u =
+                        (int)roundf((roundf(pos_u) - pos_u) * oversample);
+                const int off_v =
+                        (int)roundf((roundf(pos_v) - pos_v) * oversample);
+
+                /* Convolve this point onto the grid. */
+                for (j = -support; j <= support; ++j)
+                {
+                    size_t p1;
+                    const float c1 = conv_func[abs(off_v + j * oversample)];
+                    p1 = grid_v + j;
+                    p1 *= grid_size; /* Tested to avoid int overflow. */
+                    p1 += grid_u;
+                    for (l = -support; l <= support; ++l)
+                    {
+                        const size_t p = (p1 + l) << 1;
+                        const float cv =
+                                conv_func[abs(off_u + l * oversample)] * c1;
+                        grid[p]     += v_re * cv;
+                        grid[p + 1] += v_im * cv;
+                        sum += cv;
+                    }
+                }
+                tile_sum += sum * weight_i;
+            }
+            tile_norm[t] = tile_sum;
+        }
+    }
+
+    /* Update the normalisation factor and the number of points skipped. */
+    for (t = 0; t < num_tiles; ++t) *norm += tile_norm[t];
+    *num_skipped = skipped;
+    free(tile_norm);
+    free(tile_start);
+    free(sorted);
+    return 0;
+}
+#endif
+
 void oskar_grid_simple_d(
         const int support,
         const int oversample,
@@ -194,6 +482,18 @@ void oskar_grid_simple_d(
     const int grid_centre = grid_size / 2;
     const double grid_scale = grid_size * cell_size_rad;
 
+#ifdef _OPENMP
+    /* Grid tiles in parallel if using more than one thread. */
+    if (num_points >= OSKAR_GRID_TILES_MIN_POINTS &&
+            omp_get_max_threads() > 1 && !omp_in_parallel())
+    {
+        if (!oskar_grid_simple_tiled_d(support, oversample, conv_func,
+                num_points, uu, vv, vis, weight, cell_size_rad, grid_size,
+                num_skipped, norm, grid))
+            return;
+    }
+#endif
+
     /* Use slightly more efficient version for default parameters. */
     if (support == D_SUPPORT && oversample == D_OVERSAMPLE)
     {
@@ -273,6 +573,18 @@ void oskar_grid_simple_f(
     const int grid_centre = grid_size / 2;
     const float grid_scale = grid_size * cell_size_rad;
 
+#ifdef _OPENMP
+    /* Grid tiles in parallel if using more than one thread. */
+    if (num_points >= OSKAR_GRID_TILES_MIN_POINTS &&
+            omp_get_max_threads() > 1 && !omp_in_parallel())
+    {
+        if (!oskar_grid_simple_tiled_f(support, oversample, conv_func,
+                num_points, uu, vv, vis, weight, cell_size_rad, grid_size,
+                num_skipped, norm, grid))
+            return;
+    }
+#endif
+
     /* Use slightly more efficient version for default parameters. */
     if (support == D_SUPPORT && oversample == D_OVERSAMPLE)
     {
@@ -27,13 +27,347 @@
  */
 
 #include "imager/oskar_grid_wproj.h"
+#include "imager/private_imager_grid_tiles.h"
 #include <math.h>
 #include <stdlib.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#ifdef _OPENMP
+static int oskar_grid_wproj_tiled_d(
+        const size_t num_w_planes,
+        const int* restrict support,
+        const int oversample,
+        const int conv_size_half,
+        const double* restrict conv_func,
+        const size_t num_points,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* restrict ww,
+        const double* restrict vis,
+        const double* restrict weight,
+        const double cell_size_rad,
+        const double w_scale,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* restrict grid)
+{
+#ifdef OSKAR_OS_WIN
+    int i;
+    const int num = (const int) num_points;
+#else
+    size_t i;
+    const size_t num = num_points;
+#endif
+    int c, t, *tile_id, num_tiles, num_tiles_side, tile_size, max_support = 0;
+    size_t skipped = 0, *tile_start = 0, *sorted = 0;
+    double* tile_norm;
+    const size_t kernel_dim = conv_size_half * conv_size_half;
+    const int grid_centre = grid_size / 2;
+    const double grid_scale = grid_size * cell_size_rad;
+
+    /* Set up the tiles. */
+    for (t = 0; t < (int) num_w_planes; ++t)
+        if (support[t] > max_support) max_support = support[t];
+    tile_size = oskar_imager_grid_tile_size(max_support);
+    num_tiles_side = (grid_size + tile_size - 1) / tile_size;
+    num_tiles = num_tiles_side * num_tiles_side;
+    tile_id = (int*) malloc(num_points * sizeof(int));
+    tile_norm = (double*) calloc(num_tiles, sizeof(double));
+    if (!tile_id || !tile_norm)
+    {
+        free(tile_id);
+        free(tile_norm);
+        return 1;
+    }
+
+    /* Find the tile containing the centre of each visibility. */
+#pragma omp parallel for private(i) reduction(+:skipped)
+    for (i = 0; i < num; ++i)
+    {
+        const double pos_u = -uu[i] * grid_scale;
+        const double pos_v = vv[i] * grid_scale;
+        const size_t grid_w = (size_t)round(sqrt(fabs(ww[i] * w_scale)));
+        const int grid_u = (int)round(pos_u) + grid_centre;
+        const int grid_v = (int)round(pos_v) + grid_centre;
+        const int w_support = grid_w < num_w_planes ?
+                support[grid_w] : support[num_w_planes - 1];
+
+        /* Catch points that would lie outside the grid. */
+        if (grid_u + w_support >= grid_size || grid_u - w_support < 0 ||
+                grid_v + w_support >= grid_size || grid_v - w_support < 0)
+        {
+            tile_id[i] = -1;
+            skipped++;
+        }
+        else
+            tile_id[i] = (grid_v / tile_size) * num_tiles_side +
+                    grid_u / tile_size;
+    }
+    if (oskar_imager_grid_tiles_sort(num_points, tile_id, num_tiles,
+            &tile_start, &sorted))
+    {
+        free(tile_id);
+        free(tile_norm);
+        return 1;
+    }
+    free(tile_id);
+
+    /* Grid the tiles in four passes, so that tiles being updated
+     * concurrently are never adjacent, and their footprints are disjoint. */
+    for (c = 0; c < 4; ++c)
+    {
+#pragma omp parallel for private(t) schedule(dynamic, 1)
+        for (t = 0; t < num_tiles; ++t)
+        {
+            size_t k;
+            double tile_sum = 0.0;
+            const int tile_u = t % num_tiles_side, tile_v = t / num_tiles_side;
+            if (((tile_v & 1) << 1 | (tile_u & 1)) != c) continue;
+
+            /* Loop over visibilities in this tile. */
+            for (k = tile_start[t]; k < tile_start[t + 1]; ++k)
+            {
+                double sum = 0.0;
+                int j, l;
+                const size_t s = sorted[k];
+
+                /* Convert UV coordinates to grid coordinates. */
+                const double pos_u = -uu[s] * grid_scale;
+                const double pos_v = vv[s] * grid_scale;
+                const double ww_i = ww[s];
+                const double conv_conj = (ww_i > (double) 0) ? -1 : 1;
+                const size_t grid_w = (size_t)round(sqrt(fabs(ww_i * w_scale)));
+                const int grid_u = (int)round(pos_u) + grid_centre;
+                const int grid_v = (int)round(pos_v) + grid_centre;
+
+                /* Get visibility data. */
+                const double weight_i = weight[s];
+                const double v_re = weight_i * vis[2 * s];
+                const double v_im = weight_i * vis[2 * s + 1];
+
+                /* Scaled distance from nearest grid point. */
+                const int off_u =
+                        (int)round((round(pos_u) - pos_u) * oversample);
+                const int off_v =
+                        (int)round((round(pos_v) - pos_v) * oversample);
+
+                /* Get kernel support size and start offset. */
+                const int w_support = grid_w < num_w_planes ?
+                        support[grid_w] : support[num_w_planes - 1];
+                const size_t kernel_start = grid_w < num_w_planes ?
+                        grid_w * kernel_dim : (num_w_planes - 1) * kernel_dim;
+
+                /* Convolve this point onto the grid. */
+                for (j = -w_support; j <= w_support; ++j)
+                {
+                    size_t p1, t1;
+                    p1 = grid_v + j;
+                    p1 *= grid_size; /* Tested to avoid int overflow. */
+                    p1 += grid_u;
+                    t1 = abs(off_v + j * oversample);
+                    t1 *= conv_size_half;
+                    t1 += kernel_start;
+                    for (l = -w_support; l <= w_support; ++l)
+                    {
+                        size_t p = (t1 + abs(off_u + l * oversample)) << 1;
+                        const double c_re = conv_func[p];
+                        const double c_im = conv_func[p + 1] * conv_conj;
+                        p = (p1 + l) << 1;
+                        grid[p]     += (v_re * c_re - v_im * c_im);
+                        grid[p + 1] += (v_im * c_re + v_re * c_im);
+                        sum += c_re; /* Real part only. */
+                    }
+                }
+                tile_sum += sum * weight_i;
+            }
+            tile_norm[t] = tile_sum;
+        }
+    }
+
+    /* Update the normalisation factor and the number of points skipped. */
+    for (t = 0; t < num_tiles; ++t) *norm += tile_norm[t];
+    *num_skipped = skipped;
+    free(tile_norm);
+    free(tile_start);
+    free(sorted);
+    return 0;
+}
+#endif
+
+
+#ifdef _OPENMP
+static int oskar_grid_wproj_tiled_f(
+        const size_t num_w_planes,
+        const int* restrict support,
+        const int oversample,
+        const int conv_size_half,
+        const float* restrict conv_func,
+        const size_t num_points,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* restrict ww,
+        const float* restrict vis,
+        const float* restrict weight,
+        const float cell_size_rad,
+        const float w_scale,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* restrict grid)
+{
+#ifdef OSKAR_OS_WIN
+    int i;
+    const int num = (const int) num_points;
+#else
+    size_t i;
+    const size_t num = num_points;
+#endif
+    int c, t, *tile_id, num_tiles, num_tiles_side, tile_size, max_support = 0;
+    size_t skipped = 0, *tile_start = 0, *sorted = 0;
+    double* tile_norm;
+    const size_t kernel_dim = conv_size_half * conv_size_half;
+    const int grid_centre = grid_size / 2;
+    const float grid_scale = grid_size * cell_size_rad;
+
+    /* Set up the tiles. */
+    for (t = 0; t < (int) num_w_planes; ++t)
+        if (support[t] > max_support) max_support = support[t];
+    tile_size = oskar_imager_grid_tile_size(max_support);
+    num_tiles_side = (grid_size + tile_size - 1) / tile_size;
+    num_tiles = num_tiles_side * num_tiles_side;
+    tile_id = (int*) malloc(num_points * sizeof(int));
+    tile_norm = (double*) calloc(num_tiles, sizeof(double));
+    if (!tile_id || !tile_norm)
+    {
+        free(tile_id);
+        free(tile_norm);
+        return 1;
+    }
+
+    /* Find the tile containing the centre of each visibility. */
+#pragma omp parallel for private(i) reduction(+:skipped)
+    for (i = 0; i < num; ++i)
+    {
+        const float pos_u = -uu[i] * grid_scale;
+        const float pos_v = vv[i] * grid_scale;
+        const size_t grid_w = (size_t)roundf(sqrtf(fabsf(ww[i] * w_scale)));
+        const int grid_u = (int)roundf(pos_u) + grid_centre;
+        const int grid_v = (int)roundf(pos_v) + grid_centre;
+        const int w_support = grid_w < num_w_planes ?
+                support[grid_w] : support[num_w_planes - 1];
+
+        /* Catch points that would lie outside the grid. */
+        if (grid_u + w_support >= grid_size || grid_u - w_support < 0 ||
+                grid_v + w_support >= grid_size || grid_v - w_support < 0)
+        {
+            tile_id[i] = -1;
+            skipped++;
+        }
+        else
+            tile_id[i] = (grid_v / tile_size) * num_tiles_side +
+                    grid_u / tile_size;
+    }
+    if (oskar_imager_grid_tiles_sort(num_points, tile_id, num_tiles,
+            &tile_start, &sorted))
+    {
+        free(tile_id);
+        free(tile_norm);
+        return 1;
+    }
+    free(tile_id);
+
+    /* Grid the tiles in four passes, so that tiles being updated
+     * concurrently are never adjacent, and their footprints are disjoint. */
+    for (c = 0; c < 4; ++c)
+    {
+#pragma omp parallel for private(t) schedule(dynamic, 1)
+        for (t = 0; t < num_tiles; ++t)
+        {
+            size_t k;
+            double tile_sum = 0.0;
+            const int tile_u = t % num_tiles_side, tile_v = t / num_tiles_side;
+            if (((tile_v & 1) << 1 | (tile_u & 1)) != c) continue;
+
+            /* Loop over visibilities in this tile. */
+            for (k = tile_start[t]; k < tile_start[t + 1]; ++k)
+            {
+                double sum = 0.0;
+                int j, l;
+                const size_t s = sorted[k];
+
+                /* Convert UV coordinates to grid coordinates. */
+                const float pos_u = -uu[s] * grid_scale;
+                const float pos_v = vv[s] * grid_scale;
+                const float ww_i = ww[s];
+                const float conv_conj = (ww_i > (float) 0) ? -1 : 1;
+                const size_t grid_w =
+                        (size_t)roundf(sqrtf(fabsf(ww_i * w_scale)));
+                const int grid_u = (int)roundf(pos_u) + grid_centre;
+                const int grid_v = (int)roundf(pos_v) + grid_centre;
+
+                /* Get visibility data. */
+                const float weight_i = weight[s];
+                const float v_re = weight_i * vis[2 * s];
+                const float v_im = weight_i * vis[2 * s + 1];
+
+                /* Scaled distance from nearest grid point. */
+                const int off_u =
+                        (int)roundf((roundf(pos_u) - pos_u) * oversample);
+                const int off_v =
+                        (int)roundf((roundf(pos_v) - pos_v) * oversample);
+
+                /* Get kernel support size and start offset. */
+                const int w_support = grid_w < num_w_planes ?
+                        support[grid_w] : support[num_w_planes - 1];
+                const size_t kernel_start = grid_w < num_w_planes ?
+                        grid_w * kernel_dim : (num_w_planes - 1) * kernel_dim;
+
+                /* Convolve this point onto the grid. */
+                for (j = -w_support; j <= w_support; ++j)
+                {
+                    size_t p1, t1;
+                    p1 = grid_v + j;
+                    p1 *= grid_size; /* Tested to avoid int overflow. */
+                    p1 += grid_u;
+                    t1 = abs(off_v + j * oversample);
+                    t1 *= conv_size_half;
+                    t1 += kernel_start;
+                    for (l = -w_support; l <= w_support; ++l)
+                    {
+                        size_t p = (t1 + abs(off_u + l * oversample)) << 1;
+                        const float c_re = conv_func[p];
+                        const float c_im = conv_func[p + 1] * conv_conj;
+                        p = (p1 + l) << 1;
+                        grid[p]     += (v_re * c_re - v_im * c_im);
+                        grid[p + 1] += (v_im * c_re + v_re * c_im);
+                        sum += c_re; /* Real part only. */
+                    }
+                }
+                tile_sum += sum * weight_i;
+            }
+            tile_norm[t] = tile_sum;
+        }
+    }
+
+    /* Update the normalisation factor and the number of points skipped. */
+    for (t = 0; t < num_tiles; ++t) *norm += tile_norm[t];
+    *num_skipped = skipped;
+    free(tile_norm);
+    free(tile_start);
+    free(sorted);
+    return 0;
+}
+#endif
+
+
 void oskar_grid_wproj_d(
         const size_t num_w_planes,
         const int* restrict support,
@@ -58,6 +392,19 @@ void oskar_grid_wproj_d(
     const int grid_centre = grid_size / 2;
     const double grid_scale = grid_size * cell_size_rad;
 
+#ifdef _OPENMP
+    /* Grid tiles in parallel if using more than one thread. */
+    if (num_points >= OSKAR_GRID_TILES_MIN_POINTS &&
+            omp_get_max_threads() > 1 && !omp_in_parallel())
+    {
+        if (!oskar_grid_wproj_tiled_d(num_w_planes, support, oversample,
+                conv_size_half, conv_func, num_points, uu, vv, ww, vis,
+                weight, cell_size_rad, w_scale, grid_size, num_skipped,
+                norm, grid))
+            return;
+    }
+#endif
+
     /* Loop over visibilities. */
     *num_skipped = 0;
     for (i = 0; i < num_points; ++i)
@@ -147,6 +494,19 @@ void oskar_grid_wproj_f(
     const int grid_centre = grid_size / 2;
     const float grid_scale = grid_size * cell_size_rad;
 
+#ifdef _OPENMP
+    /* Grid tiles in parallel if using more than one thread. */
+    if (num_points >= OSKAR_GRID_TILES_MIN_POINTS &&
+            omp_get_max_threads() > 1 && !omp_in_parallel())
+    {
+        if (!oskar_grid_wproj_tiled_f(num_w_planes, support, oversample,
+                conv_size_half, conv_func, num_points, uu, vv, ww, vis,
+                weight, cell_size_rad, w_scale, grid_size, num_skipped,
+                norm, grid))
+            return;
+    }
+#endif
+
     /* Loop over visibilities. */
     *num_skipped = 0;
     for (i = 0; i < num_points; ++i)
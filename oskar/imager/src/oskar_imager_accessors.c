@@ -62,6 +62,18 @@ const char* oskar_imager_algorithm(const oskar_Imager* h)
 }
 
 
+int oskar_imager_cache_vis(const oskar_Imager* h)
+{
+    return h->cache_vis;
+}
+
+
+size_t oskar_imager_cache_vis_max_mem(const oskar_Imager* h)
+{
+    return h->cache_vis_max_mem;
+}
+
+
 double oskar_imager_cellsize(const oskar_Imager* h)
 {
     return (h->cellsize_rad * (180.0 / M_PI)) * 3600.0;
@@ -160,6 +172,12 @@ int oskar_imager_num_input_files(const oskar_Imager* h)
 }
 
 
+int oskar_imager_num_read_buffers(const oskar_Imager* h)
+{
+    return h->num_read_buffers;
+}
+
+
 int oskar_imager_num_w_planes(const oskar_Imager* h)
 {
     return h->num_w_planes;
@@ -246,6 +264,18 @@ void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
 }
 
 
+void oskar_imager_set_cache_vis(oskar_Imager* h, int value)
+{
+    h->cache_vis = value;
+}
+
+
+void oskar_imager_set_cache_vis_max_mem(oskar_Imager* h, size_t bytes)
+{
+    h->cache_vis_max_mem = bytes;
+}
+
+
 void oskar_imager_set_cellsize(oskar_Imager* h, double cellsize_arcsec)
 {
     h->set_cellsize = 1;
@@ -520,6 +550,12 @@ void oskar_imager_set_num_devices(oskar_Imager* h, int value)
 }
 
 
+void oskar_imager_set_num_read_buffers(oskar_Imager* h, int value)
+{
+    h->num_read_buffers = value < 1 ? 1 : value;
+}
+
+
 void oskar_imager_set_output_root(oskar_Imager* h, const char* filename)
 {
     int len = 0;
@@ -644,6 +680,9 @@ void oskar_imager_set_vis_frequency(oskar_Imager* h,
 void oskar_imager_set_vis_phase_centre(oskar_Imager* h,
         double ra_deg, double dec_deg)
 {
+    h->vis_centre_deg[0] = ra_deg;
+    h->vis_centre_deg[1] = dec_deg;
+
     /* If imaging away from the beam direction, evaluate l0-l, m0-m, n0-n
      * for the new pointing centre, and a rotation matrix to generate the
      * rotated baseline coordinates. */
@@ -700,6 +739,20 @@ void oskar_imager_set_num_w_planes(oskar_Imager* h, int value)
 }
 
 
+void oskar_imager_set_w_kernel_cache_dir(oskar_Imager* h, const char* path)
+{
+    int len = 0;
+    free(h->w_kernel_cache_dir);
+    h->w_kernel_cache_dir = 0;
+    if (path) len = (int) strlen(path);
+    if (len > 0)
+    {
+        h->w_kernel_cache_dir = calloc(1 + len, 1);
+        strcpy(h->w_kernel_cache_dir, path);
+    }
+}
+
+
 void oskar_imager_set_weighting(oskar_Imager* h, const char* type, int* status)
 {
     if (!strncmp(type, "N", 1) || !strncmp(type, "n", 1))
@@ -744,6 +797,12 @@ double oskar_imager_uv_filter_min(const oskar_Imager* h)
 }
 
 
+const char* oskar_imager_w_kernel_cache_dir(const oskar_Imager* h)
+{
+    return h->w_kernel_cache_dir;
+}
+
+
 const char* oskar_imager_weighting(const oskar_Imager* h)
 {
     switch (h->weighting)
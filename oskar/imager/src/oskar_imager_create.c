@@ -65,6 +65,7 @@ oskar_Imager* oskar_imager_create(int imager_precision, int* status)
     h->weight_im   = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
     h->weight_tmp  = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
     h->time_im     = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->arena       = oskar_mem_arena_create(OSKAR_CPU, status);
 
     /* Check data type. */
     if (imager_precision != OSKAR_SINGLE && imager_precision != OSKAR_DOUBLE)
@@ -76,6 +77,7 @@ oskar_Imager* oskar_imager_create(int imager_precision, int* status)
     /* Set sensible defaults. */
     oskar_imager_set_gpus(h, -1, 0, status);
     oskar_imager_set_num_devices(h, -1);
+    oskar_imager_set_num_read_buffers(h, 2);
     oskar_imager_set_algorithm(h, "FFT", status);
     oskar_imager_set_image_type(h, "I", status);
     oskar_imager_set_weighting(h, "Natural", status);
@@ -26,18 +26,13 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifdef OSKAR_HAVE_CUDA
-#include <cufft.h>
-#endif
-
 #include "imager/private_imager.h"
 #include "imager/oskar_imager.h"
 
 #include "imager/oskar_grid_correction.h"
 #include "imager/oskar_grid_functions_pillbox.h"
 #include "imager/oskar_grid_functions_spheroidal.h"
-#include "math/oskar_fftpack_cfft.h"
-#include "math/oskar_fftpack_cfft_f.h"
+#include "math/oskar_fft.h"
 #include "math/oskar_fftphase.h"
 #include "mem/oskar_mem.h"
 #include "utility/oskar_device_utils.h"
@@ -177,7 +172,7 @@ void oskar_imager_finalise(oskar_Imager* h,
 void oskar_imager_finalise_plane(oskar_Imager* h,
         oskar_Mem* plane, double plane_norm, int* status)
 {
-    int size;
+    int size, location = OSKAR_CPU;
     size_t num_cells;
     if (*status) return;
 
@@ -218,61 +213,15 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
         oskar_fftphase_cf(size, size, oskar_mem_float(plane, status));
 
     /* Call FFT. */
-#ifdef OSKAR_HAVE_CUDA
     if (h->fft_on_gpu && h->num_gpus > 0)
     {
-        size_t work_size = 0;
-        oskar_Mem *plane_gpu = 0, *plane_ptr = 0;
+        location = OSKAR_GPU;
         oskar_device_set(h->gpu_ids[0], status);
-        if (cufftGetSize(h->cufft_plan, &work_size) != CUFFT_SUCCESS)
-            cufftPlan2d(&h->cufft_plan, size, size,
-                    (h->imager_prec == OSKAR_DOUBLE) ? CUFFT_Z2Z : CUFFT_C2C);
-        plane_ptr = plane;
-        if (oskar_mem_location(plane) != OSKAR_GPU)
-        {
-            plane_gpu = oskar_mem_create_copy(plane, OSKAR_GPU, status);
-            plane_ptr = plane_gpu;
-        }
-        if (h->imager_prec == OSKAR_DOUBLE)
-            cufftExecZ2Z(h->cufft_plan, oskar_mem_void(plane_ptr),
-                    oskar_mem_void(plane_ptr), CUFFT_FORWARD);
-        else
-            cufftExecC2C(h->cufft_plan, oskar_mem_void(plane_ptr),
-                    oskar_mem_void(plane_ptr), CUFFT_FORWARD);
-        if (oskar_mem_location(plane) != OSKAR_GPU)
-            oskar_mem_copy(plane, plane_ptr, status);
-        oskar_mem_free(plane_gpu, status);
-    }
-    else
-#endif
-    {
-        if (!h->fftpack_work)
-            h->fftpack_work = oskar_mem_create(h->imager_prec, OSKAR_CPU,
-                    2 * num_cells, status);
-        if (!h->fftpack_wsave)
-        {
-            int len = 4 * size + 2 * (int)(log((double)size) / log(2.0)) + 8;
-            h->fftpack_wsave = oskar_mem_create(h->imager_prec, OSKAR_CPU,
-                    len, status);
-            if (h->imager_prec == OSKAR_DOUBLE)
-                oskar_fftpack_cfft2i(size, size,
-                        oskar_mem_double(h->fftpack_wsave, status));
-            else
-                oskar_fftpack_cfft2i_f(size, size,
-                        oskar_mem_float(h->fftpack_wsave, status));
-        }
-        if (h->imager_prec == OSKAR_DOUBLE)
-            oskar_fftpack_cfft2f(size, size, size,
-                    oskar_mem_double(plane, status),
-                    oskar_mem_double(h->fftpack_wsave, status),
-                    oskar_mem_double(h->fftpack_work, status));
-        else
-            oskar_fftpack_cfft2f_f(size, size, size,
-                    oskar_mem_float(plane, status),
-                    oskar_mem_float(h->fftpack_wsave, status),
-                    oskar_mem_float(h->fftpack_work, status));
-        oskar_mem_scale_real(plane, (double)num_cells, status);
     }
+    if (!h->fft)
+        h->fft = oskar_fft_create(h->imager_prec, location, 2, size, 0,
+                status);
+    oskar_fft_exec(h->fft, plane, status);
 
     /* Generate grid correction function if required. */
     if (!h->corr_func)
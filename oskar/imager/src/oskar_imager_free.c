@@ -54,6 +54,7 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     oskar_mem_free(h->weight_im, status);
     oskar_mem_free(h->weight_tmp, status);
     oskar_mem_free(h->time_im, status);
+    oskar_mem_arena_free(h->arena, status);
     oskar_timer_free(h->tmr_grid_finalise);
     oskar_timer_free(h->tmr_grid_update);
     oskar_timer_free(h->tmr_init);
@@ -73,6 +74,7 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     free(h->input_root);
     free(h->output_root);
     free(h->ms_column);
+    free(h->w_kernel_cache_dir);
     free(h->gpu_ids);
     free(h->d);
     free(h);
@@ -26,12 +26,9 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifdef OSKAR_HAVE_CUDA
-#include <cufft.h>
-#endif
-
 #include "imager/private_imager.h"
 #include "imager/oskar_imager_reset_cache.h"
+#include "imager/private_imager_vis_cache.h"
 #include <fitsio.h>
 
 #include <stdlib.h>
@@ -54,15 +51,9 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
 
     /* Clear FFT caches. */
     oskar_mem_free(h->corr_func, status);
-    oskar_mem_free(h->fftpack_wsave, status);
-    oskar_mem_free(h->fftpack_work, status);
-#ifdef OSKAR_HAVE_CUDA
-    cufftDestroy(h->cufft_plan);
-    h->cufft_plan = 0;
-#endif
+    oskar_fft_free(h->fft);
     h->corr_func = 0;
-    h->fftpack_wsave = 0;
-    h->fftpack_work = 0;
+    h->fft = 0;
 
     /* Clear algorithm-specific caches. */
     oskar_mem_free(h->l, status); h->l = 0;
@@ -114,6 +105,10 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
         h->output_name[i] = 0;
     }
 
+    /* Free any cached visibility data. */
+    oskar_imager_vis_cache_free(h->vis_cache);
+    h->vis_cache = 0;
+
     /* Clear the number of image planes. */
     h->num_planes = 0;
 }
@@ -30,7 +30,9 @@
 #include "imager/private_imager_read_coords.h"
 #include "imager/private_imager_read_data.h"
 #include "imager/private_imager_read_dims.h"
+#include "imager/private_imager_vis_cache.h"
 #include "imager/oskar_imager.h"
+#include "utility/oskar_get_memory_usage.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -45,7 +47,7 @@ void oskar_imager_run(oskar_Imager* h,
         int num_output_images, oskar_Mem** output_images,
         int num_output_grids, oskar_Mem** output_grids, int* status)
 {
-    int i, num_files, percent_done = 0, percent_next = 10;
+    int i, num_files, first_pass = 0, percent_done = 0, percent_next = 10;
     const char* filename;
     if (*status) return;
 
@@ -100,13 +102,21 @@ void oskar_imager_run(oskar_Imager* h,
         return;
     }
 
-    /* Read baseline coordinates and weights if required. */
+    /* Read baseline coordinates and weights if required.
+     * If caching, read all the data now, so it need not be read again. */
     if (h->weighting == OSKAR_WEIGHTING_UNIFORM ||
             h->algorithm == OSKAR_ALGORITHM_WPROJ)
     {
+        first_pass = 1;
         oskar_imager_set_coords_only(h, 1);
+        if (h->cache_vis)
+            h->vis_cache = oskar_imager_vis_cache_create(
+                    h->cache_vis_max_mem > 0 ? h->cache_vis_max_mem :
+                    oskar_get_free_physical_memory() / 2);
         if (h->log)
-            oskar_log_section(h->log, 'M', "Reading coordinates...");
+            oskar_log_section(h->log, 'M', h->vis_cache ?
+                    "Reading and caching visibility data..." :
+                    "Reading coordinates...");
 
         /* Loop over input files. */
         for (i = 0; i < num_files; ++i)
@@ -117,11 +127,23 @@ void oskar_imager_run(oskar_Imager* h,
             if (h->log)
                 oskar_log_message(h->log, 'M', 0, "Opening '%s'", filename);
             if (oskar_imager_is_ms(filename))
-                oskar_imager_read_coords_ms(h, filename, i, num_files,
-                        &percent_done, &percent_next, status);
+            {
+                if (h->vis_cache)
+                    oskar_imager_read_data_ms(h, filename, i, num_files,
+                            &percent_done, &percent_next, status);
+                else
+                    oskar_imager_read_coords_ms(h, filename, i, num_files,
+                            &percent_done, &percent_next, status);
+            }
             else
-                oskar_imager_read_coords_vis(h, filename, i, num_files,
-                        &percent_done, &percent_next, status);
+            {
+                if (h->vis_cache)
+                    oskar_imager_read_data_vis(h, filename, i, num_files,
+                            &percent_done, &percent_next, status);
+                else
+                    oskar_imager_read_coords_vis(h, filename, i, num_files,
+                            &percent_done, &percent_next, status);
+            }
         }
         oskar_imager_set_coords_only(h, 0);
     }
@@ -151,24 +173,51 @@ void oskar_imager_run(oskar_Imager* h,
             oskar_log_message(h->log, 'M', 0, "Using %d W-planes.",
                     oskar_imager_num_w_planes(h));
         }
-        oskar_log_section(h->log, 'M', "Reading visibility data...");
+        oskar_log_section(h->log, 'M', h->vis_cache ?
+                "Gridding cached visibility data..." :
+                "Reading visibility data...");
     }
 
-    /* Loop over input files. */
+    /* Grid the cached data, or loop over input files. */
     percent_done = 0; percent_next = 10;
-    for (i = 0; i < num_files; ++i)
+    if (h->vis_cache)
     {
-        /* Read visibility data. */
-        if (*status) break;
-        filename = h->input_files[i];
-        if (h->log)
-            oskar_log_message(h->log, 'M', 0, "Opening '%s'", filename);
-        if (oskar_imager_is_ms(filename))
-            oskar_imager_read_data_ms(h, filename, i, num_files,
-                    &percent_done, &percent_next, status);
-        else
-            oskar_imager_read_data_vis(h, filename, i, num_files,
-                    &percent_done, &percent_next, status);
+        oskar_imager_vis_cache_replay(h->vis_cache, h,
+                &percent_done, &percent_next, status);
+        if (h->log && !*status)
+        {
+            const double mb = 1.0 / (1024.0 * 1024.0);
+            oskar_log_message(h->log, 'M', 0, "Served %.1f MB from cache "
+                    "(%.1f MB in memory, %.1f MB on disk); re-read 0 MB.",
+                    (oskar_imager_vis_cache_bytes_in_memory(h->vis_cache) +
+                    oskar_imager_vis_cache_bytes_on_disk(h->vis_cache)) * mb,
+                    oskar_imager_vis_cache_bytes_in_memory(h->vis_cache) * mb,
+                    oskar_imager_vis_cache_bytes_on_disk(h->vis_cache) * mb);
+        }
+        oskar_imager_vis_cache_free(h->vis_cache);
+        h->vis_cache = 0;
+    }
+    else
+    {
+        h->vis_bytes_read = 0;
+        for (i = 0; i < num_files; ++i)
+        {
+            /* Read visibility data. */
+            if (*status) break;
+            filename = h->input_files[i];
+            if (h->log)
+                oskar_log_message(h->log, 'M', 0, "Opening '%s'", filename);
+            if (oskar_imager_is_ms(filename))
+                oskar_imager_read_data_ms(h, filename, i, num_files,
+                        &percent_done, &percent_next, status);
+            else
+                oskar_imager_read_data_vis(h, filename, i, num_files,
+                        &percent_done, &percent_next, status);
+        }
+        if (h->log && first_pass && !*status)
+            oskar_log_message(h->log, 'M', 0, "Re-read %.1f MB of "
+                    "visibility data; served 0 MB from cache.",
+                    h->vis_bytes_read / (1024.0 * 1024.0));
     }
 
     /* Check for errors. */
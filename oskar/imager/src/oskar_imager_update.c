@@ -60,7 +60,7 @@ void oskar_imager_update_from_block(oskar_Imager* h,
         const oskar_VisHeader* header, const oskar_VisBlock* block,
         int* status)
 {
-    int t, start_time, start_chan, end_chan;
+    int t, start_time, start_chan, end_chan, mark;
     int num_baselines, num_channels, num_pols, num_times;
     size_t num_rows;
     double time_start_mjd, time_inc_sec;
@@ -95,24 +95,31 @@ void oskar_imager_update_from_block(oskar_Imager* h,
             oskar_vis_header_phase_centre_dec_deg(header));
 
     /* Create scratch arrays. Weights are all 1. */
+    mark = oskar_mem_arena_mark(h->arena);
     if (num_channels > 1)
-        scratch = oskar_mem_create(oskar_mem_type(
+        scratch = oskar_mem_arena_array(h->arena, oskar_mem_type(
                 oskar_vis_block_cross_correlations_const(block)),
-                OSKAR_CPU, num_rows * num_channels, status);
+                num_rows * num_channels, status);
     if (!weight)
     {
         size_t weight_len = num_rows * num_pols;
-        weight = oskar_mem_create(oskar_mem_precision(
+        weight = oskar_mem_arena_array(h->arena, oskar_mem_precision(
                 oskar_vis_block_cross_correlations_const(block)),
-                OSKAR_CPU, weight_len, status);
-        oskar_mem_set_value_real(weight, 1.0, 0, weight_len, status);
+                weight_len, status);
+        if (!*status)
+            oskar_mem_set_value_real(weight, 1.0, 0, weight_len, status);
         weight_ptr = weight;
     }
 
     /* Fill in the time centroid values. */
-    time_centroid = oskar_mem_create(OSKAR_DOUBLE,
-            OSKAR_CPU, num_rows, status);
-    time_slice = oskar_mem_create_alias(0, 0, 0, status);
+    time_centroid = oskar_mem_arena_array(h->arena, OSKAR_DOUBLE,
+            num_rows, status);
+    time_slice = oskar_mem_arena_alias(h->arena, 0, 0, 0, status);
+    if (*status)
+    {
+        oskar_mem_arena_release(h->arena, mark);
+        return;
+    }
     for (t = 0; t < num_times; ++t)
     {
         oskar_mem_set_alias(time_slice, time_centroid,
@@ -167,10 +174,7 @@ void oskar_imager_update_from_block(oskar_Imager* h,
             oskar_vis_block_baseline_vv_metres_const(block),
             oskar_vis_block_baseline_ww_metres_const(block),
             ptr, weight_ptr, time_centroid, status);
-    oskar_mem_free(weight, status);
-    oskar_mem_free(scratch, status);
-    oskar_mem_free(time_centroid, status);
-    oskar_mem_free(time_slice, status);
+    oskar_mem_arena_release(h->arena, mark);
 }
 
 
@@ -179,9 +183,8 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
         const oskar_Mem* ww, const oskar_Mem* amps, const oskar_Mem* weight,
         const oskar_Mem* time_centroid, int* status)
 {
-    int c, p, plane;
+    int c, p, plane, mark;
     size_t max_num_vis;
-    oskar_Mem *tu = 0, *tv = 0, *tw = 0, *ta = 0, *th = 0;
     const oskar_Mem *u_in, *v_in, *w_in, *amp_in = 0, *weight_in;
     if (*status) return;
 
@@ -204,6 +207,7 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
     if (*status) return;
 
     /* Convert precision of input data if required. */
+    mark = oskar_mem_arena_mark(h->arena);
     u_in = uu; v_in = vv; w_in = ww; weight_in = weight;
     if (!h->coords_only)
     {
@@ -214,10 +218,8 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
         }
         amp_in = amps;
         if (oskar_mem_precision(amps) != h->imager_prec)
-        {
-            ta = oskar_mem_convert_precision(amps, h->imager_prec, status);
-            amp_in = ta;
-        }
+            amp_in = oskar_mem_arena_convert_precision(h->arena, amps,
+                    h->imager_prec, status);
 
         /* Convert linear polarisations to Stokes parameters if required. */
         if (h->use_stokes)
@@ -227,25 +229,17 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
         }
     }
     if (oskar_mem_precision(uu) != h->imager_prec)
-    {
-        tu = oskar_mem_convert_precision(uu, h->imager_prec, status);
-        u_in = tu;
-    }
+        u_in = oskar_mem_arena_convert_precision(h->arena, uu,
+                h->imager_prec, status);
     if (oskar_mem_precision(vv) != h->imager_prec)
-    {
-        tv = oskar_mem_convert_precision(vv, h->imager_prec, status);
-        v_in = tv;
-    }
+        v_in = oskar_mem_arena_convert_precision(h->arena, vv,
+                h->imager_prec, status);
     if (oskar_mem_precision(ww) != h->imager_prec)
-    {
-        tw = oskar_mem_convert_precision(ww, h->imager_prec, status);
-        w_in = tw;
-    }
+        w_in = oskar_mem_arena_convert_precision(h->arena, ww,
+                h->imager_prec, status);
     if (oskar_mem_precision(weight) != h->imager_prec)
-    {
-        th = oskar_mem_convert_precision(weight, h->imager_prec, status);
-        weight_in = th;
-    }
+        weight_in = oskar_mem_arena_convert_precision(h->arena, weight,
+                h->imager_prec, status);
 
     /* Ensure work arrays are large enough. */
     max_num_vis = num_rows;
@@ -319,11 +313,7 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
         }
     }
 
-    oskar_mem_free(tu, status);
-    oskar_mem_free(tv, status);
-    oskar_mem_free(tw, status);
-    oskar_mem_free(ta, status);
-    oskar_mem_free(th, status);
+    oskar_mem_arena_release(h->arena, mark);
 }
 
 
@@ -332,33 +322,26 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
         const oskar_Mem* amps, const oskar_Mem* weight, oskar_Mem* plane,
         double* plane_norm, oskar_Mem* weights_grid, int* status)
 {
-    oskar_Mem *tu = 0, *tv = 0, *tw = 0, *ta = 0, *th = 0;
+    int mark;
     const oskar_Mem *pu, *pv, *pw, *pa, *ph;
     if (*status || num_vis == 0) return;
     oskar_timer_resume(h->tmr_grid_update);
 
     /* Convert precision of input data if required. */
+    mark = oskar_mem_arena_mark(h->arena);
     pu = uu; pv = vv; pw = ww; ph = weight;
     if (oskar_mem_precision(uu) != h->imager_prec)
-    {
-        tu = oskar_mem_convert_precision(uu, h->imager_prec, status);
-        pu = tu;
-    }
+        pu = oskar_mem_arena_convert_precision(h->arena, uu,
+                h->imager_prec, status);
     if (oskar_mem_precision(vv) != h->imager_prec)
-    {
-        tv = oskar_mem_convert_precision(vv, h->imager_prec, status);
-        pv = tv;
-    }
+        pv = oskar_mem_arena_convert_precision(h->arena, vv,
+                h->imager_prec, status);
     if (oskar_mem_precision(ww) != h->imager_prec)
-    {
-        tw = oskar_mem_convert_precision(ww, h->imager_prec, status);
-        pw = tw;
-    }
+        pw = oskar_mem_arena_convert_precision(h->arena, ww,
+                h->imager_prec, status);
     if (oskar_mem_precision(weight) != h->imager_prec)
-    {
-        th = oskar_mem_convert_precision(weight, h->imager_prec, status);
-        ph = th;
-    }
+        ph = oskar_mem_arena_convert_precision(h->arena, weight,
+                h->imager_prec, status);
 
     /* Just update the grid of weights if we're in coordinate-only mode. */
     if (h->coords_only)
@@ -373,10 +356,8 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
         /* Convert precision of visibility amplitudes if required. */
         pa = amps;
         if (oskar_mem_precision(amps) != h->imager_prec)
-        {
-            ta = oskar_mem_convert_precision(amps, h->imager_prec, status);
-            pa = ta;
-        }
+            pa = oskar_mem_arena_convert_precision(h->arena, amps,
+                    h->imager_prec, status);
 
         /* Check imager is ready. */
         oskar_imager_check_init(h, status);
@@ -430,11 +411,7 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
     }
 
     /* Clean up. */
-    oskar_mem_free(tu, status);
-    oskar_mem_free(tv, status);
-    oskar_mem_free(tw, status);
-    oskar_mem_free(ta, status);
-    oskar_mem_free(th, status);
+    oskar_mem_arena_release(h->arena, mark);
     oskar_timer_pause(h->tmr_grid_update);
 }
 
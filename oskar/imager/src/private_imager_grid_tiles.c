@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager_grid_tiles.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int oskar_imager_grid_tile_size(int max_support)
+{
+    return (2 * max_support > 64) ? 2 * max_support : 64;
+}
+
+
+int oskar_imager_grid_tiles_sort(size_t num_points, const int* tile_id,
+        int num_tiles, size_t** tile_start, size_t** sorted)
+{
+    int t;
+    size_t i, *start, *fill, *idx;
+    start = (size_t*) calloc(num_tiles + 1, sizeof(size_t));
+    fill = (size_t*) malloc(num_tiles * sizeof(size_t));
+    idx = (size_t*) malloc((num_points > 0 ? num_points : 1) *
+            sizeof(size_t));
+    if (!start || !fill || !idx)
+    {
+        free(start);
+        free(fill);
+        free(idx);
+        return 1;
+    }
+
+    /* Count visibilities in each tile and find where each tile starts. */
+    for (i = 0; i < num_points; ++i)
+        if (tile_id[i] >= 0) start[tile_id[i] + 1]++;
+    for (t = 0; t < num_tiles; ++t)
+        start[t + 1] += start[t];
+
+    /* Fill the index array, keeping the original order within each tile. */
+    memcpy(fill, start, num_tiles * sizeof(size_t));
+    for (i = 0; i < num_points; ++i)
+        if (tile_id[i] >= 0) idx[fill[tile_id[i]]++] = i;
+    free(fill);
+    *tile_start = start;
+    *sorted = idx;
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
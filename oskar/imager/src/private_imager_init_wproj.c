@@ -26,10 +26,6 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifdef OSKAR_HAVE_CUDA
-#include <cufft.h>
-#endif
-
 #include "imager/private_imager.h"
 #include "imager/oskar_imager.h"
 
@@ -38,15 +34,30 @@
 #include "imager/private_imager_init_wproj.h"
 #include "imager/oskar_grid_functions_spheroidal.h"
 #include "math/oskar_cmath.h"
-#include "math/oskar_fftpack_cfft.h"
-#include "math/oskar_fftpack_cfft_f.h"
+#include "math/oskar_fft.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "binary/oskar_binary.h"
+#include "binary/oskar_crc.h"
 #include "utility/oskar_get_memory_usage.h"
 #include "utility/oskar_device_utils.h"
+#include "utility/oskar_file_exists.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+#ifdef OSKAR_OS_WIN
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -56,6 +67,16 @@ extern "C" {
 
 #define SAVE_KERNELS 0
 
+/*
+ * Kernels are cached in an OSKAR binary file, named using the CRC-32C of
+ * the parameters that define them. The parameters are also stored in the
+ * file, and checked when it is loaded.
+ * Increment the version number if the kernel generation method changes.
+ */
+#define KERNEL_CACHE_VERSION 1
+#define KERNEL_CACHE_GROUP "W_KERNELS"
+#define NUM_KEYS 9
+
 #if SAVE_KERNELS
 #include <fitsio.h>
 
@@ -100,6 +121,17 @@ static void compact_kernels(const int num_w_planes, const int* support,
         const int oversample, const int conv_size_half,
         const oskar_Mem* kernels_in, oskar_Mem* kernels_out,
         int* compacted_kernel_start, int* status);
+static void store_kernel(int iw, int conv_size, int conv_size_half,
+        const oskar_Mem* screen, oskar_Mem* kernels, double* maxes);
+static void generate_kernels_cpu(int num_w_planes, int conv_size,
+        int conv_size_half, int inner, double sampling, double w_scale,
+        const oskar_Mem* taper, oskar_Mem* kernels, double* maxes,
+        int num_threads, int* status);
+static char* kernel_cache_filename(const char* dir, const double* key);
+static int kernel_cache_read(oskar_Imager* h, const char* filename,
+        const double* key);
+static int kernel_cache_write(const oskar_Imager* h, const char* filename,
+        const double* key);
 
 /*
  * W-kernel generation is based on CASA implementation
@@ -112,18 +144,18 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
     int conv_size, conv_size_half, inner, nearest;
     double l_max, max_conv_size, max_uvw, max_val, sampling, sum;
     double *maxes;
-#ifdef OSKAR_HAVE_CUDA
-    cufftHandle cufft_plan = 0;
-#endif
-    oskar_Mem *screen = 0, *screen_gpu = 0, *screen_ptr = 0;
-    oskar_Mem *taper = 0, *taper_gpu = 0, *taper_ptr = 0;
-    oskar_Mem *wsave = 0, *work = 0;
-    char *ptr_out, *ptr_in, *fname = 0;
+    oskar_Mem *screen = 0, *screen_gpu = 0, *taper = 0, *taper_gpu = 0;
+    char *fname = 0, *cache_name = 0;
+    double key[NUM_KEYS];
+    int on_gpu = 0;
     if (*status) return;
 
     /* Get GCF padding oversample factor and imager precision. */
     oversample = h->oversample;
     prec = h->imager_prec;
+#ifdef OSKAR_HAVE_CUDA
+    on_gpu = h->generate_w_kernels_on_gpu && h->num_gpus > 0;
+#endif
 
     /* Calculate required number of w-planes if not set. */
     if (h->ww_max > 0.0)
@@ -180,41 +212,32 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
     sampling = (2.0 * l_max * oversample) / h->image_size;
     sampling *= ((double) oskar_imager_plane_size(h)) / ((double) conv_size);
 
-    /* Create scratch arrays and FFT plan for the phase screens. */
-    screen = oskar_mem_create(prec | OSKAR_COMPLEX,
-            OSKAR_CPU, conv_size * conv_size, status);
-    screen_ptr = screen;
-#ifdef OSKAR_HAVE_CUDA
-    if (h->generate_w_kernels_on_gpu && h->num_gpus > 0)
+    /* Load the kernels from the cache, if they were made with the same
+     * parameters. */
+    key[0] = KERNEL_CACHE_VERSION;
+    key[1] = prec;
+    key[2] = oversample;
+    key[3] = conv_size;
+    key[4] = inner;
+    key[5] = h->num_w_planes;
+    key[6] = sampling;
+    key[7] = h->w_scale;
+    key[8] = on_gpu;
+    if (h->w_kernel_cache_dir)
     {
-        oskar_device_set(h->gpu_ids[0], status);
-        screen_gpu = oskar_mem_create(prec | OSKAR_COMPLEX,
-                OSKAR_GPU, conv_size * conv_size, status);
-        screen_ptr = screen_gpu;
-        if (prec == OSKAR_DOUBLE)
-            cufftPlan2d(&cufft_plan, conv_size, conv_size, CUFFT_Z2Z);
-        else
-            cufftPlan2d(&cufft_plan, conv_size, conv_size, CUFFT_C2C);
-    }
-    else
-#endif
-    {
-        int len_save = 4 * conv_size +
-                2 * (int)(log((double)conv_size) / log(2.0)) + 8;
-        wsave = oskar_mem_create(prec, OSKAR_CPU, len_save, status);
-        work = oskar_mem_create(prec, OSKAR_CPU,
-                2 * conv_size * conv_size, status);
-        if (prec == OSKAR_DOUBLE)
-            oskar_fftpack_cfft2i(conv_size, conv_size,
-                    oskar_mem_double(wsave, status));
-        else
-            oskar_fftpack_cfft2i_f(conv_size, conv_size,
-                    oskar_mem_float(wsave, status));
+        cache_name = kernel_cache_filename(h->w_kernel_cache_dir, key);
+        if (kernel_cache_read(h, cache_name, key))
+        {
+            if (h->log)
+                oskar_log_message(h->log, 'M', 0,
+                        "Loaded W-kernels from '%s'", cache_name);
+            free(cache_name);
+            return;
+        }
     }
 
     /* Generate 1D spheroidal tapering function to cover the inner region. */
     taper = oskar_mem_create(prec, OSKAR_CPU, inner, status);
-    taper_ptr = taper;
     if (prec == OSKAR_DOUBLE)
     {
         double* t = oskar_mem_double(taper, status);
@@ -235,91 +258,75 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
             t[i] = oskar_grid_function_spheroidal(fabs(nu));
         }
     }
-#ifdef OSKAR_HAVE_CUDA
-    if (h->generate_w_kernels_on_gpu && h->num_gpus > 0)
-    {
-        taper_gpu = oskar_mem_create_copy(taper, OSKAR_GPU, status);
-        taper_ptr = taper_gpu;
-    }
-#endif
 
     /* Evaluate kernels. */
-    ptr_in   = oskar_mem_char(screen);
-    copy_len = element_size * conv_size_half;
     maxes = (double*) calloc(h->num_w_planes, sizeof(double));
-    for (iw = 0; iw < h->num_w_planes; ++iw)
+    if (!maxes)
     {
-        size_t in = 0, out = 0, offset;
-
-        /* Generate the tapered phase screen. */
-        oskar_imager_generate_w_phase_screen(iw, conv_size, inner, sampling,
-                h->w_scale, taper_ptr, screen_ptr, status);
-        if (*status) break;
-
-        /* Perform the FFT to get the kernel. No shifts are required. */
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        oskar_mem_free(taper, status);
+        free(cache_name);
+        return;
+    }
 #ifdef OSKAR_HAVE_CUDA
-        if (h->generate_w_kernels_on_gpu && h->num_gpus > 0)
+    if (on_gpu)
+    {
+        oskar_FFT* fft;
+        oskar_device_set(h->gpu_ids[0], status);
+        screen = oskar_mem_create(prec | OSKAR_COMPLEX,
+                OSKAR_CPU, conv_size * conv_size, status);
+        screen_gpu = oskar_mem_create(prec | OSKAR_COMPLEX,
+                OSKAR_GPU, conv_size * conv_size, status);
+        taper_gpu = oskar_mem_create_copy(taper, OSKAR_GPU, status);
+        fft = oskar_fft_create(prec, OSKAR_GPU, 2, conv_size, 0, status);
+        for (iw = 0; iw < h->num_w_planes; ++iw)
         {
-            if (oskar_mem_precision(screen) == OSKAR_DOUBLE)
-                cufftExecZ2Z(cufft_plan, oskar_mem_void(screen_ptr),
-                        oskar_mem_void(screen_ptr), CUFFT_FORWARD);
-            else
-                cufftExecC2C(cufft_plan, oskar_mem_void(screen_ptr),
-                        oskar_mem_void(screen_ptr), CUFFT_FORWARD);
-            oskar_mem_copy(screen, screen_ptr, status);
+            /* Generate the tapered phase screen. */
+            oskar_imager_generate_w_phase_screen(iw, conv_size, inner,
+                    sampling, h->w_scale, taper_gpu, screen_gpu, status);
+
+            /* Perform the FFT to get the kernel. No shifts are required. */
+            oskar_fft_exec(fft, screen_gpu, status);
+            oskar_mem_copy(screen, screen_gpu, status);
+            if (*status) break;
+            store_kernel(iw, conv_size, conv_size_half, screen,
+                    h->w_kernels, maxes);
         }
-        else
+        oskar_fft_free(fft);
+    }
+    else
 #endif
-        {
-            if (oskar_mem_precision(screen_ptr) == OSKAR_DOUBLE)
-                oskar_fftpack_cfft2f(conv_size, conv_size, conv_size,
-                        oskar_mem_double(screen_ptr, status),
-                        oskar_mem_double(wsave, status),
-                        oskar_mem_double(work, status));
-            else
-                oskar_fftpack_cfft2f_f(conv_size, conv_size, conv_size,
-                        oskar_mem_float(screen_ptr, status),
-                        oskar_mem_float(wsave, status),
-                        oskar_mem_float(work, status));
-        }
-        if (*status) break;
-
-        /* Get the maximum (from the first element). */
-        if (oskar_mem_precision(screen) == OSKAR_DOUBLE)
-        {
-            const double* t = (const double*) oskar_mem_void_const(screen);
-            maxes[iw] = sqrt(t[0]*t[0] + t[1]*t[1]);
-        }
-        else
-        {
-            const float* t = (const float*) oskar_mem_void_const(screen);
-            maxes[iw] = sqrt(t[0]*t[0] + t[1]*t[1]);
-        }
-
-        /* Save only the first quarter of the kernel; the rest is redundant. */
-        offset = iw * conv_size_half * conv_size_half * element_size;
-        ptr_out = oskar_mem_char(h->w_kernels) + offset;
-        for (iy = 0; iy < conv_size_half; ++iy)
-        {
-            memcpy(ptr_out + out, ptr_in + in, copy_len);
-            in += conv_size * element_size;
-            out += copy_len;
-        }
+    {
+        /* Limit the number of threads to use at most half the free memory
+         * for the phase screens and FFT workspaces. */
+        int num_threads = 1;
+#ifdef _OPENMP
+        size_t max_threads, thread_bytes;
+        num_threads = MIN(omp_get_max_threads(), h->num_w_planes);
+        thread_bytes = 4 * oskar_mem_element_size(prec) *
+                ((size_t) conv_size) * ((size_t) conv_size);
+        max_threads = (oskar_get_free_physical_memory() / 2) / thread_bytes;
+        if ((size_t) num_threads > max_threads)
+            num_threads = max_threads > 0 ? (int) max_threads : 1;
+#endif
+        generate_kernels_cpu(h->num_w_planes, conv_size, conv_size_half,
+                inner, sampling, h->w_scale, taper, h->w_kernels,
+                maxes, num_threads, status);
     }
 
     /* Clean up. */
-#ifdef OSKAR_HAVE_CUDA
-    cufftDestroy(cufft_plan);
-#endif
     oskar_mem_free(screen, status);
     oskar_mem_free(screen_gpu, status);
     oskar_mem_free(taper, status);
     oskar_mem_free(taper_gpu, status);
-    oskar_mem_free(wsave, status);
-    oskar_mem_free(work, status);
 
     /* Normalise each plane by the maximum. */
-    if (*status) return;
+    if (*status)
+    {
+        free(maxes);
+        free(cache_name);
+        return;
+    }
     max_val = -INT_MAX;
     for (iw = 0; iw < h->num_w_planes; ++iw) max_val = MAX(max_val, maxes[iw]);
     oskar_mem_scale_real(h->w_kernels, 1.0 / max_val, status);
@@ -373,7 +380,11 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
                 supp[iw] = conv_size / 2 / oversample - 1;
         }
     }
-    if (*status) return;
+    if (*status)
+    {
+        free(cache_name);
+        return;
+    }
 
     /* Compact the kernels if we can. */
     max_val = -INT_MAX;
@@ -405,7 +416,11 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
                 ((size_t) h->num_w_planes) * ((size_t) new_conv_size_half) *
                 ((size_t) new_conv_size_half), status);
     }
-    if (*status) return;
+    if (*status)
+    {
+        free(cache_name);
+        return;
+    }
 
 #if 0
     /* Print kernel support sizes. */
@@ -456,6 +471,21 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
     compact_kernels(h->num_w_planes, supp, oversample, conv_size_half,
             h->w_kernels, h->w_kernels_compact,
             oskar_mem_int(h->w_kernel_start, status), status);
+
+    /* Save the kernels to the cache. */
+    if (cache_name && !*status)
+    {
+        if (kernel_cache_write(h, cache_name, key))
+        {
+            if (h->log)
+                oskar_log_message(h->log, 'M', 0,
+                        "Saved W-kernels to '%s'", cache_name);
+        }
+        else if (h->log)
+            oskar_log_warning(h->log,
+                    "Unable to save W-kernels to '%s'", cache_name);
+    }
+    free(cache_name);
 }
 
 static void compact_kernels(const int num_w_planes, const int* support,
@@ -576,7 +606,210 @@ static void compact_kernels(const int num_w_planes, const int* support,
     fclose(fhan);
 #endif
 }
-    
+
+static void store_kernel(int iw, int conv_size, int conv_size_half,
+        const oskar_Mem* screen, oskar_Mem* kernels, double* maxes)
+{
+    int iy;
+    size_t element_size, copy_len, in = 0, out = 0, offset;
+    const char* ptr_in;
+    char* ptr_out;
+    element_size = oskar_mem_element_size(oskar_mem_type(kernels));
+    copy_len = element_size * conv_size_half;
+
+    /* Get the maximum (from the first element). */
+    if (oskar_mem_precision(screen) == OSKAR_DOUBLE)
+    {
+        const double* t = (const double*) oskar_mem_void_const(screen);
+        maxes[iw] = sqrt(t[0]*t[0] + t[1]*t[1]);
+    }
+    else
+    {
+        const float* t = (const float*) oskar_mem_void_const(screen);
+        maxes[iw] = sqrt(t[0]*t[0] + t[1]*t[1]);
+    }
+
+    /* Save only the first quarter of the kernel; the rest is redundant. */
+    offset = ((size_t) iw) * conv_size_half * conv_size_half * element_size;
+    ptr_in = (const char*) oskar_mem_void_const(screen);
+    ptr_out = oskar_mem_char(kernels) + offset;
+    for (iy = 0; iy < conv_size_half; ++iy)
+    {
+        memcpy(ptr_out + out, ptr_in + in, copy_len);
+        in += conv_size * element_size;
+        out += copy_len;
+    }
+}
+
+static void generate_kernels_cpu(int num_w_planes, int conv_size,
+        int conv_size_half, int inner, double sampling, double w_scale,
+        const oskar_Mem* taper, oskar_Mem* kernels, double* maxes,
+        int num_threads, int* status)
+{
+    int iw;
+    const int prec = oskar_mem_precision(kernels);
+    if (*status) return;
+
+    /* Each thread uses its own phase screen and single-threaded FFT. */
+#ifdef _OPENMP
+#pragma omp parallel num_threads(num_threads)
+#else
+    (void) num_threads;
+#endif
+    {
+        int thread_status = 0;
+        oskar_Mem* screen;
+        oskar_FFT* fft;
+        screen = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+                conv_size * conv_size, &thread_status);
+        fft = oskar_fft_create(prec, OSKAR_CPU, 2, conv_size, 0,
+                &thread_status);
+        if (fft) oskar_fft_set_num_threads(fft, 1);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+        for (iw = 0; iw < num_w_planes; ++iw)
+        {
+            if (thread_status) continue;
+
+            /* Generate the tapered phase screen. */
+            oskar_imager_generate_w_phase_screen(iw, conv_size, inner,
+                    sampling, w_scale, taper, screen, &thread_status);
+
+            /* Perform the FFT to get the kernel. No shifts are required. */
+            oskar_fft_exec(fft, screen, &thread_status);
+            if (thread_status) continue;
+            store_kernel(iw, conv_size, conv_size_half, screen,
+                    kernels, maxes);
+        }
+        oskar_mem_free(screen, &thread_status);
+        oskar_fft_free(fft);
+#ifdef _OPENMP
+#pragma omp critical (w_kernel_status)
+#endif
+        if (thread_status && !*status) *status = thread_status;
+    }
+}
+
+static char* kernel_cache_filename(const char* dir, const double* key)
+{
+    char* filename;
+    unsigned long crc;
+    oskar_CRC* crc_data;
+    crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    crc = oskar_crc_compute(crc_data, key, NUM_KEYS * sizeof(double));
+    oskar_crc_free(crc_data);
+    filename = (char*) calloc(strlen(dir) + 40, 1);
+    sprintf(filename, "%s/oskar_w_kernels_%08lx.bin", dir, crc);
+    return filename;
+}
+
+static int kernel_cache_read(oskar_Imager* h, const char* filename,
+        const double* key)
+{
+    int i, prec, conv_size_half = 0, status = 0;
+    double stored_key[NUM_KEYS];
+    oskar_Mem *support, *kernel_start, *kernels, *kernels_compact;
+    oskar_Binary* file;
+    FILE* f;
+
+    /* Check the file exists before trying to open it. */
+    f = fopen(filename, "rb");
+    if (!f) return 0;
+    fclose(f);
+
+    /* Check the kernels were made using the same parameters. */
+    file = oskar_binary_create(filename, 'r', &status);
+    oskar_binary_read_ext(file, OSKAR_DOUBLE, KERNEL_CACHE_GROUP, "KEY", 0,
+            sizeof(stored_key), stored_key, &status);
+    for (i = 0; i < NUM_KEYS && !status; ++i)
+        if (stored_key[i] != key[i]) status = OSKAR_ERR_FILE_IO;
+
+    /* Load the kernels into new arrays, so that the existing ones are
+     * left untouched if anything goes wrong. */
+    prec = oskar_mem_precision(h->w_kernels);
+    support = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    kernels = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU, 0, &status);
+    kernels_compact = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU, 0,
+            &status);
+    oskar_binary_read_ext_int(file, KERNEL_CACHE_GROUP, "CONV_SIZE_HALF", 0,
+            &conv_size_half, &status);
+    oskar_binary_read_mem_ext(file, support, KERNEL_CACHE_GROUP,
+            "SUPPORT", 0, &status);
+    oskar_binary_read_mem_ext(file, kernel_start, KERNEL_CACHE_GROUP,
+            "KERNEL_START", 0, &status);
+    oskar_binary_read_mem_ext(file, kernels, KERNEL_CACHE_GROUP,
+            "KERNELS", 0, &status);
+    oskar_binary_read_mem_ext(file, kernels_compact, KERNEL_CACHE_GROUP,
+            "KERNELS_COMPACT", 0, &status);
+    oskar_binary_free(file);
+    if (!status &&
+            (int) oskar_mem_length(support) == h->num_w_planes &&
+            (int) oskar_mem_length(kernel_start) == h->num_w_planes)
+    {
+        /* Replace the existing arrays only once everything has loaded. */
+        oskar_mem_free(h->w_support, &status);
+        oskar_mem_free(h->w_kernel_start, &status);
+        oskar_mem_free(h->w_kernels, &status);
+        oskar_mem_free(h->w_kernels_compact, &status);
+        h->w_support = support;
+        h->w_kernel_start = kernel_start;
+        h->w_kernels = kernels;
+        h->w_kernels_compact = kernels_compact;
+        h->conv_size_half = conv_size_half;
+        return 1;
+    }
+    oskar_mem_free(support, &status);
+    oskar_mem_free(kernel_start, &status);
+    oskar_mem_free(kernels, &status);
+    oskar_mem_free(kernels_compact, &status);
+    return 0;
+}
+
+static int kernel_cache_write(const oskar_Imager* h, const char* filename,
+        const double* key)
+{
+    int status = 0;
+    char* temp_name;
+    oskar_Binary* file;
+
+    /* Write to a temporary file first, so that other processes never see
+     * a partly-written cache file. The temporary name includes the process
+     * ID and the imager address, so it is unique to this imager. */
+    temp_name = (char*) calloc(strlen(filename) + 64, 1);
+#ifdef OSKAR_OS_WIN
+    sprintf(temp_name, "%s.%lu.%p.part", filename,
+            (unsigned long) GetCurrentProcessId(), (const void*) h);
+#else
+    sprintf(temp_name, "%s.%lu.%p.part", filename,
+            (unsigned long) getpid(), (const void*) h);
+#endif
+    file = oskar_binary_create(temp_name, 'w', &status);
+    oskar_binary_write_ext(file, OSKAR_DOUBLE, KERNEL_CACHE_GROUP, "KEY", 0,
+            NUM_KEYS * sizeof(double), key, &status);
+    oskar_binary_write_ext_int(file, KERNEL_CACHE_GROUP, "CONV_SIZE_HALF", 0,
+            h->conv_size_half, &status);
+    oskar_binary_write_mem_ext(file, h->w_support, KERNEL_CACHE_GROUP,
+            "SUPPORT", 0, 0, &status);
+    oskar_binary_write_mem_ext(file, h->w_kernel_start, KERNEL_CACHE_GROUP,
+            "KERNEL_START", 0, 0, &status);
+    oskar_binary_write_mem_ext(file, h->w_kernels, KERNEL_CACHE_GROUP,
+            "KERNELS", 0, 0, &status);
+    oskar_binary_write_mem_ext(file, h->w_kernels_compact, KERNEL_CACHE_GROUP,
+            "KERNELS_COMPACT", 0, 0, &status);
+    oskar_binary_free(file);
+    if (!status && rename(temp_name, filename))
+    {
+        /* Another imager may have written the same kernels already. */
+        if (!oskar_file_exists(filename)) status = OSKAR_ERR_FILE_IO;
+        remove(temp_name);
+    }
+    else if (status) remove(temp_name);
+    free(temp_name);
+    return status ? 0 : 1;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -28,6 +28,7 @@
 
 #include "imager/private_imager.h"
 #include "imager/private_imager_read_data.h"
+#include "imager/private_imager_vis_cache.h"
 #include "imager/oskar_imager.h"
 #include "binary/oskar_binary.h"
 #include "math/oskar_cmath.h"
@@ -35,6 +36,8 @@
 #include "ms/oskar_measurement_set.h"
 #include "vis/oskar_vis_block.h"
 #include "vis/oskar_vis_header.h"
+#include "utility/oskar_get_memory_usage.h"
+#include "utility/oskar_thread.h"
 #include "utility/oskar_timer.h"
 
 #include <float.h>
@@ -46,114 +49,307 @@
 extern "C" {
 #endif
 
+/*
+ * Visibility data are read into a ring of buffers by a separate thread,
+ * while the calling thread grids the buffers already filled.
+ * Empty and full buffers are passed between the threads using two queues,
+ * so the reader can never be more than the number of buffers ahead.
+ */
+typedef struct ReadBuffer
+{
+    int status, start_chan, end_chan;
+    size_t num_rows;
+    double fraction_done; /* Fraction of the file read after this block. */
+
+    /* Data passed to the imager. */
+    const oskar_Mem *uu, *vv, *ww, *amps, *weight, *time_centroid;
+
+    /* Storage used by the readers. */
+    oskar_Mem *uvw, *u, *v, *w, *data, *weights, *times, *scratch;
+    oskar_VisBlock* block;
+} ReadBuffer;
+
+typedef void (*ReadBlockFunc)(void* reader, ReadBuffer* buf, int i_block);
+
+typedef struct ReadAhead
+{
+    ReadBlockFunc read_block;
+    void* reader;
+    int num_blocks;
+    oskar_Queue *empty, *full;
+    oskar_Timer* tmr_read;
+} ReadAhead;
+
+static void* read_ahead_thread(void* arg)
+{
+    int i_block;
+    ReadAhead* ra = (ReadAhead*) arg;
+    for (i_block = 0; i_block < ra->num_blocks; ++i_block)
+    {
+        ReadBuffer* buf = (ReadBuffer*) oskar_queue_pop(ra->empty);
+        if (!buf) break;
+        buf->status = 0;
+        oskar_timer_resume(ra->tmr_read);
+        ra->read_block(ra->reader, buf, i_block);
+        oskar_timer_pause(ra->tmr_read);
+        oskar_queue_push(ra->full, buf);
+        if (buf->status) break;
+    }
+    oskar_queue_close(ra->full);
+    return 0;
+}
+
+static int read_ahead_num_buffers(const oskar_Imager* h, size_t buffer_bytes)
+{
+    int n = h->num_read_buffers;
+    const size_t max_bytes = oskar_get_free_physical_memory() / 2;
+    if (n < 1) n = 1;
+
+    /* Limit the number of buffers to use at most half the free memory. */
+    if (n > 1 && buffer_bytes > 0 && max_bytes > 0 &&
+            (size_t) n * buffer_bytes > max_bytes)
+    {
+        n = (int) (max_bytes / buffer_bytes);
+        if (n < 1) n = 1;
+    }
+    return n;
+}
+
+static size_t buffer_bytes_used(const ReadBuffer* buf, int num_pols)
+{
+    size_t bytes;
+    const size_t num_rows = buf->num_rows;
+    bytes = num_rows * (oskar_mem_element_size(oskar_mem_type(buf->uu)) +
+            oskar_mem_element_size(oskar_mem_type(buf->vv)) +
+            oskar_mem_element_size(oskar_mem_type(buf->ww)));
+    bytes += num_rows * (1 + buf->end_chan - buf->start_chan) *
+            oskar_mem_element_size(oskar_mem_type(buf->amps));
+    bytes += num_rows * num_pols *
+            oskar_mem_element_size(oskar_mem_type(buf->weight));
+    if (buf->time_centroid)
+        bytes += num_rows * sizeof(double);
+    return bytes;
+}
+
+static void read_ahead_run(oskar_Imager* h, void* reader,
+        ReadBlockFunc read_block, int num_blocks, int num_buffers,
+        ReadBuffer* buffers, int num_pols, int i_file, int num_files,
+        int* percent_done, int* percent_next, int* status)
+{
+    int i, i_block;
+    ReadAhead ra;
+    oskar_Thread* thread = 0;
+    if (*status) return;
+
+    /* Start the reader thread if using more than one buffer. */
+    memset(&ra, 0, sizeof(ReadAhead));
+    if (num_buffers > 1)
+    {
+        ra.read_block = read_block;
+        ra.reader = reader;
+        ra.num_blocks = num_blocks;
+        ra.tmr_read = h->tmr_read;
+        ra.empty = oskar_queue_create(num_buffers);
+        ra.full = oskar_queue_create(num_buffers);
+        for (i = 0; i < num_buffers; ++i)
+            oskar_queue_push(ra.empty, &buffers[i]);
+        thread = oskar_thread_create(read_ahead_thread, (void*)&ra, 0);
+    }
+
+    /* Grid each block as it becomes available. */
+    for (i_block = 0; i_block < num_blocks; ++i_block)
+    {
+        ReadBuffer* buf;
+        if (thread)
+        {
+            buf = (ReadBuffer*) oskar_queue_pop(ra.full);
+            if (!buf) break;
+        }
+        else
+        {
+            buf = &buffers[0];
+            buf->status = 0;
+            oskar_timer_resume(h->tmr_read);
+            read_block(reader, buf, i_block);
+            oskar_timer_pause(h->tmr_read);
+        }
+        if (buf->status)
+        {
+            *status = buf->status;
+            break;
+        }
+
+        /* Update the imager with the data, and cache it if required. */
+        h->vis_bytes_read += buffer_bytes_used(buf, num_pols);
+        oskar_imager_update(h, buf->num_rows, buf->start_chan, buf->end_chan,
+                num_pols, buf->uu, buf->vv, buf->ww, buf->amps, buf->weight,
+                buf->time_centroid, status);
+        if (h->vis_cache && h->coords_only)
+            oskar_imager_vis_cache_add(h->vis_cache, h, buf->num_rows,
+                    buf->start_chan, buf->end_chan, num_pols, buf->uu,
+                    buf->vv, buf->ww, buf->amps, buf->weight,
+                    buf->time_centroid, status);
+        *percent_done = (int) round(100.0 * (
+                buf->fraction_done / (double)num_files +
+                i_file / (double)num_files));
+        if (h->log && percent_next && *percent_done >= *percent_next)
+        {
+            oskar_log_message(h->log, 'S', -2, "%3d%% ...", *percent_done);
+            *percent_next = 10 + 10 * (*percent_done / 10);
+        }
+        if (*status) break;
+        if (thread) oskar_queue_push(ra.empty, buf);
+    }
+
+    /* Stop the reader thread. */
+    if (thread)
+    {
+        oskar_queue_close(ra.empty);
+        oskar_thread_join(thread);
+        oskar_thread_free(thread);
+        oskar_queue_free(ra.empty);
+        oskar_queue_free(ra.full);
+    }
+}
+
+#ifndef OSKAR_NO_MS
+typedef struct MsReader
+{
+    oskar_MeasurementSet* ms;
+    const char* column;
+    size_t num_rows, num_baselines;
+    int num_channels;
+} MsReader;
+
+static void read_block_ms(void* reader, ReadBuffer* buf, int i_block)
+{
+    size_t allocated, required, block_size, start_row, i;
+    double *uvw_, *u_, *v_, *w_;
+    int* status = &buf->status;
+    MsReader* r = (MsReader*) reader;
+
+    /* Read rows from Measurement Set. */
+    start_row = i_block * r->num_baselines;
+    block_size = r->num_rows - start_row;
+    if (block_size > r->num_baselines) block_size = r->num_baselines;
+    allocated = oskar_mem_length(buf->uvw) *
+            oskar_mem_element_size(oskar_mem_type(buf->uvw));
+    oskar_ms_read_column(r->ms, "UVW", start_row, block_size,
+            allocated, oskar_mem_void(buf->uvw), &required, status);
+    allocated = oskar_mem_length(buf->weights) *
+            oskar_mem_element_size(oskar_mem_type(buf->weights));
+    oskar_ms_read_column(r->ms, "WEIGHT", start_row, block_size,
+            allocated, oskar_mem_void(buf->weights), &required, status);
+    allocated = oskar_mem_length(buf->times) *
+            oskar_mem_element_size(oskar_mem_type(buf->times));
+    oskar_ms_read_column(r->ms, "TIME_CENTROID", start_row, block_size,
+            allocated, oskar_mem_void(buf->times), &required, status);
+    allocated = oskar_mem_length(buf->data) *
+            oskar_mem_element_size(oskar_mem_type(buf->data));
+    oskar_ms_read_column(r->ms, r->column, start_row, block_size,
+            allocated, oskar_mem_void(buf->data), &required, status);
+    if (*status) return;
+
+    /* Split up baseline coordinates. */
+    uvw_ = oskar_mem_double(buf->uvw, status);
+    u_ = oskar_mem_double(buf->u, status);
+    v_ = oskar_mem_double(buf->v, status);
+    w_ = oskar_mem_double(buf->w, status);
+    for (i = 0; i < block_size; ++i)
+    {
+        u_[i] = uvw_[3*i + 0];
+        v_[i] = uvw_[3*i + 1];
+        w_[i] = uvw_[3*i + 2];
+    }
+    buf->num_rows = block_size;
+    buf->start_chan = 0;
+    buf->end_chan = r->num_channels - 1;
+    buf->fraction_done = (start_row + block_size) / (double)(r->num_rows);
+}
+#endif
+
 void oskar_imager_read_data_ms(oskar_Imager* h, const char* filename,
         int i_file, int num_files, int* percent_done, int* percent_next,
         int* status)
 {
 #ifndef OSKAR_NO_MS
-    oskar_MeasurementSet* ms;
-    oskar_Mem *uvw, *u, *v, *w, *data, *weight, *time_centroid;
-    int num_channels, num_pols, num_stations, type;
-    size_t num_baselines, start_row, num_rows;
-    double *uvw_, *u_, *v_, *w_;
+    MsReader reader;
+    ReadBuffer* buffers;
+    int i, num_blocks, num_buffers, num_pols, num_stations, type;
+    size_t num_baselines, buffer_bytes;
     if (*status) return;
 
     /* Read the header. */
-    ms = oskar_ms_open(filename);
-    if (!ms)
+    reader.ms = oskar_ms_open(filename);
+    if (!reader.ms)
     {
         *status = OSKAR_ERR_FILE_IO;
         return;
     }
-    num_rows = (size_t) oskar_ms_num_rows(ms);
-    num_stations = (int) oskar_ms_num_stations(ms);
+    reader.column = h->ms_column;
+    reader.num_rows = (size_t) oskar_ms_num_rows(reader.ms);
+    num_stations = (int) oskar_ms_num_stations(reader.ms);
     num_baselines = num_stations * (num_stations - 1) / 2;
-    num_pols = (int) oskar_ms_num_pols(ms);
-    num_channels = (int) oskar_ms_num_channels(ms);
+    reader.num_baselines = num_baselines;
+    reader.num_channels = (int) oskar_ms_num_channels(reader.ms);
+    num_pols = (int) oskar_ms_num_pols(reader.ms);
+    num_blocks = num_baselines == 0 ? 0 : (int) ((reader.num_rows +
+            num_baselines - 1) / num_baselines);
 
     /* Set visibility meta-data. */
     oskar_imager_set_vis_frequency(h,
-            oskar_ms_freq_start_hz(ms),
-            oskar_ms_freq_inc_hz(ms), num_channels);
+            oskar_ms_freq_start_hz(reader.ms),
+            oskar_ms_freq_inc_hz(reader.ms), reader.num_channels);
     oskar_imager_set_vis_phase_centre(h,
-            oskar_ms_phase_centre_ra_rad(ms) * 180/M_PI,
-            oskar_ms_phase_centre_dec_rad(ms) * 180/M_PI);
-
-    /* Create arrays. */
-    uvw = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 3 * num_baselines, status);
-    u = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_baselines, status);
-    v = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_baselines, status);
-    w = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_baselines, status);
-    weight = oskar_mem_create(OSKAR_SINGLE, OSKAR_CPU,
-            num_baselines * num_pols, status);
-    time_centroid = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_baselines,
-            status);
-    uvw_ = oskar_mem_double(uvw, status);
-    u_ = oskar_mem_double(u, status);
-    v_ = oskar_mem_double(v, status);
-    w_ = oskar_mem_double(w, status);
+            oskar_ms_phase_centre_ra_rad(reader.ms) * 180/M_PI,
+            oskar_ms_phase_centre_dec_rad(reader.ms) * 180/M_PI);
+
+    /* Create buffers. */
     type = OSKAR_SINGLE | OSKAR_COMPLEX;
     if (num_pols == 4) type |= OSKAR_MATRIX;
-    data = oskar_mem_create(type, OSKAR_CPU,
-            num_baselines * num_channels, status);
-
-    /* Loop over visibility blocks. */
-    for (start_row = 0; start_row < num_rows; start_row += num_baselines)
+    buffer_bytes = num_baselines * (7 * sizeof(double) +
+            num_pols * sizeof(float) +
+            reader.num_channels * oskar_mem_element_size(type));
+    num_buffers = read_ahead_num_buffers(h, buffer_bytes);
+    buffers = (ReadBuffer*) calloc(num_buffers, sizeof(ReadBuffer));
+    for (i = 0; i < num_buffers; ++i)
     {
-        size_t allocated, required, block_size, i;
-        if (*status) break;
-
-        /* Read rows from Measurement Set. */
-        oskar_timer_resume(h->tmr_read);
-        block_size = num_rows - start_row;
-        if (block_size > num_baselines) block_size = num_baselines;
-        allocated = oskar_mem_length(uvw) *
-                oskar_mem_element_size(oskar_mem_type(uvw));
-        oskar_ms_read_column(ms, "UVW", start_row, block_size,
-                allocated, oskar_mem_void(uvw), &required, status);
-        allocated = oskar_mem_length(weight) *
-                oskar_mem_element_size(oskar_mem_type(weight));
-        oskar_ms_read_column(ms, "WEIGHT", start_row, block_size,
-                allocated, oskar_mem_void(weight), &required, status);
-        allocated = oskar_mem_length(time_centroid) *
-                oskar_mem_element_size(oskar_mem_type(time_centroid));
-        oskar_ms_read_column(ms, "TIME_CENTROID", start_row, block_size,
-                allocated, oskar_mem_void(time_centroid), &required, status);
-        allocated = oskar_mem_length(data) *
-                oskar_mem_element_size(oskar_mem_type(data));
-        oskar_ms_read_column(ms, h->ms_column, start_row, block_size,
-                allocated, oskar_mem_void(data), &required, status);
-        if (*status) break;
-
-        /* Split up baseline coordinates. */
-        for (i = 0; i < block_size; ++i)
-        {
-            u_[i] = uvw_[3*i + 0];
-            v_[i] = uvw_[3*i + 1];
-            w_[i] = uvw_[3*i + 2];
-        }
+        ReadBuffer* b = &buffers[i];
+        b->uvw = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+                3 * num_baselines, status);
+        b->u = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_baselines, status);
+        b->v = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_baselines, status);
+        b->w = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_baselines, status);
+        b->weights = oskar_mem_create(OSKAR_SINGLE, OSKAR_CPU,
+                num_baselines * num_pols, status);
+        b->times = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+                num_baselines, status);
+        b->data = oskar_mem_create(type, OSKAR_CPU,
+                num_baselines * reader.num_channels, status);
+        b->uu = b->u;
+        b->vv = b->v;
+        b->ww = b->w;
+        b->amps = b->data;
+        b->weight = b->weights;
+        b->time_centroid = b->times;
+    }
 
-        /* Update the imager with the data. */
-        oskar_timer_pause(h->tmr_read);
-        oskar_imager_update(h, block_size, 0, num_channels - 1, num_pols,
-                u, v, w, data, weight, time_centroid, status);
-        *percent_done = (int) round(100.0 * (
-                (start_row + block_size) / (double)(num_rows * num_files) +
-                i_file / (double)num_files));
-        if (h->log && percent_next && *percent_done >= *percent_next)
-        {
-            oskar_log_message(h->log, 'S', -2, "%3d%% ...", *percent_done);
-            *percent_next = 10 + 10 * (*percent_done / 10);
-        }
+    /* Read and grid the visibility blocks. */
+    read_ahead_run(h, &reader, read_block_ms, num_blocks, num_buffers,
+            buffers, num_pols, i_file, num_files,
+            percent_done, percent_next, status);
+    for (i = 0; i < num_buffers; ++i)
+    {
+        oskar_mem_free(buffers[i].uvw, status);
+        oskar_mem_free(buffers[i].u, status);
+        oskar_mem_free(buffers[i].v, status);
+        oskar_mem_free(buffers[i].w, status);
+        oskar_mem_free(buffers[i].data, status);
+        oskar_mem_free(buffers[i].weights, status);
+        oskar_mem_free(buffers[i].times, status);
     }
-    oskar_mem_free(uvw, status);
-    oskar_mem_free(u, status);
-    oskar_mem_free(v, status);
-    oskar_mem_free(w, status);
-    oskar_mem_free(data, status);
-    oskar_mem_free(weight, status);
-    oskar_mem_free(time_centroid, status);
-    oskar_ms_close(ms);
+    free(buffers);
+    oskar_ms_close(reader.ms);
 #else
     (void) filename;
     (void) i_file;
@@ -166,149 +362,178 @@ void oskar_imager_read_data_ms(oskar_Imager* h, const char* filename,
 }
 
 
-void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
-        int i_file, int num_files, int* percent_done, int* percent_next,
-        int* status)
+typedef struct VisReader
 {
     oskar_Binary* vis_file;
-    oskar_VisBlock* block;
     oskar_VisHeader* header;
-    oskar_Mem *weight, *time_centroid, *time_slice, *scratch = 0, *ptr;
-    int max_times_per_block, tags_per_block, i_block, num_blocks;
-    int num_times_tot, num_channels_tot, num_stations, num_baselines, num_pols;
+    const oskar_Mem* weight;
+    int num_blocks, tags_per_block, num_baselines, num_pols;
     double time_start_mjd, time_inc_sec;
+} VisReader;
+
+static void read_block_vis(void* reader, ReadBuffer* buf, int i_block)
+{
+    int t, num_times, num_channels, num_baselines, num_pols, start_time;
+    oskar_Mem* ptr;
+    int* status = &buf->status;
+    VisReader* r = (VisReader*) reader;
+    oskar_VisBlock* block = buf->block;
+    num_baselines = r->num_baselines;
+    num_pols = r->num_pols;
+
+    /* Read the visibility data. */
+    oskar_binary_set_query_search_start(r->vis_file,
+            i_block * r->tags_per_block, status);
+    oskar_vis_block_read(block, r->header, r->vis_file, i_block, status);
+    if (*status) return;
+    start_time       = oskar_vis_block_start_time_index(block);
+    buf->start_chan  = oskar_vis_block_start_channel_index(block);
+    num_times        = oskar_vis_block_num_times(block);
+    num_channels     = oskar_vis_block_num_channels(block);
+    buf->num_rows    = num_times * num_baselines;
+    buf->end_chan    = buf->start_chan + num_channels - 1;
+
+    /* Fill in the time centroid values. */
+    for (t = 0; t < num_times; ++t)
+    {
+        size_t b;
+        const double val = r->time_start_mjd +
+                (start_time + t + 0.5) * r->time_inc_sec;
+        double* tc = oskar_mem_double(buf->times, status) + t * num_baselines;
+        for (b = 0; b < (size_t) num_baselines; ++b) tc[b] = val;
+    }
+
+    /* Swap baseline and channel dimensions. */
+    ptr = oskar_vis_block_cross_correlations(block);
+#define SWAP_LOOP \
+    for (t = 0; t < num_times; ++t)                                  \
+        for (c = 0; c < num_channels; ++c)                           \
+            for (b = 0; b < num_baselines; ++b)                      \
+                for (p = 0; p < num_pols; ++p)                       \
+                {                                                    \
+                    k = (num_pols * (num_baselines *                 \
+                            (num_channels * t + c) + b) + p) << 1;   \
+                    l = (num_pols * (num_channels *                  \
+                            (num_baselines * t + b) + c) + p) << 1;  \
+                    out[l] = in[k];                                  \
+                    out[l + 1] = in[k + 1];                          \
+                }
+    if (num_channels != 1)
+    {
+        int b, c, p;
+        size_t k, l;
+        if (oskar_mem_precision(ptr) == OSKAR_SINGLE)
+        {
+            float *in, *out;
+            in  = oskar_mem_float(ptr, status);
+            out = oskar_mem_float(buf->scratch, status);
+            SWAP_LOOP
+        }
+        else
+        {
+            double *in, *out;
+            in  = oskar_mem_double(ptr, status);
+            out = oskar_mem_double(buf->scratch, status);
+            SWAP_LOOP
+        }
+        ptr = buf->scratch;
+    }
+#undef SWAP_LOOP
+    buf->uu = oskar_vis_block_baseline_uu_metres(block);
+    buf->vv = oskar_vis_block_baseline_vv_metres(block);
+    buf->ww = oskar_vis_block_baseline_ww_metres(block);
+    buf->amps = ptr;
+    buf->weight = r->weight;
+    buf->time_centroid = buf->times;
+    buf->fraction_done = (i_block + 1) / (double)(r->num_blocks);
+}
+
+void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
+        int i_file, int num_files, int* percent_done, int* percent_next,
+        int* status)
+{
+    VisReader reader;
+    ReadBuffer* buffers;
+    oskar_Mem* weight;
+    int i, amp_type, max_times_per_block, num_times_tot, num_channels_tot;
+    int num_stations, num_buffers;
+    size_t buffer_bytes, num_amps;
     if (*status) return;
 
     /* Read the header. */
-    vis_file = oskar_binary_create(filename, 'r', status);
-    header = oskar_vis_header_read(vis_file, status);
+    reader.vis_file = oskar_binary_create(filename, 'r', status);
+    reader.header = oskar_vis_header_read(reader.vis_file, status);
     if (*status)
     {
-        oskar_vis_header_free(header, status);
-        oskar_binary_free(vis_file);
+        oskar_vis_header_free(reader.header, status);
+        oskar_binary_free(reader.vis_file);
         return;
     }
-    max_times_per_block = oskar_vis_header_max_times_per_block(header);
-    tags_per_block = oskar_vis_header_num_tags_per_block(header);
-    num_times_tot = oskar_vis_header_num_times_total(header);
-    num_channels_tot = oskar_vis_header_num_channels_total(header);
-    num_stations = oskar_vis_header_num_stations(header);
-    num_baselines = num_stations * (num_stations - 1) / 2;
-    num_pols = oskar_type_is_matrix(oskar_vis_header_amp_type(header)) ? 4 : 1;
-    num_blocks = (num_times_tot + max_times_per_block - 1) /
+    max_times_per_block = oskar_vis_header_max_times_per_block(reader.header);
+    reader.tags_per_block = oskar_vis_header_num_tags_per_block(reader.header);
+    num_times_tot = oskar_vis_header_num_times_total(reader.header);
+    num_channels_tot = oskar_vis_header_num_channels_total(reader.header);
+    num_stations = oskar_vis_header_num_stations(reader.header);
+    amp_type = oskar_vis_header_amp_type(reader.header);
+    reader.num_baselines = num_stations * (num_stations - 1) / 2;
+    reader.num_pols = oskar_type_is_matrix(amp_type) ? 4 : 1;
+    reader.num_blocks = (num_times_tot + max_times_per_block - 1) /
             max_times_per_block;
-    time_start_mjd = oskar_vis_header_time_start_mjd_utc(header) * 86400.0;
-    time_inc_sec = oskar_vis_header_time_inc_sec(header);
+    reader.time_start_mjd =
+            oskar_vis_header_time_start_mjd_utc(reader.header) * 86400.0;
+    reader.time_inc_sec = oskar_vis_header_time_inc_sec(reader.header);
 
     /* Set visibility meta-data. */
     oskar_imager_set_vis_frequency(h,
-            oskar_vis_header_freq_start_hz(header),
-            oskar_vis_header_freq_inc_hz(header), num_channels_tot);
+            oskar_vis_header_freq_start_hz(reader.header),
+            oskar_vis_header_freq_inc_hz(reader.header), num_channels_tot);
     oskar_imager_set_vis_phase_centre(h,
-            oskar_vis_header_phase_centre_ra_deg(header),
-            oskar_vis_header_phase_centre_dec_deg(header));
-
-    /* Create scratch arrays. Weights are all 1. */
-    time_centroid = oskar_mem_create(OSKAR_DOUBLE,
-            OSKAR_CPU, num_baselines * max_times_per_block, status);
-    time_slice = oskar_mem_create_alias(0, 0, 0, status);
-    weight = oskar_mem_create(h->imager_prec,
-            OSKAR_CPU, num_baselines * num_pols * max_times_per_block, status);
+            oskar_vis_header_phase_centre_ra_deg(reader.header),
+            oskar_vis_header_phase_centre_dec_deg(reader.header));
+
+    /* Create weights, which are all 1. */
+    weight = oskar_mem_create(h->imager_prec, OSKAR_CPU,
+            reader.num_baselines * reader.num_pols * max_times_per_block,
+            status);
     oskar_mem_set_value_real(weight, 1.0, 0, 0, status);
-    if (num_channels_tot > 1)
-        scratch = oskar_mem_create(oskar_vis_header_amp_type(header), OSKAR_CPU,
-                num_baselines * num_channels_tot * max_times_per_block, status);
+    reader.weight = weight;
 
-    /* Loop over visibility blocks. */
-    block = oskar_vis_block_create_from_header(OSKAR_CPU, header, status);
-    for (i_block = 0; i_block < num_blocks; ++i_block)
+    /* Create buffers. */
+    num_amps = (size_t) reader.num_baselines * num_channels_tot *
+            max_times_per_block;
+    buffer_bytes = (size_t) reader.num_baselines * max_times_per_block * (
+            sizeof(double) + 3 * oskar_mem_element_size(
+            oskar_type_precision(amp_type))) +
+            num_amps * oskar_mem_element_size(amp_type) *
+            (num_channels_tot > 1 ? 2 : 1);
+    num_buffers = read_ahead_num_buffers(h, buffer_bytes);
+    buffers = (ReadBuffer*) calloc(num_buffers, sizeof(ReadBuffer));
+    for (i = 0; i < num_buffers; ++i)
     {
-        int t, num_times, num_channels, start_time, start_chan, end_chan;
-        size_t num_rows;
-        if (*status) break;
-
-        /* Read the visibility data. */
-        oskar_timer_resume(h->tmr_read);
-        oskar_binary_set_query_search_start(vis_file,
-                i_block * tags_per_block, status);
-        oskar_vis_block_read(block, header, vis_file, i_block, status);
-        start_time   = oskar_vis_block_start_time_index(block);
-        start_chan   = oskar_vis_block_start_channel_index(block);
-        num_times    = oskar_vis_block_num_times(block);
-        num_channels = oskar_vis_block_num_channels(block);
-        num_rows     = num_times * num_baselines;
-        end_chan     = start_chan + num_channels - 1;
-
-        /* Fill in the time centroid values. */
-        for (t = 0; t < num_times; ++t)
-        {
-            oskar_mem_set_alias(time_slice, time_centroid,
-                    t * num_baselines, num_baselines, status);
-            oskar_mem_set_value_real(time_slice,
-                    time_start_mjd + (start_time + t + 0.5) * time_inc_sec,
-                    0, num_baselines, status);
-        }
-
-        /* Swap baseline and channel dimensions. */
-        ptr = oskar_vis_block_cross_correlations(block);
-#define SWAP_LOOP \
-        for (t = 0; t < num_times; ++t)                                  \
-            for (c = 0; c < num_channels; ++c)                           \
-                for (b = 0; b < num_baselines; ++b)                      \
-                    for (p = 0; p < num_pols; ++p)                       \
-                    {                                                    \
-                        k = (num_pols * (num_baselines *                 \
-                                (num_channels * t + c) + b) + p) << 1;   \
-                        l = (num_pols * (num_channels *                  \
-                                (num_baselines * t + b) + c) + p) << 1;  \
-                        out[l] = in[k];                                  \
-                        out[l + 1] = in[k + 1];                          \
-                    }
-        if (num_channels != 1)
-        {
-            int b, c, p;
-            size_t k, l;
-            if (oskar_mem_precision(ptr) == OSKAR_SINGLE)
-            {
-                float *in, *out;
-                in  = oskar_mem_float(ptr, status);
-                out = oskar_mem_float(scratch, status);
-                SWAP_LOOP
-            }
-            else
-            {
-                double *in, *out;
-                in  = oskar_mem_double(ptr, status);
-                out = oskar_mem_double(scratch, status);
-                SWAP_LOOP
-            }
-            ptr = scratch;
-        }
-#undef SWAP_LOOP
+        ReadBuffer* b = &buffers[i];
+        b->block = oskar_vis_block_create_from_header(OSKAR_CPU,
+                reader.header, status);
+        b->times = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+                reader.num_baselines * max_times_per_block, status);
+        if (num_channels_tot > 1)
+            b->scratch = oskar_mem_create(amp_type, OSKAR_CPU,
+                    num_amps, status);
+    }
 
-        /* Update the imager with the data. */
-        oskar_timer_pause(h->tmr_read);
-        oskar_imager_update(h, num_rows, start_chan, end_chan, num_pols,
-                oskar_vis_block_baseline_uu_metres(block),
-                oskar_vis_block_baseline_vv_metres(block),
-                oskar_vis_block_baseline_ww_metres(block),
-                ptr, weight, time_centroid, status);
-        *percent_done = (int) round(100.0 * (
-                (i_block + 1) / (double)(num_blocks * num_files) +
-                i_file / (double)num_files));
-        if (h->log && percent_next && *percent_done >= *percent_next)
-        {
-            oskar_log_message(h->log, 'S', -2, "%3d%% ...", *percent_done);
-            *percent_next = 10 + 10 * (*percent_done / 10);
-        }
+    /* Read and grid the visibility blocks. */
+    read_ahead_run(h, &reader, read_block_vis, reader.num_blocks,
+            num_buffers, buffers, reader.num_pols, i_file, num_files,
+            percent_done, percent_next, status);
+    for (i = 0; i < num_buffers; ++i)
+    {
+        oskar_mem_free(buffers[i].scratch, status);
+        oskar_mem_free(buffers[i].times, status);
+        oskar_vis_block_free(buffers[i].block, status);
     }
-    oskar_mem_free(scratch, status);
+    free(buffers);
     oskar_mem_free(weight, status);
-    oskar_mem_free(time_centroid, status);
-    oskar_mem_free(time_slice, status);
-    oskar_vis_block_free(block, status);
-    oskar_vis_header_free(header, status);
-    oskar_binary_free(vis_file);
+    oskar_vis_header_free(reader.header, status);
+    oskar_binary_free(reader.vis_file);
 }
 
 #ifdef __cplusplus
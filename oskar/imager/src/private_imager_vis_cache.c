@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/private_imager_vis_cache.h"
+#include "imager/oskar_imager.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Blocks are held in memory as compact copies of the arrays passed to the
+ * imager, until the memory limit is reached. Later blocks are appended to
+ * an anonymous temporary file, which is read back in the same order.
+ */
+enum { UU, VV, WW, AMPS, WEIGHT, TIME, NUM_ARRAYS };
+
+typedef struct VisCacheBlock
+{
+    size_t num_rows;
+    int start_chan, end_chan, num_pols, on_disk;
+    double freq_start_hz, freq_inc_hz, phase_centre_deg[2];
+    int type[NUM_ARRAYS];
+    size_t length[NUM_ARRAYS];
+    oskar_Mem* data[NUM_ARRAYS]; /* NULL if on disk. */
+} VisCacheBlock;
+
+struct oskar_ImagerVisCache
+{
+    size_t max_mem_bytes, bytes_mem, bytes_disk;
+    int num_blocks, capacity;
+    VisCacheBlock* blocks;
+    FILE* file;
+};
+
+oskar_ImagerVisCache* oskar_imager_vis_cache_create(size_t max_mem_bytes)
+{
+    oskar_ImagerVisCache* cache;
+    cache = (oskar_ImagerVisCache*) calloc(1, sizeof(oskar_ImagerVisCache));
+    cache->max_mem_bytes = max_mem_bytes;
+    return cache;
+}
+
+void oskar_imager_vis_cache_free(oskar_ImagerVisCache* cache)
+{
+    int i, j, status = 0;
+    if (!cache) return;
+    for (i = 0; i < cache->num_blocks; ++i)
+        for (j = 0; j < NUM_ARRAYS; ++j)
+            oskar_mem_free(cache->blocks[i].data[j], &status);
+    free(cache->blocks);
+    if (cache->file) fclose(cache->file);
+    free(cache);
+}
+
+void oskar_imager_vis_cache_add(oskar_ImagerVisCache* cache,
+        const oskar_Imager* h, size_t num_rows, int start_chan, int end_chan,
+        int num_pols, const oskar_Mem* uu, const oskar_Mem* vv,
+        const oskar_Mem* ww, const oskar_Mem* amps, const oskar_Mem* weight,
+        const oskar_Mem* time_centroid, int* status)
+{
+    int i;
+    size_t block_bytes = 0;
+    VisCacheBlock* b;
+    const oskar_Mem* src[NUM_ARRAYS];
+    if (*status) return;
+
+    /* Get a new block descriptor. */
+    if (cache->num_blocks == cache->capacity)
+    {
+        void* t;
+        const int capacity = cache->capacity ? 2 * cache->capacity : 64;
+        t = realloc(cache->blocks, capacity * sizeof(VisCacheBlock));
+        if (!t)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        cache->blocks = (VisCacheBlock*) t;
+        cache->capacity = capacity;
+    }
+    b = &cache->blocks[cache->num_blocks];
+    memset(b, 0, sizeof(VisCacheBlock));
+    b->num_rows = num_rows;
+    b->start_chan = start_chan;
+    b->end_chan = end_chan;
+    b->num_pols = num_pols;
+    b->freq_start_hz = h->vis_freq_start_hz;
+    b->freq_inc_hz = h->freq_inc_hz;
+    b->phase_centre_deg[0] = h->vis_centre_deg[0];
+    b->phase_centre_deg[1] = h->vis_centre_deg[1];
+
+    /* Store only the elements used by the imager. */
+    src[UU] = uu;
+    src[VV] = vv;
+    src[WW] = ww;
+    src[AMPS] = amps;
+    src[WEIGHT] = weight;
+    src[TIME] = time_centroid;
+    b->length[UU] = b->length[VV] = b->length[WW] = num_rows;
+    b->length[AMPS] = num_rows * (1 + end_chan - start_chan);
+    b->length[WEIGHT] = num_rows * num_pols;
+    b->length[TIME] = num_rows;
+    for (i = 0; i < NUM_ARRAYS; ++i)
+    {
+        if (!src[i])
+        {
+            b->length[i] = 0;
+            continue;
+        }
+        b->type[i] = oskar_mem_type(src[i]);
+        block_bytes += b->length[i] * oskar_mem_element_size(b->type[i]);
+    }
+
+    /* Copy the arrays to memory, or append them to the temporary file. */
+    if (!cache->file && cache->bytes_mem + block_bytes <= cache->max_mem_bytes)
+    {
+        for (i = 0; i < NUM_ARRAYS; ++i)
+        {
+            if (!src[i]) continue;
+            b->data[i] = oskar_mem_create(b->type[i], OSKAR_CPU,
+                    b->length[i], status);
+            oskar_mem_copy_contents(b->data[i], src[i],
+                    0, 0, b->length[i], status);
+        }
+        cache->bytes_mem += block_bytes;
+    }
+    else
+    {
+        if (!cache->file)
+        {
+            cache->file = tmpfile();
+            if (!cache->file)
+            {
+                *status = OSKAR_ERR_FILE_IO;
+                return;
+            }
+        }
+        for (i = 0; i < NUM_ARRAYS; ++i)
+        {
+            size_t bytes;
+            if (!src[i]) continue;
+            bytes = b->length[i] * oskar_mem_element_size(b->type[i]);
+            if (fwrite(oskar_mem_void_const(src[i]), 1, bytes,
+                    cache->file) != bytes)
+            {
+                *status = OSKAR_ERR_FILE_IO;
+                return;
+            }
+        }
+        b->on_disk = 1;
+        cache->bytes_disk += block_bytes;
+    }
+    cache->num_blocks++;
+}
+
+void oskar_imager_vis_cache_replay(oskar_ImagerVisCache* cache,
+        oskar_Imager* h, int* percent_done, int* percent_next, int* status)
+{
+    int i, j;
+    const VisCacheBlock* last = 0;
+    oskar_Mem* scratch[NUM_ARRAYS];
+    if (*status) return;
+    memset(scratch, 0, sizeof(scratch));
+    if (cache->file && fseek(cache->file, 0, SEEK_SET))
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    for (i = 0; i < cache->num_blocks; ++i)
+    {
+        const oskar_Mem* arrays[NUM_ARRAYS];
+        const VisCacheBlock* b = &cache->blocks[i];
+
+        /* Restore the visibility meta-data if it has changed. */
+        if (!last || b->freq_start_hz != last->freq_start_hz ||
+                b->freq_inc_hz != last->freq_inc_hz)
+            oskar_imager_set_vis_frequency(h,
+                    b->freq_start_hz, b->freq_inc_hz, 0);
+        if (!last || b->phase_centre_deg[0] != last->phase_centre_deg[0] ||
+                b->phase_centre_deg[1] != last->phase_centre_deg[1])
+            oskar_imager_set_vis_phase_centre(h,
+                    b->phase_centre_deg[0], b->phase_centre_deg[1]);
+        last = b;
+
+        /* Get the arrays for the block. */
+        for (j = 0; j < NUM_ARRAYS; ++j)
+        {
+            size_t bytes;
+            arrays[j] = b->data[j];
+            if (!b->on_disk || b->length[j] == 0) continue;
+            if (!scratch[j])
+                scratch[j] = oskar_mem_create(b->type[j], OSKAR_CPU,
+                        b->length[j], status);
+            else if (oskar_mem_length(scratch[j]) < b->length[j])
+                oskar_mem_realloc(scratch[j], b->length[j], status);
+            if (*status) break;
+            bytes = b->length[j] * oskar_mem_element_size(b->type[j]);
+            if (fread(oskar_mem_void(scratch[j]), 1, bytes,
+                    cache->file) != bytes)
+            {
+                *status = OSKAR_ERR_FILE_IO;
+                break;
+            }
+            arrays[j] = scratch[j];
+        }
+
+        /* Update the imager with the data. */
+        oskar_imager_update(h, b->num_rows, b->start_chan, b->end_chan,
+                b->num_pols, arrays[UU], arrays[VV], arrays[WW],
+                arrays[AMPS], arrays[WEIGHT], arrays[TIME], status);
+        if (*status) break;
+        *percent_done = (int) round(100.0 * (i + 1) / cache->num_blocks);
+        if (h->log && percent_next && *percent_done >= *percent_next)
+        {
+            oskar_log_message(h->log, 'S', -2, "%3d%% ...", *percent_done);
+            *percent_next = 10 + 10 * (*percent_done / 10);
+        }
+    }
+    for (j = 0; j < NUM_ARRAYS; ++j)
+        oskar_mem_free(scratch[j], status);
+}
+
+size_t oskar_imager_vis_cache_bytes_in_memory(
+        const oskar_ImagerVisCache* cache)
+{
+    return cache ? cache->bytes_mem : 0;
+}
+
+size_t oskar_imager_vis_cache_bytes_on_disk(
+        const oskar_ImagerVisCache* cache)
+{
+    return cache ? cache->bytes_disk : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
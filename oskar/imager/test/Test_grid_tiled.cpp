@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_grid_simple.h"
+#include "imager/oskar_grid_wproj.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static double random_gaussian(double sigma)
+{
+    double r1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double r2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return sigma * sqrt(-2.0 * log(r1)) * cos(2.0 * M_PI * r2);
+}
+
+static void create_vis(int num_vis, std::vector<double>& uu,
+        std::vector<double>& vv, std::vector<double>& ww,
+        std::vector<double>& vis, std::vector<double>& weight)
+{
+    srand(1);
+    uu.resize(num_vis);
+    vv.resize(num_vis);
+    ww.resize(num_vis);
+    vis.resize(2 * num_vis);
+    weight.resize(num_vis);
+    for (int i = 0; i < num_vis; ++i)
+    {
+        uu[i] = random_gaussian(200.0);
+        vv[i] = random_gaussian(200.0);
+        ww[i] = random_gaussian(50.0);
+        vis[2 * i] = rand() / (double)RAND_MAX - 0.5;
+        vis[2 * i + 1] = rand() / (double)RAND_MAX - 0.5;
+        weight[i] = 0.5 + rand() / (double)RAND_MAX;
+    }
+}
+
+static void check_grids(const std::vector<double>& grid1,
+        const std::vector<double>& grid2, double norm1, double norm2,
+        size_t num_skipped1, size_t num_skipped2)
+{
+    double max_diff = 0.0, max_val = 0.0;
+    for (size_t i = 0; i < grid1.size(); ++i)
+    {
+        double diff = fabs(grid1[i] - grid2[i]);
+        if (diff > max_diff) max_diff = diff;
+        if (fabs(grid1[i]) > max_val) max_val = fabs(grid1[i]);
+    }
+    EXPECT_GT(max_val, 0.0);
+    EXPECT_LT(max_diff, 1e-12 * max_val);
+    EXPECT_NEAR(norm1, norm2, 1e-12 * norm1);
+    EXPECT_EQ(num_skipped1, num_skipped2);
+    EXPECT_GT(num_skipped1, 0u);
+}
+
+TEST(imager, grid_tiled_simple)
+{
+#ifdef _OPENMP
+    const int support = 3, oversample = 100, grid_size = 512;
+    const int num_vis = 100000, num_threads = omp_get_max_threads();
+    const double cell_size_rad = 1e-3;
+    std::vector<double> uu, vv, ww, vis, weight, conv_func;
+    create_vis(num_vis, uu, vv, ww, vis, weight);
+    for (int i = 0; i < oversample * (support + 1); ++i)
+        conv_func.push_back(exp(-pow(i / (double)oversample, 2.0)));
+
+    // Grid with one thread, then with more than one.
+    std::vector<double> grid1(2 * grid_size * grid_size, 0.0), grid2(grid1);
+    size_t num_skipped1 = 0, num_skipped2 = 0;
+    double norm1 = 0.0, norm2 = 0.0;
+    omp_set_num_threads(1);
+    oskar_grid_simple_d(support, oversample, &conv_func[0], num_vis,
+            &uu[0], &vv[0], &vis[0], &weight[0], cell_size_rad, grid_size,
+            &num_skipped1, &norm1, &grid1[0]);
+    omp_set_num_threads(num_threads > 1 ? num_threads : 4);
+    oskar_grid_simple_d(support, oversample, &conv_func[0], num_vis,
+            &uu[0], &vv[0], &vis[0], &weight[0], cell_size_rad, grid_size,
+            &num_skipped2, &norm2, &grid2[0]);
+    omp_set_num_threads(num_threads);
+    check_grids(grid1, grid2, norm1, norm2, num_skipped1, num_skipped2);
+#endif
+}
+
+TEST(imager, grid_tiled_wproj)
+{
+#ifdef _OPENMP
+    const int oversample = 4, conv_size_half = 64, grid_size = 512;
+    const int num_vis = 100000, num_threads = omp_get_max_threads();
+    const size_t num_w_planes = 8;
+    const double cell_size_rad = 1e-3, w_scale = 0.02;
+    std::vector<double> uu, vv, ww, vis, weight, conv_func;
+    std::vector<int> support;
+    create_vis(num_vis, uu, vv, ww, vis, weight);
+    for (size_t i = 0; i < num_w_planes; ++i)
+        support.push_back(3 + (int)i);
+    conv_func.resize(2 * num_w_planes * conv_size_half * conv_size_half);
+    for (size_t i = 0; i < conv_func.size(); ++i)
+        conv_func[i] = rand() / (double)RAND_MAX - 0.5;
+
+    // Grid with one thread, then with more than one.
+    std::vector<double> grid1(2 * grid_size * grid_size, 0.0), grid2(grid1);
+    size_t num_skipped1 = 0, num_skipped2 = 0;
+    double norm1 = 0.0, norm2 = 0.0;
+    omp_set_num_threads(1);
+    oskar_grid_wproj_d(num_w_planes, &support[0], oversample, conv_size_half,
+            &conv_func[0], num_vis, &uu[0], &vv[0], &ww[0], &vis[0],
+            &weight[0], cell_size_rad, w_scale, grid_size,
+            &num_skipped1, &norm1, &grid1[0]);
+    omp_set_num_threads(num_threads > 1 ? num_threads : 4);
+    oskar_grid_wproj_d(num_w_planes, &support[0], oversample, conv_size_half,
+            &conv_func[0], num_vis, &uu[0], &vv[0], &ww[0], &vis[0],
+            &weight[0], cell_size_rad, w_scale, grid_size,
+            &num_skipped2, &norm2, &grid2[0]);
+    omp_set_num_threads(num_threads);
+    check_grids(grid1, grid2, norm1, norm2, num_skipped1, num_skipped2);
+#endif
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "binary/oskar_binary.h"
+#include "imager/oskar_imager.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static const char* vis_file = "temp_test_imager_cache_vis.vis";
+
+static void write_vis_file(const char* filename, int* status)
+{
+    const int num_stations = 12, num_channels = 3, num_times = 10;
+    const int max_times_per_block = 4;
+    oskar_VisHeader* hdr = oskar_vis_header_create(OSKAR_DOUBLE_COMPLEX,
+            OSKAR_DOUBLE, max_times_per_block, num_times, num_channels,
+            num_channels, num_stations, 0, 1, status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 1e6);
+    oskar_vis_header_set_channel_bandwidth_hz(hdr, 1e6);
+    oskar_vis_header_set_time_start_mjd_utc(hdr, 51544.5);
+    oskar_vis_header_set_time_inc_sec(hdr, 60.0);
+    oskar_vis_header_set_time_average_sec(hdr, 60.0);
+    oskar_vis_header_set_phase_centre(hdr, 0, 10.0, -30.0);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(OSKAR_CPU,
+            hdr, status);
+    oskar_Binary* h = oskar_vis_header_write(hdr, filename, status);
+
+    // Write blocks of random data, the last one only partly filled.
+    srand(2);
+    const int num_blocks = (num_times + max_times_per_block - 1) /
+            max_times_per_block;
+    const int num_baselines = oskar_vis_block_num_baselines(blk);
+    for (int b = 0; b < num_blocks && !*status; ++b)
+    {
+        const int start = b * max_times_per_block;
+        const int n = (num_times - start < max_times_per_block) ?
+                num_times - start : max_times_per_block;
+        oskar_vis_block_set_start_time_index(blk, start);
+        oskar_vis_block_set_num_times(blk, n, status);
+        double* uu = oskar_mem_double(
+                oskar_vis_block_baseline_uu_metres(blk), status);
+        double* vv = oskar_mem_double(
+                oskar_vis_block_baseline_vv_metres(blk), status);
+        double* ww = oskar_mem_double(
+                oskar_vis_block_baseline_ww_metres(blk), status);
+        double* amp = oskar_mem_double(
+                oskar_vis_block_cross_correlations(blk), status);
+        for (int i = 0; i < n * num_baselines; ++i)
+        {
+            uu[i] = 2000.0 * (rand() / (double)RAND_MAX - 0.5);
+            vv[i] = 2000.0 * (rand() / (double)RAND_MAX - 0.5);
+            ww[i] = 200.0 * (rand() / (double)RAND_MAX - 0.5);
+        }
+        for (int i = 0; i < 2 * n * num_baselines * num_channels; ++i)
+            amp[i] = rand() / (double)RAND_MAX - 0.5;
+        oskar_vis_block_write(blk, h, b, status);
+    }
+    oskar_binary_free(h);
+    oskar_vis_block_free(blk, status);
+    oskar_vis_header_free(hdr, status);
+}
+
+static std::vector<double> make_image(const char* algorithm,
+        const char* weighting, int cache_vis, size_t max_mem, int* status)
+{
+    std::vector<double> image;
+    oskar_Mem* plane = 0;
+    oskar_Imager* h = oskar_imager_create(OSKAR_DOUBLE, status);
+    oskar_imager_set_algorithm(h, algorithm, status);
+    oskar_imager_set_weighting(h, weighting, status);
+    oskar_imager_set_image_type(h, "I", status);
+    oskar_imager_set_fov(h, 2.0);
+    oskar_imager_set_size(h, 128, status);
+    oskar_imager_set_channel_snapshots(h, 0);
+    oskar_imager_set_cache_vis(h, cache_vis);
+    oskar_imager_set_cache_vis_max_mem(h, max_mem);
+    oskar_imager_set_input_files(h, 1, &vis_file, status);
+    oskar_imager_run(h, 1, &plane, 0, 0, status);
+    if (!*status)
+    {
+        const double* p = oskar_mem_double_const(plane, status);
+        image.assign(p, p + oskar_mem_length(plane));
+    }
+    oskar_mem_free(plane, status);
+    oskar_imager_free(h, status);
+    return image;
+}
+
+static void compare_cache(const char* algorithm, const char* weighting)
+{
+    int status = 0;
+    write_vis_file(vis_file, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Image without the cache, with the cache in memory, and with a
+    // memory limit small enough to put all the data in a temporary file.
+    std::vector<double> ref = make_image(algorithm, weighting, 0, 0, &status);
+    std::vector<double> mem = make_image(algorithm, weighting, 1, 0, &status);
+    std::vector<double> disk = make_image(algorithm, weighting, 1, 1, &status);
+    remove(vis_file);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the images are identical.
+    double max_val = 0.0;
+    ASSERT_EQ(128u * 128u, ref.size());
+    ASSERT_EQ(ref.size(), mem.size());
+    ASSERT_EQ(ref.size(), disk.size());
+    for (size_t i = 0; i < ref.size(); ++i)
+    {
+        if (fabs(ref[i]) > max_val) max_val = fabs(ref[i]);
+        ASSERT_EQ(ref[i], mem[i]) << "pixel " << i;
+        ASSERT_EQ(ref[i], disk[i]) << "pixel " << i;
+    }
+    EXPECT_GT(max_val, 0.0);
+}
+
+TEST(imager, cache_vis_uniform)
+{
+    compare_cache("FFT", "Uniform");
+}
+
+TEST(imager, cache_vis_wproj)
+{
+    compare_cache("W-projection", "Natural");
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "binary/oskar_binary.h"
+#include "imager/oskar_imager.h"
+#include "imager/private_imager.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static const char* cache_dir = "temp_test_w_kernel_cache";
+static const char* group = "W_KERNELS";
+
+struct Kernels
+{
+    int conv_size_half;
+    std::vector<char> support, start, kernels, compact;
+};
+
+static void copy_mem(std::vector<char>& v, const oskar_Mem* m)
+{
+    const char* p = (const char*) oskar_mem_void_const(m);
+    v.assign(p, p + oskar_mem_length(m) *
+            oskar_mem_element_size(oskar_mem_type(m)));
+}
+
+static Kernels make_kernels(double fov_deg, const char* dir,
+        int num_threads, int* status)
+{
+    Kernels k;
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+    oskar_Imager* h = oskar_imager_create(OSKAR_DOUBLE, status);
+    oskar_imager_set_algorithm(h, "W-projection", status);
+    oskar_imager_set_fov(h, fov_deg);
+    oskar_imager_set_size(h, 128, status);
+    oskar_imager_set_num_w_planes(h, 16);
+    if (dir) oskar_imager_set_w_kernel_cache_dir(h, dir);
+    oskar_imager_check_init(h, status);
+    if (!*status)
+    {
+        k.conv_size_half = h->conv_size_half;
+        copy_mem(k.support, h->w_support);
+        copy_mem(k.start, h->w_kernel_start);
+        copy_mem(k.kernels, h->w_kernels);
+        copy_mem(k.compact, h->w_kernels_compact);
+    }
+    oskar_imager_free(h, status);
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    return k;
+}
+
+static void expect_same(const Kernels& a, const Kernels& b)
+{
+    EXPECT_EQ(a.conv_size_half, b.conv_size_half);
+    EXPECT_TRUE(a.support == b.support);
+    EXPECT_TRUE(a.start == b.start);
+    EXPECT_TRUE(a.kernels == b.kernels);
+    EXPECT_TRUE(a.compact == b.compact);
+    EXPECT_GT(a.compact.size(), 0u);
+}
+
+static std::vector<std::string> cache_files()
+{
+    int num_items = 0;
+    char** items = 0;
+    std::vector<std::string> names;
+    oskar_dir_items(cache_dir, "oskar_w_kernels_*.bin", 1, 0,
+            &num_items, &items);
+    for (int i = 0; i < num_items; ++i)
+    {
+        char* path = oskar_dir_get_path(cache_dir, items[i]);
+        names.push_back(path);
+        free(path);
+        free(items[i]);
+    }
+    free(items);
+    return names;
+}
+
+// Rewrites a cache file with the kernels scaled by a factor.
+static void scale_cache_file(const char* filename, double factor,
+        int* status)
+{
+    const char* tags[] = {"SUPPORT", "KERNEL_START", "KERNELS",
+            "KERNELS_COMPACT"};
+    const int types[] = {OSKAR_INT, OSKAR_INT, OSKAR_DOUBLE_COMPLEX,
+            OSKAR_DOUBLE_COMPLEX};
+    oskar_Mem* key = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    oskar_Mem* data[4];
+    int conv_size_half = 0;
+    oskar_Binary* f = oskar_binary_create(filename, 'r', status);
+    oskar_binary_read_mem_ext(f, key, group, "KEY", 0, status);
+    oskar_binary_read_ext_int(f, group, "CONV_SIZE_HALF", 0,
+            &conv_size_half, status);
+    for (int i = 0; i < 4; ++i)
+    {
+        data[i] = oskar_mem_create(types[i], OSKAR_CPU, 0, status);
+        oskar_binary_read_mem_ext(f, data[i], group, tags[i], 0, status);
+    }
+    oskar_binary_free(f);
+    oskar_mem_scale_real(data[2], factor, status);
+    oskar_mem_scale_real(data[3], factor, status);
+    f = oskar_binary_create(filename, 'w', status);
+    oskar_binary_write_mem_ext(f, key, group, "KEY", 0, 0, status);
+    oskar_binary_write_ext_int(f, group, "CONV_SIZE_HALF", 0,
+            conv_size_half, status);
+    for (int i = 0; i < 4; ++i)
+    {
+        oskar_binary_write_mem_ext(f, data[i], group, tags[i], 0, 0, status);
+        oskar_mem_free(data[i], status);
+    }
+    oskar_binary_free(f);
+    oskar_mem_free(key, status);
+}
+
+static void copy_file(const std::string& from, const std::string& to)
+{
+    FILE* in = fopen(from.c_str(), "rb");
+    FILE* out = fopen(to.c_str(), "wb");
+    ASSERT_TRUE(in != 0);
+    ASSERT_TRUE(out != 0);
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+        fwrite(buffer, 1, n, out);
+    fclose(in);
+    fclose(out);
+}
+
+TEST(imager, w_kernels_parallel)
+{
+#ifdef _OPENMP
+    int status = 0;
+    Kernels serial = make_kernels(2.0, 0, 1, &status);
+    Kernels parallel = make_kernels(2.0, 0, 4, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    expect_same(serial, parallel);
+#endif
+}
+
+TEST(imager, w_kernel_cache)
+{
+    int status = 0;
+    oskar_dir_remove(cache_dir);
+    ASSERT_TRUE(oskar_dir_mkpath(cache_dir));
+
+    // Generate kernels without the cache, then write and reload them.
+    Kernels ref = make_kernels(2.0, 0, 1, &status);
+    Kernels written = make_kernels(2.0, cache_dir, 1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    std::vector<std::string> files = cache_files();
+    ASSERT_EQ(1u, files.size());
+    Kernels loaded = make_kernels(2.0, cache_dir, 1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    expect_same(ref, written);
+    expect_same(ref, loaded);
+
+    // Check that the kernels really come from the file.
+    scale_cache_file(files[0].c_str(), 2.0, &status);
+    Kernels scaled = make_kernels(2.0, cache_dir, 1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(ref.compact.size(), scaled.compact.size());
+    const double* a = (const double*) &ref.compact[0];
+    const double* b = (const double*) &scaled.compact[0];
+    for (size_t i = 0; i < ref.compact.size() / sizeof(double); ++i)
+        ASSERT_EQ(2.0 * a[i], b[i]);
+
+    // Put the file for one field of view in place of the one for another,
+    // and check it is rejected.
+    Kernels ref3 = make_kernels(3.0, 0, 1, &status);
+    (void) make_kernels(3.0, cache_dir, 1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    std::vector<std::string> files2 = cache_files();
+    ASSERT_EQ(2u, files2.size());
+    const std::string& file3 = (files2[0] == files[0]) ?
+            files2[1] : files2[0];
+    copy_file(files[0], file3);
+    Kernels rejected = make_kernels(3.0, cache_dir, 1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    expect_same(ref3, rejected);
+    oskar_dir_remove(cache_dir);
+}
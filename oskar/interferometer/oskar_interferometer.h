@@ -75,6 +75,12 @@ int oskar_interferometer_num_devices(const oskar_Interferometer* h);
 OSKAR_EXPORT
 int oskar_interferometer_num_gpus(const oskar_Interferometer* h);
 
+OSKAR_EXPORT
+int oskar_interferometer_num_sources(const oskar_Interferometer* h);
+
+OSKAR_EXPORT
+int oskar_interferometer_num_threads_per_device(const oskar_Interferometer* h);
+
 OSKAR_EXPORT
 int oskar_interferometer_num_vis_blocks(const oskar_Interferometer* h);
 
@@ -91,6 +97,31 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
 OSKAR_EXPORT
 void oskar_interferometer_run(oskar_Interferometer* h, int* status);
 
+/**
+ * @brief
+ * Enables or disables baseline-dependent averaging of the output.
+ *
+ * @details
+ * If enabled, visibilities written to the Measurement Set are averaged in
+ * time separately on each baseline, until the average would exceed either
+ * the maximum duration, or the maximum distance moved by the baseline in
+ * the uv-plane (in wavelengths, at the highest frequency).
+ * Short baselines are therefore averaged over many more time samples than
+ * long ones. Channels are not averaged. A limit of zero is not applied.
+ *
+ * The OSKAR visibility file, which has a fixed time-baseline layout,
+ * is always written at full resolution. Running the simulator with
+ * averaging enabled but no Measurement Set output is an error.
+ *
+ * @param[in] h                 Handle to simulator.
+ * @param[in] value             If true, enable baseline-dependent averaging.
+ * @param[in] max_duration_sec  Maximum duration of an average, in seconds.
+ * @param[in] max_uvw_distance  Maximum baseline movement, in wavelengths.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_bda(oskar_Interferometer* h, int value,
+        double max_duration_sec, double max_uvw_distance);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
         int* status);
@@ -113,10 +144,56 @@ void oskar_interferometer_set_horizon_clip(oskar_Interferometer* h, int value);
 OSKAR_EXPORT
 void oskar_interferometer_set_log(oskar_Interferometer* h, oskar_Log* log);
 
+/**
+ * @brief
+ * Sets the memory limit used when choosing chunk and block sizes.
+ *
+ * @details
+ * Sets the maximum amount of host memory that the automatically-chosen
+ * sky chunk and visibility block sizes may use.
+ * If this is zero or negative, three quarters of the total physical
+ * memory is used as the limit.
+ *
+ * This has no effect unless the chunk size or the block size is chosen
+ * automatically.
+ *
+ * @param[in] h         Handle to simulator.
+ * @param[in] max_gb    Memory limit, in GB.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_max_memory_usage(oskar_Interferometer* h,
+        double max_gb);
+
+/**
+ * @brief
+ * Sets the maximum number of sources in each sky chunk.
+ *
+ * @details
+ * If \p value is less than 1, the chunk size is chosen automatically
+ * when the simulator is initialised, using the cache sizes and
+ * available memory, and a short timed run of the simulation on
+ * the first sky chunk.
+ *
+ * @param[in] h      Handle to simulator.
+ * @param[in] value  Maximum number of sources per chunk, or 0 for automatic.
+ */
 OSKAR_EXPORT
 void oskar_interferometer_set_max_sources_per_chunk(oskar_Interferometer* h,
-int value);
+        int value);
 
+/**
+ * @brief
+ * Sets the maximum number of time samples in each visibility block.
+ *
+ * @details
+ * If \p value is less than 1, the block size is chosen automatically
+ * when the simulator is initialised, so that the visibility blocks fit
+ * within the memory limit, and each block contains enough work to keep
+ * all compute devices busy.
+ *
+ * @param[in] h      Handle to simulator.
+ * @param[in] value  Maximum number of times per block, or 0 for automatic.
+ */
 OSKAR_EXPORT
 void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
         int value);
@@ -124,6 +201,46 @@ void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
 OSKAR_EXPORT
 void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value);
 
+/**
+ * @brief
+ * Sets the number of host visibility buffers used for each compute device.
+ *
+ * @details
+ * Finished visibility blocks are queued for output, so that the compute
+ * devices can keep running while earlier blocks are written. Each buffer
+ * holds one block, so with \p value buffers, devices may run up to
+ * \p value - 1 blocks ahead of the slowest output file.
+ *
+ * The default is 2 (double buffering). Larger values smooth out
+ * variations in write speed, at the cost of more host memory.
+ *
+ * @param[in] h      Handle to simulator.
+ * @param[in] value  Number of buffers per device (between 2 and 8).
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_num_output_buffers(oskar_Interferometer* h,
+        int value);
+
+/**
+ * @brief
+ * Sets the number of OpenMP threads used by each CPU compute device.
+ *
+ * @details
+ * Each CPU compute device runs its kernels using an OpenMP team of
+ * this size, so fewer devices (and fewer copies of the per-device data)
+ * are needed to use all cores. If the number of devices is chosen
+ * automatically, it is reduced accordingly, so call this function
+ * before oskar_interferometer_set_num_devices().
+ *
+ * GPU devices are unaffected.
+ *
+ * @param[in] h      Handle to simulator.
+ * @param[in] value  Number of threads per CPU device (minimum 1).
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_num_threads_per_device(oskar_Interferometer* h,
+        int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_observation_frequency(oskar_Interferometer* h,
         double start_hz, double inc_hz, int num_channels);
@@ -148,6 +265,84 @@ OSKAR_EXPORT
 void oskar_interferometer_set_sky_model(oskar_Interferometer* h,
         const oskar_Sky* sky, int* status);
 
+/**
+ * @brief
+ * Sets the sky model to use from a chunked OSKAR binary sky model file.
+ *
+ * @details
+ * The file, written using oskar_sky_write_chunked(), is mapped into memory,
+ * and the sky chunks used by the simulator alias the mapped data, so the
+ * sources are not copied, and are only read from the file when needed.
+ *
+ * When the simulator is initialised, the chunk directory in the file is
+ * used to skip chunks that are excluded by the source filters set using
+ * oskar_interferometer_set_sky_model_filter(), or that are below the horizon
+ * of all stations at all times (if horizon clipping is enabled), without
+ * reading their source data.
+ *
+ * This replaces any sky model set using oskar_interferometer_set_sky_model().
+ *
+ * @param[in] h          Handle to simulator.
+ * @param[in] filename   Path of the sky model file.
+ * @param[in,out] status Status return code.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_sky_model_file(oskar_Interferometer* h,
+        const char* filename, int* status);
+
+/**
+ * @brief
+ * Sets the source filters applied to a sky model file.
+ *
+ * @details
+ * Sets the filters applied to the sources in a sky model file set using
+ * oskar_interferometer_set_sky_model_file(), in the same way as
+ * oskar_sky_filter_by_flux() and oskar_sky_filter_by_radius().
+ * The radius is measured from the phase centre of the telescope model.
+ *
+ * This must be called before the simulator is initialised.
+ *
+ * @param[in] h                Handle to simulator.
+ * @param[in] flux_min         Minimum Stokes I flux, in Jy.
+ * @param[in] flux_max         Maximum Stokes I flux, in Jy.
+ * @param[in] radius_inner_rad Inner radius, in radians.
+ * @param[in] radius_outer_rad Outer radius, in radians.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_sky_model_filter(oskar_Interferometer* h,
+        double flux_min, double flux_max, double radius_inner_rad,
+        double radius_outer_rad);
+
+/**
+ * @brief
+ * Sets the number of sky chunks held in host memory at once.
+ *
+ * @details
+ * If \p value is greater than zero, the sky chunks are streamed through a
+ * pool of \p value host buffers, instead of being held in memory for the
+ * whole simulation. A loader thread fills each free buffer with the next
+ * chunk needed, and evaluates its source parameters, ahead of the compute
+ * devices. A buffer is reused once every time step in the block has been
+ * simulated using its chunk.
+ *
+ * Only the chunks of a sky model file set using
+ * oskar_interferometer_set_sky_model_file() are streamed, so that only the
+ * chunks in the pool need to be resident in memory, regardless of the size
+ * of the file. A sky model set using oskar_interferometer_set_sky_model()
+ * is already held in memory, so the pool is not used for it.
+ * Using at least twice as many buffers as compute devices allows the next
+ * chunks to be loaded while the current ones are in use.
+ *
+ * The default is 0 (not streamed).
+ * This must be called before the simulator is initialised.
+ *
+ * @param[in] h      Handle to simulator.
+ * @param[in] value  Number of sky chunks in the pool, or 0 to disable.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_sky_pool_size(oskar_Interferometer* h,
+        int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_telescope_model(oskar_Interferometer* h,
         const oskar_Telescope* model, int* status);
@@ -160,6 +355,20 @@ OSKAR_EXPORT
 void oskar_interferometer_set_zero_failed_gaussians(oskar_Interferometer* h,
         int value);
 
+/**
+ * @brief
+ * Returns the largest number of sky pool buffers used at once.
+ *
+ * @details
+ * Returns the largest number of buffers in the sky chunk pool that held
+ * chunks in use at the same time during the last run, which is never
+ * more than the pool size.
+ *
+ * @param[in] h      Handle to simulator.
+ */
+OSKAR_EXPORT
+int oskar_interferometer_sky_pool_peak(const oskar_Interferometer* h);
+
 OSKAR_EXPORT
 const oskar_VisHeader* oskar_interferometer_vis_header(oskar_Interferometer* h);
 
@@ -29,6 +29,7 @@
 #include "interferometer/oskar_evaluate_jones_E.h"
 #include "interferometer/oskar_jones_get_station_pointer.h"
 #include "telescope/station/oskar_evaluate_station_beam.h"
+#include "telescope/station/oskar_station_work.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,8 +40,10 @@ void oskar_evaluate_jones_E(oskar_Jones* E, int num_points, int coord_type,
         double gast, double frequency_hz, oskar_StationWork* work,
         int time_index, int* status)
 {
-    int i, num_stations;
+    int i, num_stations, mark;
     oskar_Mem *E_st;
+    oskar_MemArena* arena;
+    const oskar_Mem* model_index;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -52,34 +55,45 @@ void oskar_evaluate_jones_E(oskar_Jones* E, int num_points, int coord_type,
         *status = OSKAR_ERR_MEMORY_NOT_ALLOCATED;
         return;
     }
+    model_index = oskar_telescope_station_model_index_const(tel);
+
+    /* Tile beams can be shared between stations with identical tiles only if
+     * station beam duplication is allowed, as both ignore the differences
+     * between the horizons of the stations. */
+    oskar_station_work_set_tile_cache_enabled(work,
+            oskar_telescope_allow_station_beam_duplication(tel));
 
     /* Evaluate the station beams. */
-    E_st = oskar_mem_create_alias(0, 0, 0, status);
+    arena = oskar_station_work_arena(work);
+    mark = oskar_mem_arena_mark(arena);
+    E_st = oskar_mem_arena_alias(arena, 0, 0, 0, status);
     if (oskar_telescope_allow_station_beam_duplication(tel) &&
-            oskar_telescope_identical_stations(tel))
+            (int)oskar_mem_length(model_index) >= num_stations)
     {
-        /* Identical stations. */
-        oskar_Mem *E0; /* Pointer to row of E for station 0. */
-        const oskar_Station* station0;
-
-        /* Evaluate the beam pattern for station 0 */
-        E0 = oskar_mem_create_alias(0, 0, 0, status);
-        station0 = oskar_telescope_station_const(tel, 0);
-        oskar_jones_get_station_pointer(E0, E, 0, status);
-
-        oskar_evaluate_station_beam(E0, num_points, coord_type, x, y, z,
-                oskar_telescope_phase_centre_ra_rad(tel),
-                oskar_telescope_phase_centre_dec_rad(tel),
-                station0, work, time_index, frequency_hz, gast, status);
-
-        /* Copy E for station 0 into memory for other stations. */
-        for (i = 1; i < num_stations; ++i)
+        /* Evaluate the beam once for each distinct station model,
+         * and copy it for all other stations that use the same model. */
+        oskar_Mem *E0; /* Pointer to row of E for first station of model. */
+        const int* index;
+        E0 = oskar_mem_arena_alias(arena, 0, 0, 0, status);
+        index = oskar_mem_int_const(model_index, status);
+        for (i = 0; i < num_stations; ++i)
         {
             oskar_jones_get_station_pointer(E_st, E, i, status);
-            oskar_mem_copy_contents(E_st, E0, 0, 0,
-                    oskar_mem_length(E0), status);
+            if (index[i] == i)
+            {
+                oskar_evaluate_station_beam(E_st, num_points, coord_type,
+                        x, y, z, oskar_telescope_phase_centre_ra_rad(tel),
+                        oskar_telescope_phase_centre_dec_rad(tel),
+                        oskar_telescope_station_const(tel, i), work,
+                        time_index, frequency_hz, gast, status);
+            }
+            else
+            {
+                oskar_jones_get_station_pointer(E0, E, index[i], status);
+                oskar_mem_copy_contents(E_st, E0, 0, 0,
+                        oskar_mem_length(E0), status);
+            }
         }
-        oskar_mem_free(E0, status);
     }
     else
     {
@@ -95,7 +109,8 @@ void oskar_evaluate_jones_E(oskar_Jones* E, int num_points, int coord_type,
                     station, work, time_index, frequency_hz, gast, status);
         }
     }
-    oskar_mem_free(E_st, status);
+    oskar_mem_arena_release(arena, mark);
+    oskar_station_work_set_tile_cache_enabled(work, 0);
 }
 
 #ifdef __cplusplus
@@ -45,6 +45,7 @@ void oskar_evaluate_jones_K_f(float2* jones, int num_sources, const float* l,
     int a, s;
 
     /* Loop over stations. */
+#pragma omp parallel for private(a, s)
     for (a = 0; a < num_stations; ++a)
     {
         float us, vs, ws;
@@ -95,6 +96,7 @@ void oskar_evaluate_jones_K_d(double2* jones, int num_sources, const double* l,
     int a, s;
 
     /* Loop over stations. */
+#pragma omp parallel for private(a, s)
     for (a = 0; a < num_stations; ++a)
     {
         double us, vs, ws;
@@ -26,6 +26,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "math/oskar_angular_distance.h"
 #include "math/oskar_cmath.h"
 #include "convert/oskar_convert_ecef_to_station_uvw.h"
 #include "convert/oskar_convert_ecef_to_baseline_uvw.h"
@@ -43,11 +44,16 @@
 #include "telescope/oskar_telescope.h"
 #include "utility/oskar_cuda_mem_log.h"
 #include "utility/oskar_device_utils.h"
+#include "utility/oskar_get_cache_size.h"
 #include "utility/oskar_get_memory_usage.h"
 #include "utility/oskar_get_num_procs.h"
 #include "utility/oskar_thread.h"
 #include "utility/oskar_timer.h"
+#include "vis/oskar_vis_bda.h"
 #include "vis/oskar_vis_block.h"
+#ifndef OSKAR_NO_MS
+#include "vis/oskar_vis_bda_write_ms.h"
+#endif
 #include "vis/oskar_vis_block_write_ms.h"
 #include "vis/oskar_vis_header.h"
 #include "vis/oskar_vis_header_write_ms.h"
@@ -65,21 +71,53 @@
 extern "C" {
 #endif
 
+/* Maximum number of channels for which Jones K is advanced by phasor
+ * multiplication before it is evaluated directly again. */
+#define K_RECURRENCE_INTERVAL 16
+
+/* Limits for the automatically-chosen number of sources per chunk. */
+#define AUTO_MAX_SOURCES_PER_CHUNK 65536
+#define AUTO_MIN_SOURCES_PER_CHUNK 256
+
+/* Target compute time for each automatically-sized block, in seconds. */
+#define AUTO_BLOCK_TARGET_SEC 5.0
+
+/* Approximate number of arrays held for each source in a sky model. */
+#define SKY_ARRAYS_PER_SOURCE 24
+
+/* Maximum number of host visibility buffers for each device. */
+#define MAX_OUTPUT_BUFFERS 8
+
+/* Margin added to the radius of each sky model file chunk, in radians,
+ * when testing it against the source filters and the horizon. */
+#define SKY_CHUNK_MARGIN 1e-4
+
 /* Memory allocated per compute device (may be either CPU or GPU). */
 struct DeviceData
 {
     /* Host memory. */
-    oskar_VisBlock* vis_block_cpu[2]; /* On host, for copy back & write. */
+    /* On host, for copy back & write. */
+    oskar_VisBlock* vis_block_cpu[MAX_OUTPUT_BUFFERS];
+
+    /* Work units still to do in each block, indexed by output buffer.
+     * Units are taken from the front, and stolen from the back. */
+    int work_begin[MAX_OUTPUT_BUFFERS], work_end[MAX_OUTPUT_BUFFERS];
+    int num_chunk_copies;       /* Number of sky chunks copied. */
 
     /* Device memory. */
     int previous_chunk_index;
     oskar_VisBlock* vis_block;  /* Device memory block. */
-    oskar_Mem *u, *v, *w;
+    double gast;                /* Sidereal time of the current time step. */
+    oskar_Mem *u, *v, *w;       /* Station coordinates at the current time. */
     oskar_Sky* chunk;           /* The unmodified sky chunk being processed. */
     oskar_Sky* chunk_clip;      /* Copy of the chunk after horizon clipping. */
+    oskar_Sky* chunk_stage;     /* Host copy of a streamed chunk, if needed. */
     oskar_Telescope* tel;       /* Telescope model, created as a copy. */
     oskar_Jones *J, *R, *E, *K, *Z;
+    oskar_Jones* K_step;        /* Jones K phasor for one channel increment. */
+    int use_K_step;
     oskar_StationWork* station_work;
+    oskar_MemArena* arena;      /* Temporary handles for each work unit. */
 
     /* Timers. */
     oskar_Timer* tmr_compute;   /* Total time spent filling vis blocks. */
@@ -89,39 +127,90 @@ struct DeviceData
     oskar_Timer* tmr_join;      /* Time spent combining Jones matrices. */
     oskar_Timer* tmr_E;         /* Time spent evaluating E-Jones. */
     oskar_Timer* tmr_K;         /* Time spent evaluating K-Jones. */
+    oskar_Timer* tmr_wait;      /* Time spent waiting for a free buffer. */
 };
 typedef struct DeviceData DeviceData;
 
+/* A host buffer in the pool used to stream the sky chunks, and the work
+ * units (one per time step in the block) that use the chunk it holds. */
+struct SkyPoolSlot;
+struct SkyPoolUnit
+{
+    struct SkyPoolSlot* slot;
+    int time_index;
+};
+typedef struct SkyPoolUnit SkyPoolUnit;
+struct SkyPoolSlot
+{
+    oskar_Sky* sky;
+    int chunk_index;
+    int remaining;              /* Work units still using the chunk. */
+    SkyPoolUnit* units;
+};
+typedef struct SkyPoolSlot SkyPoolSlot;
+
 
 struct oskar_Interferometer
 {
     /* Settings. */
     int prec, num_devices, num_gpus, *gpu_ids, num_channels, num_time_steps;
-    int max_sources_per_chunk, max_times_per_block;
+    int num_threads_per_device, max_sources_per_chunk, max_times_per_block;
     int apply_horizon_clip, force_polarised_ms, zero_failed_gaussians;
-    int coords_only;
+    int coords_only, bda_enabled, auto_chunk_size, auto_times_per_block;
+    int num_buffers, sky_pool_size;
+    double max_memory_gb;
     double freq_start_hz, freq_inc_hz, time_start_mjd_utc, time_inc_sec;
+    double bda_max_duration_sec, bda_max_uvw_distance;
     double source_min_jy, source_max_jy;
+    double sky_flux_min, sky_flux_max, sky_radius_inner, sky_radius_outer;
     char correlation_type, *vis_name, *ms_name, *settings_path;
 
     /* State. */
-    int init_sky, work_unit_index, status;
+    int init_sky, auto_sized, status;
+    size_t num_allocations; /* Memory allocations made during the run. */
     oskar_Mutex* mutex;
-    oskar_Barrier* barrier;
+    int work_block[MAX_OUTPUT_BUFFERS]; /* Block index of each work range. */
+    int output_block[MAX_OUTPUT_BUFFERS];   /* Block index in each buffer. */
+    int writes_pending[MAX_OUTPUT_BUFFERS]; /* Writers yet to finish. */
+    int num_writers;
+    oskar_Queue* block_done[MAX_OUTPUT_BUFFERS]; /* Signals from devices. */
+    oskar_Queue* write_queue[2]; /* Finalised blocks for each writer. */
+    oskar_Queue** buffer_free;   /* Signals to each device when written. */
+
+    /* Pool of host buffers used to stream the sky chunks. */
+    int sky_pool_active, sky_pool_in_use, sky_pool_peak;
+    SkyPoolSlot* sky_pool;
+    SkyPoolUnit sky_pool_end;    /* Marks the end of the units in a block. */
+    oskar_Queue* sky_pool_free;  /* Buffers ready to be loaded. */
+    oskar_Queue* sky_pool_units[MAX_OUTPUT_BUFFERS]; /* Loaded work units. */
+    oskar_Timer* tmr_load;       /* Time spent loading sky chunks. */
 
     /* Sky model and telescope model. */
     int num_sources_total, num_sky_chunks;
     oskar_Sky** sky_chunks;
     oskar_Telescope* tel;
 
+    /* Memory-mapped sky model file, and the source ranges in use.
+     * Sources remaining in partly filtered chunks are copied to a host
+     * sky model, so that the mapped file is never modified. */
+    oskar_Binary* sky_file;
+    oskar_Sky* sky_file_model;
+    oskar_Sky* sky_file_filtered;
+    oskar_Mem* sky_file_directory;
+    int sky_file_chunk_size, sky_file_num_chunks, num_sky_ranges;
+    int *sky_range_start, *sky_range_size, *sky_range_filtered;
+
     /* Output data and file handles. */
     oskar_Log* log;
     oskar_VisHeader* header;
     oskar_MeasurementSet* ms;
     oskar_Binary* vis;
+    oskar_VisBda* bda;      /* Baseline-dependent averager for the MS. */
+    size_t bda_rows_out;    /* Number of averaged rows written. */
     oskar_Mem* temp;
     oskar_Timer* tmr_sim;   /* The total time for the simulation. */
-    oskar_Timer* tmr_write; /* The time spent writing vis blocks. */
+    oskar_Timer* tmr_write_ms;  /* The time spent writing the MS. */
+    oskar_Timer* tmr_write_vis; /* The time spent writing the vis file. */
 
     /* Array of DeviceData structures, one per compute device. */
     DeviceData* d;
@@ -134,12 +223,33 @@ typedef struct oskar_Interferometer oskar_Interferometer;
 
 /* Private method prototypes. */
 
+static void set_up_time_step(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, double gast, int* status);
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
         oskar_Sky* sky, int channel_index_block, int time_index_block,
         int time_index_simulation, int* status);
 static void free_device_data(oskar_Interferometer* h, int* status);
 static void set_up_device_data(oskar_Interferometer* h, int* status);
 static void set_up_vis_header(oskar_Interferometer* h, int* status);
+static int next_work_unit(oskar_Interferometer* h, int block_index,
+        int device_id, int num_units);
+static void write_block_ms(oskar_Interferometer* h,
+        const oskar_VisBlock* block, int block_index, int* status);
+static void write_block_vis(oskar_Interferometer* h,
+        const oskar_VisBlock* block, int block_index, int* status);
+static void auto_size(oskar_Interferometer* h, int* status);
+static void load_sky_chunk(oskar_Interferometer* h, int chunk_index,
+        oskar_Sky* sky, int* num_failed, int* status);
+static void load_sky_blocks(oskar_Interferometer* h);
+static void release_sky_slot(oskar_Interferometer* h, SkyPoolSlot* slot);
+static void create_sky_pool(oskar_Interferometer* h, int* status);
+static void free_sky_pool(oskar_Interferometer* h, int* status);
+static void close_sky_pool(oskar_Interferometer* h);
+static void free_sky_model(oskar_Interferometer* h, int* status);
+static void alias_sky_ranges(oskar_Interferometer* h, int max_sources,
+        int* status);
+static void select_sky_file_chunks(oskar_Interferometer* h, int* status);
+static int sky_streamed(const oskar_Interferometer* h);
 static void record_timing(oskar_Interferometer* h);
 static unsigned int disp_width(unsigned int value);
 static void system_mem_log(oskar_Log* log);
@@ -163,16 +273,25 @@ void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
     if (!h->header)
         set_up_vis_header(h, status);
 
-    /* Calculate source parameters if required. */
+    /* Select the chunks to use from a sky model file if required. */
+    if (!h->init_sky && h->sky_file_model)
+        select_sky_file_chunks(h, status);
+
+    /* Calculate source parameters if required.
+     * If the sky chunks are streamed, this is done as each one is loaded. */
     if (!h->init_sky)
     {
         int i, num_failed = 0;
         double ra0, dec0;
+        if (h->sky_pool_size > 0 && !h->sky_file_model)
+            oskar_log_warning(h->log, "The sky chunk pool is used only "
+                    "with a chunked OSKAR binary sky model file. "
+                    "The sky model will be held in memory.");
 
         /* Compute source direction cosines relative to phase centre. */
         ra0 = oskar_telescope_phase_centre_ra_rad(h->tel);
         dec0 = oskar_telescope_phase_centre_dec_rad(h->tel);
-        for (i = 0; i < h->num_sky_chunks; ++i)
+        for (i = 0; i < h->num_sky_chunks && !sky_streamed(h); ++i)
         {
             oskar_sky_evaluate_relative_directions(h->sky_chunks[i],
                     ra0, dec0, status);
@@ -195,6 +314,10 @@ void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
         h->init_sky = 1;
     }
 
+    /* Choose the chunk and block sizes if required. */
+    if ((h->auto_chunk_size || h->auto_times_per_block) && !h->auto_sized)
+        auto_size(h, status);
+
     /* Check that each compute device has been set up. */
     set_up_device_data(h, status);
 }
@@ -212,18 +335,23 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
     h = (oskar_Interferometer*) calloc(1, sizeof(oskar_Interferometer));
     h->prec      = precision;
     h->tmr_sim   = oskar_timer_create(OSKAR_TIMER_NATIVE);
-    h->tmr_write = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    h->tmr_write_ms  = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    h->tmr_write_vis = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->temp      = oskar_mem_create(precision, OSKAR_CPU, 0, status);
     h->mutex     = oskar_mutex_create();
-    h->barrier   = oskar_barrier_create(0);
+    h->tmr_load  = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    h->num_buffers = 2;
+    oskar_interferometer_reset_work_unit_index(h);
 
     /* Set sensible defaults. */
-    h->max_sources_per_chunk = 16384;
+    oskar_interferometer_set_max_sources_per_chunk(h, 16384);
+    h->num_threads_per_device = 1;
     oskar_interferometer_set_gpus(h, -1, 0, status);
     oskar_interferometer_set_num_devices(h, -1);
     oskar_interferometer_set_correlation_type(h, "Cross-correlations", status);
     oskar_interferometer_set_horizon_clip(h, 1);
     oskar_interferometer_set_source_flux_range(h, -DBL_MAX, DBL_MAX);
+    oskar_interferometer_set_sky_model_filter(h, -DBL_MAX, DBL_MAX, 0.0, M_PI);
     oskar_interferometer_set_max_times_per_block(h, 10);
     return h;
 }
@@ -232,7 +360,7 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
 oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         int block_index, int* status)
 {
-    int i, i_active;
+    int i, i_buffer;
     oskar_VisBlock *b0 = 0, *b = 0;
     if (*status) return 0;
 
@@ -240,8 +368,8 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
      * at the end of the block simulation. */
 
     /* Combine all vis blocks into the first one. */
-    i_active = (block_index + 1) % 2;
-    b0 = h->d[0].vis_block_cpu[!i_active];
+    i_buffer = block_index % h->num_buffers;
+    b0 = h->d[0].vis_block_cpu[i_buffer];
     if (!h->coords_only)
     {
         oskar_Mem *xc0 = 0, *ac0 = 0;
@@ -249,7 +377,7 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         ac0 = oskar_vis_block_auto_correlations(b0);
         for (i = 1; i < h->num_devices; ++i)
         {
-            b = h->d[i].vis_block_cpu[!i_active];
+            b = h->d[i].vis_block_cpu[i_buffer];
             if (oskar_vis_block_has_cross_correlations(b))
                 oskar_mem_add(xc0, xc0, oskar_vis_block_cross_correlations(b),
                         oskar_mem_length(xc0), status);
@@ -307,15 +435,14 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
         oskar_device_set(h->gpu_ids[i], status);
         oskar_device_reset();
     }
-    for (i = 0; i < h->num_sky_chunks; ++i)
-        oskar_sky_free(h->sky_chunks[i], status);
+    free_sky_model(h, status);
     oskar_telescope_free(h->tel, status);
     oskar_mem_free(h->temp, status);
     oskar_timer_free(h->tmr_sim);
-    oskar_timer_free(h->tmr_write);
+    oskar_timer_free(h->tmr_write_ms);
+    oskar_timer_free(h->tmr_write_vis);
+    oskar_timer_free(h->tmr_load);
     oskar_mutex_free(h->mutex);
-    oskar_barrier_free(h->barrier);
-    free(h->sky_chunks);
     free(h->gpu_ids);
     free(h->vis_name);
     free(h->ms_name);
@@ -337,6 +464,18 @@ int oskar_interferometer_num_gpus(const oskar_Interferometer* h)
 }
 
 
+int oskar_interferometer_num_sources(const oskar_Interferometer* h)
+{
+    return h ? h->num_sources_total : 0;
+}
+
+
+int oskar_interferometer_num_threads_per_device(const oskar_Interferometer* h)
+{
+    return h ? h->num_threads_per_device : 0;
+}
+
+
 int oskar_interferometer_num_vis_blocks(const oskar_Interferometer* h)
 {
     return (h->num_time_steps + h->max_times_per_block - 1) /
@@ -348,11 +487,13 @@ void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status)
 {
     free_device_data(h, status);
     oskar_binary_free(h->vis);
+    oskar_vis_bda_free(h->bda, status);
     oskar_vis_header_free(h->header, status);
 #ifndef OSKAR_NO_MS
     oskar_ms_close(h->ms);
 #endif
     h->vis = 0;
+    h->bda = 0;
     h->header = 0;
     h->ms = 0;
 }
@@ -360,7 +501,9 @@ void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status)
 
 void oskar_interferometer_reset_work_unit_index(oskar_Interferometer* h)
 {
-    h->work_unit_index = 0;
+    int i;
+    for (i = 0; i < MAX_OUTPUT_BUFFERS; ++i)
+        h->work_block[i] = -1;
 }
 
 
@@ -368,7 +511,7 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         int device_id, int* status)
 {
     double obs_start_mjd, dt_dump_days;
-    int i_active, time_index_start, time_index_end;
+    int i_buffer, time_index_start, time_index_end;
     int num_channels, num_times_block, total_chunks, total_times;
     DeviceData* d;
     if (*status) return;
@@ -386,9 +529,16 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
     /* Set the GPU to use. (Supposed to be a very low-overhead call.) */
     if (device_id >= 0 && device_id < h->num_gpus)
         oskar_device_set(h->gpu_ids[device_id], status);
+#ifdef _OPENMP
+    else
+    {
+        /* Set the size of the OpenMP team used by CPU kernels. */
+        omp_set_num_threads(h->num_threads_per_device);
+    }
+#endif
 
     /* Clear the visibility block. */
-    i_active = block_index % 2; /* Index of the active buffer. */
+    i_buffer = block_index % h->num_buffers; /* Index of host buffer. */
     d = &(h->d[device_id]);
     oskar_timer_resume(d->tmr_compute);
     oskar_vis_block_clear(d->vis_block, status);
@@ -410,43 +560,78 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
     oskar_vis_block_set_start_time_index(d->vis_block, time_index_start);
 
     /* Go though all possible work units in the block. A work unit is defined
-     * as the simulation for one time and one sky chunk. */
+     * as the simulation for one time and one sky chunk.
+     * If the sky chunks are streamed, the work units are taken in the order
+     * they are loaded, otherwise they are shared out between the devices. */
     while (!h->coords_only)
     {
         oskar_Sky* sky;
+        SkyPoolSlot* slot = 0;
+        double gast, mjd;
         int i_work_unit, i_chunk, i_time, i_channel, sim_time_idx;
 
-        oskar_mutex_lock(h->mutex);
-        i_work_unit = (h->work_unit_index)++;
-        oskar_mutex_unlock(h->mutex);
-        if ((i_work_unit >= num_times_block * total_chunks) || *status) break;
+        if (h->sky_pool_active)
+        {
+            SkyPoolUnit* unit = (SkyPoolUnit*)
+                    oskar_queue_pop(h->sky_pool_units[i_buffer]);
+            if (!unit || unit == &h->sky_pool_end) break;
+            slot = unit->slot;
+            if (*status)
+            {
+                release_sky_slot(h, slot);
+                continue;
+            }
+            i_chunk = slot->chunk_index;
+            i_time  = unit->time_index;
+        }
+        else
+        {
+            i_work_unit = next_work_unit(h, block_index, device_id,
+                    num_times_block * total_chunks);
+            if (i_work_unit < 0 || *status) break;
 
-        /* Convert slice index to chunk/time index. */
-        i_chunk      = i_work_unit / num_times_block;
-        i_time       = i_work_unit - i_chunk * num_times_block;
+            /* Convert slice index to chunk/time index. */
+            i_chunk = i_work_unit / num_times_block;
+            i_time  = i_work_unit - i_chunk * num_times_block;
+        }
         sim_time_idx = time_index_start + i_time;
+        oskar_mem_arena_reset(d->arena);
 
         /* Copy sky chunk to device only if different from the previous one. */
         if (i_chunk != d->previous_chunk_index)
         {
             oskar_timer_resume(d->tmr_copy);
-            oskar_sky_copy(d->chunk, h->sky_chunks[i_chunk], status);
+            if (slot)
+                oskar_sky_copy(d->chunk, slot->sky, status);
+            else if (sky_streamed(h))
+            {
+                /* Streamed, but not by oskar_interferometer_run(). */
+                load_sky_chunk(h, i_chunk, d->chunk_stage, 0, status);
+                oskar_sky_copy(d->chunk, d->chunk_stage, status);
+            }
+            else
+                oskar_sky_copy(d->chunk, h->sky_chunks[i_chunk], status);
             oskar_timer_pause(d->tmr_copy);
+            d->num_chunk_copies++;
         }
+        if (slot) release_sky_slot(h, slot);
         sky = h->apply_horizon_clip ? d->chunk_clip : d->chunk;
+        mjd = obs_start_mjd + dt_dump_days * (sim_time_idx + 0.5);
+        gast = oskar_convert_mjd_to_gast_fast(mjd);
 
         /* Apply horizon clip if required. */
         if (h->apply_horizon_clip)
         {
-            double gast, mjd;
-            mjd = obs_start_mjd + dt_dump_days * (sim_time_idx + 0.5);
-            gast = oskar_convert_mjd_to_gast_fast(mjd);
             oskar_timer_resume(d->tmr_clip);
             oskar_sky_horizon_clip(d->chunk_clip, d->chunk, d->tel, gast,
                     d->station_work, status);
             oskar_timer_pause(d->tmr_clip);
         }
 
+        /* Evaluate everything that does not depend on frequency once,
+         * for use by all channels of this time and chunk. */
+        set_up_time_step(h, d, sky, gast, status);
+
         /* Simulate all baselines for all channels for this time and chunk. */
         for (i_channel = 0; i_channel < num_channels; ++i_channel)
         {
@@ -469,7 +654,7 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
 
     /* Copy the visibility block to host memory. */
     oskar_timer_resume(d->tmr_copy);
-    oskar_vis_block_copy(d->vis_block_cpu[i_active], d->vis_block, status);
+    oskar_vis_block_copy(d->vis_block_cpu[i_buffer], d->vis_block, status);
     oskar_timer_pause(d->tmr_copy);
     oskar_timer_pause(d->tmr_compute);
 }
@@ -485,13 +670,13 @@ typedef struct ThreadArgs ThreadArgs;
 static void* run_blocks(void* arg)
 {
     oskar_Interferometer* h;
-    int b, thread_id, device_id, num_blocks, num_threads, *status;
+    int b, i, thread_id, device_id, num_blocks, num_buffers, *status;
 
     /* Get thread function arguments. */
     h = ((ThreadArgs*)arg)->h;
-    num_threads = ((ThreadArgs*)arg)->num_threads;
     thread_id = ((ThreadArgs*)arg)->thread_id;
     device_id = thread_id - 1;
+    num_buffers = h->num_buffers;
     status = &(h->status);
 
 #ifdef _OPENMP
@@ -502,44 +687,106 @@ static void* run_blocks(void* arg)
 
     /* Loop over blocks of observation time, running simulation and file
      * writing one block at a time. Simulation and file output are overlapped
-     * by using double buffering, and a dedicated thread is used for file
-     * output.
+     * by using a ring of host buffers for each device, and dedicated threads
+     * are used for file output.
      *
-     * Thread 0 is used for file writes.
+     * Thread 0 combines the results from each device, and queues
+     * the finished block for output.
      * Threads 1 to n (mapped to compute devices) do the simulation.
+     * The next threads write the output files: one if there is only
+     * one file, otherwise one each for the Measurement Set and the
+     * OSKAR visibility file, which are written concurrently.
+     * If the sky chunks are streamed, the last thread loads them.
      *
-     * Note that no write is launched on the first loop counter (as no
-     * data are ready yet) and no simulation is performed for the last loop
-     * counter (which corresponds to the last block + 1) as this iteration
-     * simply writes the last block.
+     * There is no barrier between blocks. A device that runs out of work
+     * in one block (after stealing what it can from the others) moves on
+     * to the next, as soon as the host buffer it will use has been written
+     * to all output files.
      */
     num_blocks = oskar_interferometer_num_vis_blocks(h);
-    for (b = 0; b < num_blocks + 1; ++b)
+    if (thread_id > 0 && thread_id <= h->num_devices)
     {
-        if ((thread_id > 0 || num_threads == 1) && b < num_blocks)
+        DeviceData* d = &h->d[device_id];
+        for (b = 0; b < num_blocks; ++b)
+        {
+            /* Wait for the host buffer to be written, if it has been used. */
+            if (b >= num_buffers)
+            {
+                oskar_timer_resume(d->tmr_wait);
+                oskar_queue_pop(h->buffer_free[device_id]);
+                oskar_timer_pause(d->tmr_wait);
+            }
             oskar_interferometer_run_block(h, b, device_id, status);
-        if (thread_id == 0 && b > 0)
+            oskar_queue_push(h->block_done[b % num_buffers], h);
+        }
+    }
+    else if (thread_id > h->num_devices + h->num_writers)
+    {
+        load_sky_blocks(h);
+    }
+    else if (thread_id > h->num_devices)
+    {
+        int* slot;
+        const int writer = thread_id - h->num_devices - 1;
+        while ((slot = (int*) oskar_queue_pop(h->write_queue[writer])) != 0)
         {
-            oskar_VisBlock* block;
-            block = oskar_interferometer_finalise_block(h, b - 1, status);
-            oskar_interferometer_write_block(h, block, b - 1, status);
+            int last;
+            const int i_buffer = (int) (slot - h->output_block);
+            const oskar_VisBlock* block = h->d[0].vis_block_cpu[i_buffer];
+            b = *slot;
+
+            /* Write the block to this thread's file(s). */
+            if (h->num_writers == 1)
+                oskar_interferometer_write_block(h, block, b, status);
+            else if (writer == 0)
+                write_block_ms(h, block, b, status);
+            else
+                write_block_vis(h, block, b, status);
+
+            /* Release the buffers once all files have the block. */
+            oskar_mutex_lock(h->mutex);
+            last = (--h->writes_pending[i_buffer] == 0);
+            oskar_mutex_unlock(h->mutex);
+            if (last && b + num_buffers < num_blocks)
+                for (i = 0; i < h->num_devices; ++i)
+                    oskar_queue_push(h->buffer_free[i], h);
         }
-
-        /* Barrier 1: Reset work unit index and print status. */
-        oskar_barrier_wait(h->barrier);
-        if (thread_id == 0)
+    }
+    else
+    {
+        for (b = 0; b < num_blocks; ++b)
         {
-            oskar_interferometer_reset_work_unit_index(h);
-            if (b < num_blocks && h->log && !*status)
+            int w;
+            const int i_buffer = b % num_buffers;
+
+            /* Wait for all devices to finish the block. */
+            for (i = 0; i < h->num_devices; ++i)
+                oskar_queue_pop(h->block_done[i_buffer]);
+            if (h->log && !*status)
+            {
+                oskar_mutex_lock(h->mutex);
                 oskar_log_message(h->log, 'S', 0, "Block %*i/%i (%3.0f%%) "
                         "complete. Simulation time elapsed: %.3f s",
                         disp_width(num_blocks), b+1, num_blocks,
                         100.0 * (b+1) / (double)num_blocks,
                         oskar_timer_elapsed(h->tmr_sim));
-        }
+                oskar_mutex_unlock(h->mutex);
+            }
 
-        /* Barrier 2: Synchronise before moving to the next block. */
-        oskar_barrier_wait(h->barrier);
+            /* Combine the block, and queue it for output.
+             * This is done even after an error, so that the buffers are
+             * still released and no thread is left waiting. */
+            oskar_interferometer_finalise_block(h, b, status);
+            oskar_mutex_lock(h->mutex);
+            h->output_block[i_buffer] = b;
+            h->writes_pending[i_buffer] = h->num_writers;
+            oskar_mutex_unlock(h->mutex);
+            for (w = 0; w < h->num_writers; ++w)
+                oskar_queue_push(h->write_queue[w],
+                        &h->output_block[i_buffer]);
+        }
+        for (i = 0; i < h->num_writers; ++i)
+            oskar_queue_close(h->write_queue[i]);
     }
     return 0;
 }
@@ -568,12 +815,55 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
         return;
     }
 
+    /* Baseline-dependent averaging applies only to the Measurement Set,
+     * so it is an error to request it without one. */
+    if (h->bda_enabled)
+    {
+        int have_ms = 0;
+#ifndef OSKAR_NO_MS
+        have_ms = (h->ms_name != 0);
+#endif
+        if (!have_ms)
+        {
+            oskar_log_error(h->log, "Baseline-dependent averaging requires "
+                    "a Measurement Set output. It cannot be applied to the "
+                    "OSKAR visibility file.");
+            *status = OSKAR_ERR_INVALID_ARGUMENT;
+            return;
+        }
+        if (h->vis_name)
+            oskar_log_warning(h->log, "Baseline-dependent averaging is "
+                    "applied only to the Measurement Set. The OSKAR "
+                    "visibility file will be written at full resolution.");
+    }
+
     /* Initialise if required. */
     oskar_interferometer_check_init(h, status);
 
-    /* Set up worker threads. */
-    num_threads = h->num_devices + 1;
-    oskar_barrier_set_num_threads(h->barrier, num_threads);
+    /* Write the Measurement Set and the OSKAR visibility file concurrently,
+     * if both are required. */
+    h->num_writers = 1;
+#ifndef OSKAR_NO_MS
+    if (h->ms_name && h->vis_name)
+        h->num_writers = 2;
+#endif
+
+    /* Set up worker threads, and the queues used to synchronise them. */
+    num_threads = 1 + h->num_devices + h->num_writers;
+    h->sky_pool_active = (sky_streamed(h) && !h->coords_only);
+    if (h->sky_pool_active)
+    {
+        create_sky_pool(h, status);
+        num_threads++;
+    }
+    for (i = 0; i < h->num_buffers; ++i)
+        h->block_done[i] = oskar_queue_create(h->num_devices);
+    for (i = 0; i < h->num_writers; ++i)
+        h->write_queue[i] = oskar_queue_create(h->num_buffers);
+    h->buffer_free = (oskar_Queue**) calloc(h->num_devices,
+            sizeof(oskar_Queue*));
+    for (i = 0; i < h->num_devices; ++i)
+        h->buffer_free[i] = oskar_queue_create(h->num_buffers);
     threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
     args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
     for (i = 0; i < num_threads; ++i)
@@ -592,6 +882,18 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
             oskar_cuda_mem_log(h->log, 0, h->gpu_ids[i]);
 #endif
         system_mem_log(h->log);
+        oskar_log_section(h->log, 'M', "Compute devices");
+        oskar_log_value(h->log, 'M', 0, "Num. devices", "%d", h->num_devices);
+        oskar_log_value(h->log, 'M', 0, "Num. GPUs", "%d", h->num_gpus);
+        if (h->num_devices > h->num_gpus)
+        {
+            int num_threads_per_device = 1;
+#ifdef _OPENMP
+            num_threads_per_device = h->num_threads_per_device;
+#endif
+            oskar_log_value(h->log, 'M', 0, "Threads per CPU device",
+                    "%d", num_threads_per_device);
+        }
         oskar_log_section(h->log, 'M', "Starting simulation...");
     }
 
@@ -603,6 +905,7 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
 
     /* Start the worker threads. */
     oskar_interferometer_reset_work_unit_index(h);
+    h->num_allocations = oskar_mem_allocation_count();
     for (i = 0; i < num_threads; ++i)
         threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
 
@@ -612,8 +915,18 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
         oskar_thread_join(threads[i]);
         oskar_thread_free(threads[i]);
     }
+    h->num_allocations = oskar_mem_allocation_count() - h->num_allocations;
     free(threads);
     free(args);
+    for (i = 0; i < h->num_buffers; ++i)
+        oskar_queue_free(h->block_done[i]);
+    for (i = 0; i < h->num_writers; ++i)
+        oskar_queue_free(h->write_queue[i]);
+    for (i = 0; i < h->num_devices; ++i)
+        oskar_queue_free(h->buffer_free[i]);
+    free(h->buffer_free);
+    h->buffer_free = 0;
+    free_sky_pool(h, status);
 
     /* Get status code. */
     *status = h->status;
@@ -627,6 +940,13 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
             oskar_cuda_mem_log(h->log, 0, h->gpu_ids[i]);
 #endif
         system_mem_log(h->log);
+        oskar_log_message(h->log, 'M', 0, "Peak memory used by simulator: "
+                "%.1f MB", oskar_get_peak_memory_usage() / (1024. * 1024.));
+        if (sky_streamed(h))
+            oskar_log_message(h->log, 'M', 0, "Sky chunk pool: "
+                    "%d of %d buffers used at once, %d sources each",
+                    h->sky_pool_peak, h->sky_pool_size,
+                    h->max_sources_per_chunk);
     }
 
     /* If there are sources in the simulation and the station beam is not
@@ -670,6 +990,11 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
         if (h->ms_name)
             oskar_log_value(h->log, 'M', 1,
                     "Measurement Set", "%s", h->ms_name);
+        if (h->bda && h->bda_rows_out > 0)
+            oskar_log_value(h->log, 'M', 1, "Averaged MS rows",
+                    "%lu (%.1fx fewer)", (unsigned long) h->bda_rows_out,
+                    oskar_vis_bda_num_input_rows(h->bda) /
+                    (double) h->bda_rows_out);
 
         /* Write simulation log to the output files. */
         log_data = oskar_log_file_data(h->log, &log_size);
@@ -688,6 +1013,15 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
 }
 
 
+void oskar_interferometer_set_bda(oskar_Interferometer* h, int value,
+        double max_duration_sec, double max_uvw_distance)
+{
+    h->bda_enabled = value;
+    h->bda_max_duration_sec = max_duration_sec;
+    h->bda_max_uvw_distance = max_uvw_distance;
+}
+
+
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
         int* status)
 {
@@ -771,17 +1105,44 @@ void oskar_interferometer_set_log(oskar_Interferometer* h, oskar_Log* log)
 }
 
 
+void oskar_interferometer_set_max_memory_usage(oskar_Interferometer* h,
+        double max_gb)
+{
+    h->max_memory_gb = max_gb;
+    h->auto_sized = 0;
+}
+
+
 void oskar_interferometer_set_max_sources_per_chunk(oskar_Interferometer* h,
         int value)
 {
-    h->max_sources_per_chunk = value;
+    /* If automatic, split the sky model into the largest chunks allowed,
+     * which will be divided up later if required. */
+    h->auto_chunk_size = (value < 1);
+    h->max_sources_per_chunk = (value < 1) ?
+            AUTO_MAX_SOURCES_PER_CHUNK : value;
+    h->auto_sized = 0;
 }
 
 
 void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
         int value)
 {
-    h->max_times_per_block = value;
+    h->auto_times_per_block = (value < 1);
+    h->max_times_per_block = (value < 1) ? 1 : value;
+    h->auto_sized = 0;
+}
+
+
+void oskar_interferometer_set_num_output_buffers(oskar_Interferometer* h,
+        int value)
+{
+    int status = 0;
+    free_device_data(h, &status);
+    if (value < 2) value = 2;
+    if (value > MAX_OUTPUT_BUFFERS) value = MAX_OUTPUT_BUFFERS;
+    h->num_buffers = value;
+    h->auto_sized = 0;
 }
 
 
@@ -790,7 +1151,8 @@ void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value)
     int status = 0;
     free_device_data(h, &status);
     if (value < 1)
-        value = (h->num_gpus == 0) ? (oskar_get_num_procs() - 1) : h->num_gpus;
+        value = (h->num_gpus == 0) ? ((oskar_get_num_procs() - 1) /
+                h->num_threads_per_device) : h->num_gpus;
     if (value < 1) value = 1;
     h->num_devices = value;
     h->d = (DeviceData*) realloc(h->d, h->num_devices * sizeof(DeviceData));
@@ -798,6 +1160,17 @@ void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value)
 }
 
 
+void oskar_interferometer_set_num_threads_per_device(oskar_Interferometer* h,
+        int value)
+{
+    int status = 0;
+    free_device_data(h, &status);
+    if (value < 1)
+        value = 1;
+    h->num_threads_per_device = value;
+}
+
+
 void oskar_interferometer_set_observation_frequency(oskar_Interferometer* h,
         double start_hz, double inc_hz, int num_channels)
 {
@@ -831,15 +1204,10 @@ void oskar_interferometer_set_settings_path(oskar_Interferometer* h,
 void oskar_interferometer_set_sky_model(oskar_Interferometer* h,
         const oskar_Sky* sky, int* status)
 {
-    int i;
     if (*status || !h || !sky) return;
 
     /* Clear the old chunk set. */
-    for (i = 0; i < h->num_sky_chunks; ++i)
-        oskar_sky_free(h->sky_chunks[i], status);
-    free(h->sky_chunks);
-    h->sky_chunks = 0;
-    h->num_sky_chunks = 0;
+    free_sky_model(h, status);
 
     /* Split up the sky model into chunks and store them. */
     h->num_sources_total = oskar_sky_num_sources(sky);
@@ -860,6 +1228,80 @@ void oskar_interferometer_set_sky_model(oskar_Interferometer* h,
 }
 
 
+void oskar_interferometer_set_sky_model_file(oskar_Interferometer* h,
+        const char* filename, int* status)
+{
+    int num_sources;
+    if (*status || !h) return;
+
+    /* Clear the old chunk set. */
+    free_sky_model(h, status);
+    h->init_sky = 0;
+
+    /* Map the file, and read its chunk directory. */
+    h->sky_file = oskar_binary_create(filename, 'r', status);
+    h->sky_file_directory = oskar_sky_read_chunk_directory(h->sky_file,
+            &h->sky_file_chunk_size, &h->sky_file_num_chunks, status);
+    h->sky_file_model = oskar_sky_map(h->sky_file, h->prec, status);
+    if (*status)
+    {
+        free_sky_model(h, status);
+        return;
+    }
+
+    /* Use all the sources until the chunks are selected. */
+    num_sources = oskar_sky_num_sources(h->sky_file_model);
+    h->sky_range_start = (int*) calloc(1 + h->sky_file_num_chunks,
+            sizeof(int));
+    h->sky_range_size = (int*) calloc(1 + h->sky_file_num_chunks,
+            sizeof(int));
+    h->sky_range_filtered = (int*) calloc(1 + h->sky_file_num_chunks,
+            sizeof(int));
+    if (num_sources > 0)
+    {
+        h->num_sky_ranges = 1;
+        h->sky_range_size[0] = num_sources;
+    }
+    alias_sky_ranges(h, h->max_sources_per_chunk, status);
+
+    /* Print summary data. */
+    if (h->log)
+    {
+        oskar_log_section(h->log, 'M', "Sky model summary");
+        oskar_log_value(h->log, 'M', 0, "Sky model file", "%s", filename);
+        oskar_log_value(h->log, 'M', 0, "Num. sources", "%d",
+                h->num_sources_total);
+        oskar_log_value(h->log, 'M', 0, "Num. file chunks", "%d",
+                h->sky_file_num_chunks);
+    }
+}
+
+
+void oskar_interferometer_set_sky_model_filter(oskar_Interferometer* h,
+        double flux_min, double flux_max, double radius_inner_rad,
+        double radius_outer_rad)
+{
+    h->sky_flux_min = flux_min;
+    h->sky_flux_max = flux_max;
+    h->sky_radius_inner = radius_inner_rad;
+    h->sky_radius_outer = radius_outer_rad;
+}
+
+
+void oskar_interferometer_set_sky_pool_size(oskar_Interferometer* h,
+        int value)
+{
+    int status = 0;
+    free_device_data(h, &status);
+    if (value < 0) value = 0;
+
+    /* Source parameters are evaluated for all chunks if not streamed. */
+    if (value == 0 && h->sky_pool_size > 0)
+        h->init_sky = 0;
+    h->sky_pool_size = value;
+}
+
+
 void oskar_interferometer_set_telescope_model(oskar_Interferometer* h,
         const oskar_Telescope* model, int* status)
 {
@@ -930,6 +1372,12 @@ void oskar_interferometer_set_zero_failed_gaussians(oskar_Interferometer* h,
 }
 
 
+int oskar_interferometer_sky_pool_peak(const oskar_Interferometer* h)
+{
+    return h ? h->sky_pool_peak : 0;
+}
+
+
 const oskar_VisHeader* oskar_interferometer_vis_header(oskar_Interferometer* h)
 {
     return h->header;
@@ -938,33 +1386,144 @@ const oskar_VisHeader* oskar_interferometer_vis_header(oskar_Interferometer* h)
 
 void oskar_interferometer_write_block(oskar_Interferometer* h,
         const oskar_VisBlock* block, int block_index, int* status)
+{
+    write_block_ms(h, block, block_index, status);
+    write_block_vis(h, block, block_index, status);
+}
+
+
+/* Private methods. */
+
+/* The Measurement Set and the OSKAR visibility file are written by
+ * separate functions, which may be called from different threads:
+ * each touches only its own file handle and timer. */
+static void write_block_ms(oskar_Interferometer* h,
+        const oskar_VisBlock* block, int block_index, int* status)
 {
     if (*status) return;
 
-    /* Open files only if required, and write the block into them. */
-    oskar_timer_resume(h->tmr_write);
+    /* Open the Measurement Set only if required, and write the block. */
+    oskar_timer_resume(h->tmr_write_ms);
 #ifndef OSKAR_NO_MS
     if (h->ms_name && !h->ms)
         h->ms = oskar_vis_header_write_ms(h->header, h->ms_name, OSKAR_TRUE,
                 h->force_polarised_ms, status);
-    if (h->ms) oskar_vis_block_write_ms(block, h->header, h->ms, status);
+    if (h->ms && h->bda_enabled)
+    {
+        /* Write any baseline averages completed by this block. */
+        if (!h->bda)
+        {
+            h->bda = oskar_vis_bda_create(h->header, h->bda_max_duration_sec,
+                    h->bda_max_uvw_distance, status);
+            h->bda_rows_out = 0;
+        }
+        oskar_vis_bda_add_block(h->bda, block, status);
+        if (block_index == oskar_interferometer_num_vis_blocks(h) - 1)
+            oskar_vis_bda_flush(h->bda, status);
+        oskar_vis_bda_write_ms(h->bda, h->ms, status);
+        h->bda_rows_out += oskar_vis_bda_num_rows(h->bda);
+        oskar_vis_bda_clear_output(h->bda);
+    }
+    else if (h->ms)
+        oskar_vis_block_write_ms(block, h->header, h->ms, status);
+#else
+    (void) block;
+    (void) block_index;
 #endif
+    oskar_timer_pause(h->tmr_write_ms);
+}
+
+
+static void write_block_vis(oskar_Interferometer* h,
+        const oskar_VisBlock* block, int block_index, int* status)
+{
+    if (*status) return;
+
+    /* Open the OSKAR visibility file only if required, and write the block. */
+    oskar_timer_resume(h->tmr_write_vis);
     if (h->vis_name && !h->vis)
         h->vis = oskar_vis_header_write(h->header, h->vis_name, status);
     if (h->vis) oskar_vis_block_write(block, h->vis, block_index, status);
-    oskar_timer_pause(h->tmr_write);
+    oskar_timer_pause(h->tmr_write_vis);
 }
 
 
-/* Private methods. */
+static void set_up_time_step(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, double gast, int* status)
+{
+    int num_stations, num_src;
+    double ra0, dec0;
+    const oskar_Mem *x, *y, *z;
+    if (*status) return;
+
+    /* Get dimensions. */
+    num_stations = oskar_telescope_num_stations(d->tel);
+    num_src      = oskar_sky_num_sources(sky);
+    d->gast      = gast;
+
+    /* Evaluate station u,v,w coordinates. */
+    ra0 = oskar_telescope_phase_centre_ra_rad(d->tel);
+    dec0 = oskar_telescope_phase_centre_dec_rad(d->tel);
+    x = oskar_telescope_station_true_x_offset_ecef_metres_const(d->tel);
+    y = oskar_telescope_station_true_y_offset_ecef_metres_const(d->tel);
+    z = oskar_telescope_station_true_z_offset_ecef_metres_const(d->tel);
+    oskar_convert_ecef_to_station_uvw(num_stations, x, y, z, ra0, dec0, gast,
+            d->u, d->v, d->w, status);
+
+    /* Set dimensions of Jones matrices. */
+    if (d->R)
+        oskar_jones_set_size(d->R, num_stations, num_src, status);
+    if (d->Z)
+        oskar_jones_set_size(d->Z, num_stations, num_src, status);
+    oskar_jones_set_size(d->J, num_stations, num_src, status);
+    oskar_jones_set_size(d->E, num_stations, num_src, status);
+    oskar_jones_set_size(d->K, num_stations, num_src, status);
+
+    /* Evaluate the Jones K phasor for a step of one channel.
+     * The geometric phase is linear in frequency, so Jones K for the next
+     * channel is Jones K for this channel multiplied by this phasor.
+     * This can't be used if sources are filtered by their (scaled) flux,
+     * as the filter may give a different result in each channel. */
+    if (d->K_step)
+    {
+        oskar_jones_set_size(d->K_step, num_stations, num_src, status);
+        if (num_src > 0 && h->source_min_jy <= -DBL_MAX &&
+                h->source_max_jy >= DBL_MAX)
+        {
+            oskar_timer_resume(d->tmr_K);
+            oskar_evaluate_jones_K(d->K_step, num_src, oskar_sky_l_const(sky),
+                    oskar_sky_m_const(sky), oskar_sky_n_const(sky),
+                    d->u, d->v, d->w, h->freq_inc_hz, oskar_sky_I_const(sky),
+                    h->source_min_jy, h->source_max_jy, status);
+            oskar_timer_pause(d->tmr_K);
+            d->use_K_step = 1;
+        }
+        else d->use_K_step = 0;
+    }
+
+    /* Source directions have changed, so discard any cached station beam
+     * coordinates from the previous time step or chunk. */
+    oskar_station_work_clear_cache(d->station_work);
+
+    /* Evaluate parallactic angle (Jones R: matrix).
+     * TODO Move this into station beam evaluation instead. */
+    if (d->R && num_src > 0)
+    {
+        oskar_timer_resume(d->tmr_E);
+        oskar_evaluate_jones_R(d->R, num_src, oskar_sky_ra_rad_const(sky),
+                oskar_sky_dec_rad_const(sky), d->tel, gast, status);
+        oskar_timer_pause(d->tmr_E);
+    }
+}
+
 
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
         oskar_Sky* sky, int channel_index_block, int time_index_block,
         int time_index_simulation, int* status)
 {
     int num_baselines, num_stations, num_src, num_times_block, num_channels;
-    double dt_dump_days, t_start, t_dump, gast, frequency, ra0, dec0;
-    const oskar_Mem *x, *y, *z;
+    int mark;
+    double gast, frequency;
     oskar_Mem* alias = 0;
 
     /* Get dimensions. */
@@ -978,34 +1537,15 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
      * or if block time index requested is outside the valid range. */
     if (num_src == 0 || time_index_block >= num_times_block) return;
 
-    /* Get the time and frequency of the visibility slice being simulated. */
-    dt_dump_days = h->time_inc_sec / 86400.0;
-    t_start = h->time_start_mjd_utc;
-    t_dump = t_start + dt_dump_days * (time_index_simulation + 0.5);
-    gast = oskar_convert_mjd_to_gast_fast(t_dump);
+    /* Get the time and frequency of the visibility slice being simulated.
+     * Station coordinates, Jones dimensions and Jones R have already been
+     * set up for this time step by set_up_time_step(). */
+    gast = d->gast;
     frequency = h->freq_start_hz + channel_index_block * h->freq_inc_hz;
 
     /* Scale source fluxes with spectral index and rotation measure. */
     oskar_sky_scale_flux_with_frequency(sky, frequency, status);
 
-    /* Evaluate station u,v,w coordinates. */
-    ra0 = oskar_telescope_phase_centre_ra_rad(d->tel);
-    dec0 = oskar_telescope_phase_centre_dec_rad(d->tel);
-    x = oskar_telescope_station_true_x_offset_ecef_metres_const(d->tel);
-    y = oskar_telescope_station_true_y_offset_ecef_metres_const(d->tel);
-    z = oskar_telescope_station_true_z_offset_ecef_metres_const(d->tel);
-    oskar_convert_ecef_to_station_uvw(num_stations, x, y, z, ra0, dec0, gast,
-            d->u, d->v, d->w, status);
-
-    /* Set dimensions of Jones matrices. */
-    if (d->R)
-        oskar_jones_set_size(d->R, num_stations, num_src, status);
-    if (d->Z)
-        oskar_jones_set_size(d->Z, num_stations, num_src, status);
-    oskar_jones_set_size(d->J, num_stations, num_src, status);
-    oskar_jones_set_size(d->E, num_stations, num_src, status);
-    oskar_jones_set_size(d->K, num_stations, num_src, status);
-
     /* Evaluate station beam (Jones E: may be matrix). */
     oskar_timer_resume(d->tmr_E);
     oskar_evaluate_jones_E(d->E, num_src, OSKAR_RELATIVE_DIRECTIONS,
@@ -1027,35 +1567,39 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     }
 #endif
 
-    /* Evaluate parallactic angle (Jones R: matrix), and join with Jones Z*E.
-     * TODO Move this into station beam evaluation instead. */
+    /* Join parallactic angle (Jones R: matrix) with Jones Z*E.
+     * Jones R is unchanged across channels, so the result goes into J. */
     if (d->R)
     {
-        oskar_timer_resume(d->tmr_E);
-        oskar_evaluate_jones_R(d->R, num_src, oskar_sky_ra_rad_const(sky),
-                oskar_sky_dec_rad_const(sky), d->tel, gast, status);
-        oskar_timer_pause(d->tmr_E);
         oskar_timer_resume(d->tmr_join);
-        oskar_jones_join(d->R, d->E, d->R, status);
+        oskar_jones_join(d->J, d->E, d->R, status);
         oskar_timer_pause(d->tmr_join);
     }
 
-    /* Evaluate interferometer phase (Jones K: scalar). */
+    /* Evaluate interferometer phase (Jones K: scalar).
+     * Channels are simulated in order, so if possible, Jones K from the
+     * previous channel is advanced using a complex multiply instead of
+     * evaluating sin() and cos() for every source and station.
+     * It is periodically evaluated directly to limit rounding errors. */
     oskar_timer_resume(d->tmr_K);
-    oskar_evaluate_jones_K(d->K, num_src, oskar_sky_l_const(sky),
-            oskar_sky_m_const(sky), oskar_sky_n_const(sky), d->u, d->v, d->w,
-            frequency, oskar_sky_I_const(sky),
-            h->source_min_jy, h->source_max_jy, status);
+    if (d->use_K_step && channel_index_block % K_RECURRENCE_INTERVAL != 0)
+        oskar_jones_join(0, d->K, d->K_step, status);
+    else
+        oskar_evaluate_jones_K(d->K, num_src, oskar_sky_l_const(sky),
+                oskar_sky_m_const(sky), oskar_sky_n_const(sky),
+                d->u, d->v, d->w, frequency, oskar_sky_I_const(sky),
+                h->source_min_jy, h->source_max_jy, status);
     oskar_timer_pause(d->tmr_K);
 
-    /* Join Jones K with Jones Z*E. */
+    /* Join Jones K with Jones Z*E (or R*Z*E, which is already in J). */
     oskar_timer_resume(d->tmr_join);
-    oskar_jones_join(d->J, d->K, d->R ? d->R : d->E, status);
+    oskar_jones_join(d->J, d->K, d->R ? d->J : d->E, status);
     oskar_timer_pause(d->tmr_join);
 
     /* Create alias for auto/cross-correlations. */
     oskar_timer_resume(d->tmr_correlate);
-    alias = oskar_mem_create_alias(0, 0, 0, status);
+    mark = oskar_mem_arena_mark(d->arena);
+    alias = oskar_mem_arena_alias(d->arena, 0, 0, 0, status);
 
     /* Auto-correlate for this time and channel. */
     if (oskar_vis_block_has_auto_correlations(d->vis_block))
@@ -1081,7 +1625,7 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     }
 
     /* Free alias for auto/cross-correlations. */
-    oskar_mem_free(alias, status);
+    oskar_mem_arena_release(d->arena, mark);
     oskar_timer_pause(d->tmr_correlate);
 }
 
@@ -1154,9 +1698,756 @@ static void set_up_vis_header(oskar_Interferometer* h, int* status)
 }
 
 
+/* Returns the index of the next work unit in the block for the device,
+ * or -1 if there are none left to start.
+ *
+ * Work units are numbered in chunk-major order, and each device is first
+ * given a contiguous range of them, so that it needs to copy each of its
+ * sky chunks only once. A device takes units from the front of its range.
+ * When its range is empty, it steals the back half of the largest range
+ * remaining, which is the part the owner will reach last. */
+static int next_work_unit(oskar_Interferometer* h, int block_index,
+        int device_id, int num_units)
+{
+    int i, unit = -1;
+    const int set = block_index % h->num_buffers;
+    DeviceData* d = &h->d[device_id];
+    oskar_mutex_lock(h->mutex);
+
+    /* The first device to reach the block divides up its work units. */
+    if (h->work_block[set] != block_index)
+    {
+        h->work_block[set] = block_index;
+        for (i = 0; i < h->num_devices; ++i)
+        {
+            h->d[i].work_begin[set] = (int) (
+                    (long long) num_units * i / h->num_devices);
+            h->d[i].work_end[set] = (int) (
+                    (long long) num_units * (i + 1) / h->num_devices);
+        }
+    }
+
+    /* Steal work if required. */
+    if (d->work_begin[set] >= d->work_end[set])
+    {
+        int victim = -1, max_remaining = 0;
+        for (i = 0; i < h->num_devices; ++i)
+        {
+            const int remaining =
+                    h->d[i].work_end[set] - h->d[i].work_begin[set];
+            if (remaining > max_remaining)
+            {
+                max_remaining = remaining;
+                victim = i;
+            }
+        }
+        if (victim >= 0)
+        {
+            const int num_stolen = (max_remaining + 1) / 2;
+            d->work_end[set] = h->d[victim].work_end[set];
+            d->work_begin[set] = d->work_end[set] - num_stolen;
+            h->d[victim].work_end[set] -= num_stolen;
+        }
+    }
+    if (d->work_begin[set] < d->work_end[set])
+        unit = (d->work_begin[set])++;
+    oskar_mutex_unlock(h->mutex);
+    return unit;
+}
+
+
+/* Copies a sky chunk to the given host sky model, and evaluates the source
+ * parameters that depend on the phase centre. */
+static void load_sky_chunk(oskar_Interferometer* h, int chunk_index,
+        oskar_Sky* sky, int* num_failed, int* status)
+{
+    int failed = 0;
+    double ra0, dec0;
+    if (*status) return;
+    ra0 = oskar_telescope_phase_centre_ra_rad(h->tel);
+    dec0 = oskar_telescope_phase_centre_dec_rad(h->tel);
+    oskar_sky_copy(sky, h->sky_chunks[chunk_index], status);
+    oskar_sky_evaluate_relative_directions(sky, ra0, dec0, status);
+    oskar_sky_evaluate_gaussian_source_parameters(sky,
+            h->zero_failed_gaussians, ra0, dec0, &failed, status);
+    if (num_failed) *num_failed += failed;
+}
+
+
+/* Loads the sky chunks needed by each block into the pool, in order,
+ * and queues the work units that use them for the compute devices. */
+static void load_sky_blocks(oskar_Interferometer* h)
+{
+    int b, c, t, i, num_blocks, num_times, num_failed = 0;
+    int* status = &(h->status);
+    num_blocks = oskar_interferometer_num_vis_blocks(h);
+    for (b = 0; b < num_blocks; ++b)
+    {
+        oskar_Queue* units = h->sky_pool_units[b % h->num_buffers];
+        num_times = h->num_time_steps - b * h->max_times_per_block;
+        if (num_times > h->max_times_per_block)
+            num_times = h->max_times_per_block;
+        for (c = 0; c < h->num_sky_chunks; ++c)
+        {
+            SkyPoolSlot* slot = (SkyPoolSlot*)
+                    oskar_queue_pop(h->sky_pool_free);
+            if (!slot || *status) break;
+            oskar_timer_resume(h->tmr_load);
+            load_sky_chunk(h, c, slot->sky, &num_failed, status);
+            oskar_timer_pause(h->tmr_load);
+            if (*status) break;
+            slot->chunk_index = c;
+            slot->remaining = num_times;
+            oskar_mutex_lock(h->mutex);
+            if (++h->sky_pool_in_use > h->sky_pool_peak)
+                h->sky_pool_peak = h->sky_pool_in_use;
+            oskar_mutex_unlock(h->mutex);
+            for (t = 0; t < num_times; ++t)
+            {
+                slot->units[t].slot = slot;
+                slot->units[t].time_index = t;
+                oskar_queue_push(units, &slot->units[t]);
+            }
+        }
+        if (c < h->num_sky_chunks) break;
+        for (i = 0; i < h->num_devices; ++i)
+            oskar_queue_push(units, &h->sky_pool_end);
+
+        /* Report Gaussian fitting failures once, for the first block. */
+        if (b == 0 && num_failed > 0 && h->log)
+        {
+            oskar_mutex_lock(h->mutex);
+            if (h->zero_failed_gaussians)
+                oskar_log_warning(h->log, "Gaussian ellipse solution failed "
+                        "for %i sources. These will have their fluxes "
+                        "set to zero.", num_failed);
+            else
+                oskar_log_warning(h->log, "Gaussian ellipse solution failed "
+                        "for %i sources. These will be simulated "
+                        "as point sources.", num_failed);
+            oskar_mutex_unlock(h->mutex);
+        }
+    }
+
+    /* Stop the compute devices waiting for chunks after an error. */
+    if (b < num_blocks) close_sky_pool(h);
+}
+
+
+/* Returns a buffer to the pool, once all its work units are done. */
+static void release_sky_slot(oskar_Interferometer* h, SkyPoolSlot* slot)
+{
+    int last;
+    oskar_mutex_lock(h->mutex);
+    last = (--slot->remaining == 0);
+    if (last) h->sky_pool_in_use--;
+    oskar_mutex_unlock(h->mutex);
+    if (last) oskar_queue_push(h->sky_pool_free, slot);
+}
+
+
+static void create_sky_pool(oskar_Interferometer* h, int* status)
+{
+    int i, capacity;
+    h->sky_pool_in_use = 0;
+    h->sky_pool_peak = 0;
+    oskar_timer_free(h->tmr_load);
+    h->tmr_load = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    h->sky_pool = (SkyPoolSlot*) calloc(h->sky_pool_size,
+            sizeof(SkyPoolSlot));
+    h->sky_pool_free = oskar_queue_create(h->sky_pool_size);
+    for (i = 0; i < h->sky_pool_size; ++i)
+    {
+        SkyPoolSlot* slot = &h->sky_pool[i];
+        slot->sky = oskar_sky_create(h->prec, OSKAR_CPU,
+                h->max_sources_per_chunk, status);
+        slot->units = (SkyPoolUnit*) calloc(h->max_times_per_block,
+                sizeof(SkyPoolUnit));
+        oskar_queue_push(h->sky_pool_free, slot);
+    }
+
+    /* Allow all the loaded work units to be queued for one block,
+     * and the end markers for the next. */
+    capacity = h->sky_pool_size * h->max_times_per_block +
+            2 * h->num_devices;
+    for (i = 0; i < h->num_buffers; ++i)
+        h->sky_pool_units[i] = oskar_queue_create(capacity);
+}
+
+
+static void free_sky_pool(oskar_Interferometer* h, int* status)
+{
+    int i;
+    if (!h->sky_pool) return;
+    for (i = 0; i < h->sky_pool_size; ++i)
+    {
+        oskar_sky_free(h->sky_pool[i].sky, status);
+        free(h->sky_pool[i].units);
+    }
+    for (i = 0; i < h->num_buffers; ++i)
+    {
+        oskar_queue_free(h->sky_pool_units[i]);
+        h->sky_pool_units[i] = 0;
+    }
+    oskar_queue_free(h->sky_pool_free);
+    free(h->sky_pool);
+    h->sky_pool_free = 0;
+    h->sky_pool = 0;
+    h->sky_pool_active = 0;
+}
+
+
+static void close_sky_pool(oskar_Interferometer* h)
+{
+    int i;
+    for (i = 0; i < h->num_buffers; ++i)
+        oskar_queue_close(h->sky_pool_units[i]);
+    oskar_queue_close(h->sky_pool_free);
+}
+
+
+/* Returns the number of bytes of device memory needed for each source
+ * in a chunk, for the Jones matrices and the sky model copies. */
+static size_t bytes_per_source(const oskar_Interferometer* h)
+{
+    size_t num_stations, complx, vis, jones;
+    num_stations = (size_t) oskar_telescope_num_stations(h->tel);
+    complx = oskar_mem_element_size(h->prec | OSKAR_COMPLEX);
+    vis = complx;
+    if (oskar_telescope_pol_mode(h->tel) == OSKAR_POL_MODE_FULL)
+        vis = oskar_mem_element_size(h->prec | OSKAR_COMPLEX | OSKAR_MATRIX);
+
+    /* Jones J, E and K, plus R (if polarised) and K_step (if needed). */
+    jones = 2 * vis + complx;
+    if (vis != complx) jones += vis;
+    if (h->num_channels > 1) jones += complx;
+    return num_stations * jones +
+            2 * SKY_ARRAYS_PER_SOURCE * oskar_mem_element_size(h->prec);
+}
+
+
+/* Re-splits the sky model into chunks of the given size. */
+static void rechunk_sky(oskar_Interferometer* h, int max_sources,
+        int* status)
+{
+    int i, num_chunks = 0;
+    oskar_Sky** chunks = 0;
+
+    /* Chunks of a sky model file are re-split without copying. */
+    if (h->sky_file_model)
+    {
+        alias_sky_ranges(h, max_sources, status);
+        return;
+    }
+    for (i = 0; i < h->num_sky_chunks; ++i)
+    {
+        oskar_sky_append_to_set(&num_chunks, &chunks, max_sources,
+                h->sky_chunks[i], status);
+        oskar_sky_free(h->sky_chunks[i], status);
+    }
+    free(h->sky_chunks);
+    h->sky_chunks = chunks;
+    h->num_sky_chunks = num_chunks;
+}
+
+
+/* Frees the sky chunks, and the sky model file, if used. */
+static void free_sky_model(oskar_Interferometer* h, int* status)
+{
+    int i;
+    for (i = 0; i < h->num_sky_chunks; ++i)
+        oskar_sky_free(h->sky_chunks[i], status);
+    free(h->sky_chunks);
+    h->sky_chunks = 0;
+    h->num_sky_chunks = 0;
+
+    /* The file must be unmapped after freeing the chunks that alias it. */
+    oskar_sky_free(h->sky_file_model, status);
+    oskar_sky_free(h->sky_file_filtered, status);
+    oskar_mem_free(h->sky_file_directory, status);
+    oskar_binary_free(h->sky_file);
+    free(h->sky_range_start);
+    free(h->sky_range_size);
+    free(h->sky_range_filtered);
+    h->sky_file_model = 0;
+    h->sky_file_filtered = 0;
+    h->sky_file_directory = 0;
+    h->sky_file = 0;
+    h->sky_range_start = 0;
+    h->sky_range_size = 0;
+    h->sky_range_filtered = 0;
+    h->sky_file_chunk_size = 0;
+    h->sky_file_num_chunks = 0;
+    h->num_sky_ranges = 0;
+}
+
+
+/* Replaces the sky chunks with aliases of the source ranges in use from
+ * the sky model file (or its filtered copy), each containing up to
+ * max_sources sources. */
+static void alias_sky_ranges(oskar_Interferometer* h, int max_sources,
+        int* status)
+{
+    int i, j, num_chunks = 0;
+    for (i = 0; i < h->num_sky_chunks; ++i)
+        oskar_sky_free(h->sky_chunks[i], status);
+    free(h->sky_chunks);
+    h->sky_chunks = 0;
+    h->num_sky_chunks = 0;
+    h->num_sources_total = 0;
+    if (*status || max_sources < 1) return;
+    for (i = 0; i < h->num_sky_ranges; ++i)
+        num_chunks += (h->sky_range_size[i] + max_sources - 1) / max_sources;
+    if (num_chunks == 0) return;
+    h->sky_chunks = (oskar_Sky**) calloc(num_chunks, sizeof(oskar_Sky*));
+    for (i = 0; i < h->num_sky_ranges; ++i)
+    {
+        for (j = 0; j < h->sky_range_size[i]; j += max_sources)
+        {
+            int num = h->sky_range_size[i] - j;
+            if (num > max_sources) num = max_sources;
+            h->sky_chunks[h->num_sky_chunks] = oskar_sky_create_alias(
+                    h->sky_range_filtered[i] ?
+                            h->sky_file_filtered : h->sky_file_model,
+                    h->sky_range_start[i] + j, num, status);
+            h->num_sky_chunks++;
+            h->num_sources_total += num;
+        }
+    }
+}
+
+
+/* Finds the cone enclosing the zenith directions of all stations,
+ * as (RA, Dec) at a Greenwich sidereal time of zero, and its radius. */
+static void station_envelope(const oskar_Telescope* tel, double* ra,
+        double* dec, double* radius)
+{
+    int i, num_stations;
+    double c[3] = {0.0, 0.0, 0.0}, dist;
+    num_stations = oskar_telescope_num_stations(tel);
+    for (i = 0; i < num_stations; ++i)
+    {
+        const oskar_Station* s = oskar_telescope_station_const(tel, i);
+        const double lon = oskar_station_lon_rad(s);
+        const double lat = oskar_station_lat_rad(s);
+        c[0] += cos(lat) * cos(lon);
+        c[1] += cos(lat) * sin(lon);
+        c[2] += sin(lat);
+    }
+    *ra = atan2(c[1], c[0]);
+    *dec = atan2(c[2], sqrt(c[0] * c[0] + c[1] * c[1]));
+    *radius = (sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]) > 1e-9) ?
+            0.0 : M_PI;
+    for (i = 0; i < num_stations; ++i)
+    {
+        const oskar_Station* s = oskar_telescope_station_const(tel, i);
+        dist = oskar_angular_distance(oskar_station_lon_rad(s), *ra,
+                oskar_station_lat_rad(s), *dec);
+        if (dist > *radius) *radius = dist;
+    }
+}
+
+
+/* Returns true if the chunk with the given bounds is below the horizon
+ * of every station at every time step of the observation. */
+static int chunk_below_horizon(const oskar_Interferometer* h,
+        const double* bounds, double env_ra, double env_dec,
+        double env_radius)
+{
+    int t;
+    const double dt_dump_days = h->time_inc_sec / 86400.0;
+    const double limit = 0.5 * M_PI + env_radius +
+            bounds[OSKAR_SKY_CHUNK_RADIUS_RAD] + SKY_CHUNK_MARGIN;
+    if (limit >= M_PI) return 0;
+    for (t = 0; t < h->num_time_steps; ++t)
+    {
+        /* The times must match those used in run_block(). */
+        const double gast = oskar_convert_mjd_to_gast_fast(
+                h->time_start_mjd_utc + dt_dump_days * (t + 0.5));
+        if (oskar_angular_distance(bounds[OSKAR_SKY_CHUNK_RA_RAD],
+                env_ra + gast, bounds[OSKAR_SKY_CHUNK_DEC_RAD],
+                env_dec) <= limit)
+            return 0;
+    }
+    return 1;
+}
+
+
+/* Applies the source filters to a range of sources in the sky model file,
+ * and appends the sources that remain to the filtered copy, leaving the
+ * mapped file unchanged. Returns the number of sources remaining, and
+ * their start index in the filtered copy. */
+static int filter_sky_range(oskar_Interferometer* h, int start, int num,
+        double ra0, double dec0, int* filtered_start, int* status)
+{
+    oskar_Sky *alias, *temp;
+    alias = oskar_sky_create_alias(h->sky_file_model, start, num, status);
+    temp = oskar_sky_create_copy(alias, OSKAR_CPU, status);
+    oskar_sky_filter_by_flux(temp, h->sky_flux_min, h->sky_flux_max, status);
+    oskar_sky_filter_by_radius(temp, h->sky_radius_inner,
+            h->sky_radius_outer, ra0, dec0, status);
+    *filtered_start = oskar_sky_num_sources(h->sky_file_filtered);
+    oskar_sky_append(h->sky_file_filtered, temp, status);
+    num = oskar_sky_num_sources(temp);
+    oskar_sky_free(temp, status);
+    oskar_sky_free(alias, status);
+    return *status ? 0 : num;
+}
+
+
+/* Selects the chunks of the sky model file to simulate, using the chunk
+ * directory. Chunks are skipped without reading their source data if
+ * they are excluded by the source filters, or are below the horizon of
+ * all stations at all times. The filters are applied to the sources in
+ * chunks that are only partly excluded.
+ * The selection always starts again from the unmodified file, so it is
+ * safe to repeat it. */
+static void select_sky_file_chunks(oskar_Interferometer* h, int* status)
+{
+    int c, i, num_file_sources, num_used = 0, num_partial = 0;
+    double ra0, dec0, d, rho, env_ra = 0.0, env_dec = 0.0, env_radius = M_PI;
+    const double* dir;
+    if (*status) return;
+    ra0 = oskar_telescope_phase_centre_ra_rad(h->tel);
+    dec0 = oskar_telescope_phase_centre_dec_rad(h->tel);
+    num_file_sources = oskar_sky_num_sources(h->sky_file_model);
+    dir = oskar_mem_double_const(h->sky_file_directory, status);
+    if (h->apply_horizon_clip)
+        station_envelope(h->tel, &env_ra, &env_dec, &env_radius);
+
+    /* Free the chunks that alias the previous filtered copy. */
+    for (i = 0; i < h->num_sky_chunks; ++i)
+        oskar_sky_free(h->sky_chunks[i], status);
+    free(h->sky_chunks);
+    h->sky_chunks = 0;
+    h->num_sky_chunks = 0;
+    oskar_sky_free(h->sky_file_filtered, status);
+    h->sky_file_filtered = oskar_sky_create(h->prec, OSKAR_CPU, 0, status);
+    h->num_sky_ranges = 0;
+    for (c = 0; c < h->sky_file_num_chunks; ++c)
+    {
+        int partial = 0, filtered = 0, start, num;
+        const double* b = dir + c * OSKAR_SKY_CHUNK_NUM_PARAMS;
+        start = c * h->sky_file_chunk_size;
+        num = num_file_sources - start;
+        if (num > h->sky_file_chunk_size) num = h->sky_file_chunk_size;
+
+        /* Test the range of Stokes I against the flux filter. */
+        if (b[OSKAR_SKY_CHUNK_MAX_I] <= h->sky_flux_min ||
+                b[OSKAR_SKY_CHUNK_MIN_I] > h->sky_flux_max)
+            continue;
+        if (b[OSKAR_SKY_CHUNK_MIN_I] <= h->sky_flux_min ||
+                b[OSKAR_SKY_CHUNK_MAX_I] > h->sky_flux_max)
+            partial = 1;
+
+        /* Test the bounding circle against the radius filter. */
+        if (h->sky_radius_inner > 0.0 || h->sky_radius_outer < M_PI)
+        {
+            rho = b[OSKAR_SKY_CHUNK_RADIUS_RAD] + SKY_CHUNK_MARGIN;
+            d = oskar_angular_distance(b[OSKAR_SKY_CHUNK_RA_RAD], ra0,
+                    b[OSKAR_SKY_CHUNK_DEC_RAD], dec0);
+            if (d + rho < h->sky_radius_inner ||
+                    d - rho >= h->sky_radius_outer)
+                continue;
+            if (d - rho < h->sky_radius_inner ||
+                    d + rho >= h->sky_radius_outer)
+                partial = 1;
+        }
+
+        /* Test the bounding circle against the horizon. */
+        if (h->apply_horizon_clip &&
+                chunk_below_horizon(h, b, env_ra, env_dec, env_radius))
+            continue;
+
+        /* Filter the sources in the chunk if required. */
+        if (partial)
+        {
+            num = filter_sky_range(h, start, num, ra0, dec0, &start, status);
+            filtered = 1;
+            num_partial++;
+        }
+        if (num <= 0) continue;
+        num_used++;
+
+        /* Store the range, joining it to the previous one if contiguous. */
+        if (h->num_sky_ranges > 0 &&
+                filtered == h->sky_range_filtered[h->num_sky_ranges - 1] &&
+                start == h->sky_range_start[h->num_sky_ranges - 1] +
+                h->sky_range_size[h->num_sky_ranges - 1])
+            h->sky_range_size[h->num_sky_ranges - 1] += num;
+        else
+        {
+            h->sky_range_start[h->num_sky_ranges] = start;
+            h->sky_range_size[h->num_sky_ranges] = num;
+            h->sky_range_filtered[h->num_sky_ranges] = filtered;
+            h->num_sky_ranges++;
+        }
+    }
+    alias_sky_ranges(h, h->max_sources_per_chunk, status);
+
+    /* Print summary data. */
+    if (h->log)
+    {
+        oskar_log_section(h->log, 'M', "Sky model file chunk selection");
+        oskar_log_value(h->log, 'M', 0, "Num. file chunks used", "%d / %d",
+                num_used, h->sky_file_num_chunks);
+        oskar_log_value(h->log, 'M', 0, "Num. file chunks filtered", "%d",
+                num_partial);
+        oskar_log_value(h->log, 'M', 0, "Num. sources", "%d",
+                h->num_sources_total);
+        oskar_log_value(h->log, 'M', 0, "Num. chunks", "%d",
+                h->num_sky_chunks);
+    }
+}
+
+
+/* Returns true if the sky chunks are loaded through the pool as they are
+ * needed. Only chunks of a sky model file are streamed, as a sky model
+ * set in memory is already resident for the whole simulation. */
+static int sky_streamed(const oskar_Interferometer* h)
+{
+    return h->sky_pool_size > 0 && h->sky_file_model;
+}
+
+
+/* Returns the time taken to simulate one time step of a chunk containing
+ * the given number of sources, on the first compute device.
+ * The sources are taken from the first sky chunk. */
+static double time_chunk(oskar_Interferometer* h, int num_src, int* status)
+{
+    int loc;
+    double gast, t_setup, t_sim;
+    oskar_Sky* sky;
+    oskar_Timer* tmr;
+    DeviceData* d = &h->d[0];
+    if (*status) return 0.0;
+
+    /* Select the device. */
+    if (h->num_gpus > 0)
+    {
+        oskar_device_set(h->gpu_ids[0], status);
+        loc = OSKAR_GPU;
+        tmr = oskar_timer_create(OSKAR_TIMER_CUDA);
+    }
+    else
+    {
+        loc = OSKAR_CPU;
+        tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+#ifdef _OPENMP
+        omp_set_num_threads(h->num_threads_per_device);
+#endif
+    }
+
+    /* Copy the sources to the device. */
+    sky = oskar_sky_create(h->prec, loc, num_src, status);
+    oskar_sky_copy_contents(sky, h->sky_chunks[0], 0, 0, num_src, status);
+    oskar_sky_set_use_extended(sky,
+            oskar_sky_use_extended(h->sky_chunks[0]));
+    if (sky_streamed(h))
+        oskar_sky_evaluate_relative_directions(sky,
+                oskar_telescope_phase_centre_ra_rad(h->tel),
+                oskar_telescope_phase_centre_dec_rad(h->tel), status);
+
+    /* Time the set-up for the time step, and one channel.
+     * Horizon clipping is not done, so this is an upper limit. */
+    gast = oskar_convert_mjd_to_gast_fast(h->time_start_mjd_utc +
+            0.5 * h->time_inc_sec / 86400.0);
+    oskar_timer_start(tmr);
+    set_up_time_step(h, d, sky, gast, status);
+    t_setup = oskar_timer_elapsed(tmr);
+    oskar_timer_start(tmr);
+    sim_baselines(h, d, sky, 0, 0, 0, status);
+    t_sim = oskar_timer_elapsed(tmr);
+    oskar_timer_free(tmr);
+    oskar_sky_free(sky, status);
+    return t_setup + h->num_channels * t_sim;
+}
+
+
+static void auto_size(oskar_Interferometer* h, int* status)
+{
+    int i, num_sizes = 0, sizes[8], num_src, chunk_size, split_size;
+    int num_cpu_devices, num_host_blocks, times, times_min, num_chunks;
+    size_t bps, mem_limit, mem_sky, mem_avail, mem_dev, bytes_per_time;
+    size_t num_stations, num_baselines, max_src, cache = 0;
+    double t, time_per_src = 0.0;
+    const double gigabyte = 1024.0 * 1024.0 * 1024.0;
+    if (*status) return;
+    h->auto_sized = 1;
+
+    /* Discard any work arrays allocated using the previous sizes. */
+    free_device_data(h, status);
+
+    /* Get the memory limit, and the memory available for the work arrays
+     * and visibility blocks after storing the sky model
+     * (or the pool of sky chunks, if streamed). */
+    mem_limit = (h->max_memory_gb > 0.0) ?
+            (size_t) (h->max_memory_gb * gigabyte) :
+            (oskar_get_total_physical_memory() / 4) * 3;
+    mem_sky = (size_t) h->num_sources_total;
+    if (sky_streamed(h) && mem_sky >
+            (size_t) h->sky_pool_size * h->max_sources_per_chunk)
+        mem_sky = (size_t) h->sky_pool_size * h->max_sources_per_chunk;
+    mem_sky *= SKY_ARRAYS_PER_SOURCE * oskar_mem_element_size(h->prec);
+    mem_avail = (mem_limit > mem_sky) ? mem_limit - mem_sky : 0;
+
+    /* Find the largest chunk that fits in memory. At most half of the
+     * available host memory is used for the work arrays of CPU devices. */
+    bps = bytes_per_source(h);
+    num_cpu_devices = h->num_devices - h->num_gpus;
+    max_src = AUTO_MAX_SOURCES_PER_CHUNK;
+    if (num_cpu_devices > 0 &&
+            max_src > mem_avail / (2 * bps * num_cpu_devices))
+        max_src = mem_avail / (2 * bps * num_cpu_devices);
+    if (h->num_gpus > 0)
+    {
+        size_t mem_free = 0, mem_total = 0;
+        for (i = 0; i < h->num_gpus; ++i)
+        {
+            oskar_device_set(h->gpu_ids[i], status);
+            oskar_device_mem_info(&mem_free, &mem_total);
+            if (max_src > (mem_free / 4) * 3 / bps)
+                max_src = (mem_free / 4) * 3 / bps;
+        }
+    }
+    if (max_src < AUTO_MIN_SOURCES_PER_CHUNK)
+        max_src = AUTO_MIN_SOURCES_PER_CHUNK;
+
+    /* Get the candidate chunk sizes. */
+    num_src = (h->num_sky_chunks > 0 && !h->coords_only) ?
+            oskar_sky_num_sources(h->sky_chunks[0]) : 0;
+    if (!h->auto_chunk_size)
+        sizes[num_sizes++] = num_src;
+    else if (num_src > 0)
+    {
+        /* Try chunks that fit in the cache of a CPU device, and larger
+         * chunks with fewer overheads. */
+        if (num_src > (int) max_src) num_src = (int) max_src;
+        sizes[num_sizes++] = num_src;
+        for (i = num_src / 4; i >= AUTO_MIN_SOURCES_PER_CHUNK &&
+                num_sizes < 5; i /= 4)
+            sizes[num_sizes++] = i;
+        if (num_cpu_devices > 0)
+        {
+            cache = oskar_get_cache_size(2) * h->num_threads_per_device +
+                    oskar_get_cache_size(3) * h->num_threads_per_device /
+                    oskar_get_num_procs();
+            i = (int) (cache / bps);
+            if (i >= AUTO_MIN_SOURCES_PER_CHUNK && i < num_src)
+                sizes[num_sizes++] = i;
+        }
+    }
+
+    /* Time a simulation of the first chunk using each candidate size,
+     * and choose the size that gives the shortest time per source. */
+    chunk_size = h->max_sources_per_chunk;
+    split_size = h->max_sources_per_chunk;
+    if (num_sizes > 0 && sizes[0] > 0)
+    {
+        if (h->log)
+            oskar_log_section(h->log, 'M', "Calibrating chunk size");
+        h->max_sources_per_chunk = sizes[0];
+        set_up_device_data(h, status);
+        for (i = 0; i < num_sizes; ++i)
+        {
+            t = time_chunk(h, sizes[i], status) / sizes[i];
+            if (*status) break;
+            if (h->log)
+                oskar_log_message(h->log, 'M', 0, "%*d sources per chunk: "
+                        "%.3g us per source per time step",
+                        (int) disp_width(sizes[0]), sizes[i], t * 1e6);
+            if (time_per_src == 0.0 || t < time_per_src)
+            {
+                time_per_src = t;
+                chunk_size = sizes[i];
+            }
+        }
+        free_device_data(h, status);
+    }
+    if (!h->auto_chunk_size)
+        chunk_size = split_size;
+    else if (time_per_src == 0.0)
+        chunk_size = (h->num_sky_chunks > 0) ?
+                split_size : AUTO_MIN_SOURCES_PER_CHUNK;
+    else if (chunk_size != split_size)
+        rechunk_sky(h, chunk_size, status);
+    h->max_sources_per_chunk = chunk_size;
+    if (*status) return;
+
+    /* Choose the block size. Memory not used by the work arrays
+     * is used for the visibility blocks. */
+    times = h->max_times_per_block;
+    if (h->auto_times_per_block)
+    {
+        num_stations = (size_t) oskar_telescope_num_stations(h->tel);
+        num_baselines = (h->correlation_type == 'A') ? 0 :
+                num_stations * (num_stations - 1) / 2;
+        bytes_per_time = 3 * num_baselines * oskar_mem_element_size(h->prec);
+        if (h->correlation_type == 'A' || h->correlation_type == 'B')
+            num_baselines += num_stations;
+        bytes_per_time += h->num_channels * num_baselines *
+                oskar_mem_element_size(
+                        oskar_vis_header_amp_type(h->header));
+
+        /* Each device has a block in each host buffer, CPU devices have
+         * one more, and one more may be needed for output. */
+        num_host_blocks = h->num_buffers * h->num_devices +
+                num_cpu_devices + 1;
+        mem_dev = (size_t) num_cpu_devices * bps * chunk_size;
+        mem_avail = (mem_avail > mem_dev) ? mem_avail - mem_dev : 0;
+        times = (int) (mem_avail / (num_host_blocks * bytes_per_time));
+
+        /* Give each block enough compute time to amortise the overheads,
+         * and enough work units to keep all the devices busy. */
+        num_chunks = h->num_sky_chunks > 0 ? h->num_sky_chunks : 1;
+        times_min = (4 * h->num_devices + num_chunks - 1) / num_chunks;
+        if (time_per_src > 0.0)
+        {
+            t = time_per_src * h->num_sources_total / h->num_devices;
+            i = (int) ceil(AUTO_BLOCK_TARGET_SEC / t);
+            if (i > times_min) times_min = i;
+        }
+        if (times > times_min) times = times_min;
+
+        /* Use at least two blocks, so that simulation and output overlap. */
+        if (h->num_time_steps > 1 && times > (h->num_time_steps + 1) / 2)
+            times = (h->num_time_steps + 1) / 2;
+        if (times < 1) times = 1;
+    }
+    if (times != h->max_times_per_block)
+    {
+        h->max_times_per_block = times;
+        oskar_vis_header_free(h->header, status);
+        h->header = 0;
+        set_up_vis_header(h, status);
+    }
+
+    /* Log the chosen parameters. */
+    if (h->log)
+    {
+        oskar_log_section(h->log, 'M', "Automatic sizing");
+        if (cache > 0)
+            oskar_log_value(h->log, 'M', 0, "Cache per CPU device",
+                    "%.1f MB", cache / (1024.0 * 1024.0));
+        oskar_log_value(h->log, 'M', 0, "Memory limit", "%.1f GB",
+                mem_limit / gigabyte);
+        oskar_log_value(h->log, 'M', 0, "Max. sources per chunk", "%d",
+                h->max_sources_per_chunk);
+        oskar_log_value(h->log, 'M', 0, "Num. chunks", "%d",
+                h->num_sky_chunks);
+        oskar_log_value(h->log, 'M', 0, "Max. times per block", "%d",
+                h->max_times_per_block);
+        if (time_per_src > 0.0)
+            oskar_log_value(h->log, 'M', 0, "Predicted run time", "%.1f s",
+                    time_per_src * h->num_sources_total *
+                    h->num_time_steps / h->num_devices);
+    }
+}
+
+
 static void set_up_device_data(oskar_Interferometer* h, int* status)
 {
-    int i, dev_loc, complx, vistype, num_stations, num_src;
+    int i, j, dev_loc, complx, vistype, num_stations, num_src;
     if (*status) return;
 
     /* Get local variables. */
@@ -1176,6 +2467,7 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
     {
         DeviceData* d = &h->d[i];
         d->previous_chunk_index = -1;
+        d->num_chunk_copies = 0;
 
         /* Select the device. */
         if (i < h->num_gpus)
@@ -1200,6 +2492,7 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
             d->tmr_K         = oskar_timer_create(timer_type);
             d->tmr_join      = oskar_timer_create(timer_type);
             d->tmr_correlate = oskar_timer_create(timer_type);
+            d->tmr_wait      = oskar_timer_create(OSKAR_TIMER_NATIVE);
         }
 
         /* Visibility blocks. */
@@ -1207,14 +2500,13 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
         {
             d->vis_block = oskar_vis_block_create_from_header(dev_loc,
                     h->header, status);
-            d->vis_block_cpu[0] = oskar_vis_block_create_from_header(OSKAR_CPU,
-                    h->header, status);
-            d->vis_block_cpu[1] = oskar_vis_block_create_from_header(OSKAR_CPU,
-                    h->header, status);
+            for (j = 0; j < h->num_buffers; ++j)
+                d->vis_block_cpu[j] = oskar_vis_block_create_from_header(
+                        OSKAR_CPU, h->header, status);
         }
         oskar_vis_block_clear(d->vis_block, status);
-        oskar_vis_block_clear(d->vis_block_cpu[0], status);
-        oskar_vis_block_clear(d->vis_block_cpu[1], status);
+        for (j = 0; j < h->num_buffers; ++j)
+            oskar_vis_block_clear(d->vis_block_cpu[j], status);
 
         /* Device scratch memory. */
         if (!d->tel)
@@ -1224,6 +2516,8 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
             d->w = oskar_mem_create(h->prec, dev_loc, num_stations, status);
             d->chunk = oskar_sky_create(h->prec, dev_loc, num_src, status);
             d->chunk_clip = oskar_sky_create(h->prec, dev_loc, num_src, status);
+            d->chunk_stage = sky_streamed(h) ? oskar_sky_create(
+                    h->prec, OSKAR_CPU, num_src, status) : 0;
             d->tel = oskar_telescope_create_copy(h->tel, dev_loc, status);
             d->J = oskar_jones_create(vistype, dev_loc, num_stations, num_src,
                     status);
@@ -1233,9 +2527,14 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
                     status);
             d->K = oskar_jones_create(complx, dev_loc, num_stations, num_src,
                     status);
+            d->K_step = (h->num_channels > 1) ? oskar_jones_create(complx,
+                    dev_loc, num_stations, num_src, status) : 0;
+            d->use_K_step = 0;
             d->Z = 0;
             d->station_work = oskar_station_work_create(h->prec, dev_loc,
                     status);
+            d->arena = oskar_mem_arena_create(dev_loc, status);
+            oskar_station_work_set_enu_cache_enabled(d->station_work, 1);
         }
     }
 }
@@ -1243,7 +2542,7 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
 
 static void free_device_data(oskar_Interferometer* h, int* status)
 {
-    int i;
+    int i, j;
     if (!h->d) return;
     for (i = 0; i < h->num_devices; ++i)
     {
@@ -1258,19 +2557,23 @@ static void free_device_data(oskar_Interferometer* h, int* status)
         oskar_timer_free(d->tmr_K);
         oskar_timer_free(d->tmr_join);
         oskar_timer_free(d->tmr_correlate);
-        oskar_vis_block_free(d->vis_block_cpu[0], status);
-        oskar_vis_block_free(d->vis_block_cpu[1], status);
+        oskar_timer_free(d->tmr_wait);
+        for (j = 0; j < MAX_OUTPUT_BUFFERS; ++j)
+            oskar_vis_block_free(d->vis_block_cpu[j], status);
         oskar_vis_block_free(d->vis_block, status);
         oskar_mem_free(d->u, status);
         oskar_mem_free(d->v, status);
         oskar_mem_free(d->w, status);
         oskar_sky_free(d->chunk, status);
         oskar_sky_free(d->chunk_clip, status);
+        oskar_sky_free(d->chunk_stage, status);
         oskar_telescope_free(d->tel, status);
         oskar_station_work_free(d->station_work, status);
+        oskar_mem_arena_free(d->arena, status);
         oskar_jones_free(d->J, status);
         oskar_jones_free(d->E, status);
         oskar_jones_free(d->K, status);
+        oskar_jones_free(d->K_step, status);
         oskar_jones_free(d->R, status);
         memset(d, 0, sizeof(DeviceData));
     }
@@ -1280,10 +2583,10 @@ static void free_device_data(oskar_Interferometer* h, int* status)
 static void record_timing(oskar_Interferometer* h)
 {
     /* Obtain component times. */
-    int i;
+    int i, num_chunk_copies = 0;
     double t_copy = 0., t_clip = 0., t_E = 0., t_K = 0., t_join = 0.;
-    double t_correlate = 0., t_compute = 0., t_components = 0.;
-    double *compute_times;
+    double t_correlate = 0., t_compute = 0., t_components = 0., t_wait = 0.;
+    double t_write_ms, t_write_vis, t_sim, *compute_times;
     compute_times = (double*) calloc(h->num_devices, sizeof(double));
     for (i = 0; i < h->num_devices; ++i)
     {
@@ -1295,18 +2598,41 @@ static void record_timing(oskar_Interferometer* h)
         t_K += oskar_timer_elapsed(h->d[i].tmr_K);
         t_correlate += oskar_timer_elapsed(h->d[i].tmr_correlate);
         t_compute += compute_times[i];
+        t_wait += oskar_timer_elapsed(h->d[i].tmr_wait);
+        num_chunk_copies += h->d[i].num_chunk_copies;
     }
     t_components = t_copy + t_clip + t_E + t_K + t_join + t_correlate;
+    t_write_ms = oskar_timer_elapsed(h->tmr_write_ms);
+    t_write_vis = oskar_timer_elapsed(h->tmr_write_vis);
+    t_sim = oskar_timer_elapsed(h->tmr_sim);
 
     /* Record time taken. */
     oskar_log_section(h->log, 'M', "Simulation timing");
-    oskar_log_value(h->log, 'M', 0, "Total wall time", "%.3f s",
-            oskar_timer_elapsed(h->tmr_sim));
+    oskar_log_value(h->log, 'M', 0, "Total wall time", "%.3f s", t_sim);
     for (i = 0; i < h->num_devices; ++i)
         oskar_log_value(h->log, 'M', 0, "Compute", "%.3f s [Device %i]",
                 compute_times[i], i);
     oskar_log_value(h->log, 'M', 0, "Write", "%.3f s",
-            oskar_timer_elapsed(h->tmr_write));
+            t_write_ms + t_write_vis);
+    if (h->num_writers > 1)
+    {
+        oskar_log_value(h->log, 'M', 1, "Measurement Set", "%.3f s",
+                t_write_ms);
+        oskar_log_value(h->log, 'M', 1, "OSKAR binary file", "%.3f s",
+                t_write_vis);
+    }
+    for (i = 0; i < h->num_devices; ++i)
+        oskar_log_value(h->log, 'M', 0, "Blocked on output",
+                "%.3f s [Device %i]", oskar_timer_elapsed(h->d[i].tmr_wait), i);
+    oskar_log_value(h->log, 'M', 0, "Sky chunk copies", "%d",
+            num_chunk_copies);
+    oskar_log_value(h->log, 'M', 0, "Memory allocations", "%lu (%.1f per "
+            "block)", (unsigned long) h->num_allocations,
+            h->num_allocations /
+            (double) oskar_interferometer_num_vis_blocks(h));
+    if (sky_streamed(h))
+        oskar_log_value(h->log, 'M', 0, "Sky chunk loading", "%.3f s",
+                oskar_timer_elapsed(h->tmr_load));
     oskar_log_message(h->log, 'M', 0, "Compute components:");
     oskar_log_value(h->log, 'M', 1, "Copy", "%4.1f%%",
             (t_copy / t_compute) * 100.0);
@@ -1322,6 +2648,11 @@ static void record_timing(oskar_Interferometer* h)
             (t_correlate / t_compute) * 100.0);
     oskar_log_value(h->log, 'M', 1, "Other", "%4.1f%%",
             ((t_compute - t_components) / t_compute) * 100.0);
+    if (t_wait > 0.1 * t_sim * h->num_devices)
+        oskar_log_warning(h->log, "Compute devices spent %.0f%% of the time "
+                "waiting for output. Consider using more output buffers, "
+                "or faster storage.",
+                100.0 * t_wait / (t_sim * h->num_devices));
     free(compute_times);
 }
 
@@ -29,11 +29,13 @@
 #include <gtest/gtest.h>
 
 #include "interferometer/oskar_evaluate_jones_K.h"
+#include "interferometer/oskar_jones_join.h"
 #include "utility/oskar_device_utils.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_timer.h"
 #include "utility/oskar_vector_types.h"
 
+#include <cfloat>
 #include <cstdio>
 
 static void run_test(int type, double tol)
@@ -127,3 +129,76 @@ TEST(Jones_K, test_double)
 {
     run_test(OSKAR_DOUBLE, 1e-8);
 }
+
+static void run_test_recurrence(int type, double tol)
+{
+    int num_sources = 1000;
+    int num_stations = 100;
+    int num_channels = 16;
+    int status = 0;
+    double freq_start_hz = 100e6, freq_inc_hz = 1e5;
+    double src_min = -DBL_MAX, src_max = DBL_MAX;
+    oskar_Jones* K = oskar_jones_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* K_step = oskar_jones_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* K_direct = oskar_jones_create(type | OSKAR_COMPLEX,
+            OSKAR_CPU, num_stations, num_sources, &status);
+    oskar_Mem* l = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* m = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* n = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* I = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* u = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* v = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* w = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    srand(2);
+    oskar_mem_random_range(l, -0.1, 0.1, &status);
+    oskar_mem_random_range(m, -0.1, 0.1, &status);
+    oskar_mem_random_range(n, 0.99, 1.0, &status);
+    oskar_mem_random_range(I, 0.0, 1.0, &status);
+    oskar_mem_random_range(u, -100.0, 100.0, &status);
+    oskar_mem_random_range(v, -100.0, 100.0, &status);
+    oskar_mem_random_range(w, -100.0, 100.0, &status);
+
+    // Advance Jones K by one channel at a time from the first channel.
+    oskar_evaluate_jones_K(K, num_sources, l, m, n, u, v, w,
+            freq_start_hz, I, src_min, src_max, &status);
+    oskar_evaluate_jones_K(K_step, num_sources, l, m, n, u, v, w,
+            freq_inc_hz, I, src_min, src_max, &status);
+    for (int c = 1; c < num_channels; ++c)
+        oskar_jones_join(0, K, K_step, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Compare with Jones K evaluated directly for the last channel.
+    oskar_evaluate_jones_K(K_direct, num_sources, l, m, n, u, v, w,
+            freq_start_hz + (num_channels - 1) * freq_inc_hz, I,
+            src_min, src_max, &status);
+    double max_err, avg_err;
+    oskar_mem_evaluate_relative_error(oskar_jones_mem_const(K),
+            oskar_jones_mem_const(K_direct), 0, &max_err, &avg_err, 0,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(max_err, tol);
+    EXPECT_LT(avg_err, tol);
+
+    oskar_mem_free(l, &status);
+    oskar_mem_free(m, &status);
+    oskar_mem_free(n, &status);
+    oskar_mem_free(I, &status);
+    oskar_mem_free(u, &status);
+    oskar_mem_free(v, &status);
+    oskar_mem_free(w, &status);
+    oskar_jones_free(K, &status);
+    oskar_jones_free(K_step, &status);
+    oskar_jones_free(K_direct, &status);
+}
+
+TEST(Jones_K, channel_recurrence_single)
+{
+    run_test_recurrence(OSKAR_SINGLE, 1e-4);
+}
+
+TEST(Jones_K, channel_recurrence_double)
+{
+    run_test_recurrence(OSKAR_DOUBLE, 1e-10);
+}
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "binary/oskar_binary.h"
+#include "interferometer/oskar_interferometer.h"
+#include "sky/oskar_sky.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_get_error_string.h"
+#include "vis/oskar_vis.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdio>
+#include <cstdlib>
+
+static const char* tel_dir = "temp_test_interferometer_telescope";
+static const char* sky_file = "temp_test_interferometer_sky.osm";
+static const double ra0 = 20.0 * M_PI / 180.0, dec0 = -50.0 * M_PI / 180.0;
+static const int num_sources = 2000, sky_file_chunk_size = 100;
+
+static oskar_Telescope* create_telescope(int* status)
+{
+    FILE* f;
+    char *path, *station_dir;
+
+    // Write a telescope model with three stations of four elements each.
+    station_dir = oskar_dir_get_path(tel_dir, "station001");
+    oskar_dir_mkpath(station_dir);
+    path = oskar_dir_get_path(tel_dir, "position.txt");
+    f = fopen(path, "w");
+    fprintf(f, "0.0, -50.0\n");
+    fclose(f);
+    free(path);
+    path = oskar_dir_get_path(tel_dir, "layout.txt");
+    f = fopen(path, "w");
+    fprintf(f, "0.0, 0.0\n100.0, 50.0\n-30.0, 120.0\n");
+    fclose(f);
+    free(path);
+    path = oskar_dir_get_path(station_dir, "layout.txt");
+    f = fopen(path, "w");
+    fprintf(f, "-1.5, -1.0\n1.5, -1.0\n-1.5, 1.0\n1.5, 1.0\n");
+    fclose(f);
+    free(path);
+    free(station_dir);
+
+    // Load it.
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, 0, status);
+    oskar_telescope_set_enable_numerical_patterns(tel, 0);
+    oskar_telescope_load(tel, tel_dir, NULL, status);
+    oskar_telescope_set_phase_centre(tel, OSKAR_SPHERICAL_TYPE_EQUATORIAL,
+            ra0, dec0);
+    oskar_dir_remove(tel_dir);
+    return tel;
+}
+
+// Writes a chunked sky model file of sources within 5 degrees of the
+// phase centre, with Stokes I values from 1 to 10 Jy in every chunk.
+static void write_sky_file(int* status)
+{
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, status);
+    srand(3);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        double r = 5.0 * (M_PI / 180.0) * rand() / (double)RAND_MAX;
+        double a = 2.0 * M_PI * rand() / (double)RAND_MAX;
+        double dec = dec0 + r * sin(a);
+        double ra = ra0 + r * cos(a) / cos(dec);
+        oskar_sky_set_source(sky, i, ra, dec, 1.0 + i % 10, 0.0, 0.0, 0.0,
+                100e6, 0.0, 0.0, 0.0, 0.0, 0.0, status);
+    }
+    oskar_sky_write_chunked(sky_file, sky, sky_file_chunk_size, status);
+    oskar_sky_free(sky, status);
+}
+
+static oskar_Interferometer* create_simulator(const oskar_Telescope* tel,
+        int* status)
+{
+    oskar_Interferometer* h = oskar_interferometer_create(OSKAR_DOUBLE,
+            status);
+    oskar_interferometer_set_gpus(h, 0, 0, status);
+    oskar_interferometer_set_num_devices(h, 1);
+    oskar_interferometer_set_observation_time(h, 51544.78, 60.0, 3);
+    oskar_interferometer_set_observation_frequency(h, 100e6, 1e6, 2);
+    oskar_interferometer_set_max_sources_per_chunk(h, 64);
+    oskar_interferometer_set_max_times_per_block(h, 2);
+    oskar_interferometer_set_telescope_model(h, tel, status);
+    oskar_interferometer_set_sky_model_file(h, sky_file, status);
+    return h;
+}
+
+// Runs the simulator and returns the visibilities it wrote.
+static oskar_Vis* run_simulator(oskar_Interferometer* h, int* status)
+{
+    const char* vis_file = "temp_test_interferometer.vis";
+    oskar_interferometer_set_output_vis_file(h, vis_file);
+    oskar_interferometer_run(h, status);
+    oskar_Binary* b = oskar_binary_create(vis_file, 'r', status);
+    oskar_Vis* vis = oskar_vis_read(b, status);
+    oskar_binary_free(b);
+    remove(vis_file);
+    return vis;
+}
+
+// Returns the largest difference between the amplitudes in two sets of
+// visibilities, relative to the largest amplitude.
+static double max_rel_difference(const oskar_Vis* a, const oskar_Vis* b,
+        int* status)
+{
+    const oskar_Mem* amp_a = oskar_vis_amplitude_const(a);
+    const oskar_Mem* amp_b = oskar_vis_amplitude_const(b);
+    EXPECT_EQ(oskar_mem_length(amp_a), oskar_mem_length(amp_b));
+    const double* pa = (const double*) oskar_mem_void_const(amp_a);
+    const double* pb = (const double*) oskar_mem_void_const(amp_b);
+    size_t n = 2 * oskar_mem_length(amp_a);
+    if (oskar_mem_is_matrix(amp_a)) n *= 4;
+    double max_diff = 0.0, max_amp = 0.0;
+    for (size_t i = 0; i < n && !*status; ++i)
+    {
+        if (fabs(pa[i] - pb[i]) > max_diff) max_diff = fabs(pa[i] - pb[i]);
+        if (fabs(pa[i]) > max_amp) max_amp = fabs(pa[i]);
+    }
+    EXPECT_GT(max_amp, 0.0);
+    return max_amp > 0.0 ? max_diff / max_amp : max_diff;
+}
+
+TEST(interferometer, sky_file_selection_repeated)
+{
+    int status = 0;
+    oskar_Telescope* tel = create_telescope(&status);
+    write_sky_file(&status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Every chunk in the file is only partly excluded by the flux filter.
+    oskar_Interferometer* h = create_simulator(tel, &status);
+    oskar_interferometer_set_sky_model_filter(h, 5.5, 1e10, 0.0, M_PI);
+
+    // Stream the sky chunks, then repeat the simulation without the pool,
+    // which selects the chunks from the file again.
+    oskar_interferometer_set_sky_pool_size(h, 2);
+    oskar_Vis* vis_pool = run_simulator(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(num_sources / 2, oskar_interferometer_num_sources(h));
+    oskar_interferometer_set_sky_pool_size(h, 0);
+    oskar_Vis* vis = run_simulator(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(num_sources / 2, oskar_interferometer_num_sources(h));
+    EXPECT_LT(max_rel_difference(vis_pool, vis, &status), 1e-10);
+
+    // Check the sources in the mapped file were not modified.
+    oskar_Sky* sky = oskar_sky_read(sky_file, OSKAR_CPU, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double* I = oskar_mem_double_const(oskar_sky_I_const(sky), &status);
+    int num_bright = 0;
+    for (int i = 0; i < num_sources; ++i)
+        if (I[i] > 5.5) num_bright++;
+    EXPECT_EQ(num_sources / 2, num_bright);
+
+    oskar_sky_free(sky, &status);
+    oskar_vis_free(vis_pool, &status);
+    oskar_vis_free(vis, &status);
+    oskar_interferometer_free(h, &status);
+    oskar_telescope_free(tel, &status);
+    remove(sky_file);
+}
+
+TEST(interferometer, sky_pool)
+{
+    int status = 0;
+    const int pool_sizes[] = {1, 3, 8};
+    oskar_Telescope* tel = create_telescope(&status);
+    write_sky_file(&status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Simulate the whole sky model without streaming it.
+    oskar_Interferometer* h = create_simulator(tel, &status);
+    oskar_interferometer_set_num_devices(h, 2);
+    oskar_Vis* vis = run_simulator(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(num_sources, oskar_interferometer_num_sources(h));
+    oskar_interferometer_free(h, &status);
+
+    // Check the visibilities are the same when the sky chunks are streamed
+    // through pools of different sizes, which are never exceeded.
+    for (int i = 0; i < (int)(sizeof(pool_sizes) / sizeof(int)); ++i)
+    {
+        h = create_simulator(tel, &status);
+        oskar_interferometer_set_num_devices(h, 2);
+        oskar_interferometer_set_sky_pool_size(h, pool_sizes[i]);
+        oskar_Vis* vis_pool = run_simulator(h, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_EQ(num_sources, oskar_interferometer_num_sources(h));
+        EXPECT_GT(oskar_interferometer_sky_pool_peak(h), 0);
+        EXPECT_LE(oskar_interferometer_sky_pool_peak(h), pool_sizes[i]);
+        EXPECT_LT(max_rel_difference(vis, vis_pool, &status), 1e-10)
+                << "Pool size " << pool_sizes[i];
+        oskar_vis_free(vis_pool, &status);
+        oskar_interferometer_free(h, &status);
+    }
+
+    // Check a sky model set in memory is not streamed.
+    oskar_Sky* sky = oskar_sky_read(sky_file, OSKAR_CPU, &status);
+    h = create_simulator(tel, &status);
+    oskar_interferometer_set_num_devices(h, 2);
+    oskar_interferometer_set_sky_model(h, sky, &status);
+    oskar_interferometer_set_sky_pool_size(h, 2);
+    oskar_Vis* vis_memory = run_simulator(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0, oskar_interferometer_sky_pool_peak(h));
+    EXPECT_LT(max_rel_difference(vis, vis_memory, &status), 1e-10);
+    oskar_vis_free(vis_memory, &status);
+    oskar_interferometer_free(h, &status);
+    oskar_sky_free(sky, &status);
+
+    oskar_vis_free(vis, &status);
+    oskar_telescope_free(tel, &status);
+    remove(sky_file);
+}
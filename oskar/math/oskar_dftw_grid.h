@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_DFTW_GRID_H_
+#define OSKAR_DFTW_GRID_H_
+
+/**
+ * @file oskar_dftw_grid.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+/* Maximum number of distinct x or y positions in an input grid. */
+#define OSKAR_DFTW_GRID_MAX_SIDE 128
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Function to perform a 2D DFT using supplied weights, for inputs on a grid.
+ *
+ * @details
+ * This function computes the same result as oskar_dftw() with no input
+ * data (all input signals implicitly of amplitude 1.0), for input points
+ * that lie on a rectangular grid, which need not be regularly spaced.
+ *
+ * Input point (ix, iy) is at (\p x_in[ix], \p y_in[iy]), and its weight
+ * is \p weights_in[iy * \p num_x + ix]. Because the phase factor for each
+ * point is the product of the factors for its x and y positions, only
+ * \p num_x + \p num_y complex exponentials need to be evaluated for each
+ * output point, rather than \p num_x * \p num_y.
+ *
+ * The wavelength used to compute the supplied wavenumber must be in the
+ * same units as the input positions (e.g. metres).
+ *
+ * This function is only available for data in CPU memory, and neither
+ * \p num_x nor \p num_y may exceed OSKAR_DFTW_GRID_MAX_SIDE.
+ *
+ * @param[in] num_x        Number of distinct input x positions.
+ * @param[in] num_y        Number of distinct input y positions.
+ * @param[in] wavenumber   Wavenumber (2 pi / wavelength).
+ * @param[in] x_in         Array of input x positions (length num_x).
+ * @param[in] y_in         Array of input y positions (length num_y).
+ * @param[in] weights_in   Array of complex DFT weights (num_x * num_y).
+ * @param[in] num_out      Number of output points.
+ * @param[in] x_out        Array of output 1/x positions.
+ * @param[in] y_out        Array of output 1/y positions.
+ * @param[out] output      Array of computed output points.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_dftw_grid(int num_x, int num_y, double wavenumber,
+        const oskar_Mem* x_in, const oskar_Mem* y_in,
+        const oskar_Mem* weights_in, int num_out, const oskar_Mem* x_out,
+        const oskar_Mem* y_out, oskar_Mem* output, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_DFTW_GRID_H_ */
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_FFT_H_
+#define OSKAR_FFT_H_
+
+/**
+ * @file oskar_fft.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_FFT;
+#ifndef OSKAR_FFT_TYPEDEF_
+#define OSKAR_FFT_TYPEDEF_
+typedef struct oskar_FFT oskar_FFT;
+#endif /* OSKAR_FFT_TYPEDEF_ */
+
+/**
+ * @brief
+ * Creates a plan for a complex-to-complex FFT.
+ *
+ * @details
+ * Creates a plan for an in-place, forward, complex-to-complex FFT,
+ * using cuFFT for data in GPU memory, or FFTPACK for data in CPU memory.
+ *
+ * On the CPU, the transforms along each dimension are divided into blocks
+ * of rows or columns, which are processed in parallel using OpenMP.
+ * The number of threads can be set using oskar_fft_set_num_threads().
+ *
+ * The output is not normalised, for consistency with cuFFT.
+ *
+ * @param[in] precision      Enumerated precision (OSKAR_SINGLE or OSKAR_DOUBLE).
+ * @param[in] location       Enumerated location (OSKAR_CPU or OSKAR_GPU).
+ * @param[in] num_dim        Number of dimensions (1 or 2).
+ * @param[in] dim_size       Length of each dimension.
+ * @param[in] batch_size_1d  Number of 1D transforms to perform at once.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+oskar_FFT* oskar_fft_create(int precision, int location, int num_dim,
+        int dim_size, int batch_size_1d, int* status);
+
+/**
+ * @brief
+ * Performs an FFT using the supplied plan.
+ *
+ * @details
+ * Performs an in-place FFT on the supplied data, using the supplied plan.
+ * If the data are not in the memory location of the plan, they are copied
+ * there and back again.
+ *
+ * @param[in] h            Handle to FFT plan.
+ * @param[in,out] data     Data to transform.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_fft_exec(oskar_FFT* h, oskar_Mem* data, int* status);
+
+/**
+ * @brief
+ * Destroys the FFT plan.
+ *
+ * @details
+ * Destroys the FFT plan.
+ *
+ * @param[in] h            Handle to FFT plan.
+ */
+OSKAR_EXPORT
+void oskar_fft_free(oskar_FFT* h);
+
+/**
+ * @brief
+ * Sets the number of CPU threads used for the FFT.
+ *
+ * @details
+ * Sets the number of CPU threads used for the FFT.
+ * The default is the maximum number of OpenMP threads.
+ *
+ * @param[in] h            Handle to FFT plan.
+ * @param[in] value        Number of threads.
+ */
+OSKAR_EXPORT
+void oskar_fft_set_num_threads(oskar_FFT* h, int value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_FFT_H_ */
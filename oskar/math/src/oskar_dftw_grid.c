@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "math/oskar_dftw_grid.h"
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static void dftw_grid_f(const int num_x, const int num_y,
+        const float wavenumber, const float* x_in, const float* y_in,
+        const float2* weights_in, const int n_out, const float* x_out,
+        const float* y_out, float2* output)
+{
+    int i_out = 0;
+
+    /* Loop over output points. */
+    #pragma omp parallel for private(i_out)
+    for (i_out = 0; i_out < n_out; ++i_out)
+    {
+        int ix, iy;
+        float xp_out, yp_out;
+        float2 out, phase_x[OSKAR_DFTW_GRID_MAX_SIDE];
+
+        /* Clear output value. */
+        out.x = 0.0f;
+        out.y = 0.0f;
+
+        /* Get the output position. */
+        xp_out = wavenumber * x_out[i_out];
+        yp_out = wavenumber * y_out[i_out];
+
+        /* Calculate the phase factor for each column of the grid. */
+        for (ix = 0; ix < num_x; ++ix)
+        {
+            const float a = xp_out * x_in[ix];
+            phase_x[ix].x = cosf(a);
+            phase_x[ix].y = sinf(a);
+        }
+
+        /* Sum each row, and multiply by its phase factor. */
+        for (iy = 0; iy < num_y; ++iy)
+        {
+            float2 row, w;
+            float signal_x, signal_y;
+            const float2* weights_row = &weights_in[iy * num_x];
+            row.x = 0.0f;
+            row.y = 0.0f;
+            for (ix = 0; ix < num_x; ++ix)
+            {
+                w = weights_row[ix];
+                row.x += phase_x[ix].x * w.x;
+                row.x -= phase_x[ix].y * w.y;
+                row.y += phase_x[ix].y * w.x;
+                row.y += phase_x[ix].x * w.y;
+            }
+            {
+                const float a = yp_out * y_in[iy];
+                signal_x = cosf(a);
+                signal_y = sinf(a);
+            }
+            out.x += signal_x * row.x;
+            out.x -= signal_y * row.y;
+            out.y += signal_y * row.x;
+            out.y += signal_x * row.y;
+        }
+
+        /* Store the output point. */
+        output[i_out] = out;
+    }
+}
+
+static void dftw_grid_d(const int num_x, const int num_y,
+        const double wavenumber, const double* x_in, const double* y_in,
+        const double2* weights_in, const int n_out, const double* x_out,
+        const double* y_out, double2* output)
+{
+    int i_out = 0;
+
+    /* Loop over output points. */
+    #pragma omp parallel for private(i_out)
+    for (i_out = 0; i_out < n_out; ++i_out)
+    {
+        int ix, iy;
+        double xp_out, yp_out;
+        double2 out, phase_x[OSKAR_DFTW_GRID_MAX_SIDE];
+
+        /* Clear output value. */
+        out.x = 0.0;
+        out.y = 0.0;
+
+        /* Get the output position. */
+        xp_out = wavenumber * x_out[i_out];
+        yp_out = wavenumber * y_out[i_out];
+
+        /* Calculate the phase factor for each column of the grid. */
+        for (ix = 0; ix < num_x; ++ix)
+        {
+            const double a = xp_out * x_in[ix];
+            phase_x[ix].x = cos(a);
+            phase_x[ix].y = sin(a);
+        }
+
+        /* Sum each row, and multiply by its phase factor. */
+        for (iy = 0; iy < num_y; ++iy)
+        {
+            double2 row, w;
+            double signal_x, signal_y;
+            const double2* weights_row = &weights_in[iy * num_x];
+            row.x = 0.0;
+            row.y = 0.0;
+            for (ix = 0; ix < num_x; ++ix)
+            {
+                w = weights_row[ix];
+                row.x += phase_x[ix].x * w.x;
+                row.x -= phase_x[ix].y * w.y;
+                row.y += phase_x[ix].y * w.x;
+                row.y += phase_x[ix].x * w.y;
+            }
+            {
+                const double a = yp_out * y_in[iy];
+                signal_x = cos(a);
+                signal_y = sin(a);
+            }
+            out.x += signal_x * row.x;
+            out.x -= signal_y * row.y;
+            out.y += signal_y * row.x;
+            out.y += signal_x * row.y;
+        }
+
+        /* Store the output point. */
+        output[i_out] = out;
+    }
+}
+
+void oskar_dftw_grid(int num_x, int num_y, double wavenumber,
+        const oskar_Mem* x_in, const oskar_Mem* y_in,
+        const oskar_Mem* weights_in, int num_out, const oskar_Mem* x_out,
+        const oskar_Mem* y_out, oskar_Mem* output, int* status)
+{
+    int type;
+    if (*status) return;
+
+    /* Check types, locations and dimensions. */
+    type = oskar_mem_precision(output);
+    if (!oskar_mem_is_complex(output) || oskar_mem_is_matrix(output) ||
+            !oskar_mem_is_complex(weights_in) ||
+            oskar_mem_is_matrix(weights_in))
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (oskar_mem_location(output) != OSKAR_CPU ||
+            oskar_mem_location(weights_in) != OSKAR_CPU ||
+            oskar_mem_location(x_in) != OSKAR_CPU ||
+            oskar_mem_location(y_in) != OSKAR_CPU ||
+            oskar_mem_location(x_out) != OSKAR_CPU ||
+            oskar_mem_location(y_out) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_mem_precision(weights_in) != type ||
+            oskar_mem_type(x_in) != type ||
+            oskar_mem_type(y_in) != type ||
+            oskar_mem_type(x_out) != type ||
+            oskar_mem_type(y_out) != type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (num_x > OSKAR_DFTW_GRID_MAX_SIDE || num_y > OSKAR_DFTW_GRID_MAX_SIDE ||
+            (int)oskar_mem_length(x_in) < num_x ||
+            (int)oskar_mem_length(y_in) < num_y ||
+            (int)oskar_mem_length(weights_in) < num_x * num_y)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Resize output array if needed. */
+    if ((int)oskar_mem_length(output) < num_out)
+        oskar_mem_realloc(output, (size_t) num_out, status);
+    if (*status) return;
+
+    if (type == OSKAR_DOUBLE)
+        dftw_grid_d(num_x, num_y, wavenumber,
+                oskar_mem_double_const(x_in, status),
+                oskar_mem_double_const(y_in, status),
+                oskar_mem_double2_const(weights_in, status), num_out,
+                oskar_mem_double_const(x_out, status),
+                oskar_mem_double_const(y_out, status),
+                oskar_mem_double2(output, status));
+    else if (type == OSKAR_SINGLE)
+        dftw_grid_f(num_x, num_y, (float) wavenumber,
+                oskar_mem_float_const(x_in, status),
+                oskar_mem_float_const(y_in, status),
+                oskar_mem_float2_const(weights_in, status), num_out,
+                oskar_mem_float_const(x_out, status),
+                oskar_mem_float_const(y_out, status),
+                oskar_mem_float2(output, status));
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+}
+
+#ifdef __cplusplus
+}
+#endif
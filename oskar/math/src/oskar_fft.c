@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef OSKAR_HAVE_CUDA
+#include <cufft.h>
+#endif
+
+#include "math/oskar_fft.h"
+#include "math/oskar_fftpack_cfft.h"
+#include "math/oskar_fftpack_cfft_f.h"
+#include "utility/oskar_device_utils.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Multiple transforms are done by FFTPACK one block of adjacent rows or
+ * columns at a time, so that each block touches a compact region of memory.
+ * Different blocks use different parts of the work array, so they can be
+ * processed in parallel.
+ */
+#define BLOCK_COLS 32
+#define BLOCK_ROWS 2
+
+struct oskar_FFT
+{
+    int precision, location, num_dim, dim_size, batch_size_1d, num_threads;
+    oskar_Mem *fftpack_work, *fftpack_wsave;
+#ifdef OSKAR_HAVE_CUDA
+    cufftHandle cufft_plan;
+#endif
+};
+
+oskar_FFT* oskar_fft_create(int precision, int location, int num_dim,
+        int dim_size, int batch_size_1d, int* status)
+{
+    oskar_FFT* h = 0;
+    size_t num_cells;
+    if (*status) return 0;
+    if (num_dim != 1 && num_dim != 2)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return 0;
+    }
+    if (precision != OSKAR_SINGLE && precision != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return 0;
+    }
+    h = (oskar_FFT*) calloc(1, sizeof(oskar_FFT));
+    h->precision = precision;
+    h->location = location;
+    h->num_dim = num_dim;
+    h->dim_size = dim_size;
+    h->batch_size_1d = batch_size_1d > 0 ? batch_size_1d : 1;
+    h->num_threads = 1;
+#ifdef _OPENMP
+    h->num_threads = omp_get_max_threads();
+#endif
+    num_cells = (size_t) dim_size;
+    num_cells *= (num_dim == 1) ? (size_t) h->batch_size_1d : (size_t) dim_size;
+    if (location == OSKAR_CPU)
+    {
+        int len_save = 2 * dim_size +
+                (int)(log((double)dim_size) / log(2.0)) + 4;
+        h->fftpack_wsave = oskar_mem_create(precision, OSKAR_CPU,
+                len_save, status);
+        h->fftpack_work = oskar_mem_create(precision, OSKAR_CPU,
+                2 * num_cells, status);
+        if (precision == OSKAR_DOUBLE)
+            oskar_fftpack_cfftmi(dim_size,
+                    oskar_mem_double(h->fftpack_wsave, status));
+        else
+            oskar_fftpack_cfftmi_f(dim_size,
+                    oskar_mem_float(h->fftpack_wsave, status));
+    }
+    else if (location == OSKAR_GPU)
+    {
+#ifdef OSKAR_HAVE_CUDA
+        const cufftType type = (precision == OSKAR_DOUBLE) ?
+                CUFFT_Z2Z : CUFFT_C2C;
+        if (num_dim == 1)
+            cufftPlan1d(&h->cufft_plan, dim_size, type, h->batch_size_1d);
+        else
+            cufftPlan2d(&h->cufft_plan, dim_size, dim_size, type);
+#else
+        *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
+#endif
+    }
+    else
+        *status = OSKAR_ERR_BAD_LOCATION;
+    return h;
+}
+
+static void fft_blocks_d(int num_transforms, int jump, int n, int inc,
+        int block_size, double* data, double* wsave, double* work,
+        int num_threads)
+{
+    int i;
+    const int num_blocks = (num_transforms + block_size - 1) / block_size;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads) schedule(static)
+#else
+    (void) num_threads;
+#endif
+    for (i = 0; i < num_blocks; ++i)
+    {
+        const int start = i * block_size;
+        const int lot = (num_transforms - start < block_size) ?
+                num_transforms - start : block_size;
+        oskar_fftpack_cfftmf(lot, jump, n, inc, data + 2 * (size_t) start *
+                jump, wsave, work + 2 * (size_t) start * n);
+    }
+}
+
+static void fft_blocks_f(int num_transforms, int jump, int n, int inc,
+        int block_size, float* data, float* wsave, float* work,
+        int num_threads)
+{
+    int i;
+    const int num_blocks = (num_transforms + block_size - 1) / block_size;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads) schedule(static)
+#else
+    (void) num_threads;
+#endif
+    for (i = 0; i < num_blocks; ++i)
+    {
+        const int start = i * block_size;
+        const int lot = (num_transforms - start < block_size) ?
+                num_transforms - start : block_size;
+        oskar_fftpack_cfftmf_f(lot, jump, n, inc, data + 2 * (size_t) start *
+                jump, wsave, work + 2 * (size_t) start * n);
+    }
+}
+
+void oskar_fft_exec(oskar_FFT* h, oskar_Mem* data, int* status)
+{
+    oskar_Mem *data_copy = 0, *data_ptr = data;
+    if (*status) return;
+    if (oskar_mem_precision(data) != h->precision)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (oskar_mem_location(data) != h->location)
+    {
+        data_copy = oskar_mem_create_copy(data, h->location, status);
+        data_ptr = data_copy;
+    }
+    if (h->location == OSKAR_CPU)
+    {
+        const int n = h->dim_size;
+        if (h->precision == OSKAR_DOUBLE)
+        {
+            double* d = oskar_mem_double(data_ptr, status);
+            double* wsave = oskar_mem_double(h->fftpack_wsave, status);
+            double* work = oskar_mem_double(h->fftpack_work, status);
+            if (h->num_dim == 1)
+                fft_blocks_d(h->batch_size_1d, n, n, 1, BLOCK_ROWS,
+                        d, wsave, work, h->num_threads);
+            else
+            {
+                fft_blocks_d(n, 1, n, n, BLOCK_COLS,
+                        d, wsave, work, h->num_threads);
+                fft_blocks_d(n, n, n, 1, BLOCK_ROWS,
+                        d, wsave, work, h->num_threads);
+            }
+        }
+        else
+        {
+            float* d = oskar_mem_float(data_ptr, status);
+            float* wsave = oskar_mem_float(h->fftpack_wsave, status);
+            float* work = oskar_mem_float(h->fftpack_work, status);
+            if (h->num_dim == 1)
+                fft_blocks_f(h->batch_size_1d, n, n, 1, BLOCK_ROWS,
+                        d, wsave, work, h->num_threads);
+            else
+            {
+                fft_blocks_f(n, 1, n, n, BLOCK_COLS,
+                        d, wsave, work, h->num_threads);
+                fft_blocks_f(n, n, n, 1, BLOCK_ROWS,
+                        d, wsave, work, h->num_threads);
+            }
+        }
+
+        /* FFTPACK normalises the forward transform, but cuFFT does not. */
+        oskar_mem_scale_real(data_ptr, (h->num_dim == 1) ?
+                (double) n : (double) n * (double) n, status);
+    }
+    else if (h->location == OSKAR_GPU)
+    {
+#ifdef OSKAR_HAVE_CUDA
+        if (h->precision == OSKAR_DOUBLE)
+            cufftExecZ2Z(h->cufft_plan, oskar_mem_void(data_ptr),
+                    oskar_mem_void(data_ptr), CUFFT_FORWARD);
+        else
+            cufftExecC2C(h->cufft_plan, oskar_mem_void(data_ptr),
+                    oskar_mem_void(data_ptr), CUFFT_FORWARD);
+        oskar_device_check_error(status);
+#endif
+    }
+    if (data_copy)
+    {
+        oskar_mem_copy(data, data_copy, status);
+        oskar_mem_free(data_copy, status);
+    }
+}
+
+void oskar_fft_free(oskar_FFT* h)
+{
+    int status = 0;
+    if (!h) return;
+    oskar_mem_free(h->fftpack_work, &status);
+    oskar_mem_free(h->fftpack_wsave, &status);
+#ifdef OSKAR_HAVE_CUDA
+    if (h->location == OSKAR_GPU)
+        cufftDestroy(h->cufft_plan);
+#endif
+    free(h);
+}
+
+void oskar_fft_set_num_threads(oskar_FFT* h, int value)
+{
+    h->num_threads = value > 0 ? value : 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -29,6 +29,8 @@
 #include <gtest/gtest.h>
 
 #include "math/oskar_dft_c2r.h"
+#include "math/oskar_dftw.h"
+#include "math/oskar_dftw_grid.h"
 #include "math/oskar_cmath.h"
 #include "math/oskar_evaluate_image_lmn_grid.h"
 #include "utility/oskar_get_error_string.h"
@@ -123,3 +125,63 @@ TEST(dft, c2r)
     oskar_mem_free(v, &status);
     oskar_mem_free(w, &status);
 }
+
+TEST(dft, dftw_grid)
+{
+    int status = 0, num_x = 7, num_y = 5, num_out = 1000;
+    int num_in = num_x * num_y;
+    double wavenumber = 2 * M_PI * 100e6 / 299792458.;
+    oskar_Mem *x_grid, *y_grid, *x_in, *y_in, *weights, *x_out, *y_out;
+    oskar_Mem *out_grid, *out_dftw;
+    x_grid = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_x, &status);
+    y_grid = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_y, &status);
+    x_in = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_in, &status);
+    y_in = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_in, &status);
+    weights = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_in, &status);
+    x_out = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_out, &status);
+    y_out = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_out, &status);
+    out_grid = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_out, &status);
+    out_dftw = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_out, &status);
+
+    /* Generate an irregular grid of inputs, and random weights. */
+    oskar_mem_random_range(x_grid, -20., 20., &status);
+    oskar_mem_random_range(y_grid, -20., 20., &status);
+    oskar_mem_random_range(weights, -1., 1., &status);
+    oskar_mem_random_range(x_out, -1., 1., &status);
+    oskar_mem_random_range(y_out, -1., 1., &status);
+    ASSERT_EQ(0, status);
+    double* x_ = oskar_mem_double(x_in, &status);
+    double* y_ = oskar_mem_double(y_in, &status);
+    for (int iy = 0; iy < num_y; ++iy)
+    {
+        for (int ix = 0; ix < num_x; ++ix)
+        {
+            x_[iy * num_x + ix] = oskar_mem_double(x_grid, &status)[ix];
+            y_[iy * num_x + ix] = oskar_mem_double(y_grid, &status)[iy];
+        }
+    }
+
+    /* Compare against the full DFT. */
+    oskar_dftw_grid(num_x, num_y, wavenumber, x_grid, y_grid, weights,
+            num_out, x_out, y_out, out_grid, &status);
+    oskar_dftw(num_in, wavenumber, x_in, y_in, 0, weights,
+            num_out, x_out, y_out, 0, 0, out_dftw, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double* a = oskar_mem_double_const(out_grid, &status);
+    const double* b = oskar_mem_double_const(out_dftw, &status);
+    for (int i = 0; i < 2 * num_out; ++i)
+        EXPECT_NEAR(a[i], b[i], 1e-10);
+
+    oskar_mem_free(x_grid, &status);
+    oskar_mem_free(y_grid, &status);
+    oskar_mem_free(x_in, &status);
+    oskar_mem_free(y_in, &status);
+    oskar_mem_free(weights, &status);
+    oskar_mem_free(x_out, &status);
+    oskar_mem_free(y_out, &status);
+    oskar_mem_free(out_grid, &status);
+    oskar_mem_free(out_dftw, &status);
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_fft.h"
+#include "math/oskar_fftpack_cfft.h"
+#include "math/oskar_fftpack_cfft_f.h"
+#include "utility/oskar_timer.h"
+
+#include <cmath>
+#include <cstdlib>
+
+static void fill_random(oskar_Mem* data, int* status)
+{
+    size_t n = 2 * oskar_mem_length(data);
+    if (oskar_mem_precision(data) == OSKAR_DOUBLE)
+    {
+        double* p = oskar_mem_double(data, status);
+        for (size_t i = 0; i < n; ++i) p[i] = rand() / (double) RAND_MAX;
+    }
+    else
+    {
+        float* p = oskar_mem_float(data, status);
+        for (size_t i = 0; i < n; ++i) p[i] = rand() / (float) RAND_MAX;
+    }
+}
+
+TEST(fft, 2d_matches_fftpack)
+{
+    int status = 0;
+    const int sizes[] = {120, 256};
+    const int precs[] = {OSKAR_DOUBLE, OSKAR_SINGLE};
+    srand(2018);
+    for (int s = 0; s < 2; ++s)
+    {
+        for (int p = 0; p < 2; ++p)
+        {
+            const int n = sizes[s], prec = precs[p];
+            const int num_cells = n * n;
+            const int len_save = 4 * n + 2 * (int)(log((double)n) / log(2.0)) + 8;
+            oskar_Mem* data = oskar_mem_create(prec | OSKAR_COMPLEX,
+                    OSKAR_CPU, num_cells, &status);
+            fill_random(data, &status);
+            oskar_Mem* ref = oskar_mem_create_copy(data, OSKAR_CPU, &status);
+            oskar_Mem* wsave = oskar_mem_create(prec, OSKAR_CPU,
+                    len_save, &status);
+            oskar_Mem* work = oskar_mem_create(prec, OSKAR_CPU,
+                    2 * num_cells, &status);
+
+            // Reference transform using serial FFTPACK.
+            if (prec == OSKAR_DOUBLE)
+            {
+                oskar_fftpack_cfft2i(n, n, oskar_mem_double(wsave, &status));
+                oskar_fftpack_cfft2f(n, n, n, oskar_mem_double(ref, &status),
+                        oskar_mem_double(wsave, &status),
+                        oskar_mem_double(work, &status));
+            }
+            else
+            {
+                oskar_fftpack_cfft2i_f(n, n, oskar_mem_float(wsave, &status));
+                oskar_fftpack_cfft2f_f(n, n, n, oskar_mem_float(ref, &status),
+                        oskar_mem_float(wsave, &status),
+                        oskar_mem_float(work, &status));
+            }
+            oskar_mem_scale_real(ref, (double) num_cells, &status);
+
+            // Transform using the FFT plan.
+            oskar_FFT* fft = oskar_fft_create(prec, OSKAR_CPU, 2, n, 0,
+                    &status);
+            oskar_fft_set_num_threads(fft, 4);
+            oskar_fft_exec(fft, data, &status);
+            ASSERT_EQ(0, status);
+            EXPECT_EQ(0, oskar_mem_different(data, ref, 0, &status));
+
+            oskar_fft_free(fft);
+            oskar_mem_free(data, &status);
+            oskar_mem_free(ref, &status);
+            oskar_mem_free(wsave, &status);
+            oskar_mem_free(work, &status);
+        }
+    }
+}
+
+TEST(fft, 1d_batch_matches_dft)
+{
+    int status = 0;
+    const int n = 60, batch = 7;
+    oskar_Mem* data = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            n * batch, &status);
+    srand(2018);
+    fill_random(data, &status);
+    oskar_Mem* ref = oskar_mem_create_copy(data, OSKAR_CPU, &status);
+    oskar_FFT* fft = oskar_fft_create(OSKAR_DOUBLE, OSKAR_CPU, 1, n, batch,
+            &status);
+    oskar_fft_exec(fft, data, &status);
+    ASSERT_EQ(0, status);
+
+    // Compare each transform against a direct DFT.
+    const double* in = oskar_mem_double_const(ref, &status);
+    const double* out = oskar_mem_double_const(data, &status);
+    for (int b = 0; b < batch; ++b)
+    {
+        for (int k = 0; k < n; ++k)
+        {
+            double re = 0.0, im = 0.0;
+            for (int j = 0; j < n; ++j)
+            {
+                const double a = -2.0 * M_PI * j * k / n;
+                const double x = in[2 * (b * n + j)];
+                const double y = in[2 * (b * n + j) + 1];
+                re += x * cos(a) - y * sin(a);
+                im += x * sin(a) + y * cos(a);
+            }
+            EXPECT_NEAR(re, out[2 * (b * n + k)], 1e-10);
+            EXPECT_NEAR(im, out[2 * (b * n + k) + 1], 1e-10);
+        }
+    }
+    oskar_fft_free(fft);
+    oskar_mem_free(data, &status);
+    oskar_mem_free(ref, &status);
+}
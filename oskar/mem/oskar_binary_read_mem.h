@@ -83,6 +83,57 @@ void oskar_binary_read_mem_ext(oskar_Binary* handle, oskar_Mem* mem,
         const char* name_group, const char* name_tag, int user_index,
         int* status);
 
+/**
+ * @brief
+ * Returns an OSKAR memory block aliasing data in a memory-mapped binary file.
+ *
+ * @details
+ * This function returns a new CPU memory block containing the data for the
+ * given tag. If the binary file has been mapped into memory, the returned
+ * block is an alias of the mapped data, so no copy is made; otherwise
+ * (or if the data are not suitably aligned) the data are read into a
+ * newly-allocated block.
+ *
+ * The returned block must be freed using oskar_mem_free(), and the binary
+ * file handle must not be freed while an aliased block is in use.
+ * Modifications made to the block are not written to the file.
+ *
+ * @param[in,out] handle   Binary file handle.
+ * @param[in] data_type    Type of the memory (as in oskar_Mem).
+ * @param[in] id_group     Tag group identifier.
+ * @param[in] id_tag       Tag identifier.
+ * @param[in] user_index   User-defined index.
+ * @param[in,out] status   Status return code.
+ *
+ * @return A handle to the memory block.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_binary_map_mem(oskar_Binary* handle, int data_type,
+        unsigned char id_group, unsigned char id_tag, int user_index,
+        int* status);
+
+/**
+ * @brief
+ * Returns an OSKAR memory block aliasing data in a memory-mapped binary file.
+ *
+ * @details
+ * This function is the same as oskar_binary_map_mem(), but uses an
+ * extended tag specified by group and tag names.
+ *
+ * @param[in,out] handle   Binary file handle.
+ * @param[in] data_type    Type of the memory (as in oskar_Mem).
+ * @param[in] name_group   Tag group name.
+ * @param[in] name_tag     Tag name.
+ * @param[in] user_index   User-defined index.
+ * @param[in,out] status   Status return code.
+ *
+ * @return A handle to the memory block.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_binary_map_mem_ext(oskar_Binary* handle, int data_type,
+        const char* name_group, const char* name_tag, int user_index,
+        int* status);
+
 #ifdef __cplusplus
 }
 #endif
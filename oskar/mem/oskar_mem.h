@@ -83,7 +83,9 @@ enum OSKAR_MEM_LOCATION
 #include <mem/oskar_mem_accessors.h>
 #include <mem/oskar_mem_add.h>
 #include <mem/oskar_mem_add_real.h>
+#include <mem/oskar_mem_allocation_count.h>
 #include <mem/oskar_mem_append_raw.h>
+#include <mem/oskar_mem_arena.h>
 #include <mem/oskar_mem_clear_contents.h>
 #include <mem/oskar_mem_copy.h>
 #include <mem/oskar_mem_copy_contents.h>
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_MEM_ARENA_H_
+#define OSKAR_MEM_ARENA_H_
+
+/**
+ * @file oskar_mem_arena.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_MemArena;
+#ifndef OSKAR_MEM_ARENA_TYPEDEF_
+#define OSKAR_MEM_ARENA_TYPEDEF_
+typedef struct oskar_MemArena oskar_MemArena;
+#endif /* OSKAR_MEM_ARENA_TYPEDEF_ */
+
+/**
+ * @brief
+ * Creates an arena for temporary memory blocks.
+ *
+ * @details
+ * An arena holds a stack of memory blocks and aliases that are reused
+ * between calls, so that temporary arrays and alias handles needed in
+ * loops do not have to be allocated and freed each time.
+ *
+ * Blocks are taken from the arena using oskar_mem_arena_array() and
+ * oskar_mem_arena_alias(), and are returned to it all at once using
+ * oskar_mem_arena_release() or oskar_mem_arena_reset(). The arena keeps
+ * the memory, so a block taken at the same position next time will not
+ * need to be allocated again unless it needs to be larger.
+ *
+ * An arena must only be used by one thread at a time.
+ *
+ * @param[in] location      Location of arrays: either OSKAR_CPU or OSKAR_GPU.
+ * @param[in,out]  status   Status return code.
+ *
+ * @return A handle to the new arena.
+ */
+OSKAR_EXPORT
+oskar_MemArena* oskar_mem_arena_create(int location, int* status);
+
+/**
+ * @brief
+ * Frees an arena and all the memory it holds.
+ *
+ * @param[in,out] arena     Handle to arena.
+ * @param[in,out]  status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mem_arena_free(oskar_MemArena* arena, int* status);
+
+/**
+ * @brief
+ * Returns a temporary array from the arena.
+ *
+ * @details
+ * Returns a handle to an array of the given type and length, in the
+ * location of the arena. The contents of the array are undefined.
+ *
+ * The handle must not be freed or resized, and is valid until it is
+ * returned to the arena.
+ *
+ * @param[in,out] arena     Handle to arena.
+ * @param[in] type          Enumerated data type of the array.
+ * @param[in] num_elements  Number of elements in the array.
+ * @param[in,out]  status   Status return code.
+ *
+ * @return A handle to the array.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_mem_arena_array(oskar_MemArena* arena, int type,
+        size_t num_elements, int* status);
+
+/**
+ * @brief
+ * Returns a temporary alias from the arena.
+ *
+ * @details
+ * Returns a handle to an alias of part of the source memory block,
+ * as if created using oskar_mem_create_alias(). If \p src is NULL,
+ * the alias is empty, and can be set using oskar_mem_set_alias().
+ *
+ * The handle must not be freed, and is valid until it is returned to the
+ * arena.
+ *
+ * @param[in,out] arena     Handle to arena.
+ * @param[in] src           Handle to source memory block (may be NULL).
+ * @param[in] offset        Offset number of elements into source block.
+ * @param[in] num_elements  Number of elements in the alias.
+ * @param[in,out]  status   Status return code.
+ *
+ * @return A handle to the alias.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_mem_arena_alias(oskar_MemArena* arena, const oskar_Mem* src,
+        size_t offset, size_t num_elements, int* status);
+
+/**
+ * @brief
+ * Returns a temporary copy of an array, converted to the given precision.
+ *
+ * @details
+ * Returns a handle to an array in host memory from the arena, holding the
+ * contents of \p input converted to the given precision, in the same way
+ * as oskar_mem_convert_precision().
+ *
+ * @param[in,out] arena     Handle to arena (must be in host memory).
+ * @param[in] input         Handle to array to convert.
+ * @param[in] precision     Either OSKAR_SINGLE or OSKAR_DOUBLE.
+ * @param[in,out]  status   Status return code.
+ *
+ * @return A handle to the converted array.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_mem_arena_convert_precision(oskar_MemArena* arena,
+        const oskar_Mem* input, int precision, int* status);
+
+/**
+ * @brief
+ * Returns the current position of the arena.
+ *
+ * @details
+ * Returns a marker that can be passed to oskar_mem_arena_release(),
+ * to return all the blocks taken after this call to the arena.
+ *
+ * This is used to scope the temporary blocks used by a function.
+ *
+ * @param[in] arena         Handle to arena.
+ *
+ * @return The current position of the arena.
+ */
+OSKAR_EXPORT
+int oskar_mem_arena_mark(const oskar_MemArena* arena);
+
+/**
+ * @brief
+ * Returns blocks taken after a marker to the arena.
+ *
+ * @param[in,out] arena     Handle to arena.
+ * @param[in] mark          Value returned by oskar_mem_arena_mark().
+ */
+OSKAR_EXPORT
+void oskar_mem_arena_release(oskar_MemArena* arena, int mark);
+
+/**
+ * @brief
+ * Returns all blocks to the arena.
+ *
+ * @param[in,out] arena     Handle to arena.
+ */
+OSKAR_EXPORT
+void oskar_mem_arena_reset(oskar_MemArena* arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_MEM_ARENA_H_ */
@@ -64,6 +64,30 @@ OSKAR_EXPORT
 oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
         int* status);
 
+/**
+ * @brief
+ * Creates a memory block without clearing its contents.
+ *
+ * @details
+ * This function is the same as oskar_mem_create(), except that host memory
+ * is not cleared after it has been allocated. (Device memory is never
+ * cleared.) It should be used for arrays that will be completely
+ * overwritten before they are read.
+ *
+ * The memory must be deallocated using oskar_mem_free() when it is
+ * no longer required.
+ *
+ * @param[in] type          Enumerated data type of memory contents.
+ * @param[in] location      Either OSKAR_CPU or OSKAR_GPU.
+ * @param[in] num_elements  Number of elements of type \p type in the array.
+ * @param[in,out]  status   Status return code.
+ *
+ * @return A handle to the memory block structure.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_mem_create_uninitialised(int type, int location,
+        size_t num_elements, int* status);
+
 #ifdef __cplusplus
 }
 #endif
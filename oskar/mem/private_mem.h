@@ -62,4 +62,20 @@ struct oskar_Mem
 typedef struct oskar_Mem oskar_Mem;
 #endif /* OSKAR_MEM_TYPEDEF_ */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Records an allocation made for an oskar_Mem structure or its data. */
+void oskar_mem_count_allocation(void);
+
+/* Converts the precision of the input data into an existing host array of
+ * the same length and dimensions. */
+void oskar_mem_convert_precision_into(oskar_Mem* output,
+        const oskar_Mem* input, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* OSKAR_PRIVATE_MEM_H_ */
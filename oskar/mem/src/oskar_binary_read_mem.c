@@ -36,6 +36,9 @@
 extern "C" {
 #endif
 
+static oskar_Mem* oskar_binary_map_mem_chunk(oskar_Binary* handle,
+        int data_type, int chunk_index, size_t size_bytes, int* status);
+
 void oskar_binary_read_mem(oskar_Binary* handle, oskar_Mem* mem,
         unsigned char id_group, unsigned char id_tag, int user_index,
         int* status)
@@ -116,6 +119,57 @@ void oskar_binary_read_mem_ext(oskar_Binary* handle, oskar_Mem* mem,
     oskar_mem_free(temp, status);
 }
 
+oskar_Mem* oskar_binary_map_mem(oskar_Binary* handle, int data_type,
+        unsigned char id_group, unsigned char id_tag, int user_index,
+        int* status)
+{
+    int chunk_index;
+    size_t size_bytes = 0;
+    if (*status) return 0;
+    chunk_index = oskar_binary_query(handle, (unsigned char)data_type,
+            id_group, id_tag, user_index, &size_bytes, status);
+    return oskar_binary_map_mem_chunk(handle, data_type, chunk_index,
+            size_bytes, status);
+}
+
+oskar_Mem* oskar_binary_map_mem_ext(oskar_Binary* handle, int data_type,
+        const char* name_group, const char* name_tag, int user_index,
+        int* status)
+{
+    int chunk_index;
+    size_t size_bytes = 0;
+    if (*status) return 0;
+    chunk_index = oskar_binary_query_ext(handle, (unsigned char)data_type,
+            name_group, name_tag, user_index, &size_bytes, status);
+    return oskar_binary_map_mem_chunk(handle, data_type, chunk_index,
+            size_bytes, status);
+}
+
+static oskar_Mem* oskar_binary_map_mem_chunk(oskar_Binary* handle,
+        int data_type, int chunk_index, size_t size_bytes, int* status)
+{
+    oskar_Mem* mem;
+    void* ptr;
+    size_t element_size;
+    if (*status) return 0;
+
+    /* Return an alias of the mapped data, if it is suitably aligned. */
+    element_size = oskar_mem_element_size(data_type);
+    ptr = oskar_binary_map_block(handle, chunk_index, status);
+    if (*status) return 0;
+    if (ptr && ((size_t)ptr %
+            oskar_mem_element_size(oskar_type_precision(data_type))) == 0)
+        return oskar_mem_create_alias_from_raw(ptr, data_type,
+                OSKAR_CPU, size_bytes / element_size, status);
+
+    /* Otherwise, read a copy of the data. */
+    mem = oskar_mem_create(data_type, OSKAR_CPU, size_bytes / element_size,
+            status);
+    oskar_binary_read_block(handle, chunk_index, size_bytes,
+            oskar_mem_void(mem), status);
+    return mem;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/oskar_mem.h"
+#include "mem/oskar_mem_arena.h"
+#include "mem/private_mem.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Each position in the arena can hold an array and an alias handle,
+ * which are created when first needed. */
+struct ArenaEntry
+{
+    oskar_Mem* array;
+    size_t capacity;        /* Size of array, in bytes. */
+    oskar_Mem* alias;
+};
+typedef struct ArenaEntry ArenaEntry;
+
+struct oskar_MemArena
+{
+    int location, num_entries, num_used;
+    ArenaEntry* entries;
+};
+
+/* Returns the next free entry in the arena. */
+static ArenaEntry* next_entry(oskar_MemArena* arena, int* status)
+{
+    if (arena->num_used == arena->num_entries)
+    {
+        ArenaEntry* t;
+        const int num_entries = 2 * arena->num_entries + 8;
+        t = (ArenaEntry*) realloc(arena->entries,
+                num_entries * sizeof(ArenaEntry));
+        if (!t)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return 0;
+        }
+        arena->entries = t;
+        for (; arena->num_entries < num_entries; ++arena->num_entries)
+        {
+            t[arena->num_entries].array = 0;
+            t[arena->num_entries].capacity = 0;
+            t[arena->num_entries].alias = 0;
+        }
+    }
+    return &arena->entries[arena->num_used++];
+}
+
+oskar_MemArena* oskar_mem_arena_create(int location, int* status)
+{
+    oskar_MemArena* arena;
+    arena = (oskar_MemArena*) calloc(1, sizeof(oskar_MemArena));
+    if (!arena)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    arena->location = location;
+    return arena;
+}
+
+void oskar_mem_arena_free(oskar_MemArena* arena, int* status)
+{
+    int i;
+    if (!arena) return;
+    for (i = 0; i < arena->num_entries; ++i)
+    {
+        oskar_mem_free(arena->entries[i].array, status);
+        oskar_mem_free(arena->entries[i].alias, status);
+    }
+    free(arena->entries);
+    free(arena);
+}
+
+oskar_Mem* oskar_mem_arena_array(oskar_MemArena* arena, int type,
+        size_t num_elements, int* status)
+{
+    size_t bytes;
+    ArenaEntry* entry;
+    if (*status) return 0;
+    entry = next_entry(arena, status);
+    if (!entry) return 0;
+    bytes = num_elements * oskar_mem_element_size(type);
+    if (bytes == 0) bytes = 1;
+
+    /* Replace the array if it is too small. Its contents can be discarded,
+     * so it is not resized. */
+    if (bytes > entry->capacity)
+    {
+        oskar_mem_free(entry->array, status);
+        entry->array = oskar_mem_create_uninitialised(OSKAR_CHAR,
+                arena->location, bytes, status);
+        entry->capacity = *status ? 0 : bytes;
+        if (*status) return 0;
+    }
+
+    /* Set the meta-data of the array. */
+    entry->array->type = type;
+    entry->array->num_elements = num_elements;
+    return entry->array;
+}
+
+oskar_Mem* oskar_mem_arena_alias(oskar_MemArena* arena, const oskar_Mem* src,
+        size_t offset, size_t num_elements, int* status)
+{
+    ArenaEntry* entry;
+
+    /* As for oskar_mem_create_alias(), a handle is returned regardless of
+     * the status code, unless it cannot be allocated. */
+    entry = next_entry(arena, status);
+    if (!entry) return 0;
+    if (!entry->alias)
+    {
+        entry->alias = oskar_mem_create_alias(0, 0, 0, status);
+        if (!entry->alias) return 0;
+    }
+    if (src)
+        oskar_mem_set_alias(entry->alias, src, offset, num_elements, status);
+    else
+        entry->alias->num_elements = 0;
+    return entry->alias;
+}
+
+oskar_Mem* oskar_mem_arena_convert_precision(oskar_MemArena* arena,
+        const oskar_Mem* input, int precision, int* status)
+{
+    int type;
+    oskar_Mem* output;
+    if (*status) return 0;
+    if (arena->location != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return 0;
+    }
+    type = oskar_mem_type(input);
+    type = precision | (type & (OSKAR_COMPLEX | OSKAR_MATRIX));
+    output = oskar_mem_arena_array(arena, type, oskar_mem_length(input),
+            status);
+    oskar_mem_convert_precision_into(output, input, status);
+    return output;
+}
+
+int oskar_mem_arena_mark(const oskar_MemArena* arena)
+{
+    return arena->num_used;
+}
+
+void oskar_mem_arena_release(oskar_MemArena* arena, int mark)
+{
+    if (mark >= 0 && mark < arena->num_used)
+        arena->num_used = mark;
+}
+
+void oskar_mem_arena_reset(oskar_MemArena* arena)
+{
+    arena->num_used = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
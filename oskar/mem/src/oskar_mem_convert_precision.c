@@ -27,6 +27,7 @@
  */
 
 #include "mem/oskar_mem.h"
+#include "mem/private_mem.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,10 +36,8 @@ extern "C" {
 oskar_Mem* oskar_mem_convert_precision(const oskar_Mem* input,
         int output_precision, int* status)
 {
-    oskar_Mem *output = 0, *in_temp = 0;
-    const oskar_Mem *in = 0;
+    oskar_Mem *output = 0;
     int input_precision, type;
-    size_t num_elements, i;
 
     /* Check if safe to proceed. */
     if (*status) return 0;
@@ -51,6 +50,31 @@ oskar_Mem* oskar_mem_convert_precision(const oskar_Mem* input,
         return oskar_mem_create_copy(input, OSKAR_CPU, status);
     }
 
+    /* Create a new array to hold the converted data. */
+    type = oskar_mem_type(input);
+    type = output_precision | (type & (OSKAR_COMPLEX | OSKAR_MATRIX));
+    output = oskar_mem_create_uninitialised(type, OSKAR_CPU,
+            oskar_mem_length(input), status);
+
+    /* Convert the data. */
+    oskar_mem_convert_precision_into(output, input, status);
+    if (*status)
+    {
+        oskar_mem_free(output, status);
+        output = 0;
+    }
+    return output;
+}
+
+void oskar_mem_convert_precision_into(oskar_Mem* output,
+        const oskar_Mem* input, int* status)
+{
+    oskar_Mem *in_temp = 0;
+    const oskar_Mem *in = 0;
+    int input_precision, output_precision;
+    size_t num_elements, i;
+    if (*status) return;
+
     /* Copy source data to CPU memory if necessary. */
     if (oskar_mem_location(input) != OSKAR_CPU)
     {
@@ -62,23 +86,22 @@ oskar_Mem* oskar_mem_convert_precision(const oskar_Mem* input,
         in = input;
     }
 
-    /* Create a new array to hold the converted data. */
-    type = output_precision;
+    /* Get the number of real values to convert. */
     num_elements = oskar_mem_length(in);
     if (oskar_mem_is_complex(in))
-    {
-        type |= OSKAR_COMPLEX;
         num_elements *= 2;
-    }
     if (oskar_mem_is_matrix(in))
-    {
-        type |= OSKAR_MATRIX;
         num_elements *= 4;
-    }
-    output = oskar_mem_create(type, OSKAR_CPU, oskar_mem_length(in), status);
 
     /* Convert the data. */
-    if (input_precision == OSKAR_SINGLE &&
+    input_precision = oskar_mem_precision(in);
+    output_precision = oskar_mem_precision(output);
+    if (input_precision == output_precision)
+    {
+        oskar_mem_copy_contents(output, in, 0, 0,
+                oskar_mem_length(in), status);
+    }
+    else if (input_precision == OSKAR_SINGLE &&
             output_precision == OSKAR_DOUBLE)
     {
         const float* src_;
@@ -104,13 +127,10 @@ oskar_Mem* oskar_mem_convert_precision(const oskar_Mem* input,
     }
     else
     {
-        oskar_mem_free(output, status);
-        output = 0;
         *status = OSKAR_ERR_BAD_DATA_TYPE;
     }
 
     oskar_mem_free(in_temp, status);
-    return output;
 }
 
 #ifdef __cplusplus
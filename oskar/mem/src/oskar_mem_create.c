@@ -41,8 +41,8 @@
 extern "C" {
 #endif
 
-oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
-         int* status)
+static oskar_Mem* mem_create(int type, int location, size_t num_elements,
+        int clear, int* status)
 {
     oskar_Mem* mem = 0;
     size_t element_size, bytes;
@@ -54,6 +54,7 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
         *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
         return 0;
     }
+    oskar_mem_count_allocation();
 
     /* Initialise meta-data.
      * (This must happen regardless of the status code.) */
@@ -81,9 +82,10 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
     if (location == OSKAR_CPU)
     {
         /* Allocate host memory. */
-        mem->data = calloc(bytes, 1);
+        mem->data = clear ? calloc(bytes, 1) : malloc(bytes);
         if (mem->data == NULL)
             *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        oskar_mem_count_allocation();
     }
     else if (location == OSKAR_GPU)
     {
@@ -93,6 +95,7 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
         if (mem->data == NULL)
             *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
         oskar_device_check_error(status);
+        oskar_mem_count_allocation();
 #else
         *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
 #endif
@@ -106,6 +109,7 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
                 CL_MEM_READ_WRITE, bytes, NULL, &error);
         if (error != CL_SUCCESS)
             *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        oskar_mem_count_allocation();
 #else
         *status = OSKAR_ERR_OPENCL_NOT_AVAILABLE;
 #endif
@@ -119,6 +123,18 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
     return mem;
 }
 
+oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
+         int* status)
+{
+    return mem_create(type, location, num_elements, 1, status);
+}
+
+oskar_Mem* oskar_mem_create_uninitialised(int type, int location,
+        size_t num_elements, int* status)
+{
+    return mem_create(type, location, num_elements, 0, status);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -47,6 +47,7 @@ oskar_Mem* oskar_mem_create_alias_from_raw(void* ptr, int type, int location,
         *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
         return 0;
     }
+    oskar_mem_count_allocation();
 
     /* Initialise meta-data.
      * (This must happen regardless of the status code.) */
@@ -118,10 +118,11 @@ size_t oskar_mem_load_ascii(const char* filename, size_t num_mem,
         /* Loop over arrays passed to this function. */
         for (i = 0; i < num_mem; ++i)
         {
-            /* Resize the array if it isn't big enough to hold the new data. */
+            /* Resize the array if it isn't big enough to hold the new data.
+             * The capacity is doubled, to avoid quadratic copying. */
             if (oskar_mem_length(mem_handle[i]) <= row_index)
             {
-                oskar_mem_realloc(mem_handle[i], row_index + 1000, status);
+                oskar_mem_realloc(mem_handle[i], 2 * row_index + 1000, status);
                 if (*status) break;
             }
 
@@ -82,6 +82,7 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
             *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
             return;
         }
+        if (new_size > 0) oskar_mem_count_allocation();
 
         /* Initialise the new memory if it's larger than the old block. */
         if (new_size > old_size)
@@ -99,6 +100,7 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
         void* mem_new = NULL;
         if (new_size > 0)
         {
+            oskar_mem_count_allocation();
             cuda_error = cudaMalloc(&mem_new, new_size);
             if (cuda_error)
             {
@@ -147,6 +149,7 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
             *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
             return;
         }
+        oskar_mem_count_allocation();
 
         /* Copy contents of old block to new block. */
         const size_t copy_size = (old_size > new_size) ? new_size : old_size;
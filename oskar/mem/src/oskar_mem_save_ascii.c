@@ -28,22 +28,35 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "utility/oskar_double_to_string.h"
 
 #include <stdarg.h>
+#include <stdio.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#define SDF "% .6e "
-#define SDD "% .14e "
+/* Precision of single and double values, as "% .6e " and "% .14e ". */
+#define PF 6
+#define PD 14
+
+/* Size of output buffer, and space needed for one row of each array. */
+#define BUFFER_SIZE 65536
+#define MAX_ROW_CHARS 512
+
+#define WRITE_F(V) pos += oskar_double_to_string(buf + pos, V, PF); \
+        buf[pos++] = ' ';
+#define WRITE_D(V) pos += oskar_double_to_string(buf + pos, V, PD); \
+        buf[pos++] = ' ';
 
 void oskar_mem_save_ascii(FILE* file, size_t num_mem, size_t num_elements,
         int* status, ...)
 {
     int type;
-    size_t i, j;
+    size_t i, j, pos = 0;
     va_list args;
+    char* buf;
     oskar_Mem** handles; /* Array of oskar_Mem pointers in CPU memory. */
 
     /* Check if safe to proceed. */
@@ -64,8 +77,19 @@ void oskar_mem_save_ascii(FILE* file, size_t num_mem, size_t num_elements,
     /* Check if safe to proceed. */
     if (*status) return;
 
-    /* Allocate and set up the handle array. */
+    /* Allocate the handle array and the output buffer, before making any
+     * temporary copies, so nothing else needs freeing if this fails. */
     handles = (oskar_Mem**) malloc(num_mem * sizeof(oskar_Mem*));
+    buf = (char*) malloc(BUFFER_SIZE + num_mem * MAX_ROW_CHARS);
+    if (!handles || !buf)
+    {
+        free(handles);
+        free(buf);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+
+    /* Set up the handle array. */
     va_start(args, status);
     for (i = 0; i < num_mem; ++i)
     {
@@ -82,6 +106,7 @@ void oskar_mem_save_ascii(FILE* file, size_t num_mem, size_t num_elements,
     }
     va_end(args);
 
+    /* Format rows into the buffer, and write it out when it is full. */
     for (j = 0; j < num_elements; ++j)
     {
         /* Break if error. */
@@ -96,52 +121,52 @@ void oskar_mem_save_ascii(FILE* file, size_t num_mem, size_t num_elements,
             {
             case OSKAR_SINGLE:
             {
-                fprintf(file, SDF, ((const float*)data)[j]);
+                WRITE_F(((const float*)data)[j])
                 continue;
             }
             case OSKAR_DOUBLE:
             {
-                fprintf(file, SDD, ((const double*)data)[j]);
+                WRITE_D(((const double*)data)[j])
                 continue;
             }
             case OSKAR_SINGLE_COMPLEX:
             {
                 float2 d;
                 d = ((const float2*)data)[j];
-                fprintf(file, SDF SDF, d.x, d.y);
+                WRITE_F(d.x) WRITE_F(d.y)
                 continue;
             }
             case OSKAR_DOUBLE_COMPLEX:
             {
                 double2 d;
                 d = ((const double2*)data)[j];
-                fprintf(file, SDD SDD, d.x, d.y);
+                WRITE_D(d.x) WRITE_D(d.y)
                 continue;
             }
             case OSKAR_SINGLE_COMPLEX_MATRIX:
             {
                 float4c d;
                 d = ((const float4c*)data)[j];
-                fprintf(file, SDF SDF SDF SDF SDF SDF SDF SDF,
-                        d.a.x, d.a.y, d.b.x, d.b.y, d.c.x, d.c.y, d.d.x, d.d.y);
+                WRITE_F(d.a.x) WRITE_F(d.a.y) WRITE_F(d.b.x) WRITE_F(d.b.y)
+                WRITE_F(d.c.x) WRITE_F(d.c.y) WRITE_F(d.d.x) WRITE_F(d.d.y)
                 continue;
             }
             case OSKAR_DOUBLE_COMPLEX_MATRIX:
             {
                 double4c d;
                 d = ((const double4c*)data)[j];
-                fprintf(file, SDD SDD SDD SDD SDD SDD SDD SDD,
-                        d.a.x, d.a.y, d.b.x, d.b.y, d.c.x, d.c.y, d.d.x, d.d.y);
+                WRITE_D(d.a.x) WRITE_D(d.a.y) WRITE_D(d.b.x) WRITE_D(d.b.y)
+                WRITE_D(d.c.x) WRITE_D(d.c.y) WRITE_D(d.d.x) WRITE_D(d.d.y)
                 continue;
             }
             case OSKAR_CHAR:
             {
-                putc(((const char*)data)[j], file);
+                buf[pos++] = ((const char*)data)[j];
                 continue;
             }
             case OSKAR_INT:
             {
-                fprintf(file, "%5d ", ((const int*)data)[j]);
+                pos += sprintf(buf + pos, "%5d ", ((const int*)data)[j]);
                 continue;
             }
             default:
@@ -151,8 +176,15 @@ void oskar_mem_save_ascii(FILE* file, size_t num_mem, size_t num_elements,
             }
             }
         }
-        putc('\n', file);
+        buf[pos++] = '\n';
+        if (pos >= BUFFER_SIZE)
+        {
+            fwrite(buf, 1, pos, file);
+            pos = 0;
+        }
     }
+    if (pos > 0) fwrite(buf, 1, pos, file);
+    free(buf);
 
     /* Free any temporary memory used by this function. */
     va_start(args, status);
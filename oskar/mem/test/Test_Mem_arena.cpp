@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mem/oskar_mem.h"
+#include "utility/oskar_get_error_string.h"
+
+TEST(Mem, arena_reuse)
+{
+    int status = 0;
+    oskar_MemArena* arena = oskar_mem_arena_create(OSKAR_CPU, &status);
+    oskar_Mem* src = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 100, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    double* src_ = oskar_mem_double(src, &status);
+    for (int i = 0; i < 100; ++i) src_[i] = (double) i;
+
+    // Take an array and an alias, and check them.
+    oskar_Mem* a = oskar_mem_arena_array(arena, OSKAR_SINGLE_COMPLEX,
+            50, &status);
+    oskar_Mem* b = oskar_mem_arena_alias(arena, src, 10, 20, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ((int)OSKAR_SINGLE_COMPLEX, oskar_mem_type(a));
+    ASSERT_EQ(50, (int)oskar_mem_length(a));
+    ASSERT_EQ((int)OSKAR_DOUBLE, oskar_mem_type(b));
+    ASSERT_EQ(20, (int)oskar_mem_length(b));
+    EXPECT_DOUBLE_EQ(10.0, oskar_mem_double(b, &status)[0]);
+
+    // Blocks taken inside a scope are returned when it ends.
+    int mark = oskar_mem_arena_mark(arena);
+    oskar_Mem* c = oskar_mem_arena_array(arena, OSKAR_INT, 10, &status);
+    oskar_mem_arena_release(arena, mark);
+    EXPECT_EQ(c, oskar_mem_arena_array(arena, OSKAR_INT, 5, &status));
+
+    // Smaller requests at the same positions reuse the same memory,
+    // without further allocations.
+    void* a_data = oskar_mem_void(a);
+    oskar_mem_arena_reset(arena);
+    size_t count = oskar_mem_allocation_count();
+    oskar_Mem* a2 = oskar_mem_arena_array(arena, OSKAR_DOUBLE, 40, &status);
+    oskar_Mem* b2 = oskar_mem_arena_alias(arena, src, 0, 100, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(count, oskar_mem_allocation_count());
+    EXPECT_EQ(a, a2);
+    EXPECT_EQ(b, b2);
+    EXPECT_EQ(a_data, oskar_mem_void(a2));
+    EXPECT_EQ((int)OSKAR_DOUBLE, oskar_mem_type(a2));
+    EXPECT_EQ(40, (int)oskar_mem_length(a2));
+    EXPECT_EQ(100, (int)oskar_mem_length(b2));
+
+    // Larger requests need a new array.
+    oskar_mem_arena_reset(arena);
+    oskar_mem_arena_array(arena, OSKAR_DOUBLE, 1000, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(count, oskar_mem_allocation_count());
+
+    oskar_mem_free(src, &status);
+    oskar_mem_arena_free(arena, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(Mem, arena_convert_precision)
+{
+    int status = 0;
+    oskar_MemArena* arena = oskar_mem_arena_create(OSKAR_CPU, &status);
+    oskar_Mem* src = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            10, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    double* src_ = oskar_mem_double(src, &status);
+    for (int i = 0; i < 20; ++i) src_[i] = 0.5 * i;
+    oskar_Mem* out = oskar_mem_arena_convert_precision(arena, src,
+            OSKAR_SINGLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ((int)OSKAR_SINGLE_COMPLEX, oskar_mem_type(out));
+    ASSERT_EQ(10, (int)oskar_mem_length(out));
+    const float* out_ = oskar_mem_float_const(out, &status);
+    for (int i = 0; i < 20; ++i)
+        EXPECT_FLOAT_EQ(0.5f * i, out_[i]);
+    oskar_mem_free(src, &status);
+    oskar_mem_arena_free(arena, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(Mem, create_uninitialised)
+{
+    int status = 0;
+    oskar_Mem* mem = oskar_mem_create_uninitialised(OSKAR_SINGLE_COMPLEX,
+            OSKAR_CPU, 100, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ((int)OSKAR_SINGLE_COMPLEX, oskar_mem_type(mem));
+    ASSERT_EQ(100, (int)oskar_mem_length(mem));
+    ASSERT_TRUE(oskar_mem_void(mem) != 0);
+    oskar_mem_free(mem, &status);
+}
@@ -230,6 +230,24 @@ void oskar_ms_set_station_coords_f(oskar_MeasurementSet* p,
 OSKAR_MS_EXPORT
 void oskar_ms_set_time_range(oskar_MeasurementSet* p);
 
+/**
+ * @brief
+ * Returns a staging buffer owned by the Measurement Set handle.
+ *
+ * @details
+ * Returns a scratch buffer of at least \p size_bytes, which callers can use
+ * to assemble data in the order needed by the write functions.
+ * The buffer is kept and reused between calls (growing it only when
+ * needed), and is freed when the Measurement Set is closed, so
+ * writing a sequence of blocks does not allocate memory for each one.
+ *
+ * The contents are not preserved between calls.
+ *
+ * @param[in] size_bytes  Minimum size of the buffer, in bytes.
+ */
+OSKAR_MS_EXPORT
+void* oskar_ms_staging_buffer(oskar_MeasurementSet* p, size_t size_bytes);
+
 /**
  * @brief
  * Returns the time increment in the Measurement Set.
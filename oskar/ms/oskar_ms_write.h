@@ -107,6 +107,43 @@ void oskar_ms_write_coords_f(oskar_MeasurementSet* p,
         const float* uu, const float* vv, const float* ww,
         double exposure_sec, double interval_sec, double time_stamp);
 
+/**
+ * @details
+ * Writes baseline coordinate data to the main table, row by row.
+ *
+ * @details
+ * This function writes the supplied list of rows to the main table of the
+ * Measurement Set, extending it if necessary.
+ *
+ * Unlike oskar_ms_write_coords_d(), the antenna indices, time stamp,
+ * exposure, interval and weight are given separately for each row,
+ * so that rows may cover different lengths of time (as produced by
+ * baseline-dependent averaging). The SIGMA column is set to the inverse
+ * square root of the weight.
+ *
+ * The time stamps are given in units of (MJD) * 86400, i.e. seconds since
+ * Julian date 2400000.5.
+ *
+ * @param[in] start_row     The start row index to write (zero-based).
+ * @param[in] num_rows      Number of rows to write to the main table.
+ * @param[in] antenna1      First antenna index of each row.
+ * @param[in] antenna2      Second antenna index of each row.
+ * @param[in] uu            Baseline u-coordinates, in metres.
+ * @param[in] vv            Baseline v-coordinates, in metres.
+ * @param[in] ww            Baseline w-coordinates, in metres.
+ * @param[in] time_stamp    Time stamp of each row.
+ * @param[in] exposure_sec  The exposure length of each row, in seconds.
+ * @param[in] interval_sec  The interval length of each row, in seconds.
+ * @param[in] weight        The weight of each row.
+ */
+OSKAR_MS_EXPORT
+void oskar_ms_write_coords_rows_d(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int num_rows,
+        const int* antenna1, const int* antenna2,
+        const double* uu, const double* vv, const double* ww,
+        const double* time_stamp, const double* exposure_sec,
+        const double* interval_sec, const double* weight);
+
 /**
  * @details
  * Writes visibility data to the main table.
@@ -173,6 +210,35 @@ void oskar_ms_write_vis_f(oskar_MeasurementSet* p,
         unsigned int num_channels, unsigned int num_baselines,
         const float* vis);
 
+/**
+ * @brief
+ * Writes visibility data for a contiguous range of rows to the main table.
+ *
+ * @details
+ * This function writes the given block of visibility data to the
+ * data column of the Measurement Set, extending it if necessary.
+ *
+ * Unlike oskar_ms_write_vis_f(), the data must already be in the
+ * order used by the Measurement Set, so no reordering is required and
+ * the block is written using a single call to the storage manager.
+ * The block may span any number of rows (for example, several time steps).
+ *
+ * The dimensionality of the complex \p vis data block is:
+ * (num_rows * num_channels * num_pols),
+ * with num_pols the fastest varying dimension, then num_channels,
+ * and num_rows the slowest.
+ *
+ * @param[in] start_row     The start row index to write (zero-based).
+ * @param[in] start_channel The start channel index of the visibility block.
+ * @param[in] num_channels  The number of channels in the visibility block.
+ * @param[in] num_rows      The number of rows in the visibility block.
+ * @param[in] vis           Pointer to complex visibility block.
+ */
+OSKAR_MS_EXPORT
+void oskar_ms_write_vis_rows_f(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int start_channel,
+        unsigned int num_channels, unsigned int num_rows, const float* vis);
+
 #ifdef __cplusplus
 }
 #endif
@@ -35,6 +35,8 @@ struct oskar_MeasurementSet
     casa::MSMainColumns* msmc;  // Pointer to the main columns.
     char* app_name;
     unsigned int *a1, *a2;
+    void* staging;              // Staging buffer for writes.
+    size_t staging_bytes;       // Size of the staging buffer, in bytes.
     unsigned int num_pols, num_channels, num_stations, num_receptors;
     int data_written;
     double freq_start_hz, freq_inc_hz;
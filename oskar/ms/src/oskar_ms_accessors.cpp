@@ -32,6 +32,8 @@
 #include <tables/Tables.h>
 #include <casa/Arrays/Vector.h>
 
+#include <cstdlib>
+
 using namespace casa;
 
 size_t oskar_ms_column_element_size(const oskar_MeasurementSet* p,
@@ -234,6 +236,18 @@ void oskar_ms_set_time_range(oskar_MeasurementSet* p)
     p->msc->observation().releaseDate().put(0, release_date);
 }
 
+void* oskar_ms_staging_buffer(oskar_MeasurementSet* p, size_t size_bytes)
+{
+    if (size_bytes > p->staging_bytes)
+    {
+        void* t = realloc(p->staging, size_bytes);
+        if (!t) return 0;
+        p->staging = t;
+        p->staging_bytes = size_bytes;
+    }
+    return p->staging;
+}
+
 double oskar_ms_time_inc_sec(const oskar_MeasurementSet* p)
 {
     return p->time_inc_sec;
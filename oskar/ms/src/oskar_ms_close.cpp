@@ -44,6 +44,7 @@ void oskar_ms_close(oskar_MeasurementSet* p)
         delete p->ms;
     free(p->a1);
     free(p->a2);
+    free(p->staging);
     free(p->app_name);
     free(p);
 }
@@ -113,10 +113,22 @@ oskar_MeasurementSet* oskar_ms_create(const char* file_name,
         tab.bindColumn(MS::columnName(MS::SIGMA), sigmaStorageManager);
 
         // Create tiled column storage managers for DATA and FLAG columns.
-        IPosition dataTileShape(3, num_pols, num_channels, 2 * num_baselines);
+        // Use tiles of about 1 MiB, so that a block of rows written in one
+        // call maps onto a small number of whole tiles. Where possible,
+        // tiles hold all channels and a whole number of time steps.
+        const unsigned int tile_bytes = 1024 * 1024;
+        unsigned int tile_channels = num_channels;
+        if (num_pols * num_channels * sizeof(Complex) > tile_bytes)
+            tile_channels = tile_bytes / (num_pols * sizeof(Complex));
+        unsigned int tile_rows =
+                tile_bytes / (num_pols * tile_channels * sizeof(Complex));
+        if (tile_rows >= num_baselines)
+            tile_rows -= tile_rows % num_baselines;
+        if (tile_rows < 1) tile_rows = 1;
+        IPosition dataTileShape(3, num_pols, tile_channels, tile_rows);
         TiledColumnStMan dataStorageManager("TiledData", dataTileShape);
         tab.bindColumn(MS::columnName(MS::DATA), dataStorageManager);
-        IPosition flagTileShape(3, num_pols, num_channels, 16 * num_baselines);
+        IPosition flagTileShape(3, num_pols, tile_channels, 16 * tile_rows);
         TiledColumnStMan flagStorageManager("TiledFlag", flagTileShape);
         tab.bindColumn(MS::columnName(MS::FLAG), flagStorageManager);
 
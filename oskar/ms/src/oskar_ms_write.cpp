@@ -30,8 +30,11 @@
 #include "ms/private_ms.h"
 
 #include <tables/Tables.h>
+#include <casa/Arrays/Matrix.h>
 #include <casa/Arrays/Vector.h>
 
+#include <cmath>
+
 using namespace casa;
 
 static void oskar_ms_create_baseline_indices(oskar_MeasurementSet* p,
@@ -91,47 +94,41 @@ void oskar_ms_write_coords(oskar_MeasurementSet* p,
         double exposure_sec, double interval_sec, double time_stamp)
 {
     MSMainColumns* msmc = p->msmc;
-    if (!msmc) return;
-
-    // Allocate storage for a (u,v,w) coordinate and a visibility weight.
-    Vector<Double> uvw(3);
-    Vector<Float> weight(p->num_pols, 1.0), sigma(p->num_pols, 1.0);
-
-    // Get references to columns.
-    ArrayColumn<Double>& col_uvw = msmc->uvw();
-    ScalarColumn<Int>& col_antenna1 = msmc->antenna1();
-    ScalarColumn<Int>& col_antenna2 = msmc->antenna2();
-    ArrayColumn<Float>& col_weight = msmc->weight();
-    ArrayColumn<Float>& col_sigma = msmc->sigma();
-    ScalarColumn<Double>& col_exposure = msmc->exposure();
-    ScalarColumn<Double>& col_interval = msmc->interval();
-    ScalarColumn<Double>& col_time = msmc->time();
-    ScalarColumn<Double>& col_timeCentroid = msmc->timeCentroid();
-
-    // Add new rows if required.
-    oskar_ms_ensure_num_rows(p, start_row + num_baselines);
+    if (!msmc || num_baselines == 0) return;
 
     // Create baseline antenna indices if required.
     if (!p->a1 || !p->a2)
         oskar_ms_create_baseline_indices(p, num_baselines);
 
-    // Loop over rows to add.
+    // Assemble the columns for all rows.
+    Matrix<Double> uvw(3, num_baselines);
+    Vector<Int> antenna1(num_baselines), antenna2(num_baselines);
+    Matrix<Float> weight(p->num_pols, num_baselines, 1.0);
+    Vector<Double> times(num_baselines, time_stamp);
     for (unsigned int r = 0; r < num_baselines; ++r)
     {
-        // Write the data to the Measurement Set.
-        unsigned int row = r + start_row;
-        uvw(0) = uu[r]; uvw(1) = vv[r]; uvw(2) = ww[r];
-        col_uvw.put(row, uvw);
-        col_antenna1.put(row, p->a1[r]);
-        col_antenna2.put(row, p->a2[r]);
-        col_weight.put(row, weight);
-        col_sigma.put(row, sigma);
-        col_exposure.put(row, exposure_sec);
-        col_interval.put(row, interval_sec);
-        col_time.put(row, time_stamp);
-        col_timeCentroid.put(row, time_stamp);
+        uvw(0, r) = uu[r]; uvw(1, r) = vv[r]; uvw(2, r) = ww[r];
+        antenna1(r) = p->a1[r];
+        antenna2(r) = p->a2[r];
     }
 
+    // Add new rows if required.
+    oskar_ms_ensure_num_rows(p, start_row + num_baselines);
+
+    // Write each column as a single range of rows.
+    Slicer row_range(IPosition(1, start_row), IPosition(1, num_baselines));
+    msmc->uvw().putColumnRange(row_range, uvw);
+    msmc->antenna1().putColumnRange(row_range, antenna1);
+    msmc->antenna2().putColumnRange(row_range, antenna2);
+    msmc->weight().putColumnRange(row_range, weight);
+    msmc->sigma().putColumnRange(row_range, weight);
+    msmc->exposure().putColumnRange(row_range,
+            Vector<Double>(num_baselines, exposure_sec));
+    msmc->interval().putColumnRange(row_range,
+            Vector<Double>(num_baselines, interval_sec));
+    msmc->time().putColumnRange(row_range, times);
+    msmc->timeCentroid().putColumnRange(row_range, times);
+
     // Update time range if required.
     if (time_stamp < p->start_time)
         p->start_time = time_stamp - interval_sec/2.0;
@@ -159,53 +156,126 @@ void oskar_ms_write_coords_f(oskar_MeasurementSet* p,
             exposure_sec, interval_sec, time_stamp);
 }
 
+void oskar_ms_write_coords_rows_d(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int num_rows,
+        const int* antenna1, const int* antenna2,
+        const double* uu, const double* vv, const double* ww,
+        const double* time_stamp, const double* exposure_sec,
+        const double* interval_sec, const double* weight)
+{
+    MSMainColumns* msmc = p->msmc;
+    if (!msmc || num_rows == 0) return;
+
+    // Assemble the columns for all rows.
+    const unsigned int num_pols = p->num_pols;
+    Matrix<Double> uvw(3, num_rows);
+    Matrix<Float> wt(num_pols, num_rows), sigma(num_pols, num_rows);
+    for (unsigned int r = 0; r < num_rows; ++r)
+    {
+        const Float s = (Float) (weight[r] > 0.0 ?
+                1.0 / std::sqrt(weight[r]) : 1.0);
+        uvw(0, r) = uu[r]; uvw(1, r) = vv[r]; uvw(2, r) = ww[r];
+        for (unsigned int i = 0; i < num_pols; ++i)
+        {
+            wt(i, r) = (Float) weight[r];
+            sigma(i, r) = s;
+        }
+
+        // Update time range if required.
+        if (time_stamp[r] - interval_sec[r]/2.0 < p->start_time)
+            p->start_time = time_stamp[r] - interval_sec[r]/2.0;
+        if (time_stamp[r] + interval_sec[r]/2.0 > p->end_time)
+            p->end_time = time_stamp[r] + interval_sec[r]/2.0;
+    }
+
+    // Add new rows if required.
+    oskar_ms_ensure_num_rows(p, start_row + num_rows);
+
+    // Write each column as a single range of rows.
+    // The input arrays are not modified by the Vector wrappers.
+    Slicer row_range(IPosition(1, start_row), IPosition(1, num_rows));
+    IPosition shape(1, num_rows);
+    msmc->uvw().putColumnRange(row_range, uvw);
+    msmc->antenna1().putColumnRange(row_range,
+            Vector<Int>(shape, (Int*) antenna1, SHARE));
+    msmc->antenna2().putColumnRange(row_range,
+            Vector<Int>(shape, (Int*) antenna2, SHARE));
+    msmc->weight().putColumnRange(row_range, wt);
+    msmc->sigma().putColumnRange(row_range, sigma);
+    msmc->exposure().putColumnRange(row_range,
+            Vector<Double>(shape, (Double*) exposure_sec, SHARE));
+    msmc->interval().putColumnRange(row_range,
+            Vector<Double>(shape, (Double*) interval_sec, SHARE));
+    msmc->time().putColumnRange(row_range,
+            Vector<Double>(shape, (Double*) time_stamp, SHARE));
+    msmc->timeCentroid().putColumnRange(row_range,
+            Vector<Double>(shape, (Double*) time_stamp, SHARE));
+    p->data_written = 1;
+}
+
+static void oskar_ms_put_vis(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int start_channel,
+        unsigned int num_channels, unsigned int num_rows,
+        Array<Complex>& vis_data)
+{
+    // Add new rows if required.
+    oskar_ms_ensure_num_rows(p, start_row + num_rows);
+
+    // Create the slicers for the column.
+    IPosition start1(1, start_row);
+    IPosition length1(1, num_rows);
+    Slicer row_range(start1, length1);
+    IPosition start2(2, 0, start_channel);
+    IPosition length2(2, p->num_pols, num_channels);
+    Slicer array_section(start2, length2);
+
+    // Write visibilities to DATA column.
+    ArrayColumn<Complex>& col_data = p->msmc->data();
+    col_data.putColumnRange(row_range, array_section, vis_data);
+    p->data_written = 1;
+}
+
+// Number of channels in each tile of the transpose in oskar_ms_write_vis().
+#define TILE_CHANNELS 16
+
 template <typename T>
 void oskar_ms_write_vis(oskar_MeasurementSet* p,
         unsigned int start_row, unsigned int start_channel,
         unsigned int num_channels, unsigned int num_baselines, const T* vis)
 {
-    MSMainColumns* msmc = p->msmc;
-    if (!msmc) return;
+    if (!p->msmc) return;
 
     // Allocate storage for the block of visibility data.
-    unsigned int num_pols = p->num_pols;
+    const unsigned int num_pols = p->num_pols;
     IPosition shape(3, num_pols, num_channels, num_baselines);
     Array<Complex> vis_data(shape);
 
     // Copy visibility data into the array,
     // swapping baseline and channel dimensions.
+    // The channels are processed in tiles, so that the input cache lines
+    // for a tile are reused by consecutive baselines.
     float* out = (float*) vis_data.data();
-    for (unsigned int c = 0; c < num_channels; ++c)
+    const size_t n = 2 * num_pols;
+    for (unsigned int c0 = 0; c0 < num_channels; c0 += TILE_CHANNELS)
     {
+        const unsigned int c1 = (c0 + TILE_CHANNELS < num_channels) ?
+                c0 + TILE_CHANNELS : num_channels;
         for (unsigned int b = 0; b < num_baselines; ++b)
         {
-            for (unsigned int p = 0; p < num_pols; ++p)
+            for (unsigned int c = c0; c < c1; ++c)
             {
-                unsigned int i = (num_pols * (c * num_baselines + b) + p) << 1;
-                unsigned int j = (num_pols * (b * num_channels + c) + p) << 1;
-                out[j]     = vis[i];
-                out[j + 1] = vis[i + 1];
+                const T* in_ = vis + n * ((size_t) c * num_baselines + b);
+                float* out_ = out + n * ((size_t) b * num_channels + c);
+                for (size_t i = 0; i < n; ++i) out_[i] = (float) in_[i];
             }
         }
     }
-
-    // Add new rows if required.
-    oskar_ms_ensure_num_rows(p, start_row + num_baselines);
-
-    // Create the slicers for the column.
-    IPosition start1(1, start_row);
-    IPosition length1(1, num_baselines);
-    Slicer row_range(start1, length1);
-    IPosition start2(2, 0, start_channel);
-    IPosition length2(2, num_pols, num_channels);
-    Slicer array_section(start2, length2);
-
-    // Write visibilities to DATA column.
-    ArrayColumn<Complex>& col_data = msmc->data();
-    col_data.putColumnRange(row_range, array_section, vis_data);
-    p->data_written = 1;
+    oskar_ms_put_vis(p, start_row, start_channel, num_channels,
+            num_baselines, vis_data);
 }
 
+#undef TILE_CHANNELS
+
 void oskar_ms_write_vis_d(oskar_MeasurementSet* p,
         unsigned int start_row, unsigned int start_channel,
         unsigned int num_channels, unsigned int num_baselines,
@@ -223,3 +293,17 @@ void oskar_ms_write_vis_f(oskar_MeasurementSet* p,
     oskar_ms_write_vis(p, start_row, start_channel,
             num_channels, num_baselines, vis);
 }
+
+void oskar_ms_write_vis_rows_f(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int start_channel,
+        unsigned int num_channels, unsigned int num_rows, const float* vis)
+{
+    if (!p->msmc || num_rows == 0) return;
+
+    // Wrap the input data, which is already in the order of the column.
+    // The input array is not modified by the wrapper.
+    IPosition shape(3, p->num_pols, num_channels, num_rows);
+    Array<Complex> vis_data(shape, (Complex*) vis, SHARE);
+    oskar_ms_put_vis(p, start_row, start_channel, num_channels,
+            num_rows, vis_data);
+}
@@ -62,7 +62,21 @@ enum OSKAR_SKY_TAGS
     OSKAR_SKY_TAG_FWHM_MAJOR = 11,
     OSKAR_SKY_TAG_FWHM_MINOR = 12,
     OSKAR_SKY_TAG_POSITION_ANGLE = 13,
-    OSKAR_SKY_TAG_ROTATION_MEASURE = 14
+    OSKAR_SKY_TAG_ROTATION_MEASURE = 14,
+    OSKAR_SKY_TAG_CHUNK_FORMAT_VERSION = 15,
+    OSKAR_SKY_TAG_CHUNK_SIZE = 16,
+    OSKAR_SKY_TAG_CHUNK_DIRECTORY = 17
+};
+
+/* Parameters stored for each chunk in the chunk directory. */
+enum OSKAR_SKY_CHUNK_PARAMS
+{
+    OSKAR_SKY_CHUNK_RA_RAD = 0,     /* Centre of bounding circle. */
+    OSKAR_SKY_CHUNK_DEC_RAD = 1,    /* Centre of bounding circle. */
+    OSKAR_SKY_CHUNK_RADIUS_RAD = 2, /* Radius of bounding circle. */
+    OSKAR_SKY_CHUNK_MIN_I = 3,      /* Minimum Stokes I in the chunk. */
+    OSKAR_SKY_CHUNK_MAX_I = 4,      /* Maximum Stokes I in the chunk. */
+    OSKAR_SKY_CHUNK_NUM_PARAMS = 5
 };
 
 #ifdef __cplusplus
@@ -75,6 +89,7 @@ enum OSKAR_SKY_TAGS
 #include <sky/oskar_sky_copy.h>
 #include <sky/oskar_sky_copy_contents.h>
 #include <sky/oskar_sky_create.h>
+#include <sky/oskar_sky_create_alias.h>
 #include <sky/oskar_sky_create_copy.h>
 #include <sky/oskar_sky_evaluate_gaussian_source_parameters.h>
 #include <sky/oskar_sky_evaluate_relative_directions.h>
@@ -88,8 +103,10 @@ enum OSKAR_SKY_TAGS
 #include <sky/oskar_sky_generate_random_power_law.h>
 #include <sky/oskar_sky_horizon_clip.h>
 #include <sky/oskar_sky_load.h>
+#include <sky/oskar_sky_map.h>
 #include <sky/oskar_sky_override_polarisation.h>
 #include <sky/oskar_sky_read.h>
+#include <sky/oskar_sky_read_chunk_directory.h>
 #include <sky/oskar_sky_resize.h>
 #include <sky/oskar_sky_rotate_to_position.h>
 #include <sky/oskar_sky_save.h>
@@ -50,6 +50,7 @@ extern "C" {
  * @param[in,out] out       Output sky model.
  * @param[in,out] status    Status return code.
  */
+OSKAR_EXPORT
 void oskar_sky_copy_source_data(const oskar_Sky* in,
         const oskar_Mem* horizon_mask, const oskar_Mem* indices,
         oskar_Sky* out, int* status);
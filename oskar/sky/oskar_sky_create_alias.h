@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SKY_CREATE_ALIAS_H_
+#define OSKAR_SKY_CREATE_ALIAS_H_
+
+/**
+ * @file oskar_sky_create_alias.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Creates a sky model that aliases a range of sources in another.
+ *
+ * @details
+ * This function creates a sky model in which every array is an alias of
+ * part of the corresponding array in the source sky model, starting at
+ * source \p offset. No data are copied, and changes made to the source data
+ * through either sky model are visible in both.
+ *
+ * The returned sky model does not own its memory, so it cannot be resized,
+ * and the source sky model must not be freed or resized while it is in use.
+ * If the source sky model is in CPU memory, the extended source flag is set
+ * only if a source in the aliased range has a non-zero size.
+ * It must be freed using oskar_sky_free() when no longer required.
+ *
+ * @param[in] src          Sky model to alias.
+ * @param[in] offset       Index of the first source to alias.
+ * @param[in] num_sources  Number of sources to alias.
+ * @param[in,out] status   Status return code.
+ *
+ * @return A handle to the new sky model.
+ */
+OSKAR_EXPORT
+oskar_Sky* oskar_sky_create_alias(const oskar_Sky* src, int offset,
+        int num_sources, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SKY_CREATE_ALIAS_H_ */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SKY_MAP_H_
+#define OSKAR_SKY_MAP_H_
+
+/**
+ * @file oskar_sky_map.h
+ */
+
+#include <oskar_global.h>
+#include <binary/oskar_binary.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Creates a sky model from a memory-mapped OSKAR binary file.
+ *
+ * @details
+ * This function creates a sky model in CPU memory from an OSKAR binary
+ * sky model file that has been opened for reading.
+ *
+ * Where possible, the source parameter arrays are aliases of the data
+ * mapped from the file, so no copy is made, and pages of the file are only
+ * read when they are first accessed. If the precision of the file does not
+ * match \p type, or the file could not be mapped, the data are copied instead.
+ *
+ * The sky model cannot be resized, and the binary file handle must not be
+ * freed until the sky model has been freed. Modifications made to the
+ * sky model are not written to the file.
+ *
+ * The extended source flag is set if any source in the file has a size.
+ *
+ * @param[in,out] h       Handle to binary file opened for reading.
+ * @param[in] type        Required precision (OSKAR_SINGLE or OSKAR_DOUBLE).
+ * @param[in,out] status  Status return code.
+ *
+ * @return A handle to the new sky model.
+ */
+OSKAR_EXPORT
+oskar_Sky* oskar_sky_map(oskar_Binary* h, int type, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SKY_MAP_H_ */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SKY_READ_CHUNK_DIRECTORY_H_
+#define OSKAR_SKY_READ_CHUNK_DIRECTORY_H_
+
+/**
+ * @file oskar_sky_read_chunk_directory.h
+ */
+
+#include <oskar_global.h>
+#include <binary/oskar_binary.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Reads the chunk directory from an OSKAR binary sky model file.
+ *
+ * @details
+ * This function reads the chunk directory written by
+ * oskar_sky_write_chunked(), which contains OSKAR_SKY_CHUNK_NUM_PARAMS
+ * double-precision values for each chunk of sources in the file,
+ * in the order given by the OSKAR_SKY_CHUNK_PARAMS enumerator.
+ *
+ * Chunk \e i contains the sources starting at index \e i * \p chunk_size
+ * in the file. All chunks except the last contain \p chunk_size sources.
+ *
+ * The status code is set to OSKAR_ERR_BINARY_TAG_NOT_FOUND if the file does
+ * not contain a chunk directory.
+ *
+ * @param[in,out] h           Handle to binary file opened for reading.
+ * @param[out] chunk_size     Number of sources in each chunk.
+ * @param[out] num_chunks     Number of chunks in the file.
+ * @param[in,out] status      Status return code.
+ *
+ * @return A handle to the chunk directory, which must be freed by the caller.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_sky_read_chunk_directory(oskar_Binary* h, int* chunk_size,
+        int* num_chunks, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SKY_READ_CHUNK_DIRECTORY_H_ */
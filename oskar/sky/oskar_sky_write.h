@@ -52,6 +52,28 @@ extern "C" {
 OSKAR_EXPORT
 void oskar_sky_write(const char* filename, const oskar_Sky* sky, int* status);
 
+/**
+ * @brief Writes an OSKAR sky model to a binary file, in chunks.
+ *
+ * @details
+ * Writes the specified OSKAR sky model to a binary file, in the same
+ * format as oskar_sky_write(), but with the sources sorted by position
+ * into chunks of up to \p max_sources_per_chunk sources.
+ *
+ * A chunk directory is also written, which gives a bounding circle and
+ * the range of Stokes I values for each chunk, so that chunks can be
+ * selected (using oskar_sky_read_chunk_directory()) without reading the
+ * source data. The file can still be read using oskar_sky_read().
+ *
+ * @param[in] filename              Output filename.
+ * @param[in] sky                   Sky model to write.
+ * @param[in] max_sources_per_chunk Maximum number of sources in each chunk.
+ * @param[in,out] status            Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_write_chunked(const char* filename, const oskar_Sky* sky,
+        int max_sources_per_chunk, int* status);
+
 #ifdef __cplusplus
 }
 #endif
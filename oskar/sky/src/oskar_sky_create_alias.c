@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sky/private_sky.h"
+#include "sky/oskar_sky.h"
+#include "sky/private_sky_has_extended_sources.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+oskar_Sky* oskar_sky_create_alias(const oskar_Sky* src, int offset,
+        int num_sources, int* status)
+{
+    oskar_Sky* model = 0;
+    size_t o = (size_t) offset, n = (size_t) num_sources;
+
+    /* Check if safe to proceed. */
+    if (*status) return 0;
+
+    /* Check the range. */
+    if (offset < 0 || num_sources < 0 ||
+            offset + num_sources > src->num_sources)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return 0;
+    }
+
+    /* Allocate and initialise a sky model structure. */
+    model = (oskar_Sky*) malloc(sizeof(oskar_Sky));
+    if (!model)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+
+    /* Set meta-data */
+    model->precision = src->precision;
+    model->mem_location = src->mem_location;
+    model->capacity = num_sources;
+    model->num_sources = num_sources;
+    model->use_extended = src->use_extended &&
+            oskar_sky_has_extended_sources(src, offset, num_sources, status);
+    model->reference_ra_rad = src->reference_ra_rad;
+    model->reference_dec_rad = src->reference_dec_rad;
+
+    /* Alias the memory. */
+    model->ra_rad = oskar_mem_create_alias(src->ra_rad, o, n, status);
+    model->dec_rad = oskar_mem_create_alias(src->dec_rad, o, n, status);
+    model->I = oskar_mem_create_alias(src->I, o, n, status);
+    model->Q = oskar_mem_create_alias(src->Q, o, n, status);
+    model->U = oskar_mem_create_alias(src->U, o, n, status);
+    model->V = oskar_mem_create_alias(src->V, o, n, status);
+    model->reference_freq_hz = oskar_mem_create_alias(
+            src->reference_freq_hz, o, n, status);
+    model->spectral_index = oskar_mem_create_alias(
+            src->spectral_index, o, n, status);
+    model->rm_rad = oskar_mem_create_alias(src->rm_rad, o, n, status);
+    model->l = oskar_mem_create_alias(src->l, o, n, status);
+    model->m = oskar_mem_create_alias(src->m, o, n, status);
+    model->n = oskar_mem_create_alias(src->n, o, n, status);
+    model->fwhm_major_rad = oskar_mem_create_alias(
+            src->fwhm_major_rad, o, n, status);
+    model->fwhm_minor_rad = oskar_mem_create_alias(
+            src->fwhm_minor_rad, o, n, status);
+    model->pa_rad = oskar_mem_create_alias(src->pa_rad, o, n, status);
+    model->gaussian_a = oskar_mem_create_alias(src->gaussian_a, o, n, status);
+    model->gaussian_b = oskar_mem_create_alias(src->gaussian_b, o, n, status);
+    model->gaussian_c = oskar_mem_create_alias(src->gaussian_c, o, n, status);
+
+    /* Return pointer to sky model. */
+    return model;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2017, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,15 +27,32 @@
  */
 
 #include "math/oskar_prefix_sum.h"
+#include "sky/private_sky.h"
 #include "sky/oskar_sky.h"
 #include "sky/oskar_sky_copy_source_data.h"
 #include "sky/oskar_update_horizon_mask.h"
 
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* Number of columns in the sky model to compact. */
+#define NUM_COLUMNS 18
+
+/* Margin used when testing against the envelope of all stations. */
+#define ENVELOPE_MARGIN 1e-4
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 static double ha0(double longitude, double ra0, double gast);
+static void horizon_clip_cpu(oskar_Sky* out, const oskar_Sky* in,
+        const oskar_Telescope* telescope, double gast, int* mask,
+        int* status);
 
 void oskar_sky_horizon_clip(oskar_Sky* out, const oskar_Sky* in,
         const oskar_Telescope* telescope, double gast,
@@ -84,6 +101,14 @@ void oskar_sky_horizon_clip(oskar_Sky* out, const oskar_Sky* in,
     if ((int)oskar_mem_length(source_indices) < num_in)
         oskar_mem_realloc(source_indices, num_in, status);
 
+    /* Use the fused mask and compaction on the CPU. */
+    if (location == OSKAR_CPU)
+    {
+        horizon_clip_cpu(out, in, telescope, gast,
+                oskar_mem_int(horizon_mask, status), status);
+        return;
+    }
+
     /* Create the horizon mask. */
     oskar_mem_clear_contents(horizon_mask, status);
     num_stations = oskar_telescope_num_stations(telescope);
@@ -109,6 +134,244 @@ static double ha0(double longitude, double ra0, double gast)
     return (gast + longitude) - ra0;
 }
 
+/*
+ * Returns the number of sources in the block above the horizon of at least
+ * one station, and sets the mask. Sources well inside or outside the cone
+ * enclosing all station zenith directions are classified from the
+ * envelope (centre c, with thresholds on l.c), and the rest are tested
+ * against each station in turn, exactly as in oskar_update_horizon_mask().
+ */
+static int mask_block_f(int start, int end, const float* l, const float* m,
+        const float* n, int num_stations, const double* v, const double c[3],
+        double accept, double reject, int* mask)
+{
+    int i, j, count = 0;
+    for (i = start; i < end; ++i)
+    {
+        const double d = l[i] * c[0] + m[i] * c[1] + n[i] * c[2];
+        int above = 0;
+        if (d > accept)
+            above = 1;
+        else if (d >= reject)
+        {
+            for (j = 0; j < num_stations; ++j)
+            {
+                if ((l[i] * (float)v[3*j] + m[i] * (float)v[3*j + 1] +
+                        n[i] * (float)v[3*j + 2]) > 0.f)
+                {
+                    above = 1;
+                    break;
+                }
+            }
+        }
+        mask[i] = above;
+        count += above;
+    }
+    return count;
+}
+
+static int mask_block_d(int start, int end, const double* l, const double* m,
+        const double* n, int num_stations, const double* v, const double c[3],
+        double accept, double reject, int* mask)
+{
+    int i, j, count = 0;
+    for (i = start; i < end; ++i)
+    {
+        const double d = l[i] * c[0] + m[i] * c[1] + n[i] * c[2];
+        int above = 0;
+        if (d > accept)
+            above = 1;
+        else if (d >= reject)
+        {
+            for (j = 0; j < num_stations; ++j)
+            {
+                if ((l[i] * v[3*j] + m[i] * v[3*j + 1] +
+                        n[i] * v[3*j + 2]) > 0.)
+                {
+                    above = 1;
+                    break;
+                }
+            }
+        }
+        mask[i] = above;
+        count += above;
+    }
+    return count;
+}
+
+static void compact_block_f(int start, int end, const int* mask,
+        int offset, const oskar_Mem* const* src, oskar_Mem** dst,
+        int* status)
+{
+    int i, j, k;
+    for (k = 0; k < NUM_COLUMNS; ++k)
+    {
+        const float* in = oskar_mem_float_const(src[k], status);
+        float* out = oskar_mem_float(dst[k], status);
+        for (i = start, j = offset; i < end; ++i)
+            if (mask[i]) out[j++] = in[i];
+    }
+}
+
+static void compact_block_d(int start, int end, const int* mask,
+        int offset, const oskar_Mem* const* src, oskar_Mem** dst,
+        int* status)
+{
+    int i, j, k;
+    for (k = 0; k < NUM_COLUMNS; ++k)
+    {
+        const double* in = oskar_mem_double_const(src[k], status);
+        double* out = oskar_mem_double(dst[k], status);
+        for (i = start, j = offset; i < end; ++i)
+            if (mask[i]) out[j++] = in[i];
+    }
+}
+
+static void horizon_clip_cpu(oskar_Sky* out, const oskar_Sky* in,
+        const oskar_Telescope* telescope, double gast, int* mask,
+        int* status)
+{
+    int i, type, num_in, num_stations, num_threads = 1, *offsets = 0;
+    double c[3] = {0.0, 0.0, 0.0}, c_norm, cos_r = 1.0, sin_r;
+    double accept = 2.0, reject = -2.0, *v = 0;
+    const oskar_Mem* src[NUM_COLUMNS];
+    oskar_Mem* dst[NUM_COLUMNS];
+    if (*status) return;
+
+    /* Get the zenith direction of each station in the sky frame. */
+    type = oskar_sky_precision(in);
+    num_in = oskar_sky_num_sources(in);
+    num_stations = oskar_telescope_num_stations(telescope);
+    v = (double*) malloc((3 * num_stations + 1) * sizeof(double));
+    if (!v)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    for (i = 0; i < num_stations; ++i)
+    {
+        double ha, cos_ha0, sin_dec0, cos_dec0, sin_lat, cos_lat;
+        const oskar_Station* s = oskar_telescope_station_const(telescope, i);
+        ha = ha0(oskar_station_lon_rad(s), in->reference_ra_rad, gast);
+        cos_ha0  = cos(ha);
+        sin_dec0 = sin(in->reference_dec_rad);
+        cos_dec0 = cos(in->reference_dec_rad);
+        sin_lat  = sin(oskar_station_lat_rad(s));
+        cos_lat  = cos(oskar_station_lat_rad(s));
+        v[3*i]     = cos_lat * sin(ha);
+        v[3*i + 1] = sin_lat * cos_dec0 - cos_lat * cos_ha0 * sin_dec0;
+        v[3*i + 2] = sin_lat * sin_dec0 + cos_lat * cos_ha0 * cos_dec0;
+        c[0] += v[3*i];
+        c[1] += v[3*i + 1];
+        c[2] += v[3*i + 2];
+    }
+
+    /* Find the cone (centre c, half-angle r) enclosing all zeniths.
+     * A source is above the horizon of all stations if l.c > sin(r),
+     * and below the horizon of all stations if l.c < -sin(r). */
+    c_norm = sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+    if (c_norm > 0.0)
+    {
+        c[0] /= c_norm; c[1] /= c_norm; c[2] /= c_norm;
+        for (i = 0; i < num_stations; ++i)
+        {
+            const double d = v[3*i] * c[0] + v[3*i + 1] * c[1] +
+                    v[3*i + 2] * c[2];
+            if (d < cos_r) cos_r = d;
+        }
+        if (cos_r > 0.0)
+        {
+            sin_r = sqrt(1.0 - cos_r * cos_r);
+            accept = sin_r + ENVELOPE_MARGIN;
+            reject = -sin_r - ENVELOPE_MARGIN;
+        }
+    }
+
+    /* Get the columns to compact. */
+    src[0]  = in->ra_rad;            dst[0]  = out->ra_rad;
+    src[1]  = in->dec_rad;           dst[1]  = out->dec_rad;
+    src[2]  = in->I;                 dst[2]  = out->I;
+    src[3]  = in->Q;                 dst[3]  = out->Q;
+    src[4]  = in->U;                 dst[4]  = out->U;
+    src[5]  = in->V;                 dst[5]  = out->V;
+    src[6]  = in->reference_freq_hz; dst[6]  = out->reference_freq_hz;
+    src[7]  = in->spectral_index;    dst[7]  = out->spectral_index;
+    src[8]  = in->rm_rad;            dst[8]  = out->rm_rad;
+    src[9]  = in->l;                 dst[9]  = out->l;
+    src[10] = in->m;                 dst[10] = out->m;
+    src[11] = in->n;                 dst[11] = out->n;
+    src[12] = in->fwhm_major_rad;    dst[12] = out->fwhm_major_rad;
+    src[13] = in->fwhm_minor_rad;    dst[13] = out->fwhm_minor_rad;
+    src[14] = in->pa_rad;            dst[14] = out->pa_rad;
+    src[15] = in->gaussian_a;        dst[15] = out->gaussian_a;
+    src[16] = in->gaussian_b;        dst[16] = out->gaussian_b;
+    src[17] = in->gaussian_c;        dst[17] = out->gaussian_c;
+
+    /* Each thread masks a contiguous block of sources and counts those
+     * above the horizon. An exclusive scan of the block counts then gives
+     * the output offset of each block, which is compacted in place. */
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+    if (num_threads > num_in / 1024) num_threads = 1 + num_in / 1024;
+#endif
+    offsets = (int*) calloc(num_threads + 1, sizeof(int));
+    if (!offsets)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        free(v);
+        return;
+    }
+#pragma omp parallel num_threads(num_threads)
+    {
+        int t = 0, nt = 1, start, end, count = 0, status_t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+        nt = omp_get_num_threads();
+#endif
+        start = (int) (((long long) num_in * t) / nt);
+        end   = (int) (((long long) num_in * (t + 1)) / nt);
+        if (type == OSKAR_DOUBLE)
+            count = mask_block_d(start, end,
+                    oskar_mem_double_const(in->l, &status_t),
+                    oskar_mem_double_const(in->m, &status_t),
+                    oskar_mem_double_const(in->n, &status_t),
+                    num_stations, v, c, accept, reject, mask);
+        else
+            count = mask_block_f(start, end,
+                    oskar_mem_float_const(in->l, &status_t),
+                    oskar_mem_float_const(in->m, &status_t),
+                    oskar_mem_float_const(in->n, &status_t),
+                    num_stations, v, c, accept, reject, mask);
+        offsets[t + 1] = count;
+#pragma omp barrier
+#pragma omp single
+        {
+            int j;
+            for (j = 0; j < nt; ++j) offsets[j + 1] += offsets[j];
+            num_threads = nt;
+        }
+        if (type == OSKAR_DOUBLE)
+            compact_block_d(start, end, mask, offsets[t], src, dst,
+                    &status_t);
+        else
+            compact_block_f(start, end, mask, offsets[t], src, dst,
+                    &status_t);
+        if (status_t)
+        {
+#pragma omp critical
+            *status = status_t;
+        }
+    }
+
+    /* Copy metadata and set the number of sources. */
+    out->use_extended = in->use_extended;
+    out->reference_ra_rad = in->reference_ra_rad;
+    out->reference_dec_rad = in->reference_dec_rad;
+    out->num_sources = offsets[num_threads];
+    free(offsets);
+    free(v);
+}
+
 #ifdef __cplusplus
 }
 #endif
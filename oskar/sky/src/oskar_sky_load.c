@@ -26,12 +26,31 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "sky/private_sky.h"
 #include "sky/oskar_sky.h"
-#include "utility/oskar_getline.h"
 #include "utility/oskar_string_to_array.h"
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define OSKAR_SKY_LOAD_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,12 +59,32 @@ extern "C" {
 static const double deg2rad = 1.74532925199432957692369e-2;
 static const double arcsec2rad = 4.84813681109535993589914e-6;
 
+#define NUM_COLUMNS 12
+#define MIN_BYTES_PER_RANGE 1048576
+
+typedef struct
+{
+    const char *begin, *end;  /* Line-aligned byte range of the file. */
+    size_t num_lines;         /* Number of lines in the range. */
+    size_t row_start;         /* Index of first row written by the range. */
+    size_t num_sources;       /* Number of sources read from the range. */
+    int error;                /* Set if the range contains a bad line. */
+} Range;
+
+static char* map_file(const char* filename, size_t* size, int* mapped,
+        int* status);
+static void unmap_file(char* ptr, size_t size, int mapped);
+static void parse_range(Range* range, void* const* columns, int type);
+static void move_rows(void* const* columns, int type, size_t dst,
+        size_t src, size_t num_rows);
+
 oskar_Sky* oskar_sky_load(const char* filename, int type, int* status)
 {
-    int n = 0;
-    FILE* file;
-    char* line = 0;
-    size_t bufsize = 0;
+    int i, mapped = 0, num_ranges = 1;
+    size_t file_size = 0, num_lines = 0, num_sources = 0;
+    char* data;
+    void* columns[NUM_COLUMNS];
+    Range* ranges;
     oskar_Sky* sky;
 
     /* Check if safe to proceed. */
@@ -58,89 +97,272 @@ oskar_Sky* oskar_sky_load(const char* filename, int type, int* status)
         return 0;
     }
 
-    /* Open the file. */
-    file = fopen(filename, "r");
-    if (!file)
+    /* Map or read the whole file into memory. */
+    data = map_file(filename, &file_size, &mapped, status);
+    if (*status) return 0;
+
+    /* Split the file into line-aligned ranges, one for each thread. */
+#ifdef _OPENMP
+    num_ranges = omp_get_max_threads();
+    if ((size_t)num_ranges > 1 + file_size / MIN_BYTES_PER_RANGE)
+        num_ranges = (int)(1 + file_size / MIN_BYTES_PER_RANGE);
+#endif
+    ranges = (Range*) calloc(num_ranges, sizeof(Range));
+    if (!ranges)
     {
-        *status = OSKAR_ERR_FILE_IO;
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        unmap_file(data, file_size, mapped);
         return 0;
     }
+    for (i = 0; i < num_ranges; ++i)
+    {
+        const char *p, *end = data + file_size;
+        p = (i == 0) ? data : ranges[i - 1].end;
+        if (i < num_ranges - 1)
+        {
+            const char* target = data + (file_size / num_ranges) * (i + 1);
+            if (target > p)
+            {
+                const char* nl = (const char*)
+                        memchr(target, '\n', (size_t)(end - target));
+                end = nl ? nl + 1 : end;
+            }
+            else end = p;
+        }
+        ranges[i].begin = p;
+        ranges[i].end = end;
+    }
 
-    /* Initialise the sky model. */
-    sky = oskar_sky_create(type, OSKAR_CPU, 0, status);
+    /* First pass: count the lines in each range, to size the sky model. */
+#pragma omp parallel for num_threads(num_ranges)
+    for (i = 0; i < num_ranges; ++i)
+    {
+        const char* p = ranges[i].begin;
+        const char* end = ranges[i].end;
+        size_t n = 0;
+        while (p < end)
+        {
+            const char* nl = (const char*) memchr(p, '\n', (size_t)(end - p));
+            ++n;
+            p = nl ? nl + 1 : end;
+        }
+        ranges[i].num_lines = n;
+    }
+    for (i = 0; i < num_ranges; ++i)
+    {
+        ranges[i].row_start = num_lines;
+        num_lines += ranges[i].num_lines;
+    }
+    if (num_lines > INT_MAX)
+    {
+        *status = OSKAR_ERR_BAD_SKY_FILE;
+        free(ranges);
+        unmap_file(data, file_size, mapped);
+        return 0;
+    }
+
+    /* Initialise the sky model with one row for every line. */
+    sky = oskar_sky_create(type, OSKAR_CPU, (int) num_lines, status);
+    if (*status)
+    {
+        oskar_sky_free(sky, status);
+        free(ranges);
+        unmap_file(data, file_size, mapped);
+        return 0;
+    }
+    columns[0] = oskar_mem_void(sky->ra_rad);
+    columns[1] = oskar_mem_void(sky->dec_rad);
+    columns[2] = oskar_mem_void(sky->I);
+    columns[3] = oskar_mem_void(sky->Q);
+    columns[4] = oskar_mem_void(sky->U);
+    columns[5] = oskar_mem_void(sky->V);
+    columns[6] = oskar_mem_void(sky->reference_freq_hz);
+    columns[7] = oskar_mem_void(sky->spectral_index);
+    columns[8] = oskar_mem_void(sky->rm_rad);
+    columns[9] = oskar_mem_void(sky->fwhm_major_rad);
+    columns[10] = oskar_mem_void(sky->fwhm_minor_rad);
+    columns[11] = oskar_mem_void(sky->pa_rad);
+
+    /* Second pass: parse each range directly into the columns. */
+#pragma omp parallel for num_threads(num_ranges)
+    for (i = 0; i < num_ranges; ++i)
+        parse_range(&ranges[i], columns, type);
+
+    /* Remove the gaps left by comments and blank lines. */
+    for (i = 0; i < num_ranges; ++i)
+    {
+        if (ranges[i].error)
+            *status = OSKAR_ERR_BAD_SKY_FILE;
+        if (ranges[i].row_start != num_sources)
+            move_rows(columns, type, num_sources, ranges[i].row_start,
+                    ranges[i].num_sources);
+        num_sources += ranges[i].num_sources;
+    }
+
+    /* Set the size to be the actual number of elements loaded. */
+    oskar_sky_resize(sky, (int) num_sources, status);
+
+    /* Clean up. */
+    free(ranges);
+    unmap_file(data, file_size, mapped);
 
-    /* Loop over lines in file. */
-    while (oskar_getline(&line, &bufsize, file) != OSKAR_ERR_EOF)
+    /* Check if an error occurred. */
+    if (*status)
+    {
+        oskar_sky_free(sky, status);
+        sky = 0;
+    }
+
+    /* Return a handle to the sky model. */
+    return sky;
+}
+
+static void parse_range(Range* range, void* const* columns, int type)
+{
+    size_t c, row = range->row_start;
+    const char* p = range->begin;
+    while (p < range->end)
     {
         /* Set defaults. */
         /* RA, Dec, I, Q, U, V, freq0, spix, RM, FWHM maj, FWHM min, PA */
         double par[] = {0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0.};
-        size_t num_param = sizeof(par) / sizeof(double);
-        size_t num_required = 3, num_read = 0;
+        double v[NUM_COLUMNS];
+        size_t num_read;
+        const char* line_end = (const char*)
+                memchr(p, '\n', (size_t)(range->end - p));
+        if (!line_end) line_end = range->end;
 
         /* Load source parameters (require at least RA, Dec, Stokes I). */
-        num_read = oskar_string_to_array_d(line, num_param, par);
-        if (num_read < num_required)
+        num_read = oskar_string_to_array_range_d(p, line_end,
+                NUM_COLUMNS, par);
+        p = line_end + 1;
+        if (num_read < 3)
             continue;
 
-        /* Ensure enough space in arrays. */
-        if (oskar_sky_num_sources(sky) <= n)
-        {
-            oskar_sky_resize(sky, n + 100, status);
-            if (*status)
-                break;
-        }
-
+        /* RA, Dec, I, Q, U, V, freq0, spix. */
+        v[0] = par[0] * deg2rad;
+        v[1] = par[1] * deg2rad;
+        for (c = 2; c < 8; ++c) v[c] = par[c];
         if (num_read <= 9)
         {
-            /* RA, Dec, I, Q, U, V, freq0, spix, RM */
-            oskar_sky_set_source(sky, n, par[0] * deg2rad,
-                    par[1] * deg2rad, par[2], par[3], par[4], par[5],
-                    par[6], par[7], par[8], 0.0, 0.0, 0.0, status);
+            /* RM, no Gaussian parameters. */
+            v[8] = par[8];
+            v[9] = v[10] = v[11] = 0.0;
         }
         else if (num_read == 11)
         {
             /* Old format, with no rotation measure. */
-            /* RA, Dec, I, Q, U, V, freq0, spix, FWHM maj, FWHM min, PA */
-            oskar_sky_set_source(sky, n, par[0] * deg2rad,
-                    par[1] * deg2rad, par[2], par[3], par[4], par[5],
-                    par[6], par[7], 0.0, par[8] * arcsec2rad,
-                    par[9] * arcsec2rad, par[10] * deg2rad, status);
+            v[8] = 0.0;
+            v[9] = par[8] * arcsec2rad;
+            v[10] = par[9] * arcsec2rad;
+            v[11] = par[10] * deg2rad;
         }
         else if (num_read == 12)
         {
             /* New format. */
-            /* RA, Dec, I, Q, U, V, freq0, spix, RM, FWHM maj, FWHM min, PA */
-            oskar_sky_set_source(sky, n, par[0] * deg2rad,
-                    par[1] * deg2rad, par[2], par[3], par[4], par[5],
-                    par[6], par[7], par[8], par[9] * arcsec2rad,
-                    par[10] * arcsec2rad, par[11] * deg2rad, status);
+            v[8] = par[8];
+            v[9] = par[9] * arcsec2rad;
+            v[10] = par[10] * arcsec2rad;
+            v[11] = par[11] * deg2rad;
         }
         else
         {
             /* Error. */
-            *status = OSKAR_ERR_BAD_SKY_FILE;
+            range->error = 1;
             break;
         }
-        ++n;
+
+        /* Store the source. */
+        if (type == OSKAR_DOUBLE)
+            for (c = 0; c < NUM_COLUMNS; ++c)
+                ((double*)(columns[c]))[row] = v[c];
+        else
+            for (c = 0; c < NUM_COLUMNS; ++c)
+                ((float*)(columns[c]))[row] = (float) v[c];
+        ++row;
     }
+    range->num_sources = row - range->row_start;
+}
 
-    /* Set the size to be the actual number of elements loaded. */
-    oskar_sky_resize(sky, n, status);
+static void move_rows(void* const* columns, int type, size_t dst,
+        size_t src, size_t num_rows)
+{
+    size_t c, element_size;
+    element_size = (type == OSKAR_DOUBLE) ? sizeof(double) : sizeof(float);
+    for (c = 0; c < NUM_COLUMNS; ++c)
+        memmove((char*)(columns[c]) + dst * element_size,
+                (char*)(columns[c]) + src * element_size,
+                num_rows * element_size);
+}
 
-    /* Free the line buffer and close the file. */
-    if (line) free(line);
-    fclose(file);
+static char* map_file(const char* filename, size_t* size, int* mapped,
+        int* status)
+{
+    char* data = 0;
+    FILE* file;
+    long len;
+#ifdef OSKAR_SKY_LOAD_HAVE_MMAP
+    struct stat st;
+    int fd;
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return 0;
+    }
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+            (unsigned long long) st.st_size <= (size_t)(-1))
+    {
+        void* ptr = mmap(0, (size_t) st.st_size, PROT_READ, MAP_PRIVATE,
+                fd, 0);
+        if (ptr != MAP_FAILED)
+        {
+            close(fd);
+            *size = (size_t) st.st_size;
+            *mapped = 1;
+            return (char*) ptr;
+        }
+    }
+    close(fd);
+#endif
 
-    /* Check if an error occurred. */
-    if (*status)
+    /* Fall back to reading the file. */
+    *size = 0;
+    *mapped = 0;
+    file = fopen(filename, "rb");
+    if (!file)
     {
-        oskar_sky_free(sky, status);
-        sky = 0;
+        *status = OSKAR_ERR_FILE_IO;
+        return 0;
+    }
+    if (fseek(file, 0, SEEK_END) == 0 && (len = ftell(file)) > 0)
+    {
+        data = (char*) malloc((size_t) len);
+        if (!data)
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        else
+        {
+            rewind(file);
+            *size = fread(data, 1, (size_t) len, file);
+        }
     }
+    fclose(file);
+    return data;
+}
 
-    /* Return a handle to the sky model. */
-    return sky;
+static void unmap_file(char* ptr, size_t size, int mapped)
+{
+#ifdef OSKAR_SKY_LOAD_HAVE_MMAP
+    if (mapped)
+    {
+        munmap(ptr, size);
+        return;
+    }
+#else
+    (void) size;
+    (void) mapped;
+#endif
+    free(ptr);
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sky/private_sky.h"
+#include "sky/oskar_sky.h"
+#include "sky/private_sky_has_extended_sources.h"
+#include "mem/oskar_binary_read_mem.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static oskar_Mem* map_column(oskar_Binary* h, int file_type, int type,
+        unsigned char tag, int* status)
+{
+    oskar_Mem *mem, *temp;
+    mem = oskar_binary_map_mem(h, file_type, OSKAR_TAG_GROUP_SKY_MODEL,
+            tag, 0, status);
+    if (*status || file_type == type) return mem;
+    temp = oskar_mem_convert_precision(mem, type, status);
+    oskar_mem_free(mem, status);
+    return temp;
+}
+
+oskar_Sky* oskar_sky_map(oskar_Binary* h, int type, int* status)
+{
+    int file_type = 0, num_sources = 0;
+    oskar_Sky* model = 0;
+    const unsigned char group = OSKAR_TAG_GROUP_SKY_MODEL;
+
+    /* Check if safe to proceed. */
+    if (*status) return 0;
+
+    /* Check the type. */
+    if (type != OSKAR_SINGLE && type != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return 0;
+    }
+
+    /* Read the sky model data parameters. */
+    oskar_binary_read_int(h, group, OSKAR_SKY_TAG_NUM_SOURCES, 0,
+            &num_sources, status);
+    oskar_binary_read_int(h, group, OSKAR_SKY_TAG_DATA_TYPE, 0,
+            &file_type, status);
+    if (*status) return 0;
+    if (file_type != OSKAR_SINGLE && file_type != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return 0;
+    }
+
+    /* Allocate and initialise a sky model structure. */
+    model = (oskar_Sky*) calloc(1, sizeof(oskar_Sky));
+    if (!model)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    model->precision = type;
+    model->mem_location = OSKAR_CPU;
+    model->capacity = num_sources;
+    model->num_sources = num_sources;
+
+    /* Map the source parameter arrays. */
+    model->ra_rad = map_column(h, file_type, type,
+            OSKAR_SKY_TAG_RA, status);
+    model->dec_rad = map_column(h, file_type, type,
+            OSKAR_SKY_TAG_DEC, status);
+    model->I = map_column(h, file_type, type,
+            OSKAR_SKY_TAG_STOKES_I, status);
+    model->Q = map_column(h, file_type, type,
+            OSKAR_SKY_TAG_STOKES_Q, status);
+    model->U = map_column(h, file_type, type,
+            OSKAR_SKY_TAG_STOKES_U, status);
+    model->V = map_column(h, file_type, type,
+            OSKAR_SKY_TAG_STOKES_V, status);
+    model->reference_freq_hz = map_column(h, file_type, type,
+            OSKAR_SKY_TAG_REF_FREQ, status);
+    model->spectral_index = map_column(h, file_type, type,
+            OSKAR_SKY_TAG_SPECTRAL_INDEX, status);
+    model->rm_rad = map_column(h, file_type, type,
+            OSKAR_SKY_TAG_ROTATION_MEASURE, status);
+    model->fwhm_major_rad = map_column(h, file_type, type,
+            OSKAR_SKY_TAG_FWHM_MAJOR, status);
+    model->fwhm_minor_rad = map_column(h, file_type, type,
+            OSKAR_SKY_TAG_FWHM_MINOR, status);
+    model->pa_rad = map_column(h, file_type, type,
+            OSKAR_SKY_TAG_POSITION_ANGLE, status);
+
+    /* Allocate the derived arrays, which are not stored in the file. */
+    model->l = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+    model->m = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+    model->n = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+    model->gaussian_a = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+    model->gaussian_b = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+    model->gaussian_c = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+
+    /* Check that all the arrays have the expected length. */
+    if (!*status && (
+            (int) oskar_mem_length(model->ra_rad) < num_sources ||
+            (int) oskar_mem_length(model->dec_rad) < num_sources ||
+            (int) oskar_mem_length(model->I) < num_sources ||
+            (int) oskar_mem_length(model->Q) < num_sources ||
+            (int) oskar_mem_length(model->U) < num_sources ||
+            (int) oskar_mem_length(model->V) < num_sources ||
+            (int) oskar_mem_length(model->reference_freq_hz) < num_sources ||
+            (int) oskar_mem_length(model->spectral_index) < num_sources ||
+            (int) oskar_mem_length(model->rm_rad) < num_sources ||
+            (int) oskar_mem_length(model->fwhm_major_rad) < num_sources ||
+            (int) oskar_mem_length(model->fwhm_minor_rad) < num_sources ||
+            (int) oskar_mem_length(model->pa_rad) < num_sources))
+        *status = OSKAR_ERR_BAD_SKY_FILE;
+
+    /* Set the extended source flag if any source has a size. */
+    model->use_extended = oskar_sky_has_extended_sources(model, 0,
+            num_sources, status);
+
+    /* Return a handle to the sky model, or NULL if an error occurred. */
+    if (*status)
+    {
+        int error = 0;
+        oskar_sky_free(model, &error);
+        model = 0;
+    }
+    return model;
+}
+
+#ifdef __cplusplus
+}
+#endif
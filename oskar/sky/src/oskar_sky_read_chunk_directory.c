@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sky/oskar_sky.h"
+#include "mem/oskar_binary_read_mem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+oskar_Mem* oskar_sky_read_chunk_directory(oskar_Binary* h, int* chunk_size,
+        int* num_chunks, int* status)
+{
+    int version = 0, num_sources = 0;
+    oskar_Mem* directory = 0;
+    const unsigned char group = OSKAR_TAG_GROUP_SKY_MODEL;
+    *chunk_size = 0;
+    *num_chunks = 0;
+    if (*status) return 0;
+
+    /* Read and check the format version. */
+    oskar_binary_read_int(h, group, OSKAR_SKY_TAG_CHUNK_FORMAT_VERSION, 0,
+            &version, status);
+    if (*status) return 0;
+    if (version != 1)
+    {
+        *status = OSKAR_ERR_BINARY_VERSION_UNKNOWN;
+        return 0;
+    }
+
+    /* Read the chunk size and the directory. */
+    oskar_binary_read_int(h, group, OSKAR_SKY_TAG_NUM_SOURCES, 0,
+            &num_sources, status);
+    oskar_binary_read_int(h, group, OSKAR_SKY_TAG_CHUNK_SIZE, 0,
+            chunk_size, status);
+    directory = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    oskar_binary_read_mem(h, directory, group,
+            OSKAR_SKY_TAG_CHUNK_DIRECTORY, 0, status);
+    if (*status)
+    {
+        oskar_mem_free(directory, status);
+        return 0;
+    }
+
+    /* Check that the directory is consistent with the number of sources. */
+    *num_chunks = (int) (oskar_mem_length(directory) /
+            OSKAR_SKY_CHUNK_NUM_PARAMS);
+    if (*chunk_size <= 0 ||
+            *num_chunks != (num_sources + *chunk_size - 1) / *chunk_size)
+    {
+        *status = OSKAR_ERR_BAD_SKY_FILE;
+        *num_chunks = 0;
+        oskar_mem_free(directory, status);
+        return 0;
+    }
+    return directory;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -28,28 +28,200 @@
 
 #include "sky/oskar_sky.h"
 #include "binary/oskar_binary.h"
+#include "math/oskar_angular_distance.h"
+#include "math/oskar_cmath.h"
 #include "mem/oskar_binary_write_mem.h"
 #include "utility/oskar_binary_write_metadata.h"
 
+#include <stdlib.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define NUM_COLUMNS 12
+
+/* Tags of the columns, in the order returned by get_columns(). */
+static const unsigned char column_tags[NUM_COLUMNS] = {
+        OSKAR_SKY_TAG_RA, OSKAR_SKY_TAG_DEC,
+        OSKAR_SKY_TAG_STOKES_I, OSKAR_SKY_TAG_STOKES_Q,
+        OSKAR_SKY_TAG_STOKES_U, OSKAR_SKY_TAG_STOKES_V,
+        OSKAR_SKY_TAG_REF_FREQ, OSKAR_SKY_TAG_SPECTRAL_INDEX,
+        OSKAR_SKY_TAG_FWHM_MAJOR, OSKAR_SKY_TAG_FWHM_MINOR,
+        OSKAR_SKY_TAG_POSITION_ANGLE, OSKAR_SKY_TAG_ROTATION_MEASURE
+};
+
+typedef struct
+{
+    int band, index;
+    double ra;
+} SortKey;
+
+static void get_columns(const oskar_Sky* sky, const oskar_Mem** columns);
+static oskar_Binary* write_columns(const char* filename, int type,
+        int num_sources, const oskar_Mem* const* columns, int* status);
+static int compare_keys(const void* a, const void* b);
+static void chunk_bounds(int num_sources, const double* ra,
+        const double* dec, const double* I, double* bounds);
+
 void oskar_sky_write(const char* filename, const oskar_Sky* sky, int* status)
 {
-    int type, num_sources, idx = 0;
+    const oskar_Mem* columns[NUM_COLUMNS];
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Write the data and release the handle. */
+    get_columns(sky, columns);
+    oskar_binary_free(write_columns(filename, oskar_sky_precision(sky),
+            oskar_sky_num_sources(sky), columns, status));
+}
+
+void oskar_sky_write_chunked(const char* filename, const oskar_Sky* sky,
+        int max_sources_per_chunk, int* status)
+{
+    int c, i, type, num_sources, num_chunks, num_bands;
     unsigned char group = OSKAR_TAG_GROUP_SKY_MODEL;
+    const oskar_Mem* columns[NUM_COLUMNS];
+    oskar_Mem *sorted[NUM_COLUMNS], *directory = 0, *temp[3];
+    const double *ra, *dec, *I;
+    SortKey* keys = 0;
     oskar_Binary* h = 0;
 
     /* Check if safe to proceed. */
     if (*status) return;
-
-    /* Get the data type and number of sources. */
+    if (max_sources_per_chunk < 1)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
     type = oskar_sky_precision(sky);
     num_sources = oskar_sky_num_sources(sky);
+    num_chunks = (num_sources + max_sources_per_chunk - 1) /
+            max_sources_per_chunk;
+    get_columns(sky, columns);
+
+    /* Get the positions and fluxes in double precision. */
+    for (c = 0; c < 3; ++c)
+        temp[c] = oskar_mem_convert_precision(columns[c], OSKAR_DOUBLE,
+                status);
+    ra = oskar_mem_double_const(temp[0], status);
+    dec = oskar_mem_double_const(temp[1], status);
+    I = oskar_mem_double_const(temp[2], status);
+
+    /* Sort the sources by right ascension in bands of declination,
+     * with roughly square chunks at the equator. */
+    num_bands = (int) sqrt(num_chunks / 2.0);
+    if (num_bands < 1) num_bands = 1;
+    keys = (SortKey*) malloc((num_sources + 1) * sizeof(SortKey));
+    if (!keys && !*status)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    for (i = 0; i < num_sources && !*status; ++i)
+    {
+        int band = (int) ((dec[i] + M_PI / 2.0) / M_PI * num_bands);
+        keys[i].band = band < 0 ? 0 :
+                (band >= num_bands ? num_bands - 1 : band);
+        keys[i].ra = ra[i];
+        keys[i].index = i;
+    }
+    if (!*status)
+        qsort(keys, num_sources, sizeof(SortKey), compare_keys);
+
+    /* Reorder the columns. */
+    for (c = 0; c < NUM_COLUMNS; ++c)
+    {
+        sorted[c] = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+        if (*status) continue;
+        if (type == OSKAR_DOUBLE)
+        {
+            const double* in = oskar_mem_double_const(columns[c], status);
+            double* out = oskar_mem_double(sorted[c], status);
+            for (i = 0; i < num_sources; ++i) out[i] = in[keys[i].index];
+        }
+        else
+        {
+            const float* in = oskar_mem_float_const(columns[c], status);
+            float* out = oskar_mem_float(sorted[c], status);
+            for (i = 0; i < num_sources; ++i) out[i] = in[keys[i].index];
+        }
+    }
+
+    /* Find the bounds of each chunk from the sorted data. */
+    directory = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_chunks * OSKAR_SKY_CHUNK_NUM_PARAMS, status);
+    for (c = 0; c < 3; ++c)
+    {
+        oskar_mem_free(temp[c], status);
+        temp[c] = oskar_mem_convert_precision(sorted[c], OSKAR_DOUBLE,
+                status);
+    }
+    if (!*status)
+    {
+        double* bounds = oskar_mem_double(directory, status);
+        ra = oskar_mem_double_const(temp[0], status);
+        dec = oskar_mem_double_const(temp[1], status);
+        I = oskar_mem_double_const(temp[2], status);
+        for (i = 0; i < num_chunks; ++i)
+        {
+            const int start = i * max_sources_per_chunk;
+            int num = num_sources - start;
+            if (num > max_sources_per_chunk) num = max_sources_per_chunk;
+            chunk_bounds(num, ra + start, dec + start, I + start,
+                    bounds + i * OSKAR_SKY_CHUNK_NUM_PARAMS);
+        }
+    }
+
+    /* Write the sorted columns, and the chunk directory. */
+    h = write_columns(filename, type, num_sources,
+            (const oskar_Mem* const*) sorted, status);
+    oskar_binary_write_int(h, group,
+            OSKAR_SKY_TAG_CHUNK_FORMAT_VERSION, 0, 1, status);
+    oskar_binary_write_int(h, group,
+            OSKAR_SKY_TAG_CHUNK_SIZE, 0, max_sources_per_chunk, status);
+    oskar_binary_write_mem(h, directory, group,
+            OSKAR_SKY_TAG_CHUNK_DIRECTORY, 0, 0, status);
+
+    /* Clean up. */
+    oskar_binary_free(h);
+    for (c = 0; c < NUM_COLUMNS; ++c)
+        oskar_mem_free(sorted[c], status);
+    for (c = 0; c < 3; ++c)
+        oskar_mem_free(temp[c], status);
+    oskar_mem_free(directory, status);
+    free(keys);
+}
+
+static void get_columns(const oskar_Sky* sky, const oskar_Mem** columns)
+{
+    columns[0] = oskar_sky_ra_rad_const(sky);
+    columns[1] = oskar_sky_dec_rad_const(sky);
+    columns[2] = oskar_sky_I_const(sky);
+    columns[3] = oskar_sky_Q_const(sky);
+    columns[4] = oskar_sky_U_const(sky);
+    columns[5] = oskar_sky_V_const(sky);
+    columns[6] = oskar_sky_reference_freq_hz_const(sky);
+    columns[7] = oskar_sky_spectral_index_const(sky);
+    columns[8] = oskar_sky_fwhm_major_rad_const(sky);
+    columns[9] = oskar_sky_fwhm_minor_rad_const(sky);
+    columns[10] = oskar_sky_position_angle_rad_const(sky);
+    columns[11] = oskar_sky_rotation_measure_rad_const(sky);
+}
+
+static oskar_Binary* write_columns(const char* filename, int type,
+        int num_sources, const oskar_Mem* const* columns, int* status)
+{
+    int c, idx = 0;
+    unsigned char group = OSKAR_TAG_GROUP_SKY_MODEL;
+    oskar_Binary* h = 0;
 
     /* Create the handle. */
     h = oskar_binary_create(filename, 'w', status);
+    oskar_binary_set_write_index(h, 1);
 
     /* Write the common metadata. */
     oskar_binary_write_metadata(h, status);
@@ -61,33 +233,56 @@ void oskar_sky_write(const char* filename, const oskar_Sky* sky, int* status)
             OSKAR_SKY_TAG_DATA_TYPE, idx, type, status);
 
     /* Write the arrays. */
-    oskar_binary_write_mem(h, oskar_sky_ra_rad_const(sky),
-            group, OSKAR_SKY_TAG_RA, idx, num_sources, status);
-    oskar_binary_write_mem(h, oskar_sky_dec_rad_const(sky),
-            group, OSKAR_SKY_TAG_DEC, idx, num_sources, status);
-    oskar_binary_write_mem(h, oskar_sky_I_const(sky),
-            group, OSKAR_SKY_TAG_STOKES_I, idx, num_sources, status);
-    oskar_binary_write_mem(h, oskar_sky_Q_const(sky),
-            group, OSKAR_SKY_TAG_STOKES_Q, idx, num_sources, status);
-    oskar_binary_write_mem(h, oskar_sky_U_const(sky),
-            group, OSKAR_SKY_TAG_STOKES_U, idx, num_sources, status);
-    oskar_binary_write_mem(h, oskar_sky_V_const(sky),
-            group, OSKAR_SKY_TAG_STOKES_V, idx, num_sources, status);
-    oskar_binary_write_mem(h, oskar_sky_reference_freq_hz_const(sky),
-            group, OSKAR_SKY_TAG_REF_FREQ, idx, num_sources, status);
-    oskar_binary_write_mem(h, oskar_sky_spectral_index_const(sky),
-            group, OSKAR_SKY_TAG_SPECTRAL_INDEX, idx, num_sources, status);
-    oskar_binary_write_mem(h, oskar_sky_fwhm_major_rad_const(sky),
-            group, OSKAR_SKY_TAG_FWHM_MAJOR, idx, num_sources, status);
-    oskar_binary_write_mem(h, oskar_sky_fwhm_minor_rad_const(sky),
-            group, OSKAR_SKY_TAG_FWHM_MINOR, idx, num_sources, status);
-    oskar_binary_write_mem(h, oskar_sky_position_angle_rad_const(sky),
-            group, OSKAR_SKY_TAG_POSITION_ANGLE, idx, num_sources, status);
-    oskar_binary_write_mem(h, oskar_sky_rotation_measure_rad_const(sky),
-            group, OSKAR_SKY_TAG_ROTATION_MEASURE, idx, num_sources, status);
-
-    /* Release the handle. */
-    oskar_binary_free(h);
+    for (c = 0; c < NUM_COLUMNS; ++c)
+        oskar_binary_write_mem(h, columns[c],
+                group, column_tags[c], idx, num_sources, status);
+    return h;
+}
+
+static int compare_keys(const void* a, const void* b)
+{
+    const SortKey *x = (const SortKey*) a, *y = (const SortKey*) b;
+    if (x->band != y->band) return x->band < y->band ? -1 : 1;
+    if (x->ra != y->ra) return x->ra < y->ra ? -1 : 1;
+    return x->index < y->index ? -1 : (x->index > y->index);
+}
+
+static void chunk_bounds(int num_sources, const double* ra,
+        const double* dec, const double* I, double* bounds)
+{
+    int i;
+    double x = 0.0, y = 0.0, z = 0.0, norm, ra0 = 0.0, dec0 = 0.0;
+    double radius = 0.0, min_I = 0.0, max_I = 0.0;
+
+    /* Use the mean direction as the centre, and find the largest
+     * distance from it. */
+    for (i = 0; i < num_sources; ++i)
+    {
+        const double cos_dec = cos(dec[i]);
+        x += cos_dec * cos(ra[i]);
+        y += cos_dec * sin(ra[i]);
+        z += sin(dec[i]);
+        if (i == 0 || I[i] < min_I) min_I = I[i];
+        if (i == 0 || I[i] > max_I) max_I = I[i];
+    }
+    norm = sqrt(x * x + y * y + z * z);
+    if (norm > 0.0)
+    {
+        ra0 = atan2(y, x);
+        dec0 = asin(z / norm);
+        for (i = 0; i < num_sources; ++i)
+        {
+            const double d = oskar_angular_distance(ra[i], ra0, dec[i], dec0);
+            if (d > radius) radius = d;
+        }
+    }
+    else if (num_sources > 0)
+        radius = M_PI;
+    bounds[OSKAR_SKY_CHUNK_RA_RAD] = ra0;
+    bounds[OSKAR_SKY_CHUNK_DEC_RAD] = dec0;
+    bounds[OSKAR_SKY_CHUNK_RADIUS_RAD] = radius;
+    bounds[OSKAR_SKY_CHUNK_MIN_I] = min_I;
+    bounds[OSKAR_SKY_CHUNK_MAX_I] = max_I;
 }
 
 #ifdef __cplusplus
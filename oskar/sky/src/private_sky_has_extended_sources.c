@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "sky/private_sky.h"
+#include "sky/private_sky_has_extended_sources.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int oskar_sky_has_extended_sources(const oskar_Sky* sky, int offset,
+        int num_sources, int* status)
+{
+    int i, end;
+    if (*status || num_sources <= 0) return 0;
+    if (sky->mem_location != OSKAR_CPU) return sky->use_extended;
+    end = offset + num_sources;
+    if (sky->precision == OSKAR_DOUBLE)
+    {
+        const double *maj, *min;
+        maj = oskar_mem_double_const(sky->fwhm_major_rad, status);
+        min = oskar_mem_double_const(sky->fwhm_minor_rad, status);
+        for (i = offset; i < end; ++i)
+            if (maj[i] > 0.0 || min[i] > 0.0) return 1;
+    }
+    else
+    {
+        const float *maj, *min;
+        maj = oskar_mem_float_const(sky->fwhm_major_rad, status);
+        min = oskar_mem_float_const(sky->fwhm_minor_rad, status);
+        for (i = offset; i < end; ++i)
+            if (maj[i] > 0.0f || min[i] > 0.0f) return 1;
+    }
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
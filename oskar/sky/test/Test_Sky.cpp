@@ -30,7 +30,10 @@
 
 #include "telescope/oskar_telescope.h"
 #include "sky/oskar_sky.h"
+#include "sky/oskar_sky_copy_source_data.h"
+#include "sky/oskar_update_horizon_mask.h"
 #include "convert/oskar_convert_lon_lat_to_relative_directions.h"
+#include "math/oskar_angular_distance.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_timer.h"
 #include "utility/oskar_cl_utils.h"
@@ -566,6 +569,92 @@ TEST(SkyModel, horizon_clip)
 }
 
 
+static void horizon_clip_compare(int type, double gast)
+{
+    int status = 0;
+    const double deg2rad = M_PI / 180.0;
+
+    // Generate random sources over the whole sky.
+    int n_sources = 100000;
+    oskar_Sky* sky_in = oskar_sky_create(type, OSKAR_CPU, n_sources, &status);
+    srand(2);
+    for (int i = 0; i < n_sources; ++i)
+    {
+        double ra = 2.0 * M_PI * rand() / (double)RAND_MAX;
+        double dec = asin(2.0 * rand() / (double)RAND_MAX - 1.0);
+        oskar_sky_set_source(sky_in, i, ra, dec, double(i), 1.0, 2.0, 3.0,
+                100e6, -0.7, 0.0, 1e-4, 2e-4, 0.5, &status);
+    }
+    oskar_sky_evaluate_relative_directions(sky_in, 0.3, -0.5, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Create a telescope with stations spread over a wide area.
+    int n_stations = 64;
+    oskar_Telescope* telescope = oskar_telescope_create(type,
+            OSKAR_CPU, n_stations, &status);
+    for (int i = 0; i < n_stations; ++i)
+    {
+        oskar_station_set_position(oskar_telescope_station(telescope, i),
+                (i * 2.5 - 80.0) * deg2rad, (-60.0 + i * 0.5) * deg2rad, 0.0);
+    }
+
+    // Reference: per-station horizon mask followed by copy.
+    oskar_Mem* mask = oskar_mem_create(OSKAR_INT, OSKAR_CPU, n_sources,
+            &status);
+    oskar_Mem* indices = oskar_mem_create(OSKAR_INT, OSKAR_CPU, n_sources,
+            &status);
+    oskar_mem_clear_contents(mask, &status);
+    for (int i = 0; i < n_stations; ++i)
+    {
+        const oskar_Station* s = oskar_telescope_station_const(telescope, i);
+        oskar_update_horizon_mask(n_sources, oskar_sky_l_const(sky_in),
+                oskar_sky_m_const(sky_in), oskar_sky_n_const(sky_in),
+                gast + oskar_station_lon_rad(s) - 0.3, -0.5,
+                oskar_station_lat_rad(s), mask, &status);
+    }
+    oskar_Sky* sky_ref = oskar_sky_create(type, OSKAR_CPU, n_sources, &status);
+    oskar_sky_copy_source_data(sky_in, mask, indices, sky_ref, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Fused horizon clip.
+    oskar_StationWork* work = oskar_station_work_create(type, OSKAR_CPU,
+            &status);
+    oskar_Sky* sky_out = oskar_sky_create(type, OSKAR_CPU, 0, &status);
+    oskar_sky_horizon_clip(sky_out, sky_in, telescope, gast, work, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the outputs are identical.
+    int n_out = oskar_sky_num_sources(sky_ref);
+    ASSERT_GT(n_out, 0);
+    ASSERT_LT(n_out, n_sources);
+    ASSERT_EQ(n_out, oskar_sky_num_sources(sky_out));
+    EXPECT_EQ(0, oskar_mem_different(oskar_sky_ra_rad_const(sky_ref),
+            oskar_sky_ra_rad_const(sky_out), n_out, &status));
+    EXPECT_EQ(0, oskar_mem_different(oskar_sky_I_const(sky_ref),
+            oskar_sky_I_const(sky_out), n_out, &status));
+    EXPECT_EQ(0, oskar_mem_different(oskar_sky_n_const(sky_ref),
+            oskar_sky_n_const(sky_out), n_out, &status));
+    EXPECT_EQ(0, oskar_mem_different(oskar_sky_gaussian_c_const(sky_ref),
+            oskar_sky_gaussian_c_const(sky_out), n_out, &status));
+
+    oskar_mem_free(mask, &status);
+    oskar_mem_free(indices, &status);
+    oskar_sky_free(sky_in, &status);
+    oskar_sky_free(sky_ref, &status);
+    oskar_sky_free(sky_out, &status);
+    oskar_station_work_free(work, &status);
+    oskar_telescope_free(telescope, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+
+TEST(SkyModel, horizon_clip_spread_stations)
+{
+    horizon_clip_compare(OSKAR_SINGLE, 0.0);
+    horizon_clip_compare(OSKAR_DOUBLE, 1.2);
+}
+
+
 TEST(SkyModel, resize)
 {
     int status = 0;
@@ -1138,6 +1227,76 @@ TEST(SkyModel, load_ascii)
 }
 
 
+TEST(SkyModel, load_ascii_large)
+{
+    // Large enough to be split into several ranges for parallel parsing.
+    int status = 0;
+    const double deg2rad = 0.0174532925199432957692;
+    const double arcsec2rad = 4.84813681109535993589914e-6;
+    const char* filename = "temp_sources_large.osm";
+    const int num_sources = 100000;
+    FILE* file = fopen(filename, "w");
+    if (!file) FAIL() << "Unable to create test file";
+    for (int i = 0; i < num_sources; ++i)
+    {
+        if (i % 7 == 0) fprintf(file, "\n# comment %d\n", i);
+        if (i % 2 == 0)
+            fprintf(file, "%.10f,%.10f,%.6e 0 0 0 1.5e8 -0.7 %.3f "
+                    "%.3f %.4f %.2f", i * 0.003, -i * 0.0005, i * 1.25,
+                    i * 0.01, i * 0.001, i * 0.0005, 0.25 * (i % 20));
+        else
+            fprintf(file, "%.10f %.10f %.6e", i * 0.003, -i * 0.0005,
+                    i * 1.25);
+        if (i < num_sources - 1) fprintf(file, "\r\n");
+    }
+    fclose(file);
+
+    // Load the file.
+    oskar_Sky* sky = oskar_sky_load(filename, OSKAR_DOUBLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_sources, oskar_sky_num_sources(sky));
+    const double* ra = oskar_mem_double_const(oskar_sky_ra_rad_const(sky),
+            &status);
+    const double* dec = oskar_mem_double_const(oskar_sky_dec_rad_const(sky),
+            &status);
+    const double* I = oskar_mem_double_const(oskar_sky_I_const(sky), &status);
+    const double* rm = oskar_mem_double_const(
+            oskar_sky_rotation_measure_rad_const(sky), &status);
+    const double* maj = oskar_mem_double_const(
+            oskar_sky_fwhm_major_rad_const(sky), &status);
+    const double* pa = oskar_mem_double_const(
+            oskar_sky_position_angle_rad_const(sky), &status);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        ASSERT_DOUBLE_EQ(i * 0.003 * deg2rad, ra[i]) << i;
+        ASSERT_DOUBLE_EQ(-i * 0.0005 * deg2rad, dec[i]) << i;
+        ASSERT_NEAR(i * 1.25, I[i], i * 1e-6) << i;
+        if (i % 2 == 0)
+        {
+            ASSERT_NEAR(i * 0.01, rm[i], 1e-3) << i;
+            ASSERT_NEAR(i * 0.001 * arcsec2rad, maj[i], 1e-9) << i;
+            ASSERT_DOUBLE_EQ(0.25 * (i % 20) * deg2rad, pa[i]) << i;
+        }
+        else
+        {
+            ASSERT_EQ(0.0, rm[i]);
+            ASSERT_EQ(0.0, maj[i]);
+        }
+    }
+    oskar_sky_free(sky, &status);
+
+    // Check that a line with the wrong number of columns is an error.
+    file = fopen(filename, "a");
+    if (!file) FAIL() << "Unable to open test file";
+    fprintf(file, "\n1 2 3 4 5 6 7 8 9 10\n");
+    fclose(file);
+    sky = oskar_sky_load(filename, OSKAR_DOUBLE, &status);
+    EXPECT_EQ((int)OSKAR_ERR_BAD_SKY_FILE, status);
+    EXPECT_TRUE(sky == 0);
+    remove(filename);
+}
+
+
 TEST(SkyModel, read_write)
 {
     oskar_Sky *sky, *sky2;
@@ -1238,3 +1397,181 @@ TEST(SkyModel, read_write)
     remove(filename);
 }
 
+
+TEST(SkyModel, write_chunked_map)
+{
+    int status = 0, chunk_size = 0, num_chunks = 0;
+    const int num_sources = 10000, max_sources_per_chunk = 768;
+    const char* filename = "test_sky_model_write_chunked.osm";
+
+    // Fill sky model with random positions, and parameters that can be
+    // checked after the sources are sorted into chunks.
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, &status);
+    srand(2);
+    double sum_I = 0.0;
+    for (int i = 0; i < num_sources; ++i)
+    {
+        double ra = 2.0 * M_PI * rand() / (double)RAND_MAX;
+        double dec = asin(2.0 * rand() / (double)RAND_MAX - 1.0);
+        double I = 1.0 + i % 97;
+        sum_I += I;
+        oskar_sky_set_source(sky, i, ra, dec, I, 2.0 * I, ra, dec,
+                1e8, -0.7, 0.0, 0.0, 0.0, 0.0, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Write it to a file, in chunks.
+    oskar_sky_write_chunked(filename, sky, max_sources_per_chunk, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the file can still be read as a normal sky model file.
+    oskar_Sky* sky2 = oskar_sky_read(filename, OSKAR_CPU, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(num_sources, oskar_sky_num_sources(sky2));
+    oskar_sky_free(sky2, &status);
+
+    // Read the chunk directory, and map the file.
+    oskar_Binary* h = oskar_binary_create(filename, 'r', &status);
+    oskar_Mem* dir = oskar_sky_read_chunk_directory(h,
+            &chunk_size, &num_chunks, &status);
+    oskar_Sky* mapped = oskar_sky_map(h, OSKAR_DOUBLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(max_sources_per_chunk, chunk_size);
+    ASSERT_EQ((num_sources + chunk_size - 1) / chunk_size, num_chunks);
+    ASSERT_EQ(num_sources, oskar_sky_num_sources(mapped));
+
+    // Check each chunk against its bounds in the directory.
+    double sum_I_mapped = 0.0;
+    const double* b = oskar_mem_double_const(dir, &status);
+    for (int c = 0; c < num_chunks; ++c, b += OSKAR_SKY_CHUNK_NUM_PARAMS)
+    {
+        int num = num_sources - c * chunk_size;
+        if (num > chunk_size) num = chunk_size;
+        oskar_Sky* alias = oskar_sky_create_alias(mapped,
+                c * chunk_size, num, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        ASSERT_EQ(num, oskar_sky_num_sources(alias));
+        const double* ra = oskar_mem_double_const(
+                oskar_sky_ra_rad_const(alias), &status);
+        const double* dec = oskar_mem_double_const(
+                oskar_sky_dec_rad_const(alias), &status);
+        const double* I = oskar_mem_double_const(
+                oskar_sky_I_const(alias), &status);
+        const double* Q = oskar_mem_double_const(
+                oskar_sky_Q_const(alias), &status);
+        const double* U = oskar_mem_double_const(
+                oskar_sky_U_const(alias), &status);
+        const double* V = oskar_mem_double_const(
+                oskar_sky_V_const(alias), &status);
+        for (int i = 0; i < num; ++i)
+        {
+            EXPECT_DOUBLE_EQ(2.0 * I[i], Q[i]);
+            EXPECT_DOUBLE_EQ(ra[i], U[i]);
+            EXPECT_DOUBLE_EQ(dec[i], V[i]);
+            EXPECT_GE(I[i], b[OSKAR_SKY_CHUNK_MIN_I]);
+            EXPECT_LE(I[i], b[OSKAR_SKY_CHUNK_MAX_I]);
+            EXPECT_LE(oskar_angular_distance(ra[i],
+                    b[OSKAR_SKY_CHUNK_RA_RAD], dec[i],
+                    b[OSKAR_SKY_CHUNK_DEC_RAD]),
+                    b[OSKAR_SKY_CHUNK_RADIUS_RAD] + 1e-12);
+            sum_I_mapped += I[i];
+        }
+
+        // Chunks of sorted sources should cover a small part of the sky.
+        EXPECT_LT(b[OSKAR_SKY_CHUNK_RADIUS_RAD], M_PI / 2.0);
+        oskar_sky_free(alias, &status);
+    }
+    EXPECT_DOUBLE_EQ(sum_I, sum_I_mapped);
+
+    // Check an alias outside the range fails.
+    oskar_Sky* alias = oskar_sky_create_alias(mapped, num_sources - 1, 2,
+            &status);
+    EXPECT_EQ((int)OSKAR_ERR_OUT_OF_RANGE, status);
+    EXPECT_TRUE(alias == 0);
+    status = 0;
+
+    // Check the file can be mapped at a different precision.
+    oskar_Sky* mapped_single = oskar_sky_map(h, OSKAR_SINGLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ((int)OSKAR_SINGLE, oskar_sky_precision(mapped_single));
+    EXPECT_EQ(num_sources, oskar_sky_num_sources(mapped_single));
+    EXPECT_FLOAT_EQ((float) oskar_mem_double_const(
+            oskar_sky_I_const(mapped), &status)[123],
+            oskar_mem_float_const(oskar_sky_I_const(mapped_single),
+                    &status)[123]);
+
+    // Free memory. The file must be unmapped last.
+    oskar_sky_free(mapped_single, &status);
+    oskar_sky_free(mapped, &status);
+    oskar_mem_free(dir, &status);
+    oskar_binary_free(h);
+    oskar_sky_free(sky, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    remove(filename);
+}
+
+
+TEST(SkyModel, map_gaussian_source)
+{
+    int status = 0;
+    const int num_sources = 4;
+    const char* filename = "test_sky_model_map_gaussian.osm";
+
+    // Create a sky model with one Gaussian source at index 2.
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, &status);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        double fwhm = (i == 2) ? (1.0 / 60.0) * (M_PI / 180.0) : 0.0;
+        oskar_sky_set_source(sky, i, 0.1 * i, -0.5, 1.0, 0.0, 0.0, 0.0,
+                1e8, 0.0, 0.0, fwhm, fwhm, 0.0, &status);
+    }
+    oskar_sky_write(filename, sky, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the extended source flag is set on the mapped sky model.
+    oskar_Binary* h = oskar_binary_create(filename, 'r', &status);
+    oskar_Sky* mapped = oskar_sky_map(h, OSKAR_DOUBLE, &status);
+    oskar_Sky* mapped_single = oskar_sky_map(h, OSKAR_SINGLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_TRUE(oskar_sky_use_extended(mapped));
+    EXPECT_TRUE(oskar_sky_use_extended(mapped_single));
+
+    // Check it is set only on aliases that contain the Gaussian source.
+    oskar_Sky* points = oskar_sky_create_alias(mapped, 0, 2, &status);
+    oskar_Sky* gaussian = oskar_sky_create_alias(mapped, 1, 2, &status);
+    oskar_Sky* gaussian_single = oskar_sky_create_alias(mapped_single,
+            2, 2, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_FALSE(oskar_sky_use_extended(points));
+    EXPECT_TRUE(oskar_sky_use_extended(gaussian));
+    EXPECT_TRUE(oskar_sky_use_extended(gaussian_single));
+
+    // Check the flag is kept when an alias is copied for simulation.
+    oskar_Sky* copy = oskar_sky_create_copy(gaussian, OSKAR_CPU, &status);
+    EXPECT_TRUE(oskar_sky_use_extended(copy));
+
+    // Free memory. The file must be unmapped last.
+    oskar_sky_free(copy, &status);
+    oskar_sky_free(points, &status);
+    oskar_sky_free(gaussian, &status);
+    oskar_sky_free(gaussian_single, &status);
+    oskar_sky_free(mapped_single, &status);
+    oskar_sky_free(mapped, &status);
+    oskar_binary_free(h);
+
+    // Check a file of point sources does not set the flag.
+    oskar_sky_set_source(sky, 2, 0.2, -0.5, 1.0, 0.0, 0.0, 0.0,
+            1e8, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    oskar_sky_write(filename, sky, &status);
+    h = oskar_binary_create(filename, 'r', &status);
+    mapped = oskar_sky_map(h, OSKAR_DOUBLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_FALSE(oskar_sky_use_extended(mapped));
+    oskar_sky_free(mapped, &status);
+    oskar_binary_free(h);
+    oskar_sky_free(sky, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    remove(filename);
+}
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "splines/private_splines.h"
+#include "splines/oskar_dierckx_fpbspl.h"
+#include "splines/oskar_splines.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Returns the (1-based) knot interval l containing arg, such that
+ * t[l - 1] <= arg < t[l], with kx1 <= l <= nkx1.
+ * This is the same interval found by the linear search in fpbisp.
+ */
+#define KNOT_INTERVAL(L, T, ARG, K1, NK1) {                               \
+        int lo_ = K1, hi_ = NK1;                                          \
+        while (lo_ < hi_) {                                               \
+            const int mid_ = (lo_ + hi_) >> 1;                            \
+            if (ARG < T[mid_]) hi_ = mid_; else lo_ = mid_ + 1; }         \
+        L = lo_; }
+
+static void evaluate_group_f(int num_points, const float* x, const float* y,
+        int nx, const float* tx, int ny, const float* ty, int num_members,
+        const float* const* coeff, const int* member_offset, int stride,
+        float* out)
+{
+    int i;
+    const int nkx1 = nx - 4, nky1 = ny - 4;
+    const float tbx = tx[3], tex = tx[nkx1];
+    const float tby = ty[3], tey = ty[nky1];
+#pragma omp parallel for private(i)
+    for (i = 0; i < num_points; ++i)
+    {
+        int lx, ly, m, i1, j1;
+        float arg, hx[6], hy[6];
+
+        /* Evaluate the basis functions in x and y once per point. */
+        arg = x[i];
+        if (arg < tbx) arg = tbx;
+        if (arg > tex) arg = tex;
+        KNOT_INTERVAL(lx, tx, arg, 4, nkx1)
+        oskar_dierckx_fpbspl_f(tx, 3, arg, lx, hx);
+        arg = y[i];
+        if (arg < tby) arg = tby;
+        if (arg > tey) arg = tey;
+        KNOT_INTERVAL(ly, ty, arg, 4, nky1)
+        oskar_dierckx_fpbspl_f(ty, 3, arg, ly, hy);
+        lx -= 4;
+        ly -= 4;
+
+        /* Apply them to each set of coefficients. */
+        for (m = 0; m < num_members; ++m)
+        {
+            const float* c = coeff[m] + lx * nky1 + ly;
+            float sp = 0.0f;
+            for (i1 = 0; i1 < 4; ++i1)
+            {
+                for (j1 = 0; j1 < 4; ++j1)
+                    sp += c[j1] * hx[i1] * hy[j1];
+                c += nky1;
+            }
+            out[i * stride + member_offset[m]] = sp;
+        }
+    }
+}
+
+static void evaluate_group_d(int num_points, const double* x, const double* y,
+        int nx, const double* tx, int ny, const double* ty, int num_members,
+        const double* const* coeff, const int* member_offset, int stride,
+        double* out)
+{
+    int i;
+    const int nkx1 = nx - 4, nky1 = ny - 4;
+    const double tbx = tx[3], tex = tx[nkx1];
+    const double tby = ty[3], tey = ty[nky1];
+#pragma omp parallel for private(i)
+    for (i = 0; i < num_points; ++i)
+    {
+        int lx, ly, m, i1, j1;
+        double arg, hx[6], hy[6];
+
+        /* Evaluate the basis functions in x and y once per point. */
+        arg = x[i];
+        if (arg < tbx) arg = tbx;
+        if (arg > tex) arg = tex;
+        KNOT_INTERVAL(lx, tx, arg, 4, nkx1)
+        oskar_dierckx_fpbspl_d(tx, 3, arg, lx, hx);
+        arg = y[i];
+        if (arg < tby) arg = tby;
+        if (arg > tey) arg = tey;
+        KNOT_INTERVAL(ly, ty, arg, 4, nky1)
+        oskar_dierckx_fpbspl_d(ty, 3, arg, ly, hy);
+        lx -= 4;
+        ly -= 4;
+
+        /* Apply them to each set of coefficients. */
+        for (m = 0; m < num_members; ++m)
+        {
+            const double* c = coeff[m] + lx * nky1 + ly;
+            double sp = 0.0;
+            for (i1 = 0; i1 < 4; ++i1)
+            {
+                for (j1 = 0; j1 < 4; ++j1)
+                    sp += c[j1] * hx[i1] * hy[j1];
+                c += nky1;
+            }
+            out[i * stride + member_offset[m]] = sp;
+        }
+    }
+}
+
+static int is_empty(const oskar_Splines* spline)
+{
+    return (spline->num_knots_x_theta == 0 || spline->num_knots_y_phi == 0 ||
+            !oskar_mem_void_const(spline->knots_x_theta) ||
+            !oskar_mem_void_const(spline->knots_y_phi) ||
+            !oskar_mem_void_const(spline->coeff));
+}
+
+static int same_knots(const oskar_Splines* a, const oskar_Splines* b,
+        int* status)
+{
+    return (a->num_knots_x_theta == b->num_knots_x_theta &&
+            a->num_knots_y_phi == b->num_knots_y_phi &&
+            !oskar_mem_different(a->knots_x_theta, b->knots_x_theta,
+                    a->num_knots_x_theta, status) &&
+            !oskar_mem_different(a->knots_y_phi, b->knots_y_phi,
+                    a->num_knots_y_phi, status));
+}
+
+void oskar_splines_evaluate_fused(oskar_Mem* output, int offset, int stride,
+        int num_splines, const oskar_Splines* const* splines, int num_points,
+        const oskar_Mem* x, const oskar_Mem* y, int* status)
+{
+    int k, m, type, num_members, *member_offset = 0, *used = 0;
+    const void** coeff = 0;
+
+    /* Check if safe to proceed. */
+    if (*status || num_splines <= 0) return;
+
+    /* Evaluate each spline in turn if not in CPU memory. */
+    if (oskar_mem_location(output) != OSKAR_CPU)
+    {
+        for (k = 0; k < num_splines; ++k)
+            oskar_splines_evaluate(output, offset + k, stride, splines[k],
+                    num_points, x, y, status);
+        return;
+    }
+
+    /* Check types and locations. */
+    type = oskar_mem_type(x);
+    if (type != OSKAR_SINGLE && type != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (type != oskar_mem_type(y))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (oskar_mem_location(x) != OSKAR_CPU ||
+            oskar_mem_location(y) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    for (k = 0; k < num_splines; ++k)
+    {
+        if (splines[k]->precision != type)
+        {
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+            return;
+        }
+        if (splines[k]->mem_location != OSKAR_CPU)
+        {
+            *status = OSKAR_ERR_LOCATION_MISMATCH;
+            return;
+        }
+    }
+
+    /* Allocate scratch space for the group lists. */
+    member_offset = (int*) calloc(num_splines, sizeof(int));
+    used = (int*) calloc(num_splines, sizeof(int));
+    coeff = (const void**) calloc(num_splines, sizeof(void*));
+    if (!member_offset || !used || !coeff)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        goto done;
+    }
+
+    /* Evaluate each group of splines that share the same knots. */
+    for (k = 0; k < num_splines; ++k)
+    {
+        const oskar_Splines* s = splines[k];
+        if (used[k]) continue;
+
+        /* Splines with no data evaluate to zero. */
+        if (is_empty(s))
+        {
+            if (type == OSKAR_SINGLE)
+            {
+                float* out = oskar_mem_float(output, status) + offset + k;
+                for (m = 0; m < num_points; ++m) out[m * stride] = 0.0f;
+            }
+            else
+            {
+                double* out = oskar_mem_double(output, status) + offset + k;
+                for (m = 0; m < num_points; ++m) out[m * stride] = 0.0;
+            }
+            used[k] = 1;
+            continue;
+        }
+
+        /* Find the other members of the group. */
+        num_members = 0;
+        for (m = k; m < num_splines; ++m)
+        {
+            if (used[m] || is_empty(splines[m])) continue;
+            if (m != k && !same_knots(s, splines[m], status)) continue;
+            if (*status) goto done;
+            used[m] = 1;
+            member_offset[num_members] = offset + m;
+            coeff[num_members] = oskar_mem_void_const(splines[m]->coeff);
+            num_members++;
+        }
+
+        /* Evaluate the group. */
+        if (type == OSKAR_SINGLE)
+            evaluate_group_f(num_points,
+                    oskar_mem_float_const(x, status),
+                    oskar_mem_float_const(y, status),
+                    s->num_knots_x_theta,
+                    oskar_mem_float_const(s->knots_x_theta, status),
+                    s->num_knots_y_phi,
+                    oskar_mem_float_const(s->knots_y_phi, status),
+                    num_members, (const float* const*) coeff,
+                    member_offset, stride, oskar_mem_float(output, status));
+        else
+            evaluate_group_d(num_points,
+                    oskar_mem_double_const(x, status),
+                    oskar_mem_double_const(y, status),
+                    s->num_knots_x_theta,
+                    oskar_mem_double_const(s->knots_x_theta, status),
+                    s->num_knots_y_phi,
+                    oskar_mem_double_const(s->knots_y_phi, status),
+                    num_members, (const double* const*) coeff,
+                    member_offset, stride, oskar_mem_double(output, status));
+    }
+
+done:
+    free(member_offset);
+    free(used);
+    free(coeff);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -315,6 +315,44 @@ int oskar_telescope_num_stations(const oskar_Telescope* model);
 OSKAR_EXPORT
 int oskar_telescope_identical_stations(const oskar_Telescope* model);
 
+/**
+ * @brief
+ * Returns the number of distinct station models.
+ *
+ * @details
+ * Returns the number of distinct station models in the telescope.
+ * Stations that differ only in their position belong to the same model.
+ *
+ * Note that this value is only valid after calling
+ * oskar_telescope_analyse().
+ *
+ * @param[in] model Pointer to telescope model.
+ *
+ * @return The number of distinct station models.
+ */
+OSKAR_EXPORT
+int oskar_telescope_num_station_models(const oskar_Telescope* model);
+
+/**
+ * @brief
+ * Returns the station model index array.
+ *
+ * @details
+ * Returns an integer array in CPU memory containing, for each station,
+ * the index of the first station that has an identical model.
+ * Stations for which this index is their own are the first of their kind.
+ *
+ * Note that this array is only valid after calling
+ * oskar_telescope_analyse().
+ *
+ * @param[in] model Pointer to telescope model.
+ *
+ * @return A handle to the station model index array.
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_telescope_station_model_index_const(
+        const oskar_Telescope* model);
+
 /**
  * @brief
  * Returns the flag specifying whether station beam duplication is enabled.
@@ -48,6 +48,9 @@ extern "C" {
  * stations are identical and whether element errors and/or weights
  * should be applied. The relevant flags within the structure are updated.
  *
+ * Stations that differ only in their position are also grouped into
+ * distinct station models, so that their beams need only be evaluated once.
+ *
  * @param[in,out] model Telescope model structure to analyse.
  * @param[in,out]  status   Status return code.
  */
@@ -74,6 +74,8 @@ struct oskar_Telescope
     int max_station_size;                             /* Maximum station size (number of elements) */
     int max_station_depth;                            /* Maximum station depth. */
     int identical_stations;                           /* True if all stations are identical. */
+    int num_station_models;                           /* Number of distinct station models. */
+    oskar_Mem* station_model_index;                   /* For each station, index of first station with an identical model. */
     int allow_station_beam_duplication;               /* True if station beam duplication is allowed. */
     int enable_numerical_patterns;                    /* True if numerical element patterns are enabled. */
 };
@@ -134,6 +134,17 @@ int oskar_telescope_identical_stations(const oskar_Telescope* model)
     return model->identical_stations;
 }
 
+int oskar_telescope_num_station_models(const oskar_Telescope* model)
+{
+    return model->num_station_models;
+}
+
+const oskar_Mem* oskar_telescope_station_model_index_const(
+        const oskar_Telescope* model)
+{
+    return model->station_model_index;
+}
+
 int oskar_telescope_allow_station_beam_duplication(
         const oskar_Telescope* model)
 {
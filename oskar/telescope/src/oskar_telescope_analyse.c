@@ -28,10 +28,13 @@
 
 #include "telescope/private_telescope.h"
 #include "telescope/oskar_telescope.h"
+#include "telescope/station/private_station.h"
 
 #include "telescope/station/oskar_station_analyse.h"
 #include "telescope/station/oskar_station_different.h"
 
+#include <stdlib.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -75,6 +78,130 @@ static void set_child_station_locations(oskar_Station* s,
     }
 }
 
+/* FNV-1a hash of a block of memory. */
+static unsigned long long hash_bytes(unsigned long long h,
+        const void* data, size_t num_bytes)
+{
+    size_t i;
+    const unsigned char* p = (const unsigned char*) data;
+    for (i = 0; i < num_bytes; ++i)
+    {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+
+static unsigned long long hash_mem(unsigned long long h, const oskar_Mem* mem,
+        size_t num_elements)
+{
+    const void* data;
+    if (!mem) return h;
+    data = oskar_mem_void_const(mem);
+    if (num_elements > oskar_mem_length(mem))
+        num_elements = oskar_mem_length(mem);
+    if (!data || num_elements == 0) return h;
+    return hash_bytes(h, data,
+            num_elements * oskar_mem_element_size(oskar_mem_type(mem)));
+}
+
+
+/*
+ * Returns a hash of the station properties that affect its beam.
+ * Stations with different hashes are guaranteed to be different,
+ * as determined by oskar_station_different().
+ */
+static unsigned long long station_hash(const oskar_Station* s,
+        unsigned long long h)
+{
+    int i, flags[6];
+    const size_t n = (size_t) s->num_elements;
+    flags[0] = s->station_type;
+    flags[1] = s->num_elements;
+    flags[2] = s->num_element_types;
+    flags[3] = s->apply_element_errors;
+    flags[4] = s->apply_element_weight;
+    flags[5] = oskar_station_has_child(s);
+    h = hash_bytes(h, flags, sizeof(flags));
+    h = hash_mem(h, s->element_true_x_enu_metres, n);
+    h = hash_mem(h, s->element_true_y_enu_metres, n);
+    h = hash_mem(h, s->element_true_z_enu_metres, n);
+    h = hash_mem(h, s->element_gain, n);
+    h = hash_mem(h, s->element_phase_offset_rad, n);
+    h = hash_mem(h, s->element_weight, n);
+    h = hash_mem(h, s->element_x_alpha_cpu, n);
+    h = hash_mem(h, s->element_y_alpha_cpu, n);
+    h = hash_mem(h, s->element_types_cpu, n);
+    if (oskar_station_has_child(s))
+    {
+        for (i = 0; i < s->num_elements; ++i)
+            h = station_hash(oskar_station_child_const(s, i), h);
+    }
+    return h;
+}
+
+
+/*
+ * Finds the first station with an identical model for each station,
+ * and counts the number of distinct models.
+ * Stations are first grouped by hash, and then compared in full.
+ */
+static void find_station_models(oskar_Telescope* model,
+        int identical_check_possible, int* status)
+{
+    int i, j, *index, num_stations;
+    unsigned long long* hash;
+
+    /* Resize the index array. */
+    num_stations = model->num_stations;
+    oskar_mem_realloc(model->station_model_index, num_stations, status);
+    if (*status) return;
+    index = oskar_mem_int(model->station_model_index, status);
+    model->num_station_models = num_stations;
+    for (i = 0; i < num_stations; ++i) index[i] = i;
+
+    /* Stations with time-variable errors are always different. */
+    if (!identical_check_possible || num_stations == 0) return;
+    if (model->identical_stations)
+    {
+        for (i = 0; i < num_stations; ++i) index[i] = 0;
+        model->num_station_models = 1;
+        return;
+    }
+
+    /* Compute the hash of each station. */
+    hash = (unsigned long long*) malloc(
+            num_stations * sizeof(unsigned long long));
+    if (!hash)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    for (i = 0; i < num_stations; ++i)
+        hash[i] = station_hash(oskar_telescope_station_const(model, i),
+                14695981039346656037ULL);
+
+    /* Compare each station with the first of each previous model. */
+    model->num_station_models = 0;
+    for (i = 0; i < num_stations; ++i)
+    {
+        for (j = 0; j < i; ++j)
+        {
+            if (index[j] != j || hash[j] != hash[i]) continue;
+            if (!oskar_station_different(
+                    oskar_telescope_station_const(model, j),
+                    oskar_telescope_station_const(model, i), status))
+            {
+                index[i] = j;
+                break;
+            }
+        }
+        if (index[i] == i) model->num_station_models++;
+    }
+    free(hash);
+}
+
 
 void oskar_telescope_analyse(oskar_Telescope* model, int* status)
 {
@@ -124,6 +251,9 @@ void oskar_telescope_analyse(oskar_Telescope* model, int* status)
             }
         }
     }
+
+    /* Find groups of stations with identical models. */
+    find_station_models(model, !finished_identical_station_check, status);
 }
 
 #ifdef __cplusplus
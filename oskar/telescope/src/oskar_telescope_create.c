@@ -69,6 +69,7 @@ oskar_Telescope* oskar_telescope_create(int type, int location,
     telescope->max_station_size = 0;
     telescope->max_station_depth = 1;
     telescope->identical_stations = 0;
+    telescope->num_station_models = 0;
     telescope->allow_station_beam_duplication = 0;
     telescope->enable_numerical_patterns = 1;
     telescope->lon_rad = 0.0;
@@ -112,6 +113,8 @@ oskar_Telescope* oskar_telescope_create(int type, int location,
             oskar_mem_create(type, location, num_stations, status);
     telescope->station_measured_z_enu_metres =
             oskar_mem_create(type, location, num_stations, status);
+    telescope->station_model_index =
+            oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
 
     /* Initialise the station structures. */
     telescope->station = NULL;
@@ -55,6 +55,7 @@ oskar_Telescope* oskar_telescope_create_copy(const oskar_Telescope* src,
     telescope->max_station_size = src->max_station_size;
     telescope->max_station_depth = src->max_station_depth;
     telescope->identical_stations = src->identical_stations;
+    telescope->num_station_models = src->num_station_models;
     telescope->allow_station_beam_duplication = src->allow_station_beam_duplication;
     telescope->enable_numerical_patterns = src->enable_numerical_patterns;
     telescope->lon_rad = src->lon_rad;
@@ -98,6 +99,8 @@ oskar_Telescope* oskar_telescope_create_copy(const oskar_Telescope* src,
             src->station_measured_y_enu_metres, status);
     oskar_mem_copy(telescope->station_measured_z_enu_metres,
             src->station_measured_z_enu_metres, status);
+    oskar_mem_copy(telescope->station_model_index,
+            src->station_model_index, status);
 
     /* Copy each station. */
     telescope->station = malloc(src->num_stations * sizeof(oskar_Station*));
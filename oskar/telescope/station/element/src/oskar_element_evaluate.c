@@ -100,14 +100,15 @@ void oskar_element_evaluate(const oskar_Element* model, oskar_Mem* output,
                     oskar_element_freqs_hz_const(model));
 
             /* Evaluate spline pattern for dipole X. */
-            oskar_splines_evaluate(output, 0, 8, model->x_h_re[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 1, 8, model->x_h_im[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 2, 8, model->x_v_re[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 3, 8, model->x_v_im[freq_id],
-                    num_points, theta, phi, status);
+            {
+                const oskar_Splines* splines[4];
+                splines[0] = model->x_h_re[freq_id];
+                splines[1] = model->x_h_im[freq_id];
+                splines[2] = model->x_v_re[freq_id];
+                splines[3] = model->x_v_im[freq_id];
+                oskar_splines_evaluate_fused(output, 0, 8, 4, splines,
+                        num_points, theta, phi, status);
+            }
 
             /* Convert from Ludwig-3 to spherical representation. */
             oskar_convert_ludwig3_to_theta_phi_components(output, 0, 4,
@@ -139,14 +140,15 @@ void oskar_element_evaluate(const oskar_Element* model, oskar_Mem* output,
                     oskar_element_freqs_hz_const(model));
 
             /* Evaluate spline pattern for dipole Y. */
-            oskar_splines_evaluate(output, 4, 8, model->y_h_re[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 5, 8, model->y_h_im[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 6, 8, model->y_v_re[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 7, 8, model->y_v_im[freq_id],
-                    num_points, theta, phi, status);
+            {
+                const oskar_Splines* splines[4];
+                splines[0] = model->y_h_re[freq_id];
+                splines[1] = model->y_h_im[freq_id];
+                splines[2] = model->y_v_re[freq_id];
+                splines[3] = model->y_v_im[freq_id];
+                oskar_splines_evaluate_fused(output, 4, 8, 4, splines,
+                        num_points, theta, phi, status);
+            }
 
             /* Convert from Ludwig-3 to spherical representation. */
             oskar_convert_ludwig3_to_theta_phi_components(output, 2, 4,
@@ -177,10 +179,14 @@ void oskar_element_evaluate(const oskar_Element* model, oskar_Mem* output,
                     oskar_element_num_freq(model),
                     oskar_element_freqs_hz_const(model));
 
-            oskar_splines_evaluate(output, 0, 2, model->scalar_re[freq_id],
-                    num_points, theta, phi, status);
-            oskar_splines_evaluate(output, 1, 2, model->scalar_im[freq_id],
-                    num_points, theta, phi, status);
+            /* Evaluate spline pattern. */
+            {
+                const oskar_Splines* splines[2];
+                splines[0] = model->scalar_re[freq_id];
+                splines[1] = model->scalar_im[freq_id];
+                oskar_splines_evaluate_fused(output, 0, 2, 2, splines,
+                        num_points, theta, phi, status);
+            }
         }
         else if (element_type == OSKAR_ELEMENT_TYPE_DIPOLE)
         {
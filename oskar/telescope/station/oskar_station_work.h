@@ -75,8 +75,63 @@ oskar_StationWork* oskar_station_work_create(int type, int location,
 OSKAR_EXPORT
 void oskar_station_work_free(oskar_StationWork* work, int* status);
 
+/**
+ * @brief Invalidates any cached data in the station work buffers.
+ * @details
+ * This function must be called whenever the source directions passed to
+ * the station beam functions change, if the ENU direction cache is enabled.
+ * @param[in,out]  work   Pointer to structure.
+ */
+OSKAR_EXPORT
+void oskar_station_work_clear_cache(oskar_StationWork* work);
+
+/**
+ * @brief Enables or disables reuse of ENU direction cosines.
+ * @details
+ * If enabled, the ENU direction cosines computed when evaluating a station
+ * beam from relative directions are reused for subsequent calls using the
+ * same station, number of points and Greenwich sidereal time (for example,
+ * for all frequency channels of one time step), until
+ * oskar_station_work_clear_cache() is called.
+ *
+ * The caller is responsible for clearing the cache if the contents of the
+ * source direction arrays are modified.
+ * @param[in,out]  work   Pointer to structure.
+ * @param[in]      value  If true, enable the cache.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_enu_cache_enabled(oskar_StationWork* work,
+        int value);
+
+/**
+ * @brief Enables or disables sharing of tile beams between stations.
+ * @details
+ * If enabled, the beam of the identical child stations (tiles) of one
+ * station is reused for the next station with identical tiles, at the same
+ * time, frequency and number of points, instead of being evaluated again.
+ *
+ * The tile beam is evaluated in the horizon frame of the first station,
+ * so this should only be enabled if station beam duplication is allowed.
+ * Changing this setting clears any cached tile beam.
+ * @param[in,out]  work   Pointer to structure.
+ * @param[in]      value  If true, enable the cache.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_tile_cache_enabled(oskar_StationWork* work,
+        int value);
+
 /* Accessors. */
 
+/**
+ * @brief Returns the arena used for temporary alias handles.
+ * @details
+ * Functions that take handles from the arena must return them before
+ * they return, using oskar_mem_arena_mark() and oskar_mem_arena_release().
+ * @param[in,out]  work   Pointer to structure.
+ */
+OSKAR_EXPORT
+oskar_MemArena* oskar_station_work_arena(oskar_StationWork* work);
+
 OSKAR_EXPORT
 oskar_Mem* oskar_station_work_horizon_mask(oskar_StationWork* work);
 
@@ -96,6 +151,10 @@ OSKAR_EXPORT
 oskar_Mem* oskar_station_work_normalised_beam(oskar_StationWork* work,
         const oskar_Mem* output_beam, int* status);
 
+OSKAR_EXPORT
+oskar_Mem* oskar_station_work_tile_beam(oskar_StationWork* work,
+        const oskar_Mem* output_beam, size_t length, int* status);
+
 OSKAR_EXPORT
 oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
         const oskar_Mem* output_beam, size_t length, int depth, int* status);
@@ -31,6 +31,22 @@
 
 #include <mem/oskar_mem.h>
 
+/* Maximum number of station layouts in the grid cache. */
+#define OSKAR_STATION_WORK_GRID_CACHE_SIZE 4
+
+/* Grid layout of one station, keyed on a copy of its element coordinates.
+ * The grid size is zero if the layout is not a grid. */
+typedef struct oskar_StationWorkGrid
+{
+    int valid, num_x, num_y;
+    unsigned int last_used;
+    oskar_Mem* key_x;            /* Real scalar. Element x coordinates. */
+    oskar_Mem* key_y;            /* Real scalar. Element y coordinates. */
+    oskar_Mem* x;                /* Real scalar. Distinct x positions. */
+    oskar_Mem* y;                /* Real scalar. Distinct y positions. */
+    oskar_Mem* index;            /* Integer. Grid cell of each element. */
+} oskar_StationWorkGrid;
+
 struct oskar_StationWork
 {
     oskar_Mem* horizon_mask;     /* Integer. */
@@ -49,6 +65,27 @@ struct oskar_StationWork
 
     int num_depths;
     oskar_Mem** beam;            /* For hierarchical stations. */
+
+    /* Key for cached ENU direction cosines. */
+    int enu_cache_enabled, enu_cache_num_points;
+    const void* enu_cache_station;
+    double enu_cache_gast;
+
+    /* Grid layouts of the stations checked most recently, for the
+     * factorised array factor. There is room for one entry for each level
+     * of a hierarchical station, so the levels do not evict each other. */
+    oskar_StationWorkGrid grid[OSKAR_STATION_WORK_GRID_CACHE_SIZE];
+    unsigned int grid_counter;   /* Incremented on each lookup. */
+    oskar_Mem* grid_weights;     /* Complex scalar. Weights in grid order. */
+
+    /* Tile beam, shared between stations with identical tiles. */
+    oskar_Mem* tile_beam;
+    int tile_cache_enabled, tile_cache_num_points, tile_cache_time_index;
+    const void* tile_cache_tile;
+    double tile_cache_gast, tile_cache_frequency_hz;
+
+    /* Temporary alias handles used while evaluating the beam. */
+    oskar_MemArena* arena;
 };
 
 #ifndef OSKAR_STATION_WORK_TYPEDEF_
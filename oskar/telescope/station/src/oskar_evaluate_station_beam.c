@@ -30,6 +30,7 @@
 #include "telescope/station/oskar_evaluate_station_beam_aperture_array.h"
 #include "telescope/station/oskar_evaluate_station_beam_gaussian.h"
 #include "telescope/station/oskar_evaluate_vla_beam_pbcor.h"
+#include "telescope/station/private_station_work.h"
 #include "convert/oskar_convert_relative_directions_to_enu_directions.h"
 #include "convert/oskar_convert_enu_directions_to_relative_directions.h"
 
@@ -194,11 +195,20 @@ static void evaluate_station_beam_relative_directions(oskar_Mem* beam_pattern,
 
     if (*status) return;
 
-    /* ENU directions are needed for horizon clip in all cases */
+    /* ENU directions are needed for horizon clip in all cases.
+     * They depend only on the station and time, so can be reused if they
+     * have already been computed for this station at this time. */
     x = oskar_station_work_enu_direction_x(work);
     y = oskar_station_work_enu_direction_y(work);
     z = oskar_station_work_enu_direction_z(work);
-    compute_enu_directions(x, y, z, np, l, m, n, station, GAST, status);
+    if (!work->enu_cache_enabled || work->enu_cache_station != station ||
+            work->enu_cache_num_points != np || work->enu_cache_gast != GAST)
+    {
+        compute_enu_directions(x, y, z, np, l, m, n, station, GAST, status);
+        work->enu_cache_station = (*status) ? 0 : station;
+        work->enu_cache_num_points = np;
+        work->enu_cache_gast = GAST;
+    }
 
     switch (oskar_station_type(station))
     {
@@ -244,6 +254,9 @@ static void evaluate_station_beam_enu_directions(oskar_Mem* beam_pattern,
 {
     if (*status) return;
 
+    /* The ENU work arrays may be overwritten below. */
+    oskar_station_work_clear_cache(work);
+
     switch (oskar_station_type(station))
     {
         case OSKAR_STATION_TYPE_AA:
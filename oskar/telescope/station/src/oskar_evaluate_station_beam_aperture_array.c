@@ -32,10 +32,14 @@
 #include "telescope/station/oskar_evaluate_element_weights.h"
 #include "telescope/station/element/oskar_element_evaluate.h"
 #include "telescope/station/oskar_blank_below_horizon.h"
+#include "telescope/station/oskar_station.h"
 #include "telescope/station/private_station_work.h"
 
 #include "math/oskar_cmath.h"
 #include "math/oskar_dftw.h"
+#include "math/oskar_dftw_grid.h"
+
+#include <stdlib.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -43,12 +47,22 @@ extern "C" {
 
 #define MAX_CHUNK_SIZE 49152
 
+/* Tolerance used to decide if element coordinates are equal, in metres. */
+#define GRID_TOLERANCE 1e-6
+
 /* Private function, used for recursive calls. */
 static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
         const oskar_Station* s, int num_points, const oskar_Mem* x,
         const oskar_Mem* y, const oskar_Mem* z, double gast,
         double frequency_hz, oskar_StationWork* work, int time_index,
-        int depth, int* status);
+        int depth, oskar_Mem* tile_beam, int* status);
+static void evaluate_array_factor(oskar_Mem* array, const oskar_Station* s,
+        const oskar_Mem* weights, double wavenumber, int num_points,
+        const oskar_Mem* x, const oskar_Mem* y, const oskar_Mem* z,
+        oskar_StationWork* work, int* status);
+static int tile_cache_valid(const oskar_StationWork* work,
+        const oskar_Station* tile, int num_points, double gast,
+        double frequency_hz, int time_index, int* status);
 
 
 void oskar_evaluate_station_beam_aperture_array(oskar_Mem* beam,
@@ -68,15 +82,32 @@ void oskar_evaluate_station_beam_aperture_array(oskar_Mem* beam,
     {
         oskar_evaluate_station_beam_aperture_array_private(beam, station,
                 num_points, x, y, z, gast, frequency_hz, work,
-                time_index, 0, status);
+                time_index, 0, 0, status);
     }
     else
     {
-        oskar_Mem *c_beam, *c_x, *c_y, *c_z;
-        c_beam = oskar_mem_create_alias(0, 0, 0, status);
-        c_x = oskar_mem_create_alias(0, 0, 0, status);
-        c_y = oskar_mem_create_alias(0, 0, 0, status);
-        c_z = oskar_mem_create_alias(0, 0, 0, status);
+        int evaluate_tile = 0;
+        const oskar_Station* tile = 0;
+        oskar_Mem *c_beam, *c_x, *c_y, *c_z, *c_tile = 0, *tile_beam = 0;
+        const int mark = oskar_mem_arena_mark(work->arena);
+        c_beam = oskar_mem_arena_alias(work->arena, 0, 0, 0, status);
+        c_x = oskar_mem_arena_alias(work->arena, 0, 0, 0, status);
+        c_y = oskar_mem_arena_alias(work->arena, 0, 0, 0, status);
+        c_z = oskar_mem_arena_alias(work->arena, 0, 0, 0, status);
+
+        /* If the tiles are identical, their beam can be shared with other
+         * stations that have the same tiles, if enabled. */
+        if (work->tile_cache_enabled &&
+                oskar_station_identical_children(station))
+        {
+            tile = oskar_station_child_const(station, 0);
+            tile_beam = oskar_station_work_tile_beam(work, beam,
+                    num_points, status);
+            c_tile = oskar_mem_arena_alias(work->arena, 0, 0, 0, status);
+            evaluate_tile = !tile_cache_valid(work, tile, num_points, gast,
+                    frequency_hz, time_index, status);
+            if (evaluate_tile) work->tile_cache_tile = 0;
+        }
 
         /* Split up list of input points into manageable chunks. */
         for (start = 0; start < num_points; start += MAX_CHUNK_SIZE)
@@ -93,17 +124,35 @@ void oskar_evaluate_station_beam_aperture_array(oskar_Mem* beam,
             oskar_mem_set_alias(c_y, y, start, chunk_size, status);
             oskar_mem_set_alias(c_z, z, start, chunk_size, status);
 
+            /* Evaluate the shared tile beam if required. */
+            if (c_tile)
+            {
+                oskar_mem_set_alias(c_tile, tile_beam, start, chunk_size,
+                        status);
+                if (evaluate_tile)
+                    oskar_evaluate_station_beam_aperture_array_private(c_tile,
+                            tile, chunk_size, c_x, c_y, c_z, gast,
+                            frequency_hz, work, time_index, 2, 0, status);
+            }
+
             /* Start recursive call at depth 1 (depth 0 is element level). */
             oskar_evaluate_station_beam_aperture_array_private(c_beam, station,
                     chunk_size, c_x, c_y, c_z, gast, frequency_hz, work,
-                    time_index, 1, status);
+                    time_index, 1, c_tile, status);
+        }
+
+        /* Store the key for the tile beam. */
+        if (evaluate_tile && !*status)
+        {
+            work->tile_cache_tile = tile;
+            work->tile_cache_num_points = num_points;
+            work->tile_cache_gast = gast;
+            work->tile_cache_frequency_hz = frequency_hz;
+            work->tile_cache_time_index = time_index;
         }
 
         /* Release handles for chunk memory. */
-        oskar_mem_free(c_beam, status);
-        oskar_mem_free(c_x, status);
-        oskar_mem_free(c_y, status);
-        oskar_mem_free(c_z, status);
+        oskar_mem_arena_release(work->arena, mark);
     }
 }
 
@@ -111,7 +160,7 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
         const oskar_Station* s, int num_points, const oskar_Mem* x,
         const oskar_Mem* y, const oskar_Mem* z, double gast,
         double frequency_hz, oskar_StationWork* work, int time_index,
-        int depth, int* status)
+        int depth, oskar_Mem* tile_beam, int* status)
 {
     double beam_x, beam_y, beam_z, wavenumber;
     oskar_Mem *weights, *weights_error, *theta, *phi, *array;
@@ -158,12 +207,8 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
                 oskar_evaluate_element_weights(weights, weights_error,
                         wavenumber, s, beam_x, beam_y, beam_z,
                         time_index, status);
-                oskar_dftw(num_elements, wavenumber,
-                        oskar_station_element_true_x_enu_metres_const(s),
-                        oskar_station_element_true_y_enu_metres_const(s),
-                        oskar_station_element_true_z_enu_metres_const(s),
-                        weights, num_points, x, y, (is_3d ? z : 0), 0, array,
-                        status);
+                evaluate_array_factor(array, s, weights, wavenumber,
+                        num_points, x, y, z, work, status);
 
                 /* Normalise array response if required. */
                 if (oskar_station_normalise_array_pattern(s))
@@ -196,7 +241,7 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
         /* Can't separate array and element evaluation. */
         else
         {
-            int i, num_element_types;
+            int i, num_element_types, mark;
             oskar_Mem *element_block = 0, *element = 0;
             const int* element_type_array = 0;
 
@@ -212,7 +257,9 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
                     num_elements * num_points, 0, status);
 
             /* Create alias into element block. */
-            element = oskar_mem_create_alias(element_block, 0, 0, status);
+            mark = oskar_mem_arena_mark(work->arena);
+            element = oskar_mem_arena_alias(work->arena,
+                    element_block, 0, 0, status);
 
             /* Loop over elements and evaluate response for each. */
             element_type_array = oskar_station_element_types_cpu_const(s);
@@ -250,7 +297,7 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
                     element_block, beam, status);
 
             /* Free element alias. */
-            oskar_mem_free(element, status);
+            oskar_mem_arena_release(work->arena, mark);
 
             /* Normalise array response if required. */
             if (oskar_station_normalise_array_pattern(s))
@@ -274,48 +321,56 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
             return;
         }
 
-        /* Get sized work array for this depth, with the correct type. */
-        signal = oskar_station_work_beam(work, beam, num_elements * num_points,
-                depth, status);
-
         /* Check if child stations are identical. */
         if (oskar_station_identical_children(s))
         {
-            /* Set up the output buffer for the first station. */
-            oskar_Mem* output0;
-            output0 = oskar_mem_create_alias(signal, 0, num_points, status);
-
-            /* Recursive call. */
-            oskar_evaluate_station_beam_aperture_array_private(output0,
-                    oskar_station_child_const(s, 0), num_points,
-                    x, y, z, gast, frequency_hz, work, time_index,
-                    depth + 1, status);
-
-            /* Copy beam for child station 0 into memory for other stations. */
-            for (i = 1; i < num_elements; ++i)
+            /* The beam is the product of the beam of any one child station
+             * and the array factor, so the child beam is evaluated only once,
+             * unless it has been supplied. */
+            if (!tile_beam)
             {
-                oskar_mem_copy_contents(signal, output0, i * num_points, 0,
-                        oskar_mem_length(output0), status);
+                tile_beam = oskar_station_work_beam(work, beam, num_points,
+                        depth, status);
+                oskar_evaluate_station_beam_aperture_array_private(tile_beam,
+                        oskar_station_child_const(s, 0), num_points,
+                        x, y, z, gast, frequency_hz, work, time_index,
+                        depth + 1, 0, status);
             }
-            oskar_mem_free(output0, status);
+
+            /* Generate beamforming weights and evaluate array factor. */
+            oskar_evaluate_element_weights(weights, weights_error, wavenumber,
+                    s, beam_x, beam_y, beam_z, time_index, status);
+            evaluate_array_factor(array, s, weights, wavenumber, num_points,
+                    x, y, z, work, status);
+
+            /* Normalise array response if required. */
+            if (oskar_station_normalise_array_pattern(s))
+                oskar_mem_scale_real(array, 1.0 / num_elements, status);
+
+            /* Element-wise multiply to join array factor and child beam. */
+            oskar_mem_multiply(beam, tile_beam, array, num_points, status);
+            return;
         }
-        else
+
+        /* Get sized work array for this depth, with the correct type. */
+        signal = oskar_station_work_beam(work, beam, num_elements * num_points,
+                depth, status);
+
+        /* Loop over child stations. */
+        for (i = 0; i < num_elements; ++i)
         {
-            /* Loop over child stations. */
-            for (i = 0; i < num_elements; ++i)
-            {
-                /* Set up the output buffer for this station. */
-                oskar_Mem* output;
-                output = oskar_mem_create_alias(signal, i * num_points,
-                        num_points, status);
+            /* Set up the output buffer for this station. */
+            oskar_Mem* output;
+            const int mark = oskar_mem_arena_mark(work->arena);
+            output = oskar_mem_arena_alias(work->arena, signal,
+                    i * num_points, num_points, status);
 
-                /* Recursive call. */
-                oskar_evaluate_station_beam_aperture_array_private(output,
-                        oskar_station_child_const(s, i), num_points,
-                        x, y, z, gast, frequency_hz, work, time_index,
-                        depth + 1, status);
-                oskar_mem_free(output, status);
-            }
+            /* Recursive call. */
+            oskar_evaluate_station_beam_aperture_array_private(output,
+                    oskar_station_child_const(s, i), num_points,
+                    x, y, z, gast, frequency_hz, work, time_index,
+                    depth + 1, 0, status);
+            oskar_mem_arena_release(work->arena, mark);
         }
 
         /* Generate beamforming weights and form beam from child stations. */
@@ -334,6 +389,244 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
     }
 }
 
+
+static int compare_double(const void* a, const void* b)
+{
+    const double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+
+/* Sorts the coordinates, and reduces them to a list of distinct values.
+ * Returns the number of distinct values, or 0 if there are too many. */
+static int distinct_values(int n, double* v)
+{
+    int i, num_distinct = 0;
+    qsort(v, n, sizeof(double), compare_double);
+    for (i = 0; i < n; ++i)
+    {
+        if (num_distinct > 0 && v[i] - v[num_distinct - 1] <= GRID_TOLERANCE)
+            continue;
+        if (num_distinct == OSKAR_DFTW_GRID_MAX_SIDE) return 0;
+        v[num_distinct++] = v[i];
+    }
+    return num_distinct;
+}
+
+
+static int find_value(int n, const double* v, double value)
+{
+    int i;
+    for (i = 0; i < n; ++i)
+        if (fabs(v[i] - value) <= GRID_TOLERANCE) return i;
+    return -1;
+}
+
+
+/* Returns true if the key holds the first n elements of src. */
+static int key_matches(const oskar_Mem* key, const oskar_Mem* src, int n,
+        int* status)
+{
+    return (oskar_mem_type(key) == oskar_mem_type(src) &&
+            (int)oskar_mem_length(key) == n &&
+            !oskar_mem_different(key, src, n, status));
+}
+
+
+/* Copies the first n elements of src to the key. */
+static void set_key(oskar_Mem** key, const oskar_Mem* src, int n,
+        int* status)
+{
+    if (oskar_mem_type(*key) != oskar_mem_type(src))
+    {
+        oskar_mem_free(*key, status);
+        *key = oskar_mem_create(oskar_mem_type(src), OSKAR_CPU, n, status);
+    }
+    else
+        oskar_mem_realloc(*key, n, status);
+    oskar_mem_copy_contents(*key, src, 0, 0, n, status);
+}
+
+
+/* Checks if the elements of a 2D station lie on a rectangular grid, with
+ * one element at each grid point, so that the array factor is separable.
+ * Returns the grid layout, or NULL if the layout is not a grid.
+ * Layouts are cached in the work buffers, keyed on the element coordinates,
+ * and the least recently used one is replaced. */
+static const oskar_StationWorkGrid* station_grid(const oskar_Station* s,
+        oskar_StationWork* work, int* status)
+{
+    int i, num_elements, num_x, num_y, *index;
+    double *vx, *vy, *ux, *uy;
+    const oskar_Mem *x, *y;
+    oskar_StationWorkGrid* grid = 0;
+    if (*status) return 0;
+    num_elements = oskar_station_num_elements(s);
+    x = oskar_station_element_true_x_enu_metres_const(s);
+    y = oskar_station_element_true_y_enu_metres_const(s);
+    if (oskar_station_array_is_3d(s) || num_elements < 4 ||
+            oskar_mem_location(x) != OSKAR_CPU)
+        return 0;
+
+    /* Look for the layout in the cache. */
+    work->grid_counter++;
+    for (i = 0; i < OSKAR_STATION_WORK_GRID_CACHE_SIZE; ++i)
+    {
+        oskar_StationWorkGrid* g = &work->grid[i];
+        if (g->valid && key_matches(g->key_x, x, num_elements, status) &&
+                key_matches(g->key_y, y, num_elements, status))
+        {
+            g->last_used = work->grid_counter;
+            return (g->num_x > 0) ? g : 0;
+        }
+        if (!grid || !g->valid ||
+                (grid->valid && g->last_used < grid->last_used))
+            grid = g;
+    }
+
+    /* Replace the least recently used entry. */
+    set_key(&grid->key_x, x, num_elements, status);
+    set_key(&grid->key_y, y, num_elements, status);
+    if (*status) return 0;
+    grid->valid = 1;
+    grid->last_used = work->grid_counter;
+    grid->num_x = grid->num_y = 0;
+
+    /* Find the distinct x and y coordinates. */
+    vx = (double*) malloc(4 * num_elements * sizeof(double));
+    if (!vx)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    vy = vx + num_elements;
+    ux = vy + num_elements;
+    uy = ux + num_elements;
+    if (oskar_mem_precision(x) == OSKAR_DOUBLE)
+    {
+        const double *x_ = oskar_mem_double_const(x, status);
+        const double *y_ = oskar_mem_double_const(y, status);
+        for (i = 0; i < num_elements; ++i)
+        {
+            vx[i] = ux[i] = x_[i];
+            vy[i] = uy[i] = y_[i];
+        }
+    }
+    else
+    {
+        const float *x_ = oskar_mem_float_const(x, status);
+        const float *y_ = oskar_mem_float_const(y, status);
+        for (i = 0; i < num_elements; ++i)
+        {
+            vx[i] = ux[i] = x_[i];
+            vy[i] = uy[i] = y_[i];
+        }
+    }
+    num_x = distinct_values(num_elements, ux);
+    num_y = distinct_values(num_elements, uy);
+
+    /* Check that there is exactly one element at each grid point. */
+    if (num_x > 1 && num_y > 1 && num_x * num_y == num_elements)
+    {
+        char* used;
+        used = (char*) calloc(num_elements, 1);
+        if (!used) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        oskar_mem_realloc(grid->index, num_elements, status);
+        oskar_mem_realloc(grid->x, num_x, status);
+        oskar_mem_realloc(grid->y, num_y, status);
+        if (!*status)
+        {
+            index = oskar_mem_int(grid->index, status);
+            for (i = 0; i < num_elements; ++i)
+            {
+                const int ix = find_value(num_x, ux, vx[i]);
+                const int iy = find_value(num_y, uy, vy[i]);
+                if (ix < 0 || iy < 0 || used[iy * num_x + ix]) break;
+                used[iy * num_x + ix] = 1;
+                index[i] = iy * num_x + ix;
+            }
+            if (i == num_elements)
+            {
+                for (i = 0; i < num_x; ++i)
+                    oskar_mem_set_element_real(grid->x, i, ux[i], status);
+                for (i = 0; i < num_y; ++i)
+                    oskar_mem_set_element_real(grid->y, i, uy[i], status);
+                grid->num_x = num_x;
+                grid->num_y = num_y;
+            }
+        }
+        free(used);
+    }
+    free(vx);
+    return (grid->num_x > 0) ? grid : 0;
+}
+
+
+/* Evaluates the array factor of a station, using beamforming weights that
+ * have already been generated. Stations with elements on a rectangular grid
+ * use the separable form of the DFT, if the data are in CPU memory. */
+static void evaluate_array_factor(oskar_Mem* array, const oskar_Station* s,
+        const oskar_Mem* weights, double wavenumber, int num_points,
+        const oskar_Mem* x, const oskar_Mem* y, const oskar_Mem* z,
+        oskar_StationWork* work, int* status)
+{
+    const oskar_StationWorkGrid* grid = 0;
+    if (*status) return;
+    if (oskar_mem_location(array) == OSKAR_CPU)
+        grid = station_grid(s, work, status);
+    if (grid)
+    {
+        int i, num_elements;
+        const int* index;
+        num_elements = oskar_station_num_elements(s);
+        index = oskar_mem_int_const(grid->index, status);
+
+        /* Put the weights in grid order. */
+        if ((int)oskar_mem_length(work->grid_weights) < num_elements)
+            oskar_mem_realloc(work->grid_weights, num_elements, status);
+        if (*status) return;
+        if (oskar_mem_precision(weights) == OSKAR_DOUBLE)
+        {
+            const double2* w_in = oskar_mem_double2_const(weights, status);
+            double2* w_out = oskar_mem_double2(work->grid_weights, status);
+            for (i = 0; i < num_elements; ++i) w_out[index[i]] = w_in[i];
+        }
+        else
+        {
+            const float2* w_in = oskar_mem_float2_const(weights, status);
+            float2* w_out = oskar_mem_float2(work->grid_weights, status);
+            for (i = 0; i < num_elements; ++i) w_out[index[i]] = w_in[i];
+        }
+        oskar_dftw_grid(grid->num_x, grid->num_y, wavenumber,
+                grid->x, grid->y, work->grid_weights,
+                num_points, x, y, array, status);
+    }
+    else
+    {
+        oskar_dftw(oskar_station_num_elements(s), wavenumber,
+                oskar_station_element_true_x_enu_metres_const(s),
+                oskar_station_element_true_y_enu_metres_const(s),
+                oskar_station_element_true_z_enu_metres_const(s),
+                weights, num_points, x, y,
+                (oskar_station_array_is_3d(s) ? z : 0), 0, array, status);
+    }
+}
+
+
+/* Returns true if the cached tile beam can be used for the given tile. */
+static int tile_cache_valid(const oskar_StationWork* work,
+        const oskar_Station* tile, int num_points, double gast,
+        double frequency_hz, int time_index, int* status)
+{
+    const oskar_Station* cached = (const oskar_Station*) work->tile_cache_tile;
+    if (!cached || work->tile_cache_num_points != num_points ||
+            work->tile_cache_gast != gast ||
+            work->tile_cache_frequency_hz != frequency_hz ||
+            work->tile_cache_time_index != time_index)
+        return 0;
+    return (cached == tile || !oskar_station_different(cached, tile, status));
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,6 +39,7 @@ static void get_mem_from_template(oskar_Mem** b, const oskar_Mem* a,
 oskar_StationWork* oskar_station_work_create(int type,
         int location, int* status)
 {
+    int i;
     oskar_StationWork* work = 0;
 
     /* Allocate memory for the structure. */
@@ -62,9 +63,27 @@ oskar_StationWork* oskar_station_work_create(int type,
             location, 0, status);
     work->array_pattern = oskar_mem_create((type | OSKAR_COMPLEX),
             location, 0, status);
+    for (i = 0; i < OSKAR_STATION_WORK_GRID_CACHE_SIZE; ++i)
+    {
+        oskar_StationWorkGrid* g = &work->grid[i];
+        g->num_x = g->num_y = 0;
+        g->last_used = 0;
+        g->key_x = oskar_mem_create(type, OSKAR_CPU, 0, status);
+        g->key_y = oskar_mem_create(type, OSKAR_CPU, 0, status);
+        g->x = oskar_mem_create(type, OSKAR_CPU, 0, status);
+        g->y = oskar_mem_create(type, OSKAR_CPU, 0, status);
+        g->index = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    }
+    work->grid_weights = oskar_mem_create((type | OSKAR_COMPLEX),
+            OSKAR_CPU, 0, status);
     work->normalised_beam = 0;
+    work->tile_beam = 0;
     work->num_depths = 0;
     work->beam = 0;
+    work->enu_cache_enabled = 0;
+    work->tile_cache_enabled = 0;
+    work->arena = oskar_mem_arena_create(location, status);
+    oskar_station_work_clear_cache(work);
 
     return work;
 }
@@ -84,7 +103,18 @@ void oskar_station_work_free(oskar_StationWork* work, int* status)
     oskar_mem_free(work->weights, status);
     oskar_mem_free(work->weights_error, status);
     oskar_mem_free(work->array_pattern, status);
+    for (i = 0; i < OSKAR_STATION_WORK_GRID_CACHE_SIZE; ++i)
+    {
+        oskar_mem_free(work->grid[i].key_x, status);
+        oskar_mem_free(work->grid[i].key_y, status);
+        oskar_mem_free(work->grid[i].x, status);
+        oskar_mem_free(work->grid[i].y, status);
+        oskar_mem_free(work->grid[i].index, status);
+    }
+    oskar_mem_free(work->grid_weights, status);
     oskar_mem_free(work->normalised_beam, status);
+    oskar_mem_free(work->tile_beam, status);
+    oskar_mem_arena_free(work->arena, status);
 
     for (i = 0; i < work->num_depths; ++i)
     {
@@ -95,6 +125,37 @@ void oskar_station_work_free(oskar_StationWork* work, int* status)
     free(work);
 }
 
+void oskar_station_work_clear_cache(oskar_StationWork* work)
+{
+    int i;
+    work->enu_cache_station = 0;
+    work->enu_cache_num_points = 0;
+    work->enu_cache_gast = 0.0;
+    for (i = 0; i < OSKAR_STATION_WORK_GRID_CACHE_SIZE; ++i)
+        work->grid[i].valid = 0;
+    work->grid_counter = 0;
+    work->tile_cache_tile = 0;
+}
+
+void oskar_station_work_set_enu_cache_enabled(oskar_StationWork* work,
+        int value)
+{
+    work->enu_cache_enabled = value;
+    oskar_station_work_clear_cache(work);
+}
+
+void oskar_station_work_set_tile_cache_enabled(oskar_StationWork* work,
+        int value)
+{
+    work->tile_cache_enabled = value;
+    work->tile_cache_tile = 0;
+}
+
+oskar_MemArena* oskar_station_work_arena(oskar_StationWork* work)
+{
+    return work->arena;
+}
+
 oskar_Mem* oskar_station_work_horizon_mask(oskar_StationWork* work)
 {
     return work->horizon_mask;
@@ -128,6 +189,13 @@ oskar_Mem* oskar_station_work_normalised_beam(oskar_StationWork* work,
     return work->normalised_beam;
 }
 
+oskar_Mem* oskar_station_work_tile_beam(oskar_StationWork* work,
+        const oskar_Mem* output_beam, size_t length, int* status)
+{
+    get_mem_from_template(&work->tile_beam, output_beam, length, status);
+    return work->tile_beam;
+}
+
 oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
         const oskar_Mem* output_beam, size_t length, int depth, int* status)
 {
@@ -168,3 +168,97 @@ TEST(evaluate_jones_E, evaluate_e)
     ASSERT_EQ(0, error) << oskar_get_error_string(error);
 }
 
+
+static oskar_Telescope* create_telescope_two_models(int num_stations,
+        int* error)
+{
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, num_stations, error);
+    int station_dim = 8;
+    int num_antennas = station_dim * station_dim;
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        oskar_station_resize(s, num_antennas, error);
+        oskar_station_resize_element_types(s, 1, error);
+        oskar_station_set_position(s, 0.0, M_PI / 2.0, 0.0);
+        oskar_element_set_element_type(oskar_station_element(s, 0),
+                "Isotropic", error);
+
+        // Alternate between two station layouts.
+        double station_size_m = (i % 2) ? 60.0 : 40.0;
+        std::vector<double> x_pos(station_dim);
+        oskar_linspace_d(&x_pos[0], -station_size_m/2.0, station_size_m/2.0,
+                station_dim);
+        oskar_meshgrid_d(
+                oskar_mem_double(
+                        oskar_station_element_true_x_enu_metres(s), error),
+                oskar_mem_double(
+                        oskar_station_element_true_y_enu_metres(s), error),
+                &x_pos[0], station_dim, &x_pos[0], station_dim);
+        oskar_mem_copy(oskar_station_element_measured_x_enu_metres(s),
+                oskar_station_element_true_x_enu_metres(s), error);
+        oskar_mem_copy(oskar_station_element_measured_y_enu_metres(s),
+                oskar_station_element_true_y_enu_metres(s), error);
+    }
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_phase_centre(tel,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.0, M_PI/2.0);
+    return tel;
+}
+
+TEST(evaluate_jones_E, station_models)
+{
+    int error = 0, num_stations = 5, num_pts = 1 + 10 * 10;
+
+    // Construct telescope model with two distinct station layouts.
+    oskar_Telescope* tel = create_telescope_two_models(num_stations, &error);
+    oskar_telescope_analyse(tel, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+    EXPECT_EQ(0, oskar_telescope_identical_stations(tel));
+    EXPECT_EQ(2, oskar_telescope_num_station_models(tel));
+    const int* index = oskar_mem_int_const(
+            oskar_telescope_station_model_index_const(tel), &error);
+    for (int i = 0; i < num_stations; ++i)
+        EXPECT_EQ(i % 2, index[i]);
+
+    // Evaluate Jones E with and without duplication of station beams.
+    oskar_Mem* l = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_pts, &error);
+    oskar_Mem* m = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_pts, &error);
+    oskar_Mem* n = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_pts, &error);
+    oskar_evaluate_image_lmn_grid(10, 10, 60.0 * D2R, 60.0 * D2R,
+            1, l, m, n, &error);
+    oskar_Jones* E1 = oskar_jones_create(OSKAR_DOUBLE_COMPLEX,
+            OSKAR_CPU, num_stations, num_pts, &error);
+    oskar_Jones* E2 = oskar_jones_create(OSKAR_DOUBLE_COMPLEX,
+            OSKAR_CPU, num_stations, num_pts, &error);
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &error);
+    oskar_telescope_set_allow_station_beam_duplication(tel, OSKAR_TRUE);
+    oskar_evaluate_jones_E(E1, num_pts - 1, OSKAR_RELATIVE_DIRECTIONS,
+            l, m, n, tel, 0.0, 100e6, work, 0, &error);
+    oskar_telescope_set_allow_station_beam_duplication(tel, OSKAR_FALSE);
+    oskar_evaluate_jones_E(E2, num_pts - 1, OSKAR_RELATIVE_DIRECTIONS,
+            l, m, n, tel, 0.0, 100e6, work, 0, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+    EXPECT_EQ(0, oskar_mem_different(oskar_jones_mem(E1),
+            oskar_jones_mem(E2), 0, &error));
+
+    // Check that the two station models have different beams.
+    oskar_Mem *E_0 = oskar_mem_create_alias(0, 0, 0, &error);
+    oskar_Mem *E_1 = oskar_mem_create_alias(0, 0, 0, &error);
+    oskar_jones_get_station_pointer(E_0, E1, 0, &error);
+    oskar_jones_get_station_pointer(E_1, E1, 1, &error);
+    EXPECT_NE(0, oskar_mem_different(E_0, E_1, 0, &error));
+    oskar_mem_free(E_0, &error);
+    oskar_mem_free(E_1, &error);
+
+    oskar_jones_free(E1, &error);
+    oskar_jones_free(E2, &error);
+    oskar_mem_free(l, &error);
+    oskar_mem_free(m, &error);
+    oskar_mem_free(n, &error);
+    oskar_telescope_free(tel, &error);
+    oskar_station_work_free(work, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
@@ -32,6 +32,7 @@
 #include "telescope/station/oskar_evaluate_station_beam_aperture_array.h"
 #include "telescope/station/oskar_evaluate_station_beam_gaussian.h"
 #include "telescope/station/oskar_evaluate_beam_horizon_direction.h"
+#include "telescope/station/private_station_work.h"
 #include "utility/oskar_get_error_string.h"
 #include "math/oskar_linspace.h"
 #include "math/oskar_meshgrid.h"
@@ -158,6 +159,258 @@ TEST(evaluate_station_beam, test_array_pattern)
 }
 
 
+static oskar_Station* create_tiled_station(double tile_spacing_m,
+        const double* offset_m, int* status)
+{
+    // Create a 3 x 3 grid of identical 2 x 2 tiles of isotropic elements.
+    oskar_Station* station = oskar_station_create(OSKAR_DOUBLE,
+            OSKAR_CPU, 9, status);
+    oskar_station_set_position(station, 0.0, M_PI / 3.0, 0.0);
+    oskar_station_set_phase_centre(station,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.1, M_PI / 3.0);
+    for (int i = 0; i < 9; ++i)
+    {
+        double xyz[] = {tile_spacing_m * (i % 3 - 1) + offset_m[i],
+                tile_spacing_m * (i / 3 - 1), 0.0};
+        oskar_station_set_element_coords(station, i, xyz, xyz, status);
+    }
+    oskar_station_create_child_stations(station, status);
+    for (int i = 0; i < 9; ++i)
+    {
+        oskar_Station* tile = oskar_station_child(station, i);
+        oskar_station_resize(tile, 4, status);
+        oskar_station_resize_element_types(tile, 1, status);
+        oskar_element_set_element_type(oskar_station_element(tile, 0),
+                "Isotropic", status);
+        oskar_station_set_position(tile, 0.0, M_PI / 3.0, 0.0);
+        oskar_station_set_phase_centre(tile,
+                OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.1, M_PI / 3.0);
+        for (int j = 0; j < 4; ++j)
+        {
+            double xyz[] = {1.25 * (j % 2) - 0.625, 1.25 * (j / 2) - 0.625, 0.};
+            oskar_station_set_element_coords(tile, j, xyz, xyz, status);
+        }
+    }
+    return station;
+}
+
+
+static double max_abs_diff(const oskar_Mem* a, const oskar_Mem* b,
+        int num_points, int* status)
+{
+    double max_diff = 0.0;
+    const double* a_ = oskar_mem_double_const(a, status);
+    const double* b_ = oskar_mem_double_const(b, status);
+    for (int i = 0; i < 2 * num_points; ++i)
+    {
+        double diff = fabs(a_[i] - b_[i]);
+        if (diff > max_diff) max_diff = diff;
+    }
+    return max_diff;
+}
+
+
+TEST(evaluate_station_beam, identical_tiles)
+{
+    int status = 0, identical_check = 0;
+    int num_points = 2000;
+    double frequency = 150e6, gast = 0.3;
+    double zero_offsets[9] = {0., 0., 0., 0., 0., 0., 0., 0., 0.};
+    double offsets[9] = {0.3, -0.2, 0., 0.1, 0., -0.4, 0.2, 0., 0.};
+
+    // Generate directions over the sky above the station.
+    oskar_Mem *x, *y, *z;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    oskar_mem_random_range(x, -0.6, 0.6, &status);
+    oskar_mem_random_range(y, -0.6, 0.6, &status);
+    double* x_ = oskar_mem_double(x, &status);
+    double* y_ = oskar_mem_double(y, &status);
+    double* z_ = oskar_mem_double(z, &status);
+    for (int i = 0; i < num_points; ++i)
+        z_[i] = sqrt(1.0 - x_[i] * x_[i] - y_[i] * y_[i]);
+
+    // Evaluate the beam of a tiled station with identical tiles on a grid,
+    // and again with the tiles treated as different.
+    oskar_Mem *beam_identical, *beam_different, *beam_cached;
+    beam_identical = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_points, &status);
+    beam_different = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_points, &status);
+    beam_cached = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_points, &status);
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_Station* station = create_tiled_station(5.0, zero_offsets, &status);
+    oskar_station_analyse(station, &identical_check, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(1, oskar_station_identical_children(station));
+    oskar_evaluate_station_beam_aperture_array(beam_identical, station,
+            num_points, x, y, z, gast, frequency, work, 0, &status);
+    identical_check = 1;
+    oskar_station_analyse(station, &identical_check, &status);
+    ASSERT_EQ(0, oskar_station_identical_children(station));
+    oskar_evaluate_station_beam_aperture_array(beam_different, station,
+            num_points, x, y, z, gast, frequency, work, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(max_abs_diff(beam_identical, beam_different, num_points,
+            &status), 1e-9);
+
+    // Check that a tile beam shared with another station, with the same tiles
+    // but a different (non-grid) layout, gives the same result.
+    oskar_Station* station2 = create_tiled_station(5.0, offsets, &status);
+    identical_check = 0;
+    oskar_station_analyse(station, &identical_check, &status);
+    oskar_station_analyse(station2, &identical_check, &status);
+    oskar_evaluate_station_beam_aperture_array(beam_different, station2,
+            num_points, x, y, z, gast, frequency, work, 0, &status);
+    oskar_station_work_set_tile_cache_enabled(work, 1);
+    oskar_evaluate_station_beam_aperture_array(beam_cached, station,
+            num_points, x, y, z, gast, frequency, work, 0, &status);
+    oskar_evaluate_station_beam_aperture_array(beam_cached, station2,
+            num_points, x, y, z, gast, frequency, work, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(max_abs_diff(beam_cached, beam_different, num_points,
+            &status), 1e-12);
+
+    oskar_station_free(station, &status);
+    oskar_station_free(station2, &status);
+    oskar_station_work_free(work, &status);
+    oskar_mem_free(beam_identical, &status);
+    oskar_mem_free(beam_different, &status);
+    oskar_mem_free(beam_cached, &status);
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(evaluate_station_beam, grid_cache_levels)
+{
+    int status = 0, identical_check = 0;
+    int num_points = 100;
+    double zero_offsets[9] = {0., 0., 0., 0., 0., 0., 0., 0., 0.};
+
+    // Generate directions over the sky above the station.
+    oskar_Mem *x, *y, *z, *beam;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    beam = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_points, &status);
+    oskar_mem_random_range(x, -0.6, 0.6, &status);
+    oskar_mem_random_range(y, -0.6, 0.6, &status);
+    double* x_ = oskar_mem_double(x, &status);
+    double* y_ = oskar_mem_double(y, &status);
+    double* z_ = oskar_mem_double(z, &status);
+    for (int i = 0; i < num_points; ++i)
+        z_[i] = sqrt(1.0 - x_[i] * x_[i] - y_[i] * y_[i]);
+
+    // Evaluate the beam of a station and its tiles, which are both grids,
+    // several times. Each level must keep its own cache entry.
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_Station* station = create_tiled_station(5.0, zero_offsets, &status);
+    oskar_station_analyse(station, &identical_check, &status);
+    for (int k = 0; k < 3; ++k)
+    {
+        oskar_evaluate_station_beam_aperture_array(beam, station,
+                num_points, x, y, z, 0.3, 150e6, work, 0, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        int num_valid = 0, num_grids = 0;
+        for (int i = 0; i < OSKAR_STATION_WORK_GRID_CACHE_SIZE; ++i)
+        {
+            if (!work->grid[i].valid) continue;
+            num_valid++;
+            if (work->grid[i].num_x > 0) num_grids++;
+        }
+        EXPECT_EQ(2, num_valid);
+        EXPECT_EQ(2, num_grids);
+    }
+
+    oskar_station_free(station, &status);
+    oskar_station_work_free(work, &status);
+    oskar_mem_free(beam, &status);
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(evaluate_station_beam, grid_layout_changed)
+{
+    int status = 0, identical_check = 0;
+    int num_points = 2000;
+    double frequency = 150e6, gast = 0.3;
+
+    // Generate directions over the sky above the station.
+    oskar_Mem *x, *y, *z;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    oskar_mem_random_range(x, -0.6, 0.6, &status);
+    oskar_mem_random_range(y, -0.6, 0.6, &status);
+    double* x_ = oskar_mem_double(x, &status);
+    double* y_ = oskar_mem_double(y, &status);
+    double* z_ = oskar_mem_double(z, &status);
+    for (int i = 0; i < num_points; ++i)
+        z_[i] = sqrt(1.0 - x_[i] * x_[i] - y_[i] * y_[i]);
+
+    // Create a 4 x 4 grid of isotropic elements.
+    oskar_Station* station = oskar_station_create(OSKAR_DOUBLE,
+            OSKAR_CPU, 0, &status);
+    oskar_station_resize(station, 16, &status);
+    oskar_station_resize_element_types(station, 1, &status);
+    oskar_element_set_element_type(oskar_station_element(station, 0),
+            "Isotropic", &status);
+    oskar_station_set_position(station, 0.0, M_PI / 3.0, 0.0);
+    oskar_station_set_phase_centre(station,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.1, M_PI / 3.0);
+    for (int i = 0; i < 16; ++i)
+    {
+        double xyz[] = {1.5 * (i % 4) - 2.25, 1.5 * (i / 4) - 2.25, 0.0};
+        oskar_station_set_element_coords(station, i, xyz, xyz, &status);
+    }
+    oskar_station_analyse(station, &identical_check, &status);
+
+    // Evaluate the beam, then move one element off the grid and evaluate
+    // it again with the same work buffers, and with new ones.
+    oskar_Mem *beam_grid, *beam_moved, *beam_ref;
+    beam_grid = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_points, &status);
+    beam_moved = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_points, &status);
+    beam_ref = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_points, &status);
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_StationWork* work_ref = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_evaluate_station_beam_aperture_array(beam_grid, station,
+            num_points, x, y, z, gast, frequency, work, 0, &status);
+    double xyz[] = {1.2, 0.4, 0.0};
+    oskar_station_set_element_coords(station, 5, xyz, xyz, &status);
+    oskar_evaluate_station_beam_aperture_array(beam_moved, station,
+            num_points, x, y, z, gast, frequency, work, 0, &status);
+    oskar_evaluate_station_beam_aperture_array(beam_ref, station,
+            num_points, x, y, z, gast, frequency, work_ref, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_GT(max_abs_diff(beam_grid, beam_ref, num_points, &status), 1e-3);
+    EXPECT_LT(max_abs_diff(beam_moved, beam_ref, num_points, &status), 1e-12);
+
+    oskar_station_free(station, &status);
+    oskar_station_work_free(work, &status);
+    oskar_station_work_free(work_ref, &status);
+    oskar_mem_free(beam_grid, &status);
+    oskar_mem_free(beam_moved, &status);
+    oskar_mem_free(beam_ref, &status);
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
 TEST(evaluate_station_beam, gaussian)
 {
     int error = 0;
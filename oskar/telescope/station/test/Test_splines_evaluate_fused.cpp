@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <gtest/gtest.h>
+
+#include "mem/oskar_mem.h"
+#include "mem/oskar_mem_convert_precision.h"
+#include "splines/oskar_splines.h"
+#include "splines/private_splines.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdlib>
+#include <vector>
+
+using std::vector;
+
+// Smooth test surfaces, like the theta and phi components of an element
+// pattern (real and imaginary parts).
+static double surface(int k, double theta, double phi)
+{
+    switch (k)
+    {
+    case 0:  return cos(theta) * cos(phi);
+    case 1:  return sin(theta) * sin(2.0 * phi);
+    case 2:  return cos(theta) * cos(theta) * sin(phi);
+    default: return 0.5 * theta * cos(3.0 * phi) + 0.2;
+    }
+}
+
+static oskar_Splines* fit_surface(int k, int precision, int* status)
+{
+    const int num_theta = 19, num_phi = 37;
+    vector<double> theta, phi, data, weight;
+    for (int j = 0; j < num_phi; ++j)
+    {
+        for (int i = 0; i < num_theta; ++i)
+        {
+            double t = i * (M_PI / 2.0) / (num_theta - 1);
+            double p = j * (2.0 * M_PI) / (num_phi - 1);
+            theta.push_back(t);
+            phi.push_back(p);
+            data.push_back(surface(k, t, p));
+            weight.push_back(1.0);
+        }
+    }
+    double avg_frac_error = 0.02;
+    oskar_Splines* s = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, status);
+    oskar_splines_fit(s, (int) data.size(), &theta[0], &phi[0], &data[0],
+            &weight[0], OSKAR_SPLINES_SPHERICAL, 1, &avg_frac_error,
+            1.5, 1.0, 1e-14, status);
+    if (precision == OSKAR_DOUBLE || *status) return s;
+
+    // Fitting is only done in double precision, so convert the result.
+    oskar_Splines* t = oskar_splines_create(precision, OSKAR_CPU, status);
+    t->num_knots_x_theta = s->num_knots_x_theta;
+    t->num_knots_y_phi = s->num_knots_y_phi;
+    t->smoothing_factor = s->smoothing_factor;
+    oskar_mem_free(t->knots_x_theta, status);
+    oskar_mem_free(t->knots_y_phi, status);
+    oskar_mem_free(t->coeff, status);
+    t->knots_x_theta = oskar_mem_convert_precision(s->knots_x_theta,
+            precision, status);
+    t->knots_y_phi = oskar_mem_convert_precision(s->knots_y_phi,
+            precision, status);
+    t->coeff = oskar_mem_convert_precision(s->coeff, precision, status);
+    oskar_splines_free(s, status);
+    return t;
+}
+
+static void compare_fused(int precision, double tol)
+{
+    int status = 0;
+    const int num_surfaces = 4, num_splines = 6, num_points = 1000;
+    const int offset = 1, stride = 8;
+
+    // Fit the four surfaces. Add a spline with the same knots as the
+    // first, but different coefficients, and an empty spline.
+    oskar_Splines* splines[num_splines];
+    for (int k = 0; k < num_surfaces; ++k)
+        splines[k] = fit_surface(k, precision, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    splines[4] = oskar_splines_create(precision, OSKAR_CPU, &status);
+    oskar_splines_copy(splines[4], splines[0], &status);
+    oskar_mem_scale_real(oskar_splines_coeff(splines[4]), -2.0, &status);
+    splines[5] = oskar_splines_create(precision, OSKAR_CPU, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Generate evaluation points, including some outside the fitted range.
+    oskar_Mem* x = oskar_mem_create(precision, OSKAR_CPU, num_points, &status);
+    oskar_Mem* y = oskar_mem_create(precision, OSKAR_CPU, num_points, &status);
+    srand(1);
+    for (int i = 0; i < num_points; ++i)
+    {
+        double t = (M_PI / 2.0 + 0.2) * rand() / (double)RAND_MAX - 0.1;
+        double p = (2.0 * M_PI) * rand() / (double)RAND_MAX;
+        if (precision == OSKAR_DOUBLE)
+        {
+            oskar_mem_double(x, &status)[i] = t;
+            oskar_mem_double(y, &status)[i] = p;
+        }
+        else
+        {
+            oskar_mem_float(x, &status)[i] = (float) t;
+            oskar_mem_float(y, &status)[i] = (float) p;
+        }
+    }
+
+    // Evaluate the splines separately and fused, into interleaved arrays.
+    const size_t len = (size_t) num_points * stride;
+    oskar_Mem* separate = oskar_mem_create(precision, OSKAR_CPU, len, &status);
+    oskar_Mem* fused = oskar_mem_create(precision, OSKAR_CPU, len, &status);
+    oskar_mem_set_value_real(separate, 99.0, 0, len, &status);
+    oskar_mem_set_value_real(fused, 99.0, 0, len, &status);
+    for (int k = 0; k < num_splines; ++k)
+        oskar_splines_evaluate(separate, offset + k, stride, splines[k],
+                num_points, x, y, &status);
+    oskar_splines_evaluate_fused(fused, offset, stride, num_splines,
+            splines, num_points, x, y, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the results match, and other elements were not written.
+    for (size_t i = 0; i < len; ++i)
+    {
+        double a, b;
+        if (precision == OSKAR_DOUBLE)
+        {
+            a = oskar_mem_double(separate, &status)[i];
+            b = oskar_mem_double(fused, &status)[i];
+        }
+        else
+        {
+            a = oskar_mem_float(separate, &status)[i];
+            b = oskar_mem_float(fused, &status)[i];
+        }
+        const int k = (int)(i % stride) - offset;
+        if (k < 0 || k >= num_splines)
+            ASSERT_EQ(99.0, b);
+        else if (k == num_splines - 1)
+            ASSERT_EQ(0.0, b);
+        else
+            ASSERT_NEAR(a, b, tol) << "spline " << k << ", point " <<
+                    i / stride;
+    }
+
+    // Check the fitted surfaces are not trivial.
+    for (int k = 0; k < num_surfaces; ++k)
+    {
+        double max_abs = 0.0;
+        for (int i = 0; i < num_points; ++i)
+        {
+            const size_t j = (size_t) i * stride + offset + k;
+            double v = (precision == OSKAR_DOUBLE) ?
+                    oskar_mem_double(fused, &status)[j] :
+                    oskar_mem_float(fused, &status)[j];
+            if (fabs(v) > max_abs) max_abs = fabs(v);
+        }
+        EXPECT_GT(max_abs, 0.3) << "spline " << k;
+    }
+
+    for (int k = 0; k < num_splines; ++k)
+        oskar_splines_free(splines[k], &status);
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(separate, &status);
+    oskar_mem_free(fused, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(splines_evaluate_fused, double_precision)
+{
+    compare_fused(OSKAR_DOUBLE, 1e-12);
+}
+
+TEST(splines_evaluate_fused, single_precision)
+{
+    compare_fused(OSKAR_SINGLE, 1e-5);
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_DOUBLE_TO_STRING_H_
+#define OSKAR_DOUBLE_TO_STRING_H_
+
+/**
+ * @file oskar_double_to_string.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Writes a number to a string in exponential notation.
+ *
+ * @details
+ * This function writes a value to a string in the same way as
+ * sprintf() with the format "% .*e", but always using '.' as the
+ * decimal point, regardless of the current locale.
+ *
+ * Values that need up to 15 significant digits and have small exponents
+ * (which covers almost all values in beam patterns and other data files)
+ * are converted directly, using integer digit generation and an exact
+ * product to decide the rounding. Anything else, including values that
+ * lie too close to a rounding boundary, "inf" and "nan", is passed to
+ * sprintf(), so the output is always identical.
+ *
+ * The string is NULL-terminated, and the buffer must be large enough to
+ * hold at least \p precision + 32 characters.
+ *
+ * @param[out] buffer    Buffer to write into.
+ * @param[in]  value     Value to convert.
+ * @param[in]  precision Number of digits after the decimal point.
+ *
+ * @return The number of characters written, excluding the NULL terminator.
+ */
+OSKAR_EXPORT
+int oskar_double_to_string(char* buffer, double value, int precision);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_DOUBLE_TO_STRING_H_ */
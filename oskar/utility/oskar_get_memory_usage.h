@@ -73,6 +73,12 @@ size_t oskar_get_free_swap_memory(void);
 OSKAR_EXPORT
 size_t oskar_get_memory_usage(void);
 
+/**
+ * @brief Returns the peak memory used by the current process, in bytes.
+ */
+OSKAR_EXPORT
+size_t oskar_get_peak_memory_usage(void);
+
 /**
  * @brief Prints a summary of the current memory usage.
  */
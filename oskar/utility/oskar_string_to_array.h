@@ -66,14 +66,14 @@ size_t oskar_string_to_array_i(char* str, size_t n, int* data);
  *
  * @details
  * This function splits a string into a sequence of numbers. Splitting is
- * performed either using whitespace or a comma.
- *
- * <b>Note that the input string is corrupted on exit.</b>
+ * performed either using whitespace or a comma. Numbers are converted
+ * using oskar_string_to_double(), so '.' is always the decimal point.
+ * The input string is not modified.
  *
  * Any data after a hash '#' symbol on the line is treated as a comment and
  * ignored.
  *
- * @param[in,out] str The input string to split.
+ * @param[in] str The input string to split.
  * @param[in] n The maximum number of values to return (size of array \p data).
  * @param[out] data The array of values returned.
  *
@@ -87,14 +87,14 @@ size_t oskar_string_to_array_f(char* str, size_t n, float* data);
  *
  * @details
  * This function splits a string into a sequence of numbers. Splitting is
- * performed either using whitespace or a comma.
- *
- * <b>Note that the input string is corrupted on exit.</b>
+ * performed either using whitespace or a comma. Numbers are converted
+ * using oskar_string_to_double(), so '.' is always the decimal point.
+ * The input string is not modified.
  *
  * Any data after a hash '#' symbol on the line is treated as a comment and
  * ignored.
  *
- * @param[in,out] str The input string to split.
+ * @param[in] str The input string to split.
  * @param[in] n The maximum number of values to return (size of array \p data).
  * @param[out] data The array of values returned.
  *
@@ -103,6 +103,26 @@ size_t oskar_string_to_array_f(char* str, size_t n, float* data);
 OSKAR_EXPORT
 size_t oskar_string_to_array_d(char* str, size_t n, double* data);
 
+/**
+ * @brief Splits part of a string into numeric fields (double precision).
+ *
+ * @details
+ * This function is the same as oskar_string_to_array_d(), except that the
+ * text to split is given by a pair of pointers, and it does not need to be
+ * NULL-terminated. This allows lines to be read directly from a
+ * memory-mapped file.
+ *
+ * @param[in] begin Pointer to the start of the text to split.
+ * @param[in] end Pointer to one past the end of the text to split.
+ * @param[in] n The maximum number of values to return (size of array \p data).
+ * @param[out] data The array of values returned.
+ *
+ * @return The number of values matched (or number of array elements filled).
+ */
+OSKAR_EXPORT
+size_t oskar_string_to_array_range_d(const char* begin, const char* end,
+        size_t n, double* data);
+
 /**
  * @brief Splits a string into sub-strings.
  *
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_STRING_TO_DOUBLE_H_
+#define OSKAR_STRING_TO_DOUBLE_H_
+
+/**
+ * @file oskar_string_to_double.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Converts the number at the start of a string to double precision.
+ *
+ * @details
+ * This function converts the decimal number at the start of a string,
+ * in the same way as strtod(), but always using '.' as the decimal point,
+ * regardless of the current locale. Leading whitespace is not skipped.
+ *
+ * Numbers with up to 15 significant digits and small exponents
+ * (which covers almost all values in sky model and layout files)
+ * are converted directly, and exactly. Anything else, including
+ * "inf" and "nan", is passed to strtod().
+ *
+ * The string does not need to be NULL-terminated if \p str_end is given,
+ * so this can be used on memory-mapped files.
+ *
+ * @param[in]  str      Pointer to the start of the string.
+ * @param[in]  str_end  Pointer to one past the end of the string, or NULL
+ *                      if the string is NULL-terminated.
+ * @param[out] end_ptr  If not NULL, set to one past the last character
+ *                      converted, or to \p str if no conversion was done.
+ *
+ * @return The converted value, or 0 if no conversion was done.
+ */
+OSKAR_EXPORT
+double oskar_string_to_double(const char* str, const char* str_end,
+        const char** end_ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_STRING_TO_DOUBLE_H_ */
@@ -42,9 +42,11 @@ extern "C" {
 struct oskar_Mutex;
 struct oskar_Thread;
 struct oskar_Barrier;
+struct oskar_Queue;
 typedef struct oskar_Mutex oskar_Mutex;
 typedef struct oskar_Thread oskar_Thread;
 typedef struct oskar_Barrier oskar_Barrier;
+typedef struct oskar_Queue oskar_Queue;
 
 /**
  * @brief Creates a mutex.
@@ -163,6 +165,71 @@ void oskar_barrier_set_num_threads(oskar_Barrier* barrier, int num_threads);
 OSKAR_EXPORT
 int oskar_barrier_wait(oskar_Barrier* barrier);
 
+/**
+ * @brief Creates a bounded first-in, first-out queue of pointers.
+ *
+ * @details
+ * Creates a thread-safe queue which can hold up to \p capacity pointers.
+ * It can be used to pass items between producer and consumer threads.
+ *
+ * @param[in] capacity Maximum number of items in the queue.
+ */
+OSKAR_EXPORT
+oskar_Queue* oskar_queue_create(int capacity);
+
+/**
+ * @brief Destroys the queue.
+ *
+ * @details
+ * Destroys the queue. Items remaining in the queue are not freed.
+ *
+ * @param[in,out] queue Pointer to queue.
+ */
+OSKAR_EXPORT
+void oskar_queue_free(oskar_Queue* queue);
+
+/**
+ * @brief Closes the queue.
+ *
+ * @details
+ * Closes the queue, and wakes all threads waiting on it.
+ * Subsequent calls to oskar_queue_push() fail, and calls to
+ * oskar_queue_pop() return NULL once the queue is empty.
+ *
+ * @param[in,out] queue Pointer to queue.
+ */
+OSKAR_EXPORT
+void oskar_queue_close(oskar_Queue* queue);
+
+/**
+ * @brief Adds an item to the back of the queue.
+ *
+ * @details
+ * Adds an item to the back of the queue, blocking the caller while the
+ * queue is full.
+ *
+ * @param[in,out] queue Pointer to queue.
+ * @param[in] item      Item to add.
+ *
+ * @return 1 if the item was added, or 0 if the queue has been closed.
+ */
+OSKAR_EXPORT
+int oskar_queue_push(oskar_Queue* queue, void* item);
+
+/**
+ * @brief Removes an item from the front of the queue.
+ *
+ * @details
+ * Removes an item from the front of the queue, blocking the caller while
+ * the queue is empty.
+ *
+ * @param[in,out] queue Pointer to queue.
+ *
+ * @return The item, or NULL if the queue is empty and has been closed.
+ */
+OSKAR_EXPORT
+void* oskar_queue_pop(oskar_Queue* queue);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "utility/oskar_double_to_string.h"
+
+#include <locale.h>
+#include <math.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Powers of ten that are exactly representable in double precision. */
+static const double pow10_exact[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#define MAX_EXACT_POW10 22
+#define MAX_PRECISION 14
+
+/* Fraction of one unit in the last digit that is treated as a tie. */
+#define TIE_MARGIN 1e-6
+
+static int convert_slow(char* buffer, double value, int precision)
+{
+    const char* point;
+    int i, len;
+    len = sprintf(buffer, "% .*e", precision, value);
+
+    /* Always use '.' as the decimal point. */
+    point = localeconv()->decimal_point;
+    if (point && point[0] != '.' && point[0] != '\0' && point[1] == '\0')
+    {
+        for (i = 0; i < len; ++i)
+            if (buffer[i] == point[0]) buffer[i] = '.';
+    }
+    return len;
+}
+
+/* Exact product a * b = p + e (Dekker), without needing fma(). */
+static void two_product(double a, double b, double* p, double* e)
+{
+    const double split = 134217729.0; /* 2^27 + 1 */
+    double t, a_hi, a_lo, b_hi, b_lo;
+    *p = a * b;
+    t = split * a;
+    a_hi = t - (t - a);
+    a_lo = a - a_hi;
+    t = split * b;
+    b_hi = t - (t - b);
+    b_lo = b - b_hi;
+    *e = ((a_hi * b_hi - *p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+}
+
+int oskar_double_to_string(char* buffer, double value, int precision)
+{
+    unsigned long long digits;
+    double abs_value, scaled, remainder, frac;
+    int i, exponent, attempt, negative;
+    char* p = buffer;
+
+    /* Infinity, NaN and large precisions are handled by sprintf(). */
+    if (precision < 0 || precision > MAX_PRECISION ||
+            value != value || value - value != 0.0)
+        return convert_slow(buffer, value, precision);
+    negative = (value < 0.0 || (value == 0.0 && 1.0 / value < 0.0));
+    abs_value = fabs(value);
+
+    /* Zero. */
+    if (abs_value == 0.0)
+    {
+        *p++ = negative ? '-' : ' ';
+        *p++ = '0';
+        if (precision > 0) *p++ = '.';
+        for (i = 0; i < precision; ++i) *p++ = '0';
+        *p++ = 'e'; *p++ = '+'; *p++ = '0'; *p++ = '0';
+        *p = '\0';
+        return (int)(p - buffer);
+    }
+
+    /* Scale the value so that its integer part has (precision + 1) digits,
+     * keeping the exact remainder so the rounding is decided correctly.
+     * The estimate of the decimal exponent may be off by one. */
+    exponent = (int) floor(log10(abs_value));
+    digits = 0ull;
+    frac = 0.0;
+    for (attempt = 0; attempt < 2; ++attempt)
+    {
+        const int k = precision - exponent;
+        if (k > MAX_EXACT_POW10 || k < -MAX_EXACT_POW10)
+            return convert_slow(buffer, value, precision);
+        if (k >= 0)
+            two_product(abs_value, pow10_exact[k], &scaled, &remainder);
+        else
+        {
+            double prod, prod_err;
+            scaled = abs_value / pow10_exact[-k];
+            two_product(scaled, pow10_exact[-k], &prod, &prod_err);
+            remainder = ((abs_value - prod) - prod_err) / pow10_exact[-k];
+        }
+        frac = floor(scaled);
+        digits = (unsigned long long) frac;
+        frac = (scaled - frac) + remainder;
+        if (frac < 0.0)
+        {
+            digits--;
+            frac += 1.0;
+        }
+        else if (frac >= 1.0)
+        {
+            digits++;
+            frac -= 1.0;
+        }
+        if (digits < (unsigned long long) pow10_exact[precision])
+            exponent--;
+        else if (digits >= (unsigned long long) pow10_exact[precision + 1])
+            exponent++;
+        else break;
+    }
+    if (attempt == 2 || fabs(frac - 0.5) < TIE_MARGIN)
+        return convert_slow(buffer, value, precision);
+
+    /* Round to nearest. */
+    if (frac > 0.5)
+    {
+        digits++;
+        if (digits == (unsigned long long) pow10_exact[precision + 1])
+        {
+            digits /= 10ull;
+            exponent++;
+        }
+    }
+
+    /* Write the sign, the digits and the exponent. */
+    *p++ = negative ? '-' : ' ';
+    for (i = precision; i > 0; --i)
+    {
+        p[i + 1] = (char)('0' + (int)(digits % 10ull));
+        digits /= 10ull;
+    }
+    p[0] = (char)('0' + (int)digits);
+    if (precision > 0)
+    {
+        p[1] = '.';
+        p += precision + 2;
+    }
+    else p++;
+    *p++ = 'e';
+    *p++ = exponent < 0 ? '-' : '+';
+    if (exponent < 0) exponent = -exponent;
+    if (exponent >= 100) *p++ = (char)('0' + exponent / 100);
+    *p++ = (char)('0' + (exponent / 10) % 10);
+    *p++ = (char)('0' + exponent % 10);
+    *p = '\0';
+    return (int)(p - buffer);
+}
+
+#ifdef __cplusplus
+}
+#endif
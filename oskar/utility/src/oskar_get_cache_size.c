@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "utility/oskar_get_cache_size.h"
+
+#if defined(OSKAR_OS_LINUX)
+    #include <stdio.h>
+    #include <unistd.h>
+#elif defined(OSKAR_OS_MAC)
+    #include <sys/types.h>
+    #include <sys/sysctl.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t oskar_get_cache_size(int level)
+{
+    size_t size = 0;
+#if defined(OSKAR_OS_LINUX)
+    int i;
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+    long val = -1;
+    if (level == 1) val = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    else if (level == 2) val = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    else if (level == 3) val = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (val > 0) return (size_t) val;
+#endif
+    /* Fall back to reading the cache description from sysfs. */
+    for (i = 0; i < 8; ++i)
+    {
+        char path[128], type[32];
+        int cache_level = 0;
+        unsigned long kib = 0;
+        FILE* f;
+        sprintf(path, "/sys/devices/system/cpu/cpu0/cache/index%d/level", i);
+        f = fopen(path, "r");
+        if (!f) break;
+        if (fscanf(f, "%d", &cache_level) != 1) cache_level = 0;
+        fclose(f);
+        if (cache_level != level) continue;
+        sprintf(path, "/sys/devices/system/cpu/cpu0/cache/index%d/type", i);
+        f = fopen(path, "r");
+        if (!f) continue;
+        if (fscanf(f, "%31s", type) != 1) type[0] = 0;
+        fclose(f);
+        if (type[0] == 'I') continue; /* Skip instruction caches. */
+        sprintf(path, "/sys/devices/system/cpu/cpu0/cache/index%d/size", i);
+        f = fopen(path, "r");
+        if (!f) continue;
+        if (fscanf(f, "%luK", &kib) == 1) size = (size_t) kib * 1024;
+        fclose(f);
+        break;
+    }
+#elif defined(OSKAR_OS_MAC)
+    const char* name = (level == 1) ? "hw.l1dcachesize" :
+            (level == 2) ? "hw.l2cachesize" :
+            (level == 3) ? "hw.l3cachesize" : 0;
+    if (name)
+    {
+        int64_t val = 0;
+        size_t len = sizeof(val);
+        if (sysctlbyname(name, &val, &len, NULL, 0) == 0 && val > 0)
+            size = (size_t) val;
+    }
+#else
+    (void) level;
+#endif
+    return size;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -51,6 +51,7 @@
 #   include <mach/mach_init.h>
 #   include <mach/mach_host.h>
 #   include <sys/sysctl.h>
+#   include <sys/resource.h>
 #elif defined(OSKAR_OS_WIN)
 #   include <windows.h>
 #   include <psapi.h>
@@ -195,11 +196,12 @@ size_t oskar_get_memory_usage(void)
 {
 #ifdef OSKAR_OS_LINUX
     FILE* file = fopen("/proc/self/status", "r");
-    int result = -1;
+    size_t result = 0;
     char line[128];
+    if (!file) return 0L;
     while (fgets(line, 128, file) != NULL) {
         if (strncmp(line, "VmRSS:", 6) == 0) {
-            result = parse_line(line);
+            result = (size_t)parse_line(line) * 1024; /* Value is in kB. */
             break;
         }
     }
@@ -223,6 +225,35 @@ size_t oskar_get_memory_usage(void)
 #endif
 }
 
+size_t oskar_get_peak_memory_usage(void)
+{
+#ifdef OSKAR_OS_LINUX
+    FILE* file = fopen("/proc/self/status", "r");
+    size_t result = 0;
+    char line[128];
+    if (!file) return 0L;
+    while (fgets(line, 128, file) != NULL) {
+        if (strncmp(line, "VmHWM:", 6) == 0) {
+            result = (size_t)parse_line(line) * 1024; /* Value is in kB. */
+            break;
+        }
+    }
+    fclose(file);
+    return result;
+#elif defined(OSKAR_OS_MAC)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0L;
+    return (size_t)usage.ru_maxrss; /* In bytes on macOS. */
+#elif defined(OSKAR_OS_WIN)
+    PROCESS_MEMORY_COUNTERS pmc;
+    GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+    return (size_t)pmc.PeakWorkingSetSize;
+#else
+    return 0L;
+#endif
+}
+
 void oskar_print_memory_info(void)
 {
     size_t totalSwapMem, freeSwapMem, totalPhysMem, freePhysMem, usedMem;
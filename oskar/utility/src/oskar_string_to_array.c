@@ -27,6 +27,7 @@
  */
 
 #include "utility/oskar_string_to_array.h"
+#include "utility/oskar_string_to_double.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -61,37 +62,54 @@ size_t oskar_string_to_array_i(char* str, size_t n, int* data)
     return i;
 }
 
+#define IS_DELIMITER(c) ((c) == ',' || (c) == ' ' || (c) == '\t')
+
 /* Single precision. */
 size_t oskar_string_to_array_f(char* str, size_t n, float* data)
 {
     size_t i = 0;
-    char *save_ptr = 0, *token = 0;
-    do
+    const char *p = str, *end = str + strlen(str);
+    while (i < n)
     {
-        token = strtok_r(str, DELIMITERS, &save_ptr);
-        str = NULL;
-        if (!token) break;
-        if (token[0] == '#') break;
-        if (sscanf(token, "%f", &data[i]) > 0) i++;
+        const char* token_end = 0;
+        double value;
+        while (p < end && IS_DELIMITER(*p)) ++p;
+        if (p >= end || *p == '#') break;
+        value = oskar_string_to_double(p, end, &token_end);
+        if (token_end != p) data[i++] = (float) value;
+        for (p = token_end; p < end && !IS_DELIMITER(*p); ++p);
     }
-    while (i < n);
     return i;
 }
 
 /* Double precision. */
 size_t oskar_string_to_array_d(char* str, size_t n, double* data)
+{
+    return oskar_string_to_array_range_d(str, str + strlen(str), n, data);
+}
+
+/* Double precision, from part of a string. */
+size_t oskar_string_to_array_range_d(const char* begin, const char* end,
+        size_t n, double* data)
 {
     size_t i = 0;
-    char *save_ptr = 0, *token = 0;
-    do
+    const char* p = begin;
+    while (i < n)
     {
-        token = strtok_r(str, DELIMITERS, &save_ptr);
-        str = NULL;
-        if (!token) break;
-        if (token[0] == '#') break;
-        if (sscanf(token, "%lf", &data[i]) > 0) i++;
+        const char* token_end = 0;
+        double value;
+
+        /* Find the start of the next token, and stop at a comment. */
+        while (p < end && IS_DELIMITER(*p)) ++p;
+        if (p >= end || *p == '#') break;
+
+        /* Convert the number at the start of the token, if there is one. */
+        value = oskar_string_to_double(p, end, &token_end);
+        if (token_end != p) data[i++] = value;
+
+        /* Skip anything else in the token. */
+        for (p = token_end; p < end && !IS_DELIMITER(*p); ++p);
     }
-    while (i < n);
     return i;
 }
 
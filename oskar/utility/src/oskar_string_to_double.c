@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "utility/oskar_string_to_double.h"
+
+#include <locale.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Powers of ten that are exactly representable in double precision. */
+static const double pow10_exact[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#define MAX_EXACT_POW10 22
+#define MAX_EXACT_MANTISSA (1ull << 53)
+#define MAX_MANTISSA_DIGITS 19
+
+static double convert_slow(const char* str, const char* str_end,
+        const char** end_ptr)
+{
+    char buffer[128], *end = 0;
+    const char* point;
+    size_t i, len = 0;
+    double value;
+
+    /* Copy the candidate number into a NULL-terminated buffer. */
+    while (len < sizeof(buffer) - 1 && str + len < str_end)
+    {
+        const char c = str[len];
+        if (c == '\0' || c == ' ' || c == '\t' || c == '\n' || c == '\r' ||
+                c == ',' || c == '#')
+            break;
+        buffer[len++] = c;
+    }
+    buffer[len] = '\0';
+
+    /* Use the decimal point that strtod() expects in the current locale. */
+    point = localeconv()->decimal_point;
+    if (point && point[0] != '.' && point[0] != '\0' && point[1] == '\0')
+    {
+        for (i = 0; i < len; ++i)
+            if (buffer[i] == '.') buffer[i] = point[0];
+    }
+    value = strtod(buffer, &end);
+    if (end_ptr) *end_ptr = str + (end - buffer);
+    return value;
+}
+
+double oskar_string_to_double(const char* str, const char* str_end,
+        const char** end_ptr)
+{
+    unsigned long long mantissa = 0ull;
+    int negative = 0, num_digits = 0, have_digits = 0, exponent = 0;
+    const char* p = str;
+    double value;
+    if (!str_end) str_end = str + strlen(str);
+
+    /* Sign. */
+    if (p < str_end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+
+    /* Integer part. Leading zeros are not significant. */
+    for (; p < str_end && *p >= '0' && *p <= '9'; ++p)
+    {
+        have_digits = 1;
+        if (mantissa == 0ull && *p == '0') continue;
+        if (++num_digits <= MAX_MANTISSA_DIGITS)
+            mantissa = 10ull * mantissa + (unsigned long long)(*p - '0');
+    }
+
+    /* Fractional part. */
+    if (p < str_end && *p == '.')
+    {
+        for (++p; p < str_end && *p >= '0' && *p <= '9'; ++p)
+        {
+            have_digits = 1;
+            --exponent;
+            if (mantissa == 0ull && *p == '0') continue;
+            if (++num_digits <= MAX_MANTISSA_DIGITS)
+                mantissa = 10ull * mantissa + (unsigned long long)(*p - '0');
+        }
+    }
+    if (!have_digits)
+    {
+        /* Infinity or NaN, or not a number at all. */
+        p = str;
+        if (p < str_end && (*p == '-' || *p == '+')) ++p;
+        if (p < str_end && (*p == 'i' || *p == 'I' || *p == 'n' || *p == 'N'))
+            return convert_slow(str, str_end, end_ptr);
+        if (end_ptr) *end_ptr = str;
+        return 0.0;
+    }
+    if (p < str_end && (*p == 'x' || *p == 'X'))
+        return convert_slow(str, str_end, end_ptr); /* Hexadecimal. */
+
+    /* Exponent (ignored unless it has at least one digit). */
+    if (p < str_end && (*p == 'e' || *p == 'E'))
+    {
+        int exp_negative = 0, exp_value = 0;
+        const char* q = p + 1;
+        if (q < str_end && (*q == '-' || *q == '+'))
+            exp_negative = (*q++ == '-');
+        if (q < str_end && *q >= '0' && *q <= '9')
+        {
+            for (; q < str_end && *q >= '0' && *q <= '9'; ++q)
+                if (exp_value < 100000) exp_value = 10 * exp_value + (*q - '0');
+            exponent += exp_negative ? -exp_value : exp_value;
+            p = q;
+        }
+    }
+
+    /* Exact conversion if the mantissa and the power of ten are both
+     * exactly representable, as a single operation is correctly rounded.
+     * Otherwise, fall back to the (slower) library function. */
+    if (mantissa == 0ull)
+        value = 0.0;
+    else if (num_digits <= MAX_MANTISSA_DIGITS &&
+            mantissa <= MAX_EXACT_MANTISSA &&
+            exponent >= -MAX_EXACT_POW10 && exponent <= MAX_EXACT_POW10)
+    {
+        value = (double) mantissa;
+        if (exponent < 0)
+            value /= pow10_exact[-exponent];
+        else
+            value *= pow10_exact[exponent];
+    }
+    else
+        return convert_slow(str, str_end, end_ptr);
+    if (end_ptr) *end_ptr = p;
+    return negative ? -value : value;
+}
+
+#ifdef __cplusplus
+}
+#endif
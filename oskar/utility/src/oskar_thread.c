@@ -302,6 +302,79 @@ int oskar_barrier_wait(oskar_Barrier* barrier)
     return 0;
 }
 
+
+/* =========================================================================
+ *  QUEUE
+ * =========================================================================*/
+
+struct oskar_Queue
+{
+    oskar_ConditionVar var;
+    void** items;
+    int capacity, count, front, closed;
+};
+
+oskar_Queue* oskar_queue_create(int capacity)
+{
+    oskar_Queue* queue;
+    queue = (oskar_Queue*) calloc(1, sizeof(oskar_Queue));
+    oskar_condition_init(&queue->var);
+    if (capacity < 1) capacity = 1;
+    queue->capacity = capacity;
+    queue->items = (void**) calloc((size_t) capacity, sizeof(void*));
+    return queue;
+}
+
+void oskar_queue_free(oskar_Queue* queue)
+{
+    if (!queue) return;
+    oskar_condition_uninit(&queue->var);
+    free(queue->items);
+    free(queue);
+}
+
+void oskar_queue_close(oskar_Queue* queue)
+{
+    oskar_condition_lock(&queue->var);
+    queue->closed = 1;
+    oskar_condition_notify_all(&queue->var);
+    oskar_condition_unlock(&queue->var);
+}
+
+int oskar_queue_push(oskar_Queue* queue, void* item)
+{
+    int added = 0;
+    oskar_condition_lock(&queue->var);
+    while (queue->count == queue->capacity && !queue->closed)
+        oskar_condition_wait(&queue->var);
+    if (!queue->closed)
+    {
+        queue->items[(queue->front + queue->count) % queue->capacity] = item;
+        queue->count++;
+        added = 1;
+        oskar_condition_notify_all(&queue->var);
+    }
+    oskar_condition_unlock(&queue->var);
+    return added;
+}
+
+void* oskar_queue_pop(oskar_Queue* queue)
+{
+    void* item = 0;
+    oskar_condition_lock(&queue->var);
+    while (queue->count == 0 && !queue->closed)
+        oskar_condition_wait(&queue->var);
+    if (queue->count > 0)
+    {
+        item = queue->items[queue->front];
+        queue->front = (queue->front + 1) % queue->capacity;
+        queue->count--;
+        oskar_condition_notify_all(&queue->var);
+    }
+    oskar_condition_unlock(&queue->var);
+    return item;
+}
+
 #ifdef __cplusplus
 }
 #endif
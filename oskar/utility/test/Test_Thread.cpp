@@ -124,3 +124,43 @@ TEST(thread, barriers)
     free(args);
     free(threads);
 }
+
+struct QueueArgs
+{
+    oskar_Queue* queue;
+    int num_items;
+};
+typedef struct QueueArgs QueueArgs;
+
+void* thread_producer(void* arg)
+{
+    QueueArgs* args = (QueueArgs*) arg;
+    for (size_t i = 1; i <= (size_t) args->num_items; ++i)
+        oskar_queue_push(args->queue, (void*)i);
+    oskar_queue_close(args->queue);
+    return 0;
+}
+
+TEST(thread, queue)
+{
+    // Pass items through a small queue, and check they arrive in order.
+    QueueArgs args;
+    args.queue = oskar_queue_create(3);
+    args.num_items = 1000;
+    oskar_Thread* producer = oskar_thread_create(thread_producer,
+            (void*)(&args), 0);
+    size_t expected = 1;
+    void* item;
+    while ((item = oskar_queue_pop(args.queue)) != 0)
+    {
+        ASSERT_EQ(expected, (size_t)item);
+        expected++;
+    }
+    EXPECT_EQ((size_t) args.num_items + 1, expected);
+    oskar_thread_join(producer);
+    oskar_thread_free(producer);
+
+    // Check that push fails on a closed queue.
+    EXPECT_EQ(0, oskar_queue_push(args.queue, (void*)1));
+    oskar_queue_free(args.queue);
+}
@@ -114,6 +114,46 @@ TEST(crc, crc32_corrupted)
     free(data);
 }
 
+static unsigned long crc32c_bitwise(const unsigned char* data, size_t length)
+{
+    unsigned long crc = 0xFFFFFFFFuL;
+    for (size_t i = 0; i < length; ++i)
+    {
+        crc ^= data[i];
+        for (int j = 0; j < 8; ++j)
+            crc = (crc >> 1) ^ ((crc & 1) * 0x82f63b78uL);
+    }
+    return crc ^ 0xFFFFFFFFuL;
+}
+
+TEST(crc, crc32c_lengths_and_offsets)
+{
+    // Check long and unaligned blocks against a bitwise reference,
+    // to cover all code paths of the accelerated implementation.
+    oskar_CRC* crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    const size_t max_length = 3 * 8192 * 2 + 3 * 256 + 77;
+    unsigned char* data = (unsigned char*) malloc(max_length + 8);
+    for (size_t i = 0; i < max_length + 8; ++i)
+        data[i] = (unsigned char) ((i * 2654435761uL) >> 13);
+    const size_t lengths[] = {0, 1, 7, 8, 9, 767, 768, 769, 3 * 8192 - 1,
+            3 * 8192, 3 * 8192 + 3 * 256 + 13, max_length};
+    for (size_t k = 0; k < sizeof(lengths) / sizeof(size_t); ++k)
+    {
+        for (size_t offset = 0; offset < 8; offset += 3)
+        {
+            EXPECT_EQ(crc32c_bitwise(data + offset, lengths[k]),
+                    oskar_crc_compute(crc_data, data + offset, lengths[k]));
+        }
+    }
+
+    // Check incremental updates give the same result.
+    unsigned long crc = oskar_crc_compute(crc_data, data, 1001);
+    crc = oskar_crc_update(crc_data, crc, data + 1001, max_length - 1001);
+    EXPECT_EQ(crc32c_bitwise(data, max_length), crc);
+    oskar_crc_free(crc_data);
+    free(data);
+}
+
 TEST(crc, crc8_standard)
 {
     const char data[] = "123456789";
@@ -46,3 +46,27 @@ TEST(get_memory_usage, test)
     printf("** Released memory **\n");
     oskar_print_memory_info();
 }
+
+TEST(get_memory_usage, bytes)
+{
+    // Touch 64 MB of memory, and check the resident size grows in bytes.
+    size_t size = 64ul*1024ul*1024ul;
+    size_t before = oskar_get_memory_usage();
+    char* mem = (char*)malloc(size);
+    ASSERT_TRUE(mem != 0);
+    volatile char* p = mem;
+    for (size_t i = 0; i < size; i += 4096) p[i] = 1;
+    size_t after = oskar_get_memory_usage();
+    size_t peak = oskar_get_peak_memory_usage();
+    free(mem);
+#ifdef OSKAR_OS_LINUX
+    EXPECT_GT(before, 1024ul*1024ul);
+    EXPECT_GE(after, before + size / 2);
+    EXPECT_LT(after, oskar_get_total_physical_memory());
+    EXPECT_GE(peak, after);
+#else
+    (void) before;
+    (void) after;
+    (void) peak;
+#endif
+}
@@ -28,8 +28,11 @@
 
 #include <gtest/gtest.h>
 
+#include "utility/oskar_double_to_string.h"
 #include "utility/oskar_string_to_array.h"
+#include "utility/oskar_string_to_double.h"
 
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -138,6 +141,113 @@ TEST(string_to_array_d, comment_at_end)
         EXPECT_DOUBLE_EQ((double)(i/10.0 + 1), list[i]);
 }
 
+TEST(string_to_array_d, range)
+{
+    // Test a range that is not NULL-terminated.
+    double list[NUM_DOUBLES];
+    const char text[] = "1.5 2.5,3.5\r\n4.5 5.5";
+    const char* end = strchr(text, '\n');
+    size_t filled = oskar_string_to_array_range_d(text, end, NUM_DOUBLES, list);
+    ASSERT_EQ((size_t)3, filled);
+    for (size_t i = 0; i < filled; ++i)
+        EXPECT_DOUBLE_EQ(i + 1.5, list[i]);
+}
+
+// Conversion of single numbers.
+
+TEST(string_to_double, formats)
+{
+    const char* end = 0;
+    const char* valid[] = {"0", "-0", "+1", "1.", ".5", "-.5e-3", "1e5",
+            "1E+05", "12345678901234567890", "0.000000000000000000000001234",
+            "1.7976931348623157e308", "4.9e-324", "123.456e-300",
+            "0x1p3", "inf", "-Infinity", "3.14159265358979323846",
+            "00000000000000000000000000000012.5", "1e400", "-45.01234567"};
+    for (size_t i = 0; i < sizeof(valid) / sizeof(valid[0]); ++i)
+    {
+        char* expected_end = 0;
+        const double expected = strtod(valid[i], &expected_end);
+        const double value = oskar_string_to_double(valid[i], 0, &end);
+        EXPECT_EQ(expected, value) << valid[i];
+        EXPECT_EQ(expected_end, end) << valid[i];
+    }
+
+    // Not numbers.
+    const char* invalid[] = {"", "-", ".", "+.", "e5", "abc", "#1"};
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+    {
+        EXPECT_EQ(0.0, oskar_string_to_double(invalid[i], 0, &end));
+        EXPECT_EQ(invalid[i], end);
+    }
+
+    // Partial conversions.
+    const char text[] = "1.5e 2";
+    EXPECT_EQ(1.5, oskar_string_to_double(text, 0, &end));
+    EXPECT_EQ(text + 3, end);
+    const char digits[] = "1234";
+    EXPECT_EQ(12.0, oskar_string_to_double(digits, digits + 2, &end));
+    EXPECT_EQ(digits + 2, end);
+    EXPECT_EQ(12.0, oskar_string_to_double("12.0abc", 0, 0));
+}
+
+TEST(string_to_double, random_values)
+{
+    // Check that results match strtod() exactly.
+    char buffer[64];
+    const char* formats[] = {"%.6f", "%.10f", "%.15g", "%.17g", "%.8e"};
+    srand(7);
+    for (int i = 0; i < 100000; ++i)
+    {
+        const char* end = 0;
+        char* expected_end = 0;
+        const double r = (rand() / (double)RAND_MAX - 0.5) *
+                pow(10.0, (rand() % 40) - 20);
+        sprintf(buffer, formats[i % 5], r);
+        const double expected = strtod(buffer, &expected_end);
+        const double value = oskar_string_to_double(buffer, 0, &end);
+        ASSERT_EQ(expected, value) << buffer;
+        ASSERT_EQ((const char*)expected_end, end) << buffer;
+    }
+}
+
+// Conversion of numbers to strings.
+
+TEST(double_to_string, special_values)
+{
+    char buffer[64], expected[64];
+    const double values[] = {0.0, -0.0, 1.0, -1.0, 0.5, 9.9999995,
+            9.99999949, 1e22, 1e-22, 123456789012345.0, 1e300, 4.9e-324,
+            1.0 / 0.0, -1.0 / 0.0, 0.0 / 0.0, 2.5, 0.125, 1e100};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+    {
+        for (int precision = 0; precision <= 16; ++precision)
+        {
+            const int len = oskar_double_to_string(buffer, values[i],
+                    precision);
+            sprintf(expected, "% .*e", precision, values[i]);
+            EXPECT_STREQ(expected, buffer);
+            EXPECT_EQ((int)strlen(expected), len);
+        }
+    }
+}
+
+TEST(double_to_string, random_values)
+{
+    // Check that results match sprintf() exactly.
+    char buffer[64], expected[64];
+    srand(7);
+    for (int i = 0; i < 200000; ++i)
+    {
+        const int precision = (i % 2) ? 6 : 14;
+        double r = (rand() / (double)RAND_MAX - 0.5) *
+                pow(10.0, (rand() % 60) - 30);
+        if (precision == 6) r = (float) r;
+        oskar_double_to_string(buffer, r, precision);
+        sprintf(expected, "% .*e", precision, r);
+        ASSERT_STREQ(expected, buffer);
+    }
+}
+
 // Strings.
 
 TEST(string_to_array_s, empty_string)
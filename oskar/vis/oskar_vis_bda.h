@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_VIS_BDA_H_
+#define OSKAR_VIS_BDA_H_
+
+/**
+ * @file oskar_vis_bda.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+#include <vis/oskar_vis_block.h>
+#include <vis/oskar_vis_header.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_VisBda;
+#ifndef OSKAR_VIS_BDA_TYPEDEF_
+#define OSKAR_VIS_BDA_TYPEDEF_
+typedef struct oskar_VisBda oskar_VisBda;
+#endif /* OSKAR_VIS_BDA_TYPEDEF_ */
+
+/**
+ * @brief
+ * Creates a baseline-dependent time averager for visibility blocks.
+ *
+ * @details
+ * Visibility blocks passed to oskar_vis_bda_add_block() are averaged in time
+ * separately on each baseline, so that short baselines (which move slowly
+ * through the uv-plane) are averaged over more time samples than
+ * long baselines. Channels are not averaged.
+ *
+ * A baseline average is closed when adding the next time sample would
+ * either make the average longer than \p max_duration_sec, or move the
+ * baseline further than \p max_uvw_distance wavelengths from the first
+ * sample in the average. The distance is measured at the highest
+ * frequency in the header, where it is largest.
+ *
+ * Auto-correlations are limited only by the duration.
+ * A limit of zero is not applied.
+ *
+ * Completed averages are returned as rows, ordered as in a
+ * Measurement Set: each row has its own antenna indices, time centroid,
+ * interval and weight (the number of samples in the average).
+ *
+ * @param[in] hdr               Header of the visibility data to average.
+ * @param[in] max_duration_sec  Maximum duration of an average, in seconds.
+ * @param[in] max_uvw_distance  Maximum baseline movement, in wavelengths.
+ * @param[in,out] status        Status return code.
+ */
+OSKAR_EXPORT
+oskar_VisBda* oskar_vis_bda_create(const oskar_VisHeader* hdr,
+        double max_duration_sec, double max_uvw_distance, int* status);
+
+/**
+ * @brief
+ * Adds a block of visibility data to the averages.
+ *
+ * @details
+ * Blocks must be supplied in time order, and must contain all channels
+ * in the header. Any averages completed by this block are appended to
+ * the output rows.
+ *
+ * @param[in,out] bda      Handle to averager.
+ * @param[in] blk          Visibility block in CPU memory.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_add_block(oskar_VisBda* bda, const oskar_VisBlock* blk,
+        int* status);
+
+/**
+ * @brief
+ * Closes all averages that are still open.
+ *
+ * @details
+ * This should be called after the last block has been added, to append
+ * the remaining averages to the output rows.
+ *
+ * @param[in,out] bda      Handle to averager.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_flush(oskar_VisBda* bda, int* status);
+
+/**
+ * @brief
+ * Discards the current output rows, once they have been written.
+ *
+ * @param[in,out] bda      Handle to averager.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_clear_output(oskar_VisBda* bda);
+
+/**
+ * @brief
+ * Destroys the averager.
+ *
+ * @param[in,out] bda      Handle to averager.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_free(oskar_VisBda* bda, int* status);
+
+/* Accessors for the output rows.
+ *
+ * The visibility amplitudes are double-precision complex values, with
+ * dimension order (slowest) row, channel, polarisation (fastest).
+ * All other arrays have one element per row: antenna indices are integers,
+ * and everything else is double precision. Time centroids are at
+ * MJD(UTC) seconds. */
+
+OSKAR_EXPORT
+int oskar_vis_bda_num_rows(const oskar_VisBda* bda);
+
+OSKAR_EXPORT
+int oskar_vis_bda_num_channels(const oskar_VisBda* bda);
+
+OSKAR_EXPORT
+int oskar_vis_bda_num_pols(const oskar_VisBda* bda);
+
+OSKAR_EXPORT
+size_t oskar_vis_bda_num_input_rows(const oskar_VisBda* bda);
+
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_antenna1_const(const oskar_VisBda* bda);
+
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_antenna2_const(const oskar_VisBda* bda);
+
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_uu_metres_const(const oskar_VisBda* bda);
+
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_vv_metres_const(const oskar_VisBda* bda);
+
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_ww_metres_const(const oskar_VisBda* bda);
+
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_time_centroid_const(const oskar_VisBda* bda);
+
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_exposure_sec_const(const oskar_VisBda* bda);
+
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_interval_sec_const(const oskar_VisBda* bda);
+
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_weight_const(const oskar_VisBda* bda);
+
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_vis_const(const oskar_VisBda* bda);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_VIS_BDA_H_ */
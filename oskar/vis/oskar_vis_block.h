@@ -70,6 +70,7 @@ enum OSKAR_VIS_BLOCK_TAGS
 #include <vis/oskar_vis_block_free.h>
 #include <vis/oskar_vis_block_read.h>
 #include <vis/oskar_vis_block_resize.h>
+#include <vis/oskar_vis_block_stage_ms.h>
 #include <vis/oskar_vis_block_write.h>
 #include <vis/oskar_vis_block_write_ms.h>
 
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_VIS_BLOCK_STAGE_MS_H_
+#define OSKAR_VIS_BLOCK_STAGE_MS_H_
+
+/**
+ * @file oskar_vis_block_stage_ms.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Reorders the visibilities in a block into Measurement Set row order.
+ *
+ * @details
+ * Copies the visibilities in a block to the output buffer, in the order
+ * used by the rows of a Measurement Set, converting to single precision.
+ *
+ * The input has dimensions (time, channel, baseline or station, pol),
+ * and the output has dimensions (time, baseline, channel, pol).
+ * Within each time step, the output baselines are ordered by the first
+ * station, with the auto-correlation (if present) of each station before
+ * its cross-correlations with the stations that follow it.
+ *
+ * If the block has one polarisation and \p num_pols_out is 4,
+ * Stokes I is written to both XX and YY, and XY and YX are set to zero.
+ *
+ * The output buffer must hold at least (2 * num_times * num_channels *
+ * num_baselines_out * num_pols_out) values, where num_baselines_out
+ * includes the auto-correlations if present.
+ *
+ * @param[in] blk           Pointer to visibility block, in host memory.
+ * @param[in] num_pols_out  Number of polarisations in the output.
+ * @param[out] out          Output buffer.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_block_stage_ms(const oskar_VisBlock* blk,
+        unsigned int num_pols_out, float* out, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_VIS_BLOCK_STAGE_MS_H_ */
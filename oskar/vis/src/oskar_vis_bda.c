@@ -0,0 +1,463 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vis/oskar_vis_bda.h"
+#include "math/oskar_cmath.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define C_0 299792458.0
+
+struct oskar_VisBda
+{
+    int num_stations, num_baselines, num_channels, num_pols, num_slots;
+    double duvw_max, max_duration_sec;
+    double time_start_mjd_sec, time_inc_sec, time_average_sec;
+    size_t num_input_rows;
+
+    /* Open averages, one per baseline, followed by auto-correlations. */
+    int *slot_a1, *slot_a2, *ave_count;
+    double *ave_uvw, *first_uvw, *ave_time, *ave_vis, *uvw;
+
+    /* Completed averages. */
+    int num_rows, capacity;
+    oskar_Mem *a1, *a2, *uu, *vv, *ww, *time_centroid, *exposure, *interval;
+    oskar_Mem *weight, *vis;
+};
+
+static void close_average(oskar_VisBda* bda, int s, int* status);
+
+
+oskar_VisBda* oskar_vis_bda_create(const oskar_VisHeader* hdr,
+        double max_duration_sec, double max_uvw_distance, int* status)
+{
+    int a1, a2, s, num_stations, num_channels;
+    double freq_max_hz;
+    oskar_VisBda* bda = 0;
+    if (*status) return 0;
+
+    /* Get dimensions from the header. */
+    num_stations = oskar_vis_header_num_stations(hdr);
+    num_channels = oskar_vis_header_num_channels_total(hdr);
+    freq_max_hz = oskar_vis_header_freq_start_hz(hdr) +
+            (num_channels - 1) * oskar_vis_header_freq_inc_hz(hdr);
+    if (max_duration_sec < 0.0 || max_uvw_distance < 0.0 ||
+            !(freq_max_hz > 0.0))
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return 0;
+    }
+    bda = (oskar_VisBda*) calloc(1, sizeof(oskar_VisBda));
+    bda->num_stations = num_stations;
+    bda->num_channels = num_channels;
+    bda->num_pols = oskar_type_is_matrix(oskar_vis_header_amp_type(hdr)) ?
+            4 : 1;
+    bda->max_duration_sec = max_duration_sec;
+    bda->duvw_max = max_uvw_distance * C_0 / freq_max_hz;
+    bda->time_start_mjd_sec =
+            oskar_vis_header_time_start_mjd_utc(hdr) * 86400.0;
+    bda->time_inc_sec = oskar_vis_header_time_inc_sec(hdr);
+    bda->time_average_sec = oskar_vis_header_time_average_sec(hdr);
+    if (oskar_vis_header_write_cross_correlations(hdr))
+        bda->num_baselines = num_stations * (num_stations - 1) / 2;
+    bda->num_slots = bda->num_baselines;
+    if (oskar_vis_header_write_auto_correlations(hdr))
+        bda->num_slots += num_stations;
+
+    /* Allocate the averages, and store the antenna indices of each. */
+    bda->slot_a1   = (int*) calloc(bda->num_slots, sizeof(int));
+    bda->slot_a2   = (int*) calloc(bda->num_slots, sizeof(int));
+    bda->ave_count = (int*) calloc(bda->num_slots, sizeof(int));
+    bda->ave_time  = (double*) calloc(bda->num_slots, sizeof(double));
+    bda->ave_uvw   = (double*) calloc(3 * bda->num_slots, sizeof(double));
+    bda->first_uvw = (double*) calloc(3 * bda->num_slots, sizeof(double));
+    bda->uvw       = (double*) calloc(3 * bda->num_slots, sizeof(double));
+    bda->ave_vis   = (double*) calloc((size_t) bda->num_slots *
+            num_channels * bda->num_pols, 2 * sizeof(double));
+    if (bda->num_baselines > 0)
+    {
+        for (a1 = 0, s = 0; a1 < num_stations; ++a1)
+        {
+            for (a2 = a1 + 1; a2 < num_stations; ++a2, ++s)
+            {
+                bda->slot_a1[s] = a1;
+                bda->slot_a2[s] = a2;
+            }
+        }
+    }
+    for (s = bda->num_baselines; s < bda->num_slots; ++s)
+    {
+        bda->slot_a1[s] = s - bda->num_baselines;
+        bda->slot_a2[s] = s - bda->num_baselines;
+    }
+
+    /* Create the output arrays. */
+    bda->a1 = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    bda->a2 = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    bda->uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    bda->vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    bda->ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    bda->time_centroid = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    bda->exposure = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    bda->interval = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    bda->weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    bda->vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, 0, status);
+    return bda;
+}
+
+
+#define ACCUMULATE_VIS(FP) {                                                \
+    const FP *xc, *ac;                                                      \
+    xc = (const FP*) oskar_mem_void_const(                                  \
+            oskar_vis_block_cross_correlations_const(blk));                 \
+    ac = (const FP*) oskar_mem_void_const(                                  \
+            oskar_vis_block_auto_correlations_const(blk));                  \
+    for (c = 0; c < num_channels; ++c)                                      \
+    {                                                                       \
+        if (num_baselines > 0)                                              \
+        {                                                                   \
+            const FP* in = xc + 2 * (size_t) num_pols *                     \
+                    ((size_t) num_baselines * (t * num_channels + c));      \
+            for (s = 0; s < num_baselines; ++s)                             \
+            {                                                               \
+                double* out = bda->ave_vis + 2 * (size_t) num_pols *        \
+                        ((size_t) s * num_channels + c);                    \
+                for (i = 0; i < 2 * num_pols; ++i) out[i] += *in++;         \
+            }                                                               \
+        }                                                                   \
+        if (num_slots > num_baselines)                                      \
+        {                                                                   \
+            const FP* in = ac + 2 * (size_t) num_pols *                     \
+                    ((size_t) num_stations * (t * num_channels + c));       \
+            for (s = num_baselines; s < num_slots; ++s)                     \
+            {                                                               \
+                double* out = bda->ave_vis + 2 * (size_t) num_pols *        \
+                        ((size_t) s * num_channels + c);                    \
+                for (i = 0; i < 2 * num_pols; ++i) out[i] += *in++;         \
+            }                                                               \
+        }                                                                   \
+    }                                                                       \
+    }
+
+void oskar_vis_bda_add_block(oskar_VisBda* bda, const oskar_VisBlock* blk,
+        int* status)
+{
+    int c, i, s, t, num_times, num_channels, num_baselines, num_slots;
+    int num_pols, num_stations, prec, coord_prec, start_time;
+    const oskar_Mem *uu, *vv, *ww;
+    if (*status) return;
+
+    /* Check the block dimensions are consistent. */
+    num_times     = oskar_vis_block_num_times(blk);
+    num_channels  = bda->num_channels;
+    num_baselines = bda->num_baselines;
+    num_slots     = bda->num_slots;
+    num_pols      = bda->num_pols;
+    num_stations  = bda->num_stations;
+    start_time    = oskar_vis_block_start_time_index(blk);
+    if (oskar_vis_block_location(blk) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_vis_block_start_channel_index(blk) != 0 ||
+            oskar_vis_block_num_channels(blk) != num_channels ||
+            oskar_vis_block_num_pols(blk) != num_pols ||
+            oskar_vis_block_num_stations(blk) != num_stations ||
+            (num_baselines > 0 &&
+                    !oskar_vis_block_has_cross_correlations(blk)) ||
+            (num_slots > num_baselines &&
+                    !oskar_vis_block_has_auto_correlations(blk)))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    prec = oskar_mem_precision(num_baselines > 0 ?
+            oskar_vis_block_cross_correlations_const(blk) :
+            oskar_vis_block_auto_correlations_const(blk));
+    uu = oskar_vis_block_baseline_uu_metres_const(blk);
+    vv = oskar_vis_block_baseline_vv_metres_const(blk);
+    ww = oskar_vis_block_baseline_ww_metres_const(blk);
+    coord_prec = oskar_mem_precision(uu);
+
+    for (t = 0; t < num_times; ++t)
+    {
+        const size_t offset = (size_t) t * num_baselines;
+        const double time_centroid = bda->time_start_mjd_sec +
+                (start_time + t + 0.5) * bda->time_inc_sec;
+
+        /* Get the baseline coordinates at this time. */
+        if (coord_prec == OSKAR_DOUBLE)
+        {
+            const double *u_, *v_, *w_;
+            u_ = oskar_mem_double_const(uu, status) + offset;
+            v_ = oskar_mem_double_const(vv, status) + offset;
+            w_ = oskar_mem_double_const(ww, status) + offset;
+            for (s = 0; s < num_baselines; ++s)
+            {
+                bda->uvw[3*s + 0] = u_[s];
+                bda->uvw[3*s + 1] = v_[s];
+                bda->uvw[3*s + 2] = w_[s];
+            }
+        }
+        else
+        {
+            const float *u_, *v_, *w_;
+            u_ = oskar_mem_float_const(uu, status) + offset;
+            v_ = oskar_mem_float_const(vv, status) + offset;
+            w_ = oskar_mem_float_const(ww, status) + offset;
+            for (s = 0; s < num_baselines; ++s)
+            {
+                bda->uvw[3*s + 0] = u_[s];
+                bda->uvw[3*s + 1] = v_[s];
+                bda->uvw[3*s + 2] = w_[s];
+            }
+        }
+
+        /* Close any averages that this time sample would extend too far. */
+        for (s = 0; s < num_slots; ++s)
+        {
+            const int n = bda->ave_count[s];
+            if (n == 0) continue;
+            if (bda->max_duration_sec > 0.0 && (n + 1) * bda->time_inc_sec >
+                    bda->max_duration_sec * (1.0 + 1e-9))
+            {
+                close_average(bda, s, status);
+                continue;
+            }
+            if (bda->duvw_max > 0.0 && s < num_baselines)
+            {
+                const double du = bda->uvw[3*s + 0] - bda->first_uvw[3*s + 0];
+                const double dv = bda->uvw[3*s + 1] - bda->first_uvw[3*s + 1];
+                const double dw = bda->uvw[3*s + 2] - bda->first_uvw[3*s + 2];
+                if (du*du + dv*dv + dw*dw > bda->duvw_max * bda->duvw_max)
+                    close_average(bda, s, status);
+            }
+        }
+
+        /* Add this time sample to the averages. */
+        for (s = 0; s < num_slots; ++s)
+        {
+            if (bda->ave_count[s] == 0)
+            {
+                bda->first_uvw[3*s + 0] = bda->uvw[3*s + 0];
+                bda->first_uvw[3*s + 1] = bda->uvw[3*s + 1];
+                bda->first_uvw[3*s + 2] = bda->uvw[3*s + 2];
+            }
+            bda->ave_count[s]++;
+            bda->ave_time[s] += time_centroid;
+            bda->ave_uvw[3*s + 0] += bda->uvw[3*s + 0];
+            bda->ave_uvw[3*s + 1] += bda->uvw[3*s + 1];
+            bda->ave_uvw[3*s + 2] += bda->uvw[3*s + 2];
+        }
+        if (prec == OSKAR_DOUBLE)
+            ACCUMULATE_VIS(double)
+        else
+            ACCUMULATE_VIS(float)
+        bda->num_input_rows += num_slots;
+    }
+}
+
+#undef ACCUMULATE_VIS
+
+
+void oskar_vis_bda_flush(oskar_VisBda* bda, int* status)
+{
+    int s;
+    for (s = 0; s < bda->num_slots; ++s)
+    {
+        if (bda->ave_count[s] > 0)
+            close_average(bda, s, status);
+    }
+}
+
+
+void oskar_vis_bda_clear_output(oskar_VisBda* bda)
+{
+    bda->num_rows = 0;
+}
+
+
+void oskar_vis_bda_free(oskar_VisBda* bda, int* status)
+{
+    if (!bda) return;
+    free(bda->slot_a1);
+    free(bda->slot_a2);
+    free(bda->ave_count);
+    free(bda->ave_time);
+    free(bda->ave_uvw);
+    free(bda->first_uvw);
+    free(bda->uvw);
+    free(bda->ave_vis);
+    oskar_mem_free(bda->a1, status);
+    oskar_mem_free(bda->a2, status);
+    oskar_mem_free(bda->uu, status);
+    oskar_mem_free(bda->vv, status);
+    oskar_mem_free(bda->ww, status);
+    oskar_mem_free(bda->time_centroid, status);
+    oskar_mem_free(bda->exposure, status);
+    oskar_mem_free(bda->interval, status);
+    oskar_mem_free(bda->weight, status);
+    oskar_mem_free(bda->vis, status);
+    free(bda);
+}
+
+
+int oskar_vis_bda_num_rows(const oskar_VisBda* bda)
+{
+    return bda->num_rows;
+}
+
+int oskar_vis_bda_num_channels(const oskar_VisBda* bda)
+{
+    return bda->num_channels;
+}
+
+int oskar_vis_bda_num_pols(const oskar_VisBda* bda)
+{
+    return bda->num_pols;
+}
+
+size_t oskar_vis_bda_num_input_rows(const oskar_VisBda* bda)
+{
+    return bda->num_input_rows;
+}
+
+const oskar_Mem* oskar_vis_bda_antenna1_const(const oskar_VisBda* bda)
+{
+    return bda->a1;
+}
+
+const oskar_Mem* oskar_vis_bda_antenna2_const(const oskar_VisBda* bda)
+{
+    return bda->a2;
+}
+
+const oskar_Mem* oskar_vis_bda_uu_metres_const(const oskar_VisBda* bda)
+{
+    return bda->uu;
+}
+
+const oskar_Mem* oskar_vis_bda_vv_metres_const(const oskar_VisBda* bda)
+{
+    return bda->vv;
+}
+
+const oskar_Mem* oskar_vis_bda_ww_metres_const(const oskar_VisBda* bda)
+{
+    return bda->ww;
+}
+
+const oskar_Mem* oskar_vis_bda_time_centroid_const(const oskar_VisBda* bda)
+{
+    return bda->time_centroid;
+}
+
+const oskar_Mem* oskar_vis_bda_exposure_sec_const(const oskar_VisBda* bda)
+{
+    return bda->exposure;
+}
+
+const oskar_Mem* oskar_vis_bda_interval_sec_const(const oskar_VisBda* bda)
+{
+    return bda->interval;
+}
+
+const oskar_Mem* oskar_vis_bda_weight_const(const oskar_VisBda* bda)
+{
+    return bda->weight;
+}
+
+const oskar_Mem* oskar_vis_bda_vis_const(const oskar_VisBda* bda)
+{
+    return bda->vis;
+}
+
+
+static void close_average(oskar_VisBda* bda, int s, int* status)
+{
+    int i, row;
+    size_t num_amps;
+    double scale, *vis_out;
+    const double* vis_in;
+    if (*status) return;
+
+    /* Grow the output arrays if required. */
+    row = bda->num_rows;
+    num_amps = (size_t) bda->num_channels * bda->num_pols;
+    if (row >= bda->capacity)
+    {
+        bda->capacity = (bda->capacity > 0) ?
+                2 * bda->capacity : bda->num_slots;
+        oskar_mem_realloc(bda->a1, bda->capacity, status);
+        oskar_mem_realloc(bda->a2, bda->capacity, status);
+        oskar_mem_realloc(bda->uu, bda->capacity, status);
+        oskar_mem_realloc(bda->vv, bda->capacity, status);
+        oskar_mem_realloc(bda->ww, bda->capacity, status);
+        oskar_mem_realloc(bda->time_centroid, bda->capacity, status);
+        oskar_mem_realloc(bda->exposure, bda->capacity, status);
+        oskar_mem_realloc(bda->interval, bda->capacity, status);
+        oskar_mem_realloc(bda->weight, bda->capacity, status);
+        oskar_mem_realloc(bda->vis, bda->capacity * num_amps, status);
+        if (*status) return;
+    }
+
+    /* Store the average and reset it. */
+    scale = 1.0 / bda->ave_count[s];
+    oskar_mem_int(bda->a1, status)[row] = bda->slot_a1[s];
+    oskar_mem_int(bda->a2, status)[row] = bda->slot_a2[s];
+    oskar_mem_double(bda->uu, status)[row] = bda->ave_uvw[3*s + 0] * scale;
+    oskar_mem_double(bda->vv, status)[row] = bda->ave_uvw[3*s + 1] * scale;
+    oskar_mem_double(bda->ww, status)[row] = bda->ave_uvw[3*s + 2] * scale;
+    oskar_mem_double(bda->time_centroid, status)[row] =
+            bda->ave_time[s] * scale;
+    oskar_mem_double(bda->exposure, status)[row] =
+            bda->ave_count[s] * bda->time_average_sec;
+    oskar_mem_double(bda->interval, status)[row] =
+            bda->ave_count[s] * bda->time_inc_sec;
+    oskar_mem_double(bda->weight, status)[row] = bda->ave_count[s];
+    vis_in = bda->ave_vis + 2 * num_amps * s;
+    vis_out = oskar_mem_double(bda->vis, status) + 2 * num_amps * row;
+    for (i = 0; i < 2 * (int) num_amps; ++i) vis_out[i] = vis_in[i] * scale;
+    memset(bda->ave_vis + 2 * num_amps * s, 0, 2 * num_amps * sizeof(double));
+    bda->ave_uvw[3*s + 0] = 0.0;
+    bda->ave_uvw[3*s + 1] = 0.0;
+    bda->ave_uvw[3*s + 2] = 0.0;
+    bda->ave_time[s] = 0.0;
+    bda->ave_count[s] = 0;
+    bda->num_rows++;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ms/oskar_measurement_set.h"
+#include "vis/oskar_vis_bda.h"
+#include "vis/oskar_vis_bda_write_ms.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_vis_bda_write_ms(const oskar_VisBda* bda,
+        oskar_MeasurementSet* ms, int* status)
+{
+    const double* in;
+    float* out;
+    size_t i, num_samples;
+    unsigned int num_rows, num_channels, num_pols_in, num_pols_out;
+    unsigned int start_row;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+    num_rows = (unsigned int) oskar_vis_bda_num_rows(bda);
+    if (num_rows == 0) return;
+
+    /* Check polarisation dimension consistency:
+     * num_pols_in can be less than num_pols_out, but not vice-versa. */
+    num_channels = (unsigned int) oskar_vis_bda_num_channels(bda);
+    num_pols_in  = (unsigned int) oskar_vis_bda_num_pols(bda);
+    num_pols_out = oskar_ms_num_pols(ms);
+    if (num_pols_in > num_pols_out || num_channels != oskar_ms_num_channels(ms))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Convert to single precision in the staging buffer of the
+     * Measurement Set, expanding polarisations if required.
+     * The rows are already in the order used by the Measurement Set. */
+    num_samples = (size_t) num_rows * num_channels;
+    out = (float*) oskar_ms_staging_buffer(ms,
+            num_samples * num_pols_out * 2 * sizeof(float));
+    if (!out)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    in = oskar_mem_double_const(oskar_vis_bda_vis_const(bda), status);
+    if (*status) return;
+    if (num_pols_in == num_pols_out)
+    {
+        for (i = 0; i < 2 * num_pols_out * num_samples; ++i)
+            out[i] = (float) in[i];
+    }
+    else
+    {
+        for (i = 0; i < num_samples; ++i)
+        {
+            const double* i_ = in + 2 * num_pols_in * i;
+            float* o_ = out + 2 * num_pols_out * i;
+            o_[0] = (float) i_[0]; o_[1] = (float) i_[1]; /* XX */
+            o_[2] = 0.0f;          o_[3] = 0.0f;          /* XY */
+            o_[4] = 0.0f;          o_[5] = 0.0f;          /* YX */
+            o_[6] = (float) i_[0]; o_[7] = (float) i_[1]; /* YY */
+        }
+    }
+
+    /* Append the rows to the main table. */
+    start_row = oskar_ms_num_rows(ms);
+    oskar_ms_write_coords_rows_d(ms, start_row, num_rows,
+            oskar_mem_int_const(oskar_vis_bda_antenna1_const(bda), status),
+            oskar_mem_int_const(oskar_vis_bda_antenna2_const(bda), status),
+            oskar_mem_double_const(oskar_vis_bda_uu_metres_const(bda), status),
+            oskar_mem_double_const(oskar_vis_bda_vv_metres_const(bda), status),
+            oskar_mem_double_const(oskar_vis_bda_ww_metres_const(bda), status),
+            oskar_mem_double_const(
+                    oskar_vis_bda_time_centroid_const(bda), status),
+            oskar_mem_double_const(
+                    oskar_vis_bda_exposure_sec_const(bda), status),
+            oskar_mem_double_const(
+                    oskar_vis_bda_interval_sec_const(bda), status),
+            oskar_mem_double_const(oskar_vis_bda_weight_const(bda), status));
+    oskar_ms_write_vis_rows_f(ms, start_row, 0, num_channels, num_rows, out);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_block_stage_ms.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of channels in each tile of the transpose. */
+#define TILE_CHANNELS 16
+
+/* Copies one visibility sample, expanding Stokes I to XX and YY if needed. */
+#define COPY_VIS(IN, OUT) \
+    if (num_pols_in == num_pols_out) \
+        for (k = 0; k < 2 * num_pols_in; ++k) OUT[k] = (float) IN[k]; \
+    else { \
+        OUT[0] = OUT[6] = (float) IN[0]; \
+        OUT[1] = OUT[7] = (float) IN[1]; \
+        OUT[2] = OUT[3] = OUT[4] = OUT[5] = 0.0f; }
+
+/* Reorders a block of visibilities into Measurement Set row order,
+ * converting to single precision.
+ * The input has dimensions (time, channel, baseline or station, pol),
+ * and the output has dimensions (time, baseline, channel, pol).
+ * Channels are processed in tiles, so that the input cache lines for a tile
+ * are reused by consecutive baselines. */
+#define STAGE_VIS(NAME, FP) \
+static void NAME(unsigned int num_times, unsigned int num_channels, \
+        unsigned int num_stations, unsigned int num_baseln_in, \
+        unsigned int num_pols_in, unsigned int num_pols_out, \
+        int have_autocorr, int have_crosscorr, \
+        const FP* xcorr, const FP* acorr, float* out) \
+{ \
+    unsigned int a1, a2, b, c, c0, c1, k, t; \
+    const size_t stride_in = 2 * num_pols_in, stride_out = 2 * num_pols_out; \
+    for (t = 0; t < num_times; ++t) \
+    { \
+        for (c0 = 0; c0 < num_channels; c0 += TILE_CHANNELS) \
+        { \
+            float* out_row = out; \
+            c1 = c0 + TILE_CHANNELS; \
+            if (c1 > num_channels) c1 = num_channels; \
+            for (a1 = 0, b = 0; a1 < num_stations; ++a1) \
+            { \
+                if (have_autocorr) \
+                { \
+                    for (c = c0; c < c1; ++c) \
+                    { \
+                        const FP* in_ = acorr + stride_in * ( \
+                                ((size_t) t * num_channels + c) * \
+                                num_stations + a1); \
+                        float* out_ = out_row + stride_out * c; \
+                        COPY_VIS(in_, out_) \
+                    } \
+                    out_row += stride_out * num_channels; \
+                } \
+                if (have_crosscorr) \
+                { \
+                    for (a2 = a1 + 1; a2 < num_stations; ++a2, ++b) \
+                    { \
+                        for (c = c0; c < c1; ++c) \
+                        { \
+                            const FP* in_ = xcorr + stride_in * ( \
+                                    ((size_t) t * num_channels + c) * \
+                                    num_baseln_in + b); \
+                            float* out_ = out_row + stride_out * c; \
+                            COPY_VIS(in_, out_) \
+                        } \
+                        out_row += stride_out * num_channels; \
+                    } \
+                } \
+            } \
+        } \
+        out += stride_out * num_channels * (num_baseln_in + \
+                (have_autocorr ? num_stations : 0)); \
+    } \
+}
+
+STAGE_VIS(stage_vis_f, float)
+STAGE_VIS(stage_vis_d, double)
+
+void oskar_vis_block_stage_ms(const oskar_VisBlock* blk,
+        unsigned int num_pols_out, float* out, int* status)
+{
+    const oskar_Mem *xcorr, *acorr;
+    unsigned int num_pols_in;
+    if (*status) return;
+    xcorr = oskar_vis_block_cross_correlations_const(blk);
+    acorr = oskar_vis_block_auto_correlations_const(blk);
+    num_pols_in = oskar_vis_block_num_pols(blk);
+    if (num_pols_in > num_pols_out ||
+            (num_pols_in != num_pols_out && num_pols_out != 4))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (oskar_mem_location(xcorr) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_mem_precision(xcorr) == OSKAR_DOUBLE)
+        stage_vis_d(oskar_vis_block_num_times(blk),
+                oskar_vis_block_num_channels(blk),
+                oskar_vis_block_num_stations(blk),
+                oskar_vis_block_num_baselines(blk),
+                num_pols_in, num_pols_out,
+                oskar_vis_block_has_auto_correlations(blk),
+                oskar_vis_block_has_cross_correlations(blk),
+                oskar_mem_double_const(xcorr, status),
+                oskar_mem_double_const(acorr, status), out);
+    else if (oskar_mem_precision(xcorr) == OSKAR_SINGLE)
+        stage_vis_f(oskar_vis_block_num_times(blk),
+                oskar_vis_block_num_channels(blk),
+                oskar_vis_block_num_stations(blk),
+                oskar_vis_block_num_baselines(blk),
+                num_pols_in, num_pols_out,
+                oskar_vis_block_has_auto_correlations(blk),
+                oskar_vis_block_has_cross_correlations(blk),
+                oskar_mem_float_const(xcorr, status),
+                oskar_mem_float_const(acorr, status), out);
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -28,6 +28,7 @@
 
 #include "ms/oskar_measurement_set.h"
 #include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_block_stage_ms.h"
 #include "vis/oskar_vis_header.h"
 #include "math/oskar_cmath.h"
 
@@ -37,19 +38,44 @@ extern "C" {
 
 #define D2R (M_PI / 180.0)
 
+/* Interleaves zero-length auto-correlation coordinates with the baseline
+ * coordinates for one time step. */
+#define STAGE_UVW(NAME, FP) \
+static void NAME(unsigned int num_stations, int have_crosscorr, \
+        const FP* uu_in, const FP* vv_in, const FP* ww_in, \
+        FP* uu_out, FP* vv_out, FP* ww_out) \
+{ \
+    unsigned int a1, a2, b, i_out; \
+    for (a1 = 0, b = 0, i_out = 0; a1 < num_stations; ++a1) \
+    { \
+        uu_out[i_out] = vv_out[i_out] = ww_out[i_out] = (FP) 0; \
+        ++i_out; \
+        if (!have_crosscorr) continue; \
+        for (a2 = a1 + 1; a2 < num_stations; ++a2, ++b, ++i_out) \
+        { \
+            uu_out[i_out] = uu_in[b]; \
+            vv_out[i_out] = vv_in[b]; \
+            ww_out[i_out] = ww_in[b]; \
+        } \
+    } \
+}
+
+STAGE_UVW(stage_uvw_f, float)
+STAGE_UVW(stage_uvw_d, double)
+
 void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
         const oskar_VisHeader* header, oskar_MeasurementSet* ms, int* status)
 {
-    const oskar_Mem *in_acorr, *in_xcorr, *in_uu, *in_vv, *in_ww;
-    oskar_Mem *temp_vis = 0, *temp_uu = 0, *temp_vv = 0, *temp_ww = 0;
+    const oskar_Mem *in_xcorr, *in_uu, *in_vv, *in_ww;
     double exposure_sec, interval_sec, t_start_mjd, t_start_sec;
     double ra_rad, dec_rad, freq_start_hz;
-    unsigned int a1, a2, num_baseln_in, num_baseln_out, num_channels;
-    unsigned int num_pols_in, num_pols_out, num_stations, num_times, b, c, t;
-    unsigned int i, i_out, prec, start_time_index, start_chan_index;
+    unsigned int num_baseln_in, num_baseln_out, num_channels;
+    unsigned int num_pols_in, num_pols_out, num_stations, num_times, t;
+    unsigned int prec, start_time_index, start_chan_index;
     unsigned int have_autocorr, have_crosscorr;
-    const void *xcorr, *acorr;
-    void* out;
+    size_t vis_bytes, uvw_bytes;
+    char* staging;
+    float* out;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -61,7 +87,6 @@ void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
     num_baseln_in    = oskar_vis_block_num_baselines(blk);
     num_channels     = oskar_vis_block_num_channels(blk);
     num_times        = oskar_vis_block_num_times(blk);
-    in_acorr         = oskar_vis_block_auto_correlations_const(blk);
     in_xcorr         = oskar_vis_block_cross_correlations_const(blk);
     in_uu            = oskar_vis_block_baseline_uu_metres_const(blk);
     in_vv            = oskar_vis_block_baseline_vv_metres_const(blk);
@@ -118,271 +143,76 @@ void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
         return;
     }
 
-    /* Add visibilities and u,v,w coordinates. */
-    temp_vis = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
-            num_baseln_out * num_channels * num_pols_out, status);
-    temp_uu = oskar_mem_create(prec, OSKAR_CPU, num_baseln_out, status);
-    temp_vv = oskar_mem_create(prec, OSKAR_CPU, num_baseln_out, status);
-    temp_ww = oskar_mem_create(prec, OSKAR_CPU, num_baseln_out, status);
-    xcorr   = oskar_mem_void_const(in_xcorr);
-    acorr   = oskar_mem_void_const(in_acorr);
-    out     = oskar_mem_void(temp_vis);
-    if (prec == OSKAR_DOUBLE)
+    /* Get the staging buffer from the Measurement Set, which holds
+     * the reordered visibilities for the block, followed by
+     * the u,v,w coordinates for one time step. */
+    vis_bytes = (size_t) num_times * num_baseln_out * num_channels *
+            num_pols_out * 2 * sizeof(float);
+    uvw_bytes = 3 * (size_t) num_baseln_out * oskar_mem_element_size(prec);
+    staging = (char*) oskar_ms_staging_buffer(ms, vis_bytes + uvw_bytes);
+    if (!staging)
     {
-        const double *uu_in, *vv_in, *ww_in;
-        double *uu_out, *vv_out, *ww_out;
-        uu_in = oskar_mem_double_const(in_uu, status);
-        vv_in = oskar_mem_double_const(in_vv, status);
-        ww_in = oskar_mem_double_const(in_ww, status);
-        uu_out = oskar_mem_double(temp_uu, status);
-        vv_out = oskar_mem_double(temp_vv, status);
-        ww_out = oskar_mem_double(temp_ww, status);
-        for (t = 0; t < num_times; ++t)
-        {
-            /* Construct the baseline coordinates for the given time. */
-            unsigned int start_row = (start_time_index + t) * num_baseln_out;
-            for (a1 = 0, b = 0, i_out = 0; a1 < num_stations; ++a1)
-            {
-                if (have_autocorr)
-                {
-                    uu_out[i_out] = 0.0;
-                    vv_out[i_out] = 0.0;
-                    ww_out[i_out] = 0.0;
-                    ++i_out;
-                }
-                if (have_crosscorr)
-                {
-                    for (a2 = a1 + 1; a2 < num_stations; ++a2, ++b, ++i_out)
-                    {
-                        i = num_baseln_in * t + b;
-                        uu_out[i_out] = uu_in[i];
-                        vv_out[i_out] = vv_in[i];
-                        ww_out[i_out] = ww_in[i];
-                    }
-                }
-            }
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    out = (float*) staging;
 
-            for (c = 0, i_out = 0; c < num_channels; ++c)
+    /* Write the u,v,w coordinates for each time step. */
+    for (t = 0; t < num_times; ++t)
+    {
+        const unsigned int start_row =
+                (start_time_index + t) * num_baseln_out;
+        const size_t offset = (size_t) t * num_baseln_in;
+        const double time_stamp = t_start_sec +
+                (start_time_index + t + 0.5) * interval_sec;
+        if (prec == OSKAR_DOUBLE)
+        {
+            const double *uu, *vv, *ww;
+            uu = oskar_mem_double_const(in_uu, status) + offset;
+            vv = oskar_mem_double_const(in_vv, status) + offset;
+            ww = oskar_mem_double_const(in_ww, status) + offset;
+            if (have_autocorr)
             {
-                /* Construct amplitude data for the given time and channel. */
-                if (num_pols_in == 4)
-                {
-                    for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                    {
-                        if (have_autocorr)
-                        {
-                            i = num_stations * (t * num_channels + c) + a1;
-                            ((double4c*)out)[i_out++] =
-                                    ((const double4c*)acorr)[i];
-                        }
-                        if (have_crosscorr)
-                        {
-                            for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                            {
-                                i = num_baseln_in * (t * num_channels + c) + b;
-                                ((double4c*)out)[i_out++] =
-                                        ((const double4c*)xcorr)[i];
-                            }
-                        }
-                    }
-                }
-                else if (num_pols_in == 1 && num_pols_out == 1)
-                {
-                    for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                    {
-                        if (have_autocorr)
-                        {
-                            i = num_stations * (t * num_channels + c) + a1;
-                            ((double2*)out)[i_out++] =
-                                    ((const double2*)acorr)[i];
-                        }
-                        if (have_crosscorr)
-                        {
-                            for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                            {
-                                i = num_baseln_in * (t * num_channels + c) + b;
-                                ((double2*)out)[i_out++] =
-                                        ((const double2*)xcorr)[i];
-                            }
-                        }
-                    }
-                }
-                else
-                {
-                    double2 vis_amp, *out_;
-                    out_ = (double2*)out;
-                    for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                    {
-                        if (have_autocorr)
-                        {
-                            i = num_stations * (t * num_channels + c) + a1;
-                            vis_amp = ((const double2*)acorr)[i];
-                            out_[i_out + 0] = vis_amp;  /* XX */
-                            out_[i_out + 1].x = 0.0;    /* XY */
-                            out_[i_out + 1].y = 0.0;    /* XY */
-                            out_[i_out + 2].x = 0.0;    /* YX */
-                            out_[i_out + 2].y = 0.0;    /* YX */
-                            out_[i_out + 3] = vis_amp;  /* YY */
-                            i_out += 4;
-                        }
-                        if (have_crosscorr)
-                        {
-                            for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                            {
-                                i = num_baseln_in * (t * num_channels + c) + b;
-                                vis_amp = ((const double2*)xcorr)[i];
-                                out_[i_out + 0] = vis_amp;  /* XX */
-                                out_[i_out + 1].x = 0.0;    /* XY */
-                                out_[i_out + 1].y = 0.0;    /* XY */
-                                out_[i_out + 2].x = 0.0;    /* YX */
-                                out_[i_out + 2].y = 0.0;    /* YX */
-                                out_[i_out + 3] = vis_amp;  /* YY */
-                                i_out += 4;
-                            }
-                        }
-                    }
-                }
+                double* uvw = (double*) (staging + vis_bytes);
+                stage_uvw_d(num_stations, have_crosscorr, uu, vv, ww,
+                        uvw, uvw + num_baseln_out, uvw + 2 * num_baseln_out);
+                uu = uvw;
+                vv = uvw + num_baseln_out;
+                ww = uvw + 2 * num_baseln_out;
             }
             oskar_ms_write_coords_d(ms, start_row, num_baseln_out,
-                    uu_out, vv_out, ww_out, exposure_sec, interval_sec,
-                    (start_time_index + t + 0.5) * interval_sec + t_start_sec);
-            oskar_ms_write_vis_d(ms, start_row, start_chan_index,
-                    num_channels, num_baseln_out, (const double*)out);
+                    uu, vv, ww, exposure_sec, interval_sec, time_stamp);
         }
-    }
-    else if (prec == OSKAR_SINGLE)
-    {
-        const float *uu_in, *vv_in, *ww_in;
-        float *uu_out, *vv_out, *ww_out;
-        uu_in = oskar_mem_float_const(in_uu, status);
-        vv_in = oskar_mem_float_const(in_vv, status);
-        ww_in = oskar_mem_float_const(in_ww, status);
-        uu_out = oskar_mem_float(temp_uu, status);
-        vv_out = oskar_mem_float(temp_vv, status);
-        ww_out = oskar_mem_float(temp_ww, status);
-        for (t = 0; t < num_times; ++t)
+        else if (prec == OSKAR_SINGLE)
         {
-            /* Construct the baseline coordinates for the given time. */
-            unsigned int start_row = (start_time_index + t) * num_baseln_out;
-            for (a1 = 0, b = 0, i_out = 0; a1 < num_stations; ++a1)
-            {
-                if (have_autocorr)
-                {
-                    uu_out[i_out] = 0.0;
-                    vv_out[i_out] = 0.0;
-                    ww_out[i_out] = 0.0;
-                    ++i_out;
-                }
-                if (have_crosscorr)
-                {
-                    for (a2 = a1 + 1; a2 < num_stations; ++a2, ++b, ++i_out)
-                    {
-                        i = num_baseln_in * t + b;
-                        uu_out[i_out] = uu_in[i];
-                        vv_out[i_out] = vv_in[i];
-                        ww_out[i_out] = ww_in[i];
-                    }
-                }
-            }
-
-            for (c = 0, i_out = 0; c < num_channels; ++c)
+            const float *uu, *vv, *ww;
+            uu = oskar_mem_float_const(in_uu, status) + offset;
+            vv = oskar_mem_float_const(in_vv, status) + offset;
+            ww = oskar_mem_float_const(in_ww, status) + offset;
+            if (have_autocorr)
             {
-                /* Construct amplitude data for the given time and channel. */
-                if (num_pols_in == 4)
-                {
-                    for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                    {
-                        if (have_autocorr)
-                        {
-                            i = num_stations * (t * num_channels + c) + a1;
-                            ((float4c*)out)[i_out++] =
-                                    ((const float4c*)acorr)[i];
-                        }
-                        if (have_crosscorr)
-                        {
-                            for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                            {
-                                i = num_baseln_in * (t * num_channels + c) + b;
-                                ((float4c*)out)[i_out++] =
-                                        ((const float4c*)xcorr)[i];
-                            }
-                        }
-                    }
-                }
-                else if (num_pols_in == 1 && num_pols_out == 1)
-                {
-                    for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                    {
-                        if (have_autocorr)
-                        {
-                            i = num_stations * (t * num_channels + c) + a1;
-                            ((float2*)out)[i_out++] =
-                                    ((const float2*)acorr)[i];
-                        }
-                        if (have_crosscorr)
-                        {
-                            for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                            {
-                                i = num_baseln_in * (t * num_channels + c) + b;
-                                ((float2*)out)[i_out++] =
-                                        ((const float2*)xcorr)[i];
-                            }
-                        }
-                    }
-                }
-                else
-                {
-                    float2 vis_amp, *out_;
-                    out_ = (float2*)out;
-                    for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                    {
-                        if (have_autocorr)
-                        {
-                            i = num_stations * (t * num_channels + c) + a1;
-                            vis_amp = ((const float2*)acorr)[i];
-                            out_[i_out + 0] = vis_amp;  /* XX */
-                            out_[i_out + 1].x = 0.0;    /* XY */
-                            out_[i_out + 1].y = 0.0;    /* XY */
-                            out_[i_out + 2].x = 0.0;    /* YX */
-                            out_[i_out + 2].y = 0.0;    /* YX */
-                            out_[i_out + 3] = vis_amp;  /* YY */
-                            i_out += 4;
-                        }
-                        if (have_crosscorr)
-                        {
-                            for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                            {
-                                i = num_baseln_in * (t * num_channels + c) + b;
-                                vis_amp = ((const float2*)xcorr)[i];
-                                out_[i_out + 0] = vis_amp;  /* XX */
-                                out_[i_out + 1].x = 0.0;    /* XY */
-                                out_[i_out + 1].y = 0.0;    /* XY */
-                                out_[i_out + 2].x = 0.0;    /* YX */
-                                out_[i_out + 2].y = 0.0;    /* YX */
-                                out_[i_out + 3] = vis_amp;  /* YY */
-                                i_out += 4;
-                            }
-                        }
-                    }
-                }
+                float* uvw = (float*) (staging + vis_bytes);
+                stage_uvw_f(num_stations, have_crosscorr, uu, vv, ww,
+                        uvw, uvw + num_baseln_out, uvw + 2 * num_baseln_out);
+                uu = uvw;
+                vv = uvw + num_baseln_out;
+                ww = uvw + 2 * num_baseln_out;
             }
             oskar_ms_write_coords_f(ms, start_row, num_baseln_out,
-                    uu_out, vv_out, ww_out, exposure_sec, interval_sec,
-                    (start_time_index + t + 0.5) * interval_sec + t_start_sec);
-            oskar_ms_write_vis_f(ms, start_row, start_chan_index,
-                    num_channels, num_baseln_out, (const float*)out);
+                    uu, vv, ww, exposure_sec, interval_sec, time_stamp);
+        }
+        else
+        {
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+            return;
         }
-    }
-    else
-    {
-        *status = OSKAR_ERR_BAD_DATA_TYPE;
     }
 
-    /* Cleanup. */
-    oskar_mem_free(temp_vis, status);
-    oskar_mem_free(temp_uu, status);
-    oskar_mem_free(temp_vv, status);
-    oskar_mem_free(temp_ww, status);
+    /* Reorder the visibilities and write the whole block at once. */
+    oskar_vis_block_stage_ms(blk, num_pols_out, out, status);
+    if (*status) return;
+    oskar_ms_write_vis_rows_f(ms, start_time_index * num_baseln_out,
+            start_chan_index, num_channels, num_times * num_baseln_out, out);
 }
 
 #ifdef __cplusplus
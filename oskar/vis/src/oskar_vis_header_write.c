@@ -56,6 +56,9 @@ oskar_Binary* oskar_vis_header_write(const oskar_VisHeader* hdr,
         return 0;
     }
 
+    /* Append a tag index when the file is closed, for faster reading. */
+    oskar_binary_set_write_index(h, 1);
+
     /* Write the header and common metadata. */
     oskar_binary_write_metadata(h, status);
 
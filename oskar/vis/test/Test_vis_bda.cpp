@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "vis/oskar_vis_bda.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <vector>
+
+TEST(vis_bda, average_blocks)
+{
+    int status = 0;
+    const int num_stations = 3, num_channels = 2, num_times = 10;
+    const int max_times_per_block = 4, num_baselines = 3;
+    const double freq_start_hz = 100e6, freq_inc_hz = 1e6;
+    const double time_start_mjd = 58000.0, time_inc_sec = 1.0;
+
+    // Baseline b moves (b + 1) metres per time step. Allow a movement of
+    // 2.5 metres at the highest frequency, and averages of 4 seconds.
+    const double max_dist = 2.5 * (freq_start_hz + freq_inc_hz) / 299792458.0;
+    oskar_VisHeader* hdr = oskar_vis_header_create(OSKAR_SINGLE_COMPLEX,
+            OSKAR_SINGLE, max_times_per_block, num_times, num_channels,
+            num_channels, num_stations, 1, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, freq_start_hz);
+    oskar_vis_header_set_freq_inc_hz(hdr, freq_inc_hz);
+    oskar_vis_header_set_time_start_mjd_utc(hdr, time_start_mjd);
+    oskar_vis_header_set_time_inc_sec(hdr, time_inc_sec);
+    oskar_vis_header_set_time_average_sec(hdr, 0.5);
+    oskar_VisBda* bda = oskar_vis_bda_create(hdr, 4.0, max_dist, &status);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(OSKAR_CPU,
+            hdr, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Amplitudes are (time index, channel index) on every baseline.
+    for (int start = 0; start < num_times; start += max_times_per_block)
+    {
+        int n = num_times - start;
+        if (n > max_times_per_block) n = max_times_per_block;
+        oskar_vis_block_set_start_time_index(blk, start);
+        oskar_vis_block_set_num_times(blk, n, &status);
+        float* uu = oskar_mem_float(
+                oskar_vis_block_baseline_uu_metres(blk), &status);
+        float* xc = oskar_mem_float(
+                oskar_vis_block_cross_correlations(blk), &status);
+        float* ac = oskar_mem_float(
+                oskar_vis_block_auto_correlations(blk), &status);
+        for (int t = 0; t < n; ++t)
+        {
+            for (int b = 0; b < num_baselines; ++b)
+                uu[t * num_baselines + b] = (float) ((b + 1) * (start + t));
+            for (int c = 0; c < num_channels; ++c)
+            {
+                for (int b = 0; b < num_baselines; ++b)
+                {
+                    int i = num_baselines * (t * num_channels + c) + b;
+                    xc[2*i] = (float) (start + t);
+                    xc[2*i + 1] = (float) c;
+                }
+                for (int s = 0; s < num_stations; ++s)
+                {
+                    int i = num_stations * (t * num_channels + c) + s;
+                    ac[2*i] = (float) (start + t);
+                    ac[2*i + 1] = (float) c;
+                }
+            }
+        }
+        oskar_vis_bda_add_block(bda, blk, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+    oskar_vis_bda_flush(bda, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Baselines are averaged over 3, 2 and 1 samples.
+    // Auto-correlations are averaged over 4 samples.
+    const int num_rows = oskar_vis_bda_num_rows(bda);
+    EXPECT_EQ(4 + 5 + 10 + 3 * 3, num_rows);
+    EXPECT_EQ((size_t) (num_times * (num_baselines + num_stations)),
+            oskar_vis_bda_num_input_rows(bda));
+    const int* a1 = oskar_mem_int_const(
+            oskar_vis_bda_antenna1_const(bda), &status);
+    const int* a2 = oskar_mem_int_const(
+            oskar_vis_bda_antenna2_const(bda), &status);
+    const double* uu = oskar_mem_double_const(
+            oskar_vis_bda_uu_metres_const(bda), &status);
+    const double* tc = oskar_mem_double_const(
+            oskar_vis_bda_time_centroid_const(bda), &status);
+    const double* interval = oskar_mem_double_const(
+            oskar_vis_bda_interval_sec_const(bda), &status);
+    const double* exposure = oskar_mem_double_const(
+            oskar_vis_bda_exposure_sec_const(bda), &status);
+    const double* weight = oskar_mem_double_const(
+            oskar_vis_bda_weight_const(bda), &status);
+    const double* vis = oskar_mem_double_const(
+            oskar_vis_bda_vis_const(bda), &status);
+    std::vector<double> weight_sum(num_baselines + num_stations, 0.0);
+    for (int r = 0; r < num_rows; ++r)
+    {
+        // Check the expected number of samples in each average.
+        int slot = num_baselines + a1[r], expected = 4, first;
+        if (a1[r] != a2[r])
+        {
+            slot = (a1[r] == 0) ? a2[r] - 1 : 2;
+            expected = 3 - slot;
+        }
+        first = (int) (weight_sum[slot] + 0.5);
+        if (first + expected > num_times) expected = num_times - first;
+        EXPECT_DOUBLE_EQ((double) expected, weight[r]);
+        EXPECT_DOUBLE_EQ(expected * time_inc_sec, interval[r]);
+        EXPECT_DOUBLE_EQ(expected * 0.5, exposure[r]);
+        weight_sum[slot] += weight[r];
+
+        // Check the averages.
+        const double mean_t = first + (expected - 1) / 2.0;
+        EXPECT_NEAR(time_start_mjd * 86400.0 + mean_t + 0.5, tc[r], 1e-6);
+        if (a1[r] != a2[r])
+        {
+            EXPECT_DOUBLE_EQ((slot + 1) * mean_t, uu[r]);
+        }
+        for (int c = 0; c < num_channels; ++c)
+        {
+            EXPECT_DOUBLE_EQ(mean_t, vis[2 * (r * num_channels + c)]);
+            EXPECT_DOUBLE_EQ((double) c, vis[2 * (r * num_channels + c) + 1]);
+        }
+    }
+    for (int s = 0; s < num_baselines + num_stations; ++s)
+        EXPECT_DOUBLE_EQ((double) num_times, weight_sum[s]);
+
+    // Check the output can be cleared.
+    oskar_vis_bda_clear_output(bda);
+    EXPECT_EQ(0, oskar_vis_bda_num_rows(bda));
+    oskar_vis_bda_free(bda, &status);
+    oskar_vis_block_free(blk, &status);
+    oskar_vis_header_free(hdr, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "vis/oskar_vis_block.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <vector>
+
+// Fills the block with values that identify each input sample:
+// cross-correlations are positive, and auto-correlations are negative.
+static void fill_block(oskar_VisBlock* blk, int* status)
+{
+    oskar_Mem* mem[] = {oskar_vis_block_cross_correlations(blk),
+            oskar_vis_block_auto_correlations(blk)};
+    for (int m = 0; m < 2; ++m)
+    {
+        const double sign = (m == 0) ? 1.0 : -1.0;
+        size_t n = 2 * oskar_mem_length(mem[m]);
+        if (oskar_mem_is_matrix(mem[m])) n *= 4;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (oskar_mem_precision(mem[m]) == OSKAR_DOUBLE)
+                oskar_mem_double(mem[m], status)[i] = sign * (i + 1);
+            else
+                oskar_mem_float(mem[m], status)[i] = (float) (sign * (i + 1));
+        }
+    }
+}
+
+// Returns the expected output, ordered by (time, baseline, channel, pol).
+static std::vector<float> expected_output(const oskar_VisBlock* blk,
+        int num_pols_out)
+{
+    const int num_times = oskar_vis_block_num_times(blk);
+    const int num_channels = oskar_vis_block_num_channels(blk);
+    const int num_stations = oskar_vis_block_num_stations(blk);
+    const int num_baselines = oskar_vis_block_num_baselines(blk);
+    const int num_pols_in = oskar_vis_block_num_pols(blk);
+    const int have_auto = oskar_vis_block_has_auto_correlations(blk);
+    const int have_cross = oskar_vis_block_has_cross_correlations(blk);
+    std::vector<float> out;
+    for (int t = 0; t < num_times; ++t)
+    {
+        for (int a1 = 0, b = 0; a1 < num_stations; ++a1)
+        {
+            for (int a2 = a1; a2 < num_stations; ++a2)
+            {
+                if ((a1 == a2 && !have_auto) || (a1 != a2 && !have_cross))
+                    continue;
+                for (int c = 0; c < num_channels; ++c)
+                {
+                    // Index of the first input value for the sample.
+                    double v = (a1 == a2) ? -(1.0 + 2 * num_pols_in *
+                            ((t * num_channels + c) * num_stations + a1)) :
+                            (1.0 + 2 * num_pols_in *
+                            ((t * num_channels + c) * num_baselines + b));
+                    const double step = (a1 == a2) ? -1.0 : 1.0;
+                    for (int k = 0; k < 2 * num_pols_out; ++k)
+                    {
+                        if (num_pols_in == num_pols_out)
+                            out.push_back((float) (v + step * k));
+                        else if (k < 2 || k > 5)
+                            out.push_back((float) (v + step * (k % 2)));
+                        else
+                            out.push_back(0.0f);
+                    }
+                }
+                if (a1 != a2) ++b;
+            }
+        }
+    }
+    return out;
+}
+
+static void check_stage(int amp_type, int num_pols_out, int create_cross,
+        int create_auto)
+{
+    int status = 0;
+    const int num_times = 3, num_channels = 37, num_stations = 5;
+
+    // Use enough channels to need more than one tile.
+    oskar_VisBlock* blk = oskar_vis_block_create(OSKAR_CPU, amp_type,
+            num_times, num_channels, num_stations,
+            create_cross, create_auto, &status);
+    fill_block(blk, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    std::vector<float> expected = expected_output(blk, num_pols_out);
+    std::vector<float> out(expected.size() + 1, 123.0f);
+    oskar_vis_block_stage_ms(blk, num_pols_out, &out[0], &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    for (size_t i = 0; i < expected.size(); ++i)
+        ASSERT_EQ(expected[i], out[i]) << "Output value " << i;
+
+    // Check nothing is written past the end.
+    EXPECT_EQ(123.0f, out[expected.size()]);
+    oskar_vis_block_free(blk, &status);
+}
+
+TEST(vis_block_stage_ms, matrix_double)
+{
+    check_stage(OSKAR_DOUBLE_COMPLEX_MATRIX, 4, 1, 1);
+    check_stage(OSKAR_DOUBLE_COMPLEX_MATRIX, 4, 1, 0);
+    check_stage(OSKAR_DOUBLE_COMPLEX_MATRIX, 4, 0, 1);
+}
+
+TEST(vis_block_stage_ms, matrix_single)
+{
+    check_stage(OSKAR_SINGLE_COMPLEX_MATRIX, 4, 1, 1);
+}
+
+TEST(vis_block_stage_ms, scalar)
+{
+    check_stage(OSKAR_DOUBLE_COMPLEX, 1, 1, 1);
+    check_stage(OSKAR_SINGLE_COMPLEX, 1, 1, 0);
+}
+
+TEST(vis_block_stage_ms, scalar_to_matrix)
+{
+    check_stage(OSKAR_DOUBLE_COMPLEX, 4, 1, 1);
+    check_stage(OSKAR_SINGLE_COMPLEX, 4, 0, 1);
+}
+
+TEST(vis_block_stage_ms, dimension_mismatch)
+{
+    int status = 0;
+    float out[1];
+    oskar_VisBlock* blk = oskar_vis_block_create(OSKAR_CPU,
+            OSKAR_DOUBLE_COMPLEX_MATRIX, 1, 1, 2, 1, 0, &status);
+    oskar_vis_block_stage_ms(blk, 1, out, &status);
+    EXPECT_EQ((int) OSKAR_ERR_DIMENSION_MISMATCH, status);
+    status = 0;
+    oskar_vis_block_free(blk, &status);
+}
@@ -38,6 +38,7 @@
 #include "math/oskar_cmath.h"
 
 #include <cstdio>
+#include <vector>
 
 TEST(write_ms, test_write)
 {
@@ -221,3 +222,114 @@ TEST(write_ms, test_write_partial)
     oskar_dir_remove(filename);
 }
 
+
+
+TEST(write_ms, round_trip)
+{
+    int status = 0;
+    const int num_antennas = 4, num_channels = 20, num_times = 5;
+    const int max_times_per_block = 3, num_pols = 4;
+    const int num_baselines = num_antennas * (num_antennas - 1) / 2;
+    const int num_rows_per_time = num_baselines + num_antennas;
+
+    // Write auto- and cross-correlations, in two blocks.
+    // There are enough channels to need more than one tile in the transpose.
+    oskar_VisHeader* hdr = oskar_vis_header_create(
+            OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_DOUBLE, max_times_per_block,
+            num_times, num_channels, num_channels, num_antennas, 1, 1,
+            &status);
+    oskar_vis_header_set_phase_centre(hdr, 0, 160.0, 89.0);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 1e6);
+    oskar_vis_header_set_time_start_mjd_utc(hdr,
+            oskar_convert_date_time_to_mjd(2011, 11, 17, 0.0));
+    oskar_vis_header_set_time_inc_sec(hdr, 1.0);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(OSKAR_CPU,
+            hdr, &status);
+    const char filename[] = "temp_test_write_ms_round_trip.ms";
+    oskar_MeasurementSet* ms = oskar_vis_header_write_ms(hdr, filename,
+            OSKAR_TRUE, OSKAR_FALSE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    std::vector<float> expected_vis;
+    std::vector<double> expected_uu;
+    for (int start = 0; start < num_times; start += max_times_per_block)
+    {
+        int n = num_times - start;
+        if (n > max_times_per_block) n = max_times_per_block;
+        oskar_vis_block_set_start_time_index(blk, start);
+        oskar_vis_block_set_num_times(blk, n, &status);
+        double* xc = oskar_mem_double(
+                oskar_vis_block_cross_correlations(blk), &status);
+        double* ac = oskar_mem_double(
+                oskar_vis_block_auto_correlations(blk), &status);
+        double* uu = oskar_mem_double(
+                oskar_vis_block_baseline_uu_metres(blk), &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        for (int i = 0; i < 8 * n * num_channels * num_baselines; ++i)
+            xc[i] = start * 10000.0 + i + 1;
+        for (int i = 0; i < 8 * n * num_channels * num_antennas; ++i)
+            ac[i] = -(start * 10000.0 + i + 1);
+        for (int t = 0; t < n; ++t)
+        {
+            for (int a1 = 0, b = 0; a1 < num_antennas; ++a1)
+            {
+                expected_uu.push_back(0.0);
+                for (int a2 = a1 + 1; a2 < num_antennas; ++a2, ++b)
+                {
+                    uu[t * num_baselines + b] = (start + t) * 100.0 + b + 1;
+                    expected_uu.push_back(uu[t * num_baselines + b]);
+                }
+            }
+        }
+
+        // The layout of the staged data is tested separately.
+        std::vector<float> staged(2 * num_pols * n * num_channels *
+                num_rows_per_time);
+        oskar_vis_block_stage_ms(blk, num_pols, &staged[0], &status);
+        expected_vis.insert(expected_vis.end(), staged.begin(), staged.end());
+        oskar_vis_block_write_ms(blk, hdr, ms, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+    oskar_vis_block_free(blk, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_ms_close(ms);
+
+    // Read it back, and check every row.
+    ms = oskar_ms_open(filename);
+    ASSERT_TRUE(ms != 0);
+    ASSERT_EQ((unsigned int) (num_times * num_rows_per_time),
+            oskar_ms_num_rows(ms));
+    ASSERT_EQ((unsigned int) num_pols, oskar_ms_num_pols(ms));
+    std::vector<float> vis(2 * num_pols * num_channels * num_rows_per_time);
+    std::vector<double> uu(num_rows_per_time), vv(num_rows_per_time);
+    std::vector<double> ww(num_rows_per_time);
+    for (int t = 0; t < num_times; ++t)
+    {
+        const int start_row = t * num_rows_per_time;
+        oskar_ms_read_coords_d(ms, start_row, num_rows_per_time,
+                &uu[0], &vv[0], &ww[0], &status);
+        oskar_ms_read_vis_f(ms, start_row, 0, num_channels,
+                num_rows_per_time, "DATA", &vis[0], &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        for (int r = 0; r < num_rows_per_time; ++r)
+        {
+            EXPECT_DOUBLE_EQ(expected_uu[start_row + r], uu[r]);
+            for (int c = 0; c < num_channels; ++c)
+            {
+                for (int k = 0; k < 2 * num_pols; ++k)
+                {
+                    // Read data is (channel, row, pol);
+                    // staged data is (time, row, channel, pol).
+                    const size_t i = 2 * num_pols *
+                            ((size_t) c * num_rows_per_time + r) + k;
+                    const size_t j = 2 * num_pols *
+                            (((size_t) start_row + r) * num_channels + c) + k;
+                    ASSERT_EQ(expected_vis[j], vis[i]) << "Time " << t <<
+                            ", row " << r << ", channel " << c;
+                }
+            }
+        }
+    }
+    oskar_ms_close(ms);
+    oskar_dir_remove(filename);
+}
@@ -168,6 +168,15 @@ class Interferometer(object):
         self.capsule_ensure()
         return _interferometer_lib.num_gpus(self._capsule)
 
+    def get_num_threads_per_device(self):
+        """Returns the number of OpenMP threads used by each CPU device.
+
+        Returns:
+            int: The number of threads per CPU compute device.
+        """
+        self.capsule_ensure()
+        return _interferometer_lib.num_threads_per_device(self._capsule)
+
     def get_num_vis_blocks(self):
         """Returns the number of visibility blocks required for the simulation.
 
@@ -309,6 +318,18 @@ class Interferometer(object):
         self.capsule_ensure()
         _interferometer_lib.set_num_devices(self._capsule, value)
 
+    def set_num_threads_per_device(self, value):
+        """Sets the number of OpenMP threads used by each CPU device.
+
+        If the number of compute devices is chosen automatically, call this
+        before set_num_devices().
+
+        Args:
+            value (int): Number of threads per CPU compute device.
+        """
+        self.capsule_ensure()
+        _interferometer_lib.set_num_threads_per_device(self._capsule, value)
+
     def set_observation_frequency(self, start_frequency_hz,
                                   inc_hz=0.0, num_channels=1):
         """Sets observation start frequency, increment, and number of channels.
@@ -414,6 +435,8 @@ class Interferometer(object):
     capsule = property(capsule_get, capsule_set)
     coords_only = property(get_coords_only, set_coords_only)
     num_devices = property(get_num_devices, set_num_devices)
+    num_threads_per_device = property(get_num_threads_per_device,
+                                      set_num_threads_per_device)
     num_gpus = property(get_num_gpus)
     num_vis_blocks = property(get_num_vis_blocks)
 
@@ -193,6 +193,16 @@ static PyObject* num_gpus(PyObject* self, PyObject* args)
 }
 
 
+static PyObject* num_threads_per_device(PyObject* self, PyObject* args)
+{
+    oskar_Interferometer* h = 0;
+    PyObject* capsule = 0;
+    if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
+    if (!(h = (oskar_Interferometer*) get_handle(capsule, name))) return 0;
+    return Py_BuildValue("i", oskar_interferometer_num_threads_per_device(h));
+}
+
+
 static PyObject* num_vis_blocks(PyObject* self, PyObject* args)
 {
     oskar_Interferometer* h = 0;
@@ -423,6 +433,18 @@ static PyObject* set_num_devices(PyObject* self, PyObject* args)
 }
 
 
+static PyObject* set_num_threads_per_device(PyObject* self, PyObject* args)
+{
+    oskar_Interferometer* h = 0;
+    PyObject* capsule = 0;
+    int value = 0;
+    if (!PyArg_ParseTuple(args, "Oi", &capsule, &value)) return 0;
+    if (!(h = (oskar_Interferometer*) get_handle(capsule, name))) return 0;
+    oskar_interferometer_set_num_threads_per_device(h, value);
+    return Py_BuildValue("");
+}
+
+
 static PyObject* set_observation_frequency(PyObject* self, PyObject* args)
 {
     oskar_Interferometer* h = 0;
@@ -612,6 +634,8 @@ static PyMethodDef methods[] =
         {"num_devices", (PyCFunction)num_devices,
                 METH_VARARGS, "num_devices()"},
         {"num_gpus", (PyCFunction)num_gpus, METH_VARARGS, "num_gpus()"},
+        {"num_threads_per_device", (PyCFunction)num_threads_per_device,
+                METH_VARARGS, "num_threads_per_device()"},
         {"num_vis_blocks", (PyCFunction)num_vis_blocks,
                 METH_VARARGS, "num_vis_blocks()"},
         {"reset_cache", (PyCFunction)reset_cache,
@@ -637,6 +661,8 @@ static PyMethodDef methods[] =
                 METH_VARARGS, "set_max_times_per_block(value)"},
         {"set_num_devices", (PyCFunction)set_num_devices,
                 METH_VARARGS, "set_num_devices(value)"},
+        {"set_num_threads_per_device", (PyCFunction)set_num_threads_per_device,
+                METH_VARARGS, "set_num_threads_per_device(value)"},
         {"set_observation_frequency", (PyCFunction)set_observation_frequency,
                 METH_VARARGS,
                 "set_observation_frequency(start_freq_hz, inc_hz, "